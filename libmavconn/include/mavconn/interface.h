@@ -33,11 +33,12 @@
 #include <sstream>
 #include <cassert>
 #include <stdexcept>
-#include <unordered_map>
 #include <mavconn/mavlink_dialect.h>
 
 
 namespace mavconn {
+struct MsgBuffer;
+
 using steady_clock = std::chrono::steady_clock;
 using lock_guard = std::lock_guard<std::recursive_mutex>;
 
@@ -58,6 +59,18 @@ enum class Protocol : uint8_t {
 	V20 = 2		//!< MAVLink v2.0
 };
 
+/**
+ * @brief Transport TX priority band.
+ *
+ * Lower bands overtake higher ones in the transmit queue, so
+ * latency-critical traffic is not stuck behind bulk transfers.
+ */
+enum class TxPrio : uint8_t {
+	REALTIME = 0,	//!< latency-critical: setpoints, heartbeat
+	NORMAL = 1,	//!< default traffic
+	BULK = 2,	//!< background transfers: param, ftp, log download
+};
+
 /**
  * @brief Common exception for communication error
  */
@@ -73,9 +86,8 @@ public:
 
 	template <typename T>
 	static std::string make_message(const char *module, T msg) {
-		std::ostringstream ss;
-		ss << "DeviceError:" << module << ":" << msg_to_string(msg);
-		return ss.str();
+		// error path, but no need to drag in an ostringstream for it
+		return std::string("DeviceError:") + module + ":" + msg_to_string(msg);
 	}
 
 	static std::string msg_to_string(const char *description) {
@@ -101,6 +113,9 @@ private:
 public:
 	using ReceivedCb = std::function<void (const mavlink::mavlink_message_t *message, const Framing framing)>;
 	using ClosedCb = std::function<void (void)>;
+	//! TX backpressure notification: true above the high watermark,
+	//! false once the queue drains below the low watermark.
+	using BackpressureCb = std::function<void (bool congested)>;
 	using Ptr = std::shared_ptr<MAVConnInterface>;
 	using ConstPtr = std::shared_ptr<MAVConnInterface const>;
 	using WeakPtr = std::weak_ptr<MAVConnInterface>;
@@ -112,6 +127,16 @@ public:
 		float rx_speed;		//!< current receive speed [B/s]
 	};
 
+	struct MsgStat {
+		mavlink::msgid_t msgid;	//!< EMPTY_MSGID slot aggregates unknown ids
+		uint32_t rx_count;
+		uint32_t tx_count;
+		uint64_t rx_bytes;	//!< approximate on-wire bytes
+		uint64_t tx_bytes;	//!< approximate on-wire bytes
+		steady_clock::time_point last_rx;	//!< epoch when never received
+		steady_clock::time_point last_tx;	//!< epoch when never sent
+	};
+
 	/**
 	 * @param[in] system_id     sysid for send_message
 	 * @param[in] component_id  compid for send_message
@@ -167,6 +192,59 @@ public:
 	 */
 	virtual void send_bytes(const uint8_t *bytes, size_t length) = 0;
 
+	/**
+	 * @brief Send message with explicit TX priority band.
+	 *
+	 * Default implementation ignores the priority, for transports
+	 * without banded queues.
+	 *
+	 * @throws std::length_error  On exceeding Tx queue limit (MAX_TXQ_SIZE)
+	 */
+	virtual void send_message(const mavlink::mavlink_message_t *message, TxPrio prio) {
+		(void)prio;
+		send_message(message);
+	}
+
+	//! @copydoc send_message(const mavlink::mavlink_message_t*, TxPrio)
+	virtual void send_message(const mavlink::Message &message, const uint8_t src_compid, TxPrio prio) {
+		(void)prio;
+		send_message(message, src_compid);
+	}
+
+	//! @copydoc send_message(const mavlink::mavlink_message_t*, TxPrio)
+	void send_message(const mavlink::Message &message, TxPrio prio) {
+		send_message(message, this->comp_id, prio);
+	}
+
+	/**
+	 * @brief Non-throwing send.
+	 *
+	 * @return false when the message could not be queued (TX queue
+	 *         above capacity or channel closed); senders should pace
+	 *         themselves using tx_backpressure_cb instead of paying
+	 *         exception unwinding in the hot path.
+	 */
+	virtual bool try_send_message(const mavlink::mavlink_message_t *message, TxPrio prio = TxPrio::NORMAL);
+
+	//! @copydoc try_send_message(const mavlink::mavlink_message_t*, TxPrio)
+	virtual bool try_send_message(const mavlink::Message &message, const uint8_t src_compid, TxPrio prio);
+
+	//! @copydoc try_send_message(const mavlink::mavlink_message_t*, TxPrio)
+	bool try_send_message(const mavlink::Message &message, TxPrio prio = TxPrio::NORMAL) {
+		return try_send_message(message, this->comp_id, prio);
+	}
+
+	/**
+	 * @brief Send an already-serialized refcounted buffer.
+	 *
+	 * Routers use this to fan one serialization out to many links
+	 * without per-link copies. A full TX queue drops the payload for
+	 * this link only (no throw). Default implementation copies
+	 * through send_bytes(); queued transports enqueue the shared
+	 * payload directly.
+	 */
+	virtual void send_shared(std::shared_ptr<const MsgBuffer> payload, TxPrio prio = TxPrio::NORMAL);
+
 	/**
 	 * @brief Send message and ignore possible drop due to Tx queue limit
 	 */
@@ -189,13 +267,49 @@ public:
 	 */
 	void send_message_ignore_drop(const mavlink::Message &message, const uint8_t src_compid);
 
+	//! Priority-band variant of send_message_ignore_drop()
+	void send_message_ignore_drop(const mavlink::mavlink_message_t *message, TxPrio prio);
+
+	//! Priority-band variant of send_message_ignore_drop()
+	void send_message_ignore_drop(const mavlink::Message &message, TxPrio prio) {
+		send_message_ignore_drop(message, this->comp_id, prio);
+	}
+
+	//! Priority-band variant of send_message_ignore_drop()
+	void send_message_ignore_drop(const mavlink::Message &message, const uint8_t src_compid, TxPrio prio);
+
 	//! Message receive callback
 	ReceivedCb message_received_cb;
 	//! Port closed notification callback
 	ClosedCb port_closed_cb;
+	//! TX high/low watermark notification callback.
+	//! May fire from sender or io threads; keep it cheap.
+	BackpressureCb tx_backpressure_cb;
+
+	/**
+	 * @brief Install per-message-ID RX allow-list.
+	 *
+	 * Messages whose id is not listed are dropped right after framing,
+	 * before message_received_cb, so unwanted traffic never reaches
+	 * routing. The check is one bit test per message.
+	 *
+	 * Thread-safe: the filter map is swapped atomically, the RX path
+	 * keeps using the old map until the swap is visible.
+	 */
+	void set_rx_filter(const std::vector<mavlink::msgid_t> &allowed_msgids);
+
+	//! Remove RX filter, accept all message IDs again.
+	void clear_rx_filter();
 
 	virtual mavlink::mavlink_status_t get_status();
 	virtual IOStat get_iostat();
+
+	/**
+	 * @brief Per-msgid RX/TX counters, sorted by msgid.
+	 *
+	 * Only message ids seen at least once are reported.
+	 */
+	std::vector<MsgStat> get_msg_stats();
 	virtual bool is_open() = 0;
 
 	inline uint8_t get_system_id() {
@@ -247,9 +361,47 @@ protected:
 	static constexpr size_t MAX_PACKET_SIZE = MAVLINK_MAX_PACKET_LEN + 16;
 	//! Maximum count of transmission buffers.
 	static constexpr size_t MAX_TXQ_SIZE = 1000;
+	//! TX queue level that triggers a congestion notification.
+	static constexpr size_t TXQ_HIGH_WATERMARK = MAX_TXQ_SIZE * 3 / 4;
+	//! TX queue level that clears the congestion notification.
+	static constexpr size_t TXQ_LOW_WATERMARK = MAX_TXQ_SIZE / 2;
 
-	//! This map merge all dialect mavlink_msg_entry_t structs. Needed for packet parser.
-	static std::unordered_map<mavlink::msgid_t, const mavlink::mavlink_msg_entry_t*> message_entries;
+	/**
+	 * @brief Flat hash table over all dialect mavlink_msg_entry_t structs.
+	 *
+	 * Built once by init_msg_entry(): the multiplier is searched until
+	 * every entry lands in its own cell, so the RX parse path does one
+	 * multiply, one mask and one compare per lookup.
+	 */
+	struct MsgEntryTable {
+		struct Cell {
+			mavlink::msgid_t msgid;
+			const mavlink::mavlink_msg_entry_t *entry;
+		};
+
+		//! Sentinel for empty cells (not a valid 24-bit msgid)
+		static constexpr mavlink::msgid_t EMPTY_MSGID = 0xFFFFFFFF;
+
+		std::vector<Cell> cells;
+		uint32_t mask = 0;
+		uint32_t mult = 0;
+
+		inline const mavlink::mavlink_msg_entry_t *find(mavlink::msgid_t msgid) const {
+			const Cell &c = cells[(msgid * mult) & mask];
+			return (c.msgid == msgid) ? c.entry : nullptr;
+		}
+
+		//! Stats slot for msgid; unknown ids share the overflow slot.
+		inline size_t stat_index(mavlink::msgid_t msgid) const {
+			size_t i = (msgid * mult) & mask;
+			return (cells[i].msgid == msgid) ? i : cells.size();
+		}
+
+		void build(const std::vector<const mavlink::mavlink_msg_entry_t*> &entries);
+	};
+
+	//! This table merge all dialect mavlink_msg_entry_t structs. Needed for packet parser.
+	static MsgEntryTable message_entries;
 
 	//! Channel number used for logging.
 	size_t conn_id;
@@ -270,6 +422,14 @@ protected:
 	void iostat_tx_add(size_t bytes);
 	void iostat_rx_add(size_t bytes);
 
+	//! Per-msgid counters: one multiply + mask + three relaxed adds.
+	void msg_stat_tx_add(const mavlink::mavlink_message_t *msg);
+	void msg_stat_tx_add(const mavlink::Message &msg);
+	void msg_stat_rx_add(const mavlink::mavlink_message_t &msg);
+
+	//! Fire tx_backpressure_cb on watermark crossings.
+	void update_backpressure(size_t queued);
+
 	void log_recv(const char *pfx, mavlink::mavlink_message_t &msg, Framing framing);
 	void log_send(const char *pfx, const mavlink::mavlink_message_t *msg);
 	void log_send_obj(const char *pfx, const mavlink::Message &msg);
@@ -281,6 +441,24 @@ private:
 	mavlink::mavlink_message_t m_buffer;
 	mavlink::mavlink_status_t m_mavlink_status;
 
+	//! Bitmap over the 24-bit msgid space; null means no filtering.
+	std::shared_ptr<std::vector<uint8_t>> rx_filter_map;
+
+	//! Congestion latch for update_backpressure().
+	std::atomic<bool> tx_congested {false};
+
+	//! Per-msgid counters, indexed like MsgEntryTable cells
+	//! (one extra overflow slot for unknown message ids).
+	struct MsgStatCell {
+		std::atomic<uint32_t> rx_count {0};
+		std::atomic<uint32_t> tx_count {0};
+		std::atomic<uint64_t> rx_bytes {0};
+		std::atomic<uint64_t> tx_bytes {0};
+		std::atomic<steady_clock::rep> last_rx {0};
+		std::atomic<steady_clock::rep> last_tx {0};
+	};
+	std::unique_ptr<MsgStatCell[]> msg_stat_cells;
+
 	std::atomic<size_t> tx_total_bytes, rx_total_bytes;
 	std::recursive_mutex iostat_mutex;
 	size_t last_tx_total_bytes, last_rx_total_bytes;
@@ -0,0 +1,59 @@
+/**
+ * @brief MAVConn loopback link class
+ * @file loopback.h
+ * @author Vladimir Ermakov <vooon341@gmail.com>
+ *
+ * @addtogroup mavconn
+ * @{
+ */
+/*
+ * libmavconn
+ * Copyright 2013,2014,2015,2016 Vladimir Ermakov, All rights reserved.
+ *
+ * This file is part of the mavros package and subject to the license terms
+ * in the top-level LICENSE file of the mavros repository.
+ * https://github.com/mavlink/mavros/tree/master/LICENSE.md
+ */
+
+#pragma once
+
+#include <atomic>
+#include <mavconn/interface.h>
+#include <mavconn/reactor.h>
+#include <mavconn/msgbuffer.h>
+
+namespace mavconn {
+/**
+ * @brief Loopback interface
+ *
+ * Shortcuts TX to RX in-process at memory speed: every sent message
+ * is re-parsed and delivered through message_received_cb on the
+ * reactor pool. Useful for benchmarks and plugin regression tests
+ * without sockets in the loop.
+ */
+class MAVConnLoopback : public MAVConnInterface,
+	public std::enable_shared_from_this<MAVConnLoopback> {
+public:
+	MAVConnLoopback(uint8_t system_id = 1, uint8_t component_id = MAV_COMP_ID_UDP_BRIDGE);
+	~MAVConnLoopback();
+
+	void close() override;
+
+	void send_message(const mavlink::mavlink_message_t *message) override;
+	void send_message(const mavlink::Message &message, const uint8_t source_compid) override;
+	void send_bytes(const uint8_t *bytes, size_t length) override;
+
+	inline bool is_open() override {
+		return open_flag;
+	}
+
+private:
+	boost::asio::io_service &io_service;
+	//! Serializes RX delivery on the shared reactor pool.
+	boost::asio::io_service::strand strand;
+
+	std::atomic<bool> open_flag;
+
+	void deliver(std::shared_ptr<MsgBuffer> buf);
+};
+}	// namespace mavconn
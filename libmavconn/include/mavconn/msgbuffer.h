@@ -18,31 +18,56 @@
 #pragma once
 
 #include <cassert>
+#include <memory>
 #include <mavconn/mavlink_dialect.h>
 
 namespace mavconn {
 /**
  * @brief Message buffer for internal use in libmavconn
+ *
+ * Variable layout: the wire size is computed up front, common small
+ * telemetry (HEARTBEAT, ATTITUDE, ...) lands in the inline array so a
+ * queued entry stays within a cache line or two, larger messages
+ * (FTP, PARAM bulk) spill to a heap block. The previous fixed
+ * MAX_SIZE layout pinned ~300 KiB per full TX queue.
  */
 struct MsgBuffer {
 	//! Maximum buffer size with padding for CRC bytes (280 + padding)
 	static constexpr ssize_t MAX_SIZE = MAVLINK_MAX_PACKET_LEN + 16;
-	uint8_t data[MAX_SIZE];
-	ssize_t len;
-	ssize_t pos;
+	/**
+	 * Inline storage, covers common small telemetry and the whole
+	 * setpoint class: SET_POSITION_TARGET_LOCAL_NED/GLOBAL_INT are
+	 * 67 wire bytes, 80 with a v2 signature, so the 100 Hz
+	 * ROS-topic-to-UART path stays allocation-free.
+	 */
+	static constexpr ssize_t INLINE_SIZE = 80;
+
+	int32_t len;
+	int32_t pos;
+	//! Refcounted immutable payload for broadcast; when set, bytes
+	//! come from the shared buffer and local storage stays unused.
+	std::shared_ptr<const MsgBuffer> shared;
+	//! Spill block for messages larger than INLINE_SIZE
+	uint8_t *heap;
+	uint8_t data[INLINE_SIZE];
 
 	MsgBuffer() :
+		len(0),
 		pos(0),
-		len(0)
+		heap(nullptr)
 	{ }
 
+	MsgBuffer(const MsgBuffer &) = delete;
+	MsgBuffer &operator=(const MsgBuffer &) = delete;
+
 	/**
 	 * @brief Buffer constructor from mavlink_message_t
 	 */
 	explicit MsgBuffer(const mavlink::mavlink_message_t *msg) :
-		pos(0)
+		pos(0),
+		heap(nullptr)
 	{
-		len = mavlink::mavlink_msg_to_send_buffer(data, msg);
+		len = mavlink::mavlink_msg_to_send_buffer(storage(wire_size(msg)), msg);
 		// paranoic check, it must be less than MAVLINK_MAX_PACKET_LEN
 		assert(len < MAX_SIZE);
 	}
@@ -51,7 +76,8 @@ struct MsgBuffer {
 	 * @brief Buffer constructor for mavlink::Message derived object.
 	 */
 	MsgBuffer(const mavlink::Message &obj, mavlink::mavlink_status_t *status, uint8_t sysid, uint8_t compid) :
-		pos(0)
+		pos(0),
+		heap(nullptr)
 	{
 		mavlink::mavlink_message_t msg;
 		mavlink::MsgMap map(msg);
@@ -61,7 +87,7 @@ struct MsgBuffer {
 		obj.serialize(map);
 		mavlink::mavlink_finalize_message_buffer(&msg, sysid, compid, status, mi.min_length, mi.length, mi.crc_extra);
 
-		len = mavlink::mavlink_msg_to_send_buffer(data, &msg);
+		len = mavlink::mavlink_msg_to_send_buffer(storage(wire_size(&msg)), &msg);
 		// paranoic check, it must be less than MAVLINK_MAX_PACKET_LEN
 		assert(len < MAX_SIZE);
 	}
@@ -71,24 +97,60 @@ struct MsgBuffer {
 	 * @param[in] nbytes should be less than MAX_SIZE
 	 */
 	MsgBuffer(const uint8_t *bytes, ssize_t nbytes) :
+		len(nbytes),
 		pos(0),
-		len(nbytes)
+		heap(nullptr)
 	{
 		assert(0 < nbytes && nbytes < MAX_SIZE);
-		memcpy(data, bytes, nbytes);
+		memcpy(storage(nbytes), bytes, nbytes);
 	}
 
+	/**
+	 * @brief Buffer referencing a shared immutable payload.
+	 *
+	 * One serialization can feed many TX queues (TCP server
+	 * broadcast): no bytes are copied, only the read position
+	 * is tracked per queue.
+	 */
+	explicit MsgBuffer(std::shared_ptr<const MsgBuffer> payload) :
+		len(payload->len),
+		pos(0),
+		shared(std::move(payload)),
+		heap(nullptr)
+	{ }
+
 	virtual ~MsgBuffer() {
+		delete[] heap;
 		pos = 0;
 		len = 0;
 	}
 
-	uint8_t *dpos() {
-		return data + pos;
+	const uint8_t *dpos() const {
+		const MsgBuffer *src = shared ? shared.get() : this;
+		return (src->heap ? src->heap : src->data) + pos;
 	}
 
-	ssize_t nbytes() {
+	ssize_t nbytes() const {
 		return len - pos;
 	}
+
+private:
+	//! Upper bound of mavlink_msg_to_send_buffer() output
+	static ssize_t wire_size(const mavlink::mavlink_message_t *msg) {
+		if (msg->magic == MAVLINK_STX)
+			return msg->len + MAVLINK_NUM_NON_PAYLOAD_BYTES +
+			       ((msg->incompat_flags & MAVLINK_IFLAG_SIGNED) ? MAVLINK_SIGNATURE_BLOCK_LEN : 0);
+
+		return msg->len + MAVLINK_CORE_HEADER_MAVLINK1_LEN + 3;
+	}
+
+	//! Pick inline or heap storage for nbytes of payload.
+	uint8_t *storage(ssize_t nbytes) {
+		if (nbytes <= INLINE_SIZE)
+			return data;
+
+		heap = new uint8_t[nbytes];
+		return heap;
+	}
 };
 }	// namespace mavconn
@@ -0,0 +1,206 @@
+/**
+ * @brief MAVConn lock-free TX ring (internal)
+ * @file msgbuffer_ring.h
+ * @author Vladimir Ermakov <vooon341@gmail.com>
+ *
+ * @addtogroup mavconn
+ * @{
+ */
+/*
+ * libmavconn
+ * Copyright 2013,2014,2015,2016 Vladimir Ermakov, All rights reserved.
+ *
+ * This file is part of the mavros package and subject to the license terms
+ * in the top-level LICENSE file of the mavros repository.
+ * https://github.com/mavlink/mavros/tree/master/LICENSE.md
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <type_traits>
+#include <mavconn/interface.h>
+#include <mavconn/msgbuffer.h>
+
+namespace mavconn {
+/**
+ * @brief Bounded MPSC ring of MsgBuffer used as transport TX queue.
+ *
+ * Multiple producers (plugin threads calling send_message) claim slots
+ * with a CAS loop; the single consumer is the connection io thread
+ * draining from do_write/do_sendto. Slot sequence numbers follow the
+ * Vyukov bounded-queue scheme, so producers never block the io thread
+ * and vice versa. Storage is in-place: pushing a message constructs
+ * the MsgBuffer directly in its slot, keeping the steady-state TX path
+ * allocation-free.
+ *
+ * front()/pop_front() may only be called from the consumer thread.
+ */
+class MsgBufferRing {
+public:
+	//! Default per-band capacity, matches MAX_TXQ_SIZE rounded up.
+	static constexpr size_t DEFAULT_CAPACITY = 1024;
+
+	explicit MsgBufferRing(size_t capacity = DEFAULT_CAPACITY) :
+		mask(round_up_pow2(capacity) - 1),
+		slots(new Slot[mask + 1]),
+		head(0),
+		tail(0)
+	{
+		for (size_t i = 0; i <= mask; i++)
+			slots[i].seq.store(i, std::memory_order_relaxed);
+	}
+
+	MsgBufferRing(const MsgBufferRing &) = delete;
+	MsgBufferRing &operator=(const MsgBufferRing &) = delete;
+
+	~MsgBufferRing()
+	{
+		while (front() != nullptr)
+			pop_front();
+	}
+
+	/**
+	 * @brief Construct a MsgBuffer in the next free slot.
+	 * @return false when the ring is full (TX overflow watermark).
+	 */
+	template <typename... Args>
+	bool emplace(Args&&... args)
+	{
+		size_t pos = head.load(std::memory_order_relaxed);
+		for (;;) {
+			Slot &s = slots[pos & mask];
+			size_t seq = s.seq.load(std::memory_order_acquire);
+			intptr_t dif = intptr_t(seq) - intptr_t(pos);
+
+			if (dif == 0) {
+				if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					new (&s.storage) MsgBuffer(std::forward<Args>(args)...);
+					s.seq.store(pos + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (dif < 0)
+				return false;
+			else
+				pos = head.load(std::memory_order_relaxed);
+		}
+	}
+
+	/**
+	 * @brief Oldest queued buffer, or nullptr when empty. Consumer only.
+	 *
+	 * The returned pointer stays valid until pop_front().
+	 */
+	MsgBuffer *front()
+	{
+		return peek(0);
+	}
+
+	/**
+	 * @brief N-th queued buffer from the front, or nullptr. Consumer only.
+	 *
+	 * Used by the coalescing send path to gather several buffers
+	 * into one scatter-gather write without popping them.
+	 */
+	MsgBuffer *peek(size_t offset)
+	{
+		size_t pos = tail.load(std::memory_order_relaxed) + offset;
+		Slot &s = slots[pos & mask];
+
+		if (intptr_t(s.seq.load(std::memory_order_acquire)) - intptr_t(pos + 1) < 0)
+			return nullptr;
+
+		return reinterpret_cast<MsgBuffer *>(&s.storage);
+	}
+
+	//! Release the front slot back to producers. Consumer only.
+	void pop_front()
+	{
+		size_t pos = tail.load(std::memory_order_relaxed);
+		Slot &s = slots[pos & mask];
+
+		reinterpret_cast<MsgBuffer *>(&s.storage)->~MsgBuffer();
+		s.seq.store(pos + mask + 1, std::memory_order_release);
+		tail.store(pos + 1, std::memory_order_relaxed);
+	}
+
+	//! Approximate fill level (for diagnostics / watermarks).
+	size_t size() const
+	{
+		size_t h = head.load(std::memory_order_relaxed);
+		size_t t = tail.load(std::memory_order_relaxed);
+		return (h > t) ? h - t : 0;
+	}
+
+private:
+	struct Slot {
+		std::atomic<size_t> seq;
+		typename std::aligned_storage<sizeof(MsgBuffer), alignof(MsgBuffer)>::type storage;
+	};
+
+	static size_t round_up_pow2(size_t v)
+	{
+		size_t r = 1;
+		while (r < v)
+			r <<= 1;
+		return r;
+	}
+
+	const size_t mask;
+	std::unique_ptr<Slot[]> slots;
+	//! Producer and consumer cursors on separate cache lines.
+	alignas(64) std::atomic<size_t> head;
+	alignas(64) std::atomic<size_t> tail;
+};
+
+/**
+ * @brief TX queue with priority bands (see TxPrio).
+ *
+ * One MsgBufferRing per band; the drain loop always serves the
+ * highest-priority non-empty band, so realtime traffic overtakes
+ * queued bulk transfers. A write in flight is never mixed across
+ * bands: the consumer picks a band with active_band() and drains
+ * only that ring until the write completes.
+ */
+class MsgBufferPrioRing {
+public:
+	static constexpr size_t BAND_COUNT = 3;
+
+	template <typename... Args>
+	bool emplace(TxPrio prio, Args&&... args)
+	{
+		return band(prio).emplace(std::forward<Args>(args)...);
+	}
+
+	//! Highest-priority band with queued data, or nullptr. Consumer only.
+	MsgBufferRing *active_band()
+	{
+		for (auto &b : bands) {
+			if (b.front() != nullptr)
+				return &b;
+		}
+
+		return nullptr;
+	}
+
+	inline MsgBufferRing &band(TxPrio prio)
+	{
+		return bands[static_cast<size_t>(prio)];
+	}
+
+	size_t size() const
+	{
+		size_t total = 0;
+		for (auto &b : bands)
+			total += b.size();
+
+		return total;
+	}
+
+private:
+	MsgBufferRing bands[BAND_COUNT];
+};
+}	// namespace mavconn
@@ -0,0 +1,88 @@
+/**
+ * @brief MAVConn shared IO reactor
+ * @file reactor.h
+ * @author Vladimir Ermakov <vooon341@gmail.com>
+ *
+ * @addtogroup mavconn
+ * @{
+ */
+/*
+ * libmavconn
+ * Copyright 2013,2014,2015,2016 Vladimir Ermakov, All rights reserved.
+ *
+ * This file is part of the mavros package and subject to the license terms
+ * in the top-level LICENSE file of the mavros repository.
+ * https://github.com/mavlink/mavros/tree/master/LICENSE.md
+ */
+
+#pragma once
+
+#include <thread>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <boost/asio.hpp>
+
+namespace mavconn {
+/**
+ * @brief Shared asio reactor for all MAVConn connections.
+ *
+ * One io_service driven by a small worker pool replaces the previous
+ * one-service-one-thread-per-connection scheme, so a process with
+ * several links (FCU + GCS bridge + router fanout) does not pay a
+ * kernel thread and epoll instance per link.
+ *
+ * Connections obtain the service via IOReactor::instance(); the pool
+ * starts lazily on first use and drains in the (static) destructor.
+ */
+class IOReactor {
+public:
+	//! Default worker pool size
+	static constexpr size_t DEFAULT_THREAD_COUNT = 2;
+
+	//! Lazily started singleton reactor.
+	static IOReactor &instance();
+
+	/**
+	 * @brief Set worker pool size.
+	 *
+	 * Only effective before the first connection is opened.
+	 */
+	static void set_thread_count(size_t count);
+
+	/**
+	 * @brief Run io workers under SCHED_FIFO at the given priority.
+	 *
+	 * Keeps link RX ahead of best-effort loads (image pipelines etc.)
+	 * on companion computers. 0 (default) keeps SCHED_OTHER.
+	 * Only effective before the first connection is opened.
+	 */
+	static void set_rt_priority(int priority);
+
+	/**
+	 * @brief Pin io workers to the CPUs set in the bit mask.
+	 *
+	 * 0 (default) leaves placement to the scheduler.
+	 * Only effective before the first connection is opened.
+	 */
+	static void set_cpu_affinity(uintmax_t cpu_mask);
+
+	inline boost::asio::io_service &get_io_service() {
+		return io_service;
+	}
+
+	inline size_t get_thread_count() {
+		return pool.size();
+	}
+
+private:
+	IOReactor();
+	~IOReactor();
+	IOReactor(const IOReactor &) = delete;
+	IOReactor &operator=(const IOReactor &) = delete;
+
+	boost::asio::io_service io_service;
+	std::unique_ptr<boost::asio::io_service::work> io_work;
+	std::vector<std::thread> pool;
+};
+}	// namespace mavconn
@@ -0,0 +1,71 @@
+/**
+ * @brief MAVConn message router
+ * @file router.h
+ * @author Vladimir Ermakov <vooon341@gmail.com>
+ *
+ * @addtogroup mavconn
+ * @{
+ */
+/*
+ * libmavconn
+ * Copyright 2013,2014,2015,2016 Vladimir Ermakov, All rights reserved.
+ *
+ * This file is part of the mavros package and subject to the license terms
+ * in the top-level LICENSE file of the mavros repository.
+ * https://github.com/mavlink/mavros/tree/master/LICENSE.md
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <mavconn/interface.h>
+
+namespace mavconn {
+/**
+ * @brief N-endpoint MAVLink router.
+ *
+ * Learns which (sysid, compid) addresses live behind each endpoint
+ * from the traffic itself and forwards messages accordingly:
+ * addressed messages go only to endpoints that have seen the target
+ * system, broadcasts and messages for unknown targets fan out to
+ * every endpoint except the source.
+ *
+ * Fanout serializes each message once into a refcounted buffer and
+ * hands it to every destination via send_shared(), so adding GCS
+ * viewers costs queue slots, not serializations. Replaces chains of
+ * single-link bridges.
+ */
+class MAVRouter : public std::enable_shared_from_this<MAVRouter> {
+public:
+	using Ptr = std::shared_ptr<MAVRouter>;
+
+	//! Endpoint limit, bound by the width of the route masks.
+	static constexpr size_t MAX_ENDPOINTS = 32;
+
+	MAVRouter();
+
+	/**
+	 * @brief Attach a link; takes over its message_received_cb.
+	 * @return endpoint index for remove_endpoint()
+	 * @throws DeviceError when MAX_ENDPOINTS is reached
+	 */
+	size_t add_endpoint(const MAVConnInterface::Ptr &link);
+
+	//! Detach a link and forget routes learned through it.
+	void remove_endpoint(size_t idx);
+
+private:
+	MAVRouter(const MAVRouter &) = delete;
+	MAVRouter &operator=(const MAVRouter &) = delete;
+
+	void route(size_t src_idx, const mavlink::mavlink_message_t *msg, Framing framing);
+
+	//! Endpoint masks that have seen a given sysid (any compid).
+	std::array<std::atomic<uint32_t>, 256> sysid_routes;
+
+	std::recursive_mutex mutex;
+	std::array<MAVConnInterface::Ptr, MAX_ENDPOINTS> endpoints;
+};
+}	// namespace mavconn
@@ -20,7 +20,9 @@
 #include <atomic>
 #include <boost/asio.hpp>
 #include <mavconn/interface.h>
+#include <mavconn/reactor.h>
 #include <mavconn/msgbuffer.h>
+#include <mavconn/msgbuffer_ring.h>
 
 namespace mavconn {
 /**
@@ -31,6 +33,8 @@ class MAVConnSerial : public MAVConnInterface,
 public:
 	static constexpr auto DEFAULT_DEVICE = "/dev/ttyACM0";
 	static constexpr auto DEFAULT_BAUDRATE = 57600;
+	//! Default byte budget for one coalesced write
+	static constexpr size_t DEFAULT_TX_COALESCE_BYTES = 8192;
 
 	/**
 	 * Open and run serial link.
@@ -45,20 +49,36 @@ public:
 	void close() override;
 
 	void send_message(const mavlink::mavlink_message_t *message) override;
+	void send_message(const mavlink::mavlink_message_t *message, TxPrio prio) override;
 	void send_message(const mavlink::Message &message, const uint8_t source_compid) override;
+	void send_message(const mavlink::Message &message, const uint8_t source_compid, TxPrio prio) override;
+	bool try_send_message(const mavlink::mavlink_message_t *message, TxPrio prio = TxPrio::NORMAL) override;
+	bool try_send_message(const mavlink::Message &message, const uint8_t source_compid, TxPrio prio) override;
 	void send_bytes(const uint8_t *bytes, size_t length) override;
+	void send_shared(std::shared_ptr<const MsgBuffer> payload, TxPrio prio) override;
 
 	inline bool is_open() override {
 		return serial_dev.is_open();
 	}
 
+	//! Set byte budget for one coalesced write (0 disables coalescing)
+	inline void set_tx_coalesce_bytes(size_t bytes) {
+		tx_coalesce_bytes = bytes;
+	}
+
 private:
-	boost::asio::io_service io_service;
-	std::thread io_thread;
+	boost::asio::io_service &io_service;
+	//! Serializes this connection's handlers on the shared reactor pool.
+	boost::asio::io_service::strand strand;
 	boost::asio::serial_port serial_dev;
 
 	std::atomic<bool> tx_in_progress;
-	std::deque<MsgBuffer> tx_q;
+	MsgBufferPrioRing tx_q;
+	//! Band currently being drained; io thread only.
+	MsgBufferRing *tx_band;
+	size_t tx_coalesce_bytes;
+	//! Gather list for the coalesced write; io thread only.
+	std::vector<boost::asio::const_buffer> tx_seg;
 	std::array<uint8_t, MsgBuffer::MAX_SIZE> rx_buf;
 	std::recursive_mutex mutex;
 
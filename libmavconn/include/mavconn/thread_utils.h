@@ -21,8 +21,10 @@
 #include <thread>
 #include <string>
 #include <cstdio>
+#include <cstdint>
 #include <sstream>
 #include <pthread.h>
+#include <sched.h>
 
 namespace mavconn {
 namespace utils {
@@ -30,14 +32,23 @@ namespace utils {
 /**
  * @brief Make printf-formatted std::string
  *
+ * Formats into a stack buffer first; only output longer than that does
+ * a second pass into the string. The previous version always ran
+ * vsnprintf twice (once to measure, once to render).
  */
 template<typename ... Args>
 std::string format(const std::string &fmt, Args ... args)
 {
+	char buf[256];
+
+	auto sz = std::snprintf(buf, sizeof(buf), fmt.c_str(), args...);
+	if (sz < 0)
+		return {};
+	if (size_t(sz) < sizeof(buf))
+		return std::string(buf, sz);
+
 	// C++11 specify that string store elements continously
 	std::string ret;
-
-	auto sz = std::snprintf(nullptr, 0, fmt.c_str(), args...);
 	ret.reserve(sz + 1); ret.resize(sz);	// to be sure there have room for \0
 	std::snprintf(&ret.front(), ret.capacity() + 1, fmt.c_str(), args...);
 	return ret;
@@ -64,6 +75,46 @@ bool set_this_thread_name(const std::string &name, Args&& ... args)
 #endif
 }
 
+/**
+ * @brief Switch current thread to SCHED_FIFO real-time class
+ * @param[in] priority  SCHED_FIFO priority (1..99)
+ * @return true if success
+ *
+ * @note Needs CAP_SYS_NICE or a suitable RLIMIT_RTPRIO
+ */
+inline bool set_this_thread_rt_prio(int priority)
+{
+	struct sched_param sp {};
+
+	sp.sched_priority = priority;
+	return pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp) == 0;
+}
+
+/**
+ * @brief Pin current thread to the CPUs set in the bit mask
+ * @param[in] cpu_mask  bit N selects CPU N
+ * @return true if success
+ *
+ * @note Only for Linux target
+ */
+inline bool set_this_thread_affinity(uintmax_t cpu_mask)
+{
+#ifdef __linux__
+	cpu_set_t cpuset;
+
+	CPU_ZERO(&cpuset);
+	for (size_t cpu = 0; cpu < sizeof(cpu_mask) * 8; cpu++) {
+		if (cpu_mask & (uintmax_t(1) << cpu))
+			CPU_SET(cpu, &cpuset);
+	}
+
+	return pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset) == 0;
+#else
+	(void)cpu_mask;
+	return false;
+#endif
+}
+
 /**
  * @brief Convert to string objects with operator <<
  */
@@ -0,0 +1,83 @@
+/**
+ * @brief MAVConn telemetry log replay class
+ * @file tlog.h
+ * @author Vladimir Ermakov <vooon341@gmail.com>
+ *
+ * @addtogroup mavconn
+ * @{
+ */
+/*
+ * libmavconn
+ * Copyright 2013,2014,2015,2016 Vladimir Ermakov, All rights reserved.
+ *
+ * This file is part of the mavros package and subject to the license terms
+ * in the top-level LICENSE file of the mavros repository.
+ * https://github.com/mavlink/mavros/tree/master/LICENSE.md
+ */
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <boost/asio.hpp>
+#include <mavconn/interface.h>
+#include <mavconn/reactor.h>
+#include <mavconn/msgbuffer.h>
+
+namespace mavconn {
+/**
+ * @brief Telemetry log (tlog) replay interface
+ *
+ * Memory-maps a recorded tlog (8 byte big-endian usec timestamp
+ * before each mavlink frame, QGC format) and replays it through
+ * message_received_cb: at maximum speed by default, or paced by the
+ * recorded timestamps (speed = 1.0 is realtime, 2.0 twice as fast).
+ *
+ * Lets a full flight run through the whole plugin stack in seconds
+ * for offline regression. Sends are ignored.
+ */
+class MAVConnTlog : public MAVConnInterface,
+	public std::enable_shared_from_this<MAVConnTlog> {
+public:
+	//! Frames fed per reactor turn when replaying at maximum speed
+	static constexpr size_t REPLAY_BATCH = 256;
+
+	/**
+	 * @param[in] path   tlog file path
+	 * @param[in] speed  pacing factor, 0 replays at maximum speed
+	 */
+	MAVConnTlog(uint8_t system_id = 1, uint8_t component_id = MAV_COMP_ID_UDP_BRIDGE,
+			std::string path = "", double speed = 0.0);
+	~MAVConnTlog();
+
+	void close() override;
+
+	void send_message(const mavlink::mavlink_message_t *message) override;
+	void send_message(const mavlink::Message &message, const uint8_t source_compid) override;
+	void send_bytes(const uint8_t *bytes, size_t length) override;
+
+	inline bool is_open() override {
+		return open_flag;
+	}
+
+private:
+	boost::asio::io_service &io_service;
+	//! Serializes replay steps on the shared reactor pool.
+	boost::asio::io_service::strand strand;
+	boost::asio::deadline_timer timer;
+
+	std::atomic<bool> open_flag;
+
+	int fd;
+	const uint8_t *map_data;
+	size_t map_size;
+
+	//! Replay cursor; strand only.
+	size_t offset;
+	//! Timestamp of the previously replayed record [usec]; strand only.
+	uint64_t last_stamp;
+	double speed;
+
+	void do_replay();
+};
+}	// namespace mavconn
@@ -20,7 +20,9 @@
 #include <atomic>
 #include <boost/asio.hpp>
 #include <mavconn/interface.h>
+#include <mavconn/reactor.h>
 #include <mavconn/msgbuffer.h>
+#include <mavconn/msgbuffer_ring.h>
 
 namespace mavconn {
 /**
@@ -53,17 +55,22 @@ public:
 	void close() override;
 
 	void send_message(const mavlink::mavlink_message_t *message) override;
+	void send_message(const mavlink::mavlink_message_t *message, TxPrio prio) override;
 	void send_message(const mavlink::Message &message, const uint8_t source_compid) override;
+	void send_message(const mavlink::Message &message, const uint8_t source_compid, TxPrio prio) override;
+	bool try_send_message(const mavlink::mavlink_message_t *message, TxPrio prio = TxPrio::NORMAL) override;
+	bool try_send_message(const mavlink::Message &message, const uint8_t source_compid, TxPrio prio) override;
 	void send_bytes(const uint8_t *bytes, size_t length) override;
+	void send_shared(std::shared_ptr<const MsgBuffer> payload, TxPrio prio) override;
 
 	inline bool is_open() override {
 		return socket.is_open();
 	}
 
 private:
-	boost::asio::io_service io_service;
-	std::unique_ptr<boost::asio::io_service::work> io_work;
-	std::thread io_thread;
+	boost::asio::io_service &io_service;
+	//! Serializes this connection's handlers on the shared reactor pool.
+	boost::asio::io_service::strand strand;
 	bool permanent_broadcast;
 
 	std::atomic<bool> remote_exists;
@@ -74,10 +81,23 @@ private:
 	boost::asio::ip::udp::endpoint bind_ep;
 
 	std::atomic<bool> tx_in_progress;
-	std::deque<MsgBuffer> tx_q;
+	MsgBufferPrioRing tx_q;
+	//! Band currently being drained; io thread only.
+	MsgBufferRing *tx_band;
 	std::array<uint8_t, MsgBuffer::MAX_SIZE> rx_buf;
 	std::recursive_mutex mutex;
 
+#if defined(__linux__)
+	//! Datagrams drained per recvmmsg() call
+	static constexpr size_t RX_BATCH_SIZE = 16;
+	//! Datagrams flushed per sendmmsg() call
+	static constexpr size_t TX_BATCH_SIZE = 16;
+	std::array<std::array<uint8_t, MsgBuffer::MAX_SIZE>, RX_BATCH_SIZE> rx_batch_buf;
+
+	void do_recvmmsg();
+	void do_sendmmsg();
+#endif
+
 	void do_recvfrom();
 	void do_sendto(bool check_tx_state);
 };
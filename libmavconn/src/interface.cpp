@@ -17,6 +17,12 @@
 
 #include <set>
 #include <cassert>
+#include <cstring>
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #include <mavconn/console_bridge_compat.h>
 #include <mavconn/interface.h>
@@ -24,6 +30,8 @@
 #include <mavconn/serial.h>
 #include <mavconn/udp.h>
 #include <mavconn/tcp.h>
+#include <mavconn/loopback.h>
+#include <mavconn/tlog.h>
 
 namespace mavconn {
 #define PFX	"mavconn: "
@@ -33,10 +41,50 @@ using mavlink::mavlink_status_t;
 
 // static members
 std::once_flag MAVConnInterface::init_flag;
-std::unordered_map<mavlink::msgid_t, const mavlink::mavlink_msg_entry_t*> MAVConnInterface::message_entries {};
+MAVConnInterface::MsgEntryTable MAVConnInterface::message_entries {};
 std::atomic<size_t> MAVConnInterface::conn_id_counter {0};
 
 
+void MAVConnInterface::MsgEntryTable::build(const std::vector<const mavlink::mavlink_msg_entry_t*> &entries)
+{
+	// Knuth multiplicative hashing; keep the multiplier odd.
+	constexpr uint32_t BASE_MULT = 2654435761u;
+
+	size_t size = 64;
+	while (size < entries.size() * 4)
+		size <<= 1;
+
+	// Search for a collision-free (perfect) placement. At load factor
+	// <= 25% only a handful of attempts are ever needed; grow the
+	// table if no multiplier fits.
+	for (;; size <<= 1) {
+		for (uint32_t attempt = 0; attempt < 64; attempt++) {
+			uint32_t try_mult = BASE_MULT + 2 * attempt;
+			bool ok = true;
+
+			cells.assign(size, Cell{EMPTY_MSGID, nullptr});
+			for (auto *e : entries) {
+				Cell &c = cells[(e->msgid * try_mult) & (size - 1)];
+				if (c.entry != nullptr) {
+					ok = false;
+					break;
+				}
+				c.msgid = e->msgid;
+				c.entry = e;
+			}
+
+			if (ok) {
+				mask = size - 1;
+				mult = try_mult;
+				CONSOLE_BRIDGE_logDebug(PFX "message entry table: %zu entries in %zu cells (mult %u)",
+						entries.size(), size, try_mult);
+				return;
+			}
+		}
+	}
+}
+
+
 MAVConnInterface::MAVConnInterface(uint8_t system_id, uint8_t component_id) :
 	sys_id(system_id),
 	comp_id(component_id),
@@ -51,6 +99,9 @@ MAVConnInterface::MAVConnInterface(uint8_t system_id, uint8_t component_id) :
 {
 	conn_id = conn_id_counter.fetch_add(1);
 	std::call_once(init_flag, init_msg_entry);
+
+	// one counter cell per hash table cell + the unknown-id overflow slot
+	msg_stat_cells.reset(new MsgStatCell[message_entries.cells.size() + 1]);
 }
 
 mavlink_status_t MAVConnInterface::get_status()
@@ -93,12 +144,196 @@ void MAVConnInterface::iostat_rx_add(size_t bytes)
 	rx_total_bytes += bytes;
 }
 
+//! Approximate on-wire size: payload + header + CRC (signature ignored).
+static inline size_t msg_wire_size(uint8_t magic, uint8_t len)
+{
+	return len + ((magic == MAVLINK_STX) ?
+			MAVLINK_NUM_NON_PAYLOAD_BYTES :
+			MAVLINK_CORE_HEADER_MAVLINK1_LEN + 3);
+}
+
+void MAVConnInterface::msg_stat_tx_add(const mavlink::mavlink_message_t *msg)
+{
+	auto &c = msg_stat_cells[message_entries.stat_index(msg->msgid)];
+
+	c.tx_count.fetch_add(1, std::memory_order_relaxed);
+	c.tx_bytes.fetch_add(msg_wire_size(msg->magic, msg->len), std::memory_order_relaxed);
+	c.last_tx.store(steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+void MAVConnInterface::msg_stat_tx_add(const mavlink::Message &msg)
+{
+	auto mi = msg.get_message_info();
+	auto &c = msg_stat_cells[message_entries.stat_index(mi.id)];
+
+	c.tx_count.fetch_add(1, std::memory_order_relaxed);
+	// serialization happens later; account the maximum payload length
+	c.tx_bytes.fetch_add(mi.length + MAVLINK_NUM_NON_PAYLOAD_BYTES, std::memory_order_relaxed);
+	c.last_tx.store(steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+void MAVConnInterface::msg_stat_rx_add(const mavlink::mavlink_message_t &msg)
+{
+	auto &c = msg_stat_cells[message_entries.stat_index(msg.msgid)];
+
+	c.rx_count.fetch_add(1, std::memory_order_relaxed);
+	c.rx_bytes.fetch_add(msg_wire_size(msg.magic, msg.len), std::memory_order_relaxed);
+	c.last_rx.store(steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+std::vector<MAVConnInterface::MsgStat> MAVConnInterface::get_msg_stats()
+{
+	std::vector<MsgStat> out;
+
+	auto cell_to_stat = [&] (mavlink::msgid_t msgid, const MsgStatCell &c) {
+		MsgStat st;
+
+		st.msgid = msgid;
+		st.rx_count = c.rx_count.load(std::memory_order_relaxed);
+		st.tx_count = c.tx_count.load(std::memory_order_relaxed);
+		if (st.rx_count == 0 && st.tx_count == 0)
+			return;
+
+		st.rx_bytes = c.rx_bytes.load(std::memory_order_relaxed);
+		st.tx_bytes = c.tx_bytes.load(std::memory_order_relaxed);
+		st.last_rx = steady_clock::time_point(steady_clock::duration(c.last_rx.load(std::memory_order_relaxed)));
+		st.last_tx = steady_clock::time_point(steady_clock::duration(c.last_tx.load(std::memory_order_relaxed)));
+		out.push_back(st);
+	};
+
+	for (size_t i = 0; i < message_entries.cells.size(); i++)
+		cell_to_stat(message_entries.cells[i].msgid, msg_stat_cells[i]);
+
+	cell_to_stat(MsgEntryTable::EMPTY_MSGID, msg_stat_cells[message_entries.cells.size()]);
+
+	std::sort(out.begin(), out.end(),
+			[] (const MsgStat &a, const MsgStat &b) { return a.msgid < b.msgid; });
+
+	return out;
+}
+
+void MAVConnInterface::update_backpressure(size_t queued)
+{
+	if (!tx_congested.load(std::memory_order_relaxed) && queued >= TXQ_HIGH_WATERMARK) {
+		if (tx_congested.exchange(true))
+			return;	// lost the race, other thread notifies
+
+		CONSOLE_BRIDGE_logWarn(PFX "%zu: TX queue above high watermark (%zu buffers)",
+				conn_id, queued);
+		if (tx_backpressure_cb)
+			tx_backpressure_cb(true);
+	}
+	else if (tx_congested.load(std::memory_order_relaxed) && queued <= TXQ_LOW_WATERMARK) {
+		if (!tx_congested.exchange(false))
+			return;
+
+		if (tx_backpressure_cb)
+			tx_backpressure_cb(false);
+	}
+}
+
+void MAVConnInterface::send_shared(std::shared_ptr<const MsgBuffer> payload, TxPrio prio)
+{
+	(void)prio;
+
+	// fallback for transports without shared-buffer TX queues
+	try {
+		send_bytes(payload->dpos(), payload->nbytes());
+	}
+	catch (std::length_error &) {
+		CONSOLE_BRIDGE_logWarn(PFX "%zu: send_shared: TX queue overflow, payload dropped", conn_id);
+	}
+}
+
+bool MAVConnInterface::try_send_message(const mavlink::mavlink_message_t *message, TxPrio prio)
+{
+	// generic fallback for transports without a native non-throwing path
+	try {
+		send_message(message, prio);
+		return true;
+	}
+	catch (std::length_error &) {
+		return false;
+	}
+}
+
+bool MAVConnInterface::try_send_message(const mavlink::Message &message, const uint8_t src_compid, TxPrio prio)
+{
+	try {
+		send_message(message, src_compid, prio);
+		return true;
+	}
+	catch (std::length_error &) {
+		return false;
+	}
+}
+
+void MAVConnInterface::set_rx_filter(const std::vector<mavlink::msgid_t> &allowed_msgids)
+{
+	// one bit per possible 24-bit msgid
+	auto map = std::make_shared<std::vector<uint8_t>>((1 << 24) / 8, 0);
+
+	for (auto msgid : allowed_msgids)
+		(*map)[msgid >> 3] |= 1 << (msgid & 7);
+
+	std::atomic_store_explicit(&rx_filter_map, map, std::memory_order_release);
+}
+
+void MAVConnInterface::clear_rx_filter()
+{
+	std::atomic_store_explicit(&rx_filter_map,
+			std::shared_ptr<std::vector<uint8_t>>(),
+			std::memory_order_release);
+}
+
+/**
+ * @brief Find the next MAVLink start marker (v2.0 0xFD or v1.0 0xFE).
+ *
+ * Used to resynchronize on noisy links: when the parser is back in
+ * start-marker search, the garbage ahead of the next marker can be
+ * skipped in one vectorized scan instead of one parser call per byte.
+ */
+static inline const uint8_t *find_start_marker(const uint8_t *buf, size_t len)
+{
+#if defined(__SSE2__)
+	const __m128i stx2 = _mm_set1_epi8(char(MAVLINK_STX));
+	const __m128i stx1 = _mm_set1_epi8(char(MAVLINK_STX_MAVLINK1));
+
+	for (; len >= 16; buf += 16, len -= 16) {
+		__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf));
+		int found = _mm_movemask_epi8(_mm_or_si128(
+				_mm_cmpeq_epi8(chunk, stx2),
+				_mm_cmpeq_epi8(chunk, stx1)));
+
+		if (found != 0)
+			return buf + __builtin_ctz(found);
+	}
+
+	for (; len > 0; buf++, len--) {
+		if (*buf == MAVLINK_STX || *buf == MAVLINK_STX_MAVLINK1)
+			return buf;
+	}
+
+	return nullptr;
+#else
+	// libc memchr is vectorized on all our targets
+	auto p2 = static_cast<const uint8_t *>(memchr(buf, MAVLINK_STX, len));
+	if (p2 != nullptr)
+		len = p2 - buf;
+
+	auto p1 = static_cast<const uint8_t *>(memchr(buf, MAVLINK_STX_MAVLINK1, len));
+	return (p1 != nullptr) ? p1 : p2;
+#endif
+}
+
 void MAVConnInterface::parse_buffer(const char *pfx, uint8_t *buf, const size_t bufsize, size_t bytes_received)
 {
 	mavlink::mavlink_message_t message;
 
 	assert(bufsize >= bytes_received);
 
+	auto filter = std::atomic_load_explicit(&rx_filter_map, std::memory_order_acquire);
+
 	iostat_rx_add(bytes_received);
 	for (; bytes_received > 0; bytes_received--) {
 		auto c = *buf++;
@@ -106,16 +341,42 @@ void MAVConnInterface::parse_buffer(const char *pfx, uint8_t *buf, const size_t
 		auto msg_received = static_cast<Framing>(mavlink::mavlink_frame_char_buffer(&m_buffer, &m_parse_status, c, &message, &m_mavlink_status));
 
 		if (msg_received != Framing::incomplete) {
+			if (msg_received == Framing::ok)
+				msg_stat_rx_add(message);
+
+			if (filter && msg_received == Framing::ok &&
+					!((*filter)[message.msgid >> 3] & (1 << (message.msgid & 7))))
+				continue;
+
 			log_recv(pfx, message, msg_received);
 
 			if (message_received_cb)
 				message_received_cb(&message, msg_received);
 		}
+
+		if (bytes_received > 1 &&
+				(m_parse_status.parse_state == mavlink::MAVLINK_PARSE_STATE_IDLE ||
+				 m_parse_status.parse_state == mavlink::MAVLINK_PARSE_STATE_UNINIT)) {
+			// parser is searching for a start marker: skip garbage
+			// in bulk instead of feeding it one byte at a time
+			auto marker = find_start_marker(buf, bytes_received - 1);
+			if (marker == nullptr)
+				break;
+
+			size_t skip = marker - buf;
+			buf += skip;
+			bytes_received -= skip;
+		}
 	}
 }
 
 void MAVConnInterface::log_recv(const char *pfx, mavlink_message_t &msg, Framing framing)
 {
+	// per-message path: skip even the argument marshalling when
+	// debug output is off
+	if (console_bridge::getLogLevel() > console_bridge::CONSOLE_BRIDGE_LOG_DEBUG)
+		return;
+
 	const char *framing_str = (framing == Framing::ok) ? "OK" :
 			(framing == Framing::bad_crc) ? "!CRC" :
 			(framing == Framing::bad_signature) ? "!SIG" : "ERR";
@@ -131,6 +392,9 @@ void MAVConnInterface::log_recv(const char *pfx, mavlink_message_t &msg, Framing
 
 void MAVConnInterface::log_send(const char *pfx, const mavlink_message_t *msg)
 {
+	if (console_bridge::getLogLevel() > console_bridge::CONSOLE_BRIDGE_LOG_DEBUG)
+		return;
+
 	const char *proto_version_str = (msg->magic == MAVLINK_STX) ? "v2.0" : "v1.0";
 
 	CONSOLE_BRIDGE_logDebug("%s%zu: send: %s Message-Id: %u [%u bytes] IDs: %u.%u Seq: %u",
@@ -141,6 +405,11 @@ void MAVConnInterface::log_send(const char *pfx, const mavlink_message_t *msg)
 
 void MAVConnInterface::log_send_obj(const char *pfx, const mavlink::Message &msg)
 {
+	// to_yaml() formats and allocates even when the message is later
+	// filtered: skip it entirely unless debug output is enabled
+	if (console_bridge::getLogLevel() > console_bridge::CONSOLE_BRIDGE_LOG_DEBUG)
+		return;
+
 	CONSOLE_BRIDGE_logDebug("%s%zu: send: %s", pfx, conn_id, msg.to_yaml().c_str());
 }
 
@@ -170,6 +439,32 @@ void MAVConnInterface::send_message_ignore_drop(const mavlink::Message &msg, uin
 	}
 }
 
+void MAVConnInterface::send_message_ignore_drop(const mavlink::mavlink_message_t *msg, TxPrio prio)
+{
+	try {
+		send_message(msg, prio);
+	}
+	catch (std::length_error &e) {
+		CONSOLE_BRIDGE_logError(PFX "%zu: DROPPED Message-Id %u [%u bytes] IDs: %u.%u Seq: %u: %s",
+				conn_id,
+				msg->msgid, msg->len, msg->sysid, msg->compid, msg->seq,
+				e.what());
+	}
+}
+
+void MAVConnInterface::send_message_ignore_drop(const mavlink::Message &msg, uint8_t source_compid, TxPrio prio)
+{
+	try {
+		send_message(msg, source_compid, prio);
+	}
+	catch (std::length_error &e) {
+		CONSOLE_BRIDGE_logError(PFX "%zu: DROPPED Message %s: %s",
+				conn_id,
+				msg.get_name().c_str(),
+				e.what());
+	}
+}
+
 void MAVConnInterface::set_protocol_version(Protocol pver)
 {
 	if (pver == Protocol::V10)
@@ -331,6 +626,35 @@ static MAVConnInterface::Ptr url_parse_tcp_server(
 			bind_host, bind_port);
 }
 
+static MAVConnInterface::Ptr url_parse_loopback(
+		std::string query,
+		uint8_t system_id, uint8_t component_id)
+{
+	// loopback://?ids=1,240
+	url_parse_query(query, system_id, component_id);
+
+	return std::make_shared<MAVConnLoopback>(system_id, component_id);
+}
+
+static MAVConnInterface::Ptr url_parse_tlog(
+		std::string path, std::string query,
+		uint8_t system_id, uint8_t component_id)
+{
+	double speed = 0.0;
+
+	// tlog:///logs/flight.tlog?speed=1.0  (0 = max speed)
+	const std::string speed_tag("speed=");
+	auto speed_it = std::search(query.begin(), query.end(),
+			speed_tag.begin(), speed_tag.end());
+	if (speed_it != query.end()) {
+		std::advance(speed_it, speed_tag.length());
+		auto end_it = std::find(speed_it, query.end(), '&');
+		speed = std::stod(std::string(speed_it, end_it));
+	}
+
+	return std::make_shared<MAVConnTlog>(system_id, component_id, path, speed);
+}
+
 MAVConnInterface::Ptr MAVConnInterface::open_url(std::string url,
 		uint8_t system_id, uint8_t component_id)
 {
@@ -391,6 +715,10 @@ MAVConnInterface::Ptr MAVConnInterface::open_url(std::string url,
 		return url_parse_serial(path, query, system_id, component_id, false);
 	else if (proto == "serial-hwfc")
 		return url_parse_serial(path, query, system_id, component_id, true);
+	else if (proto == "loopback")
+		return url_parse_loopback(query, system_id, component_id);
+	else if (proto == "tlog")
+		return url_parse_tlog(path, query, system_id, component_id);
 	else
 		throw DeviceError("url", "Unknown URL type");
 }
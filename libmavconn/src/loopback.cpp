@@ -0,0 +1,113 @@
+/**
+ * @brief MAVConn loopback link class
+ * @file loopback.cpp
+ * @author Vladimir Ermakov <vooon341@gmail.com>
+ *
+ * @addtogroup mavconn
+ * @{
+ */
+/*
+ * libmavconn
+ * Copyright 2013,2014,2015,2016 Vladimir Ermakov, All rights reserved.
+ *
+ * This file is part of the mavros package and subject to the license terms
+ * in the top-level LICENSE file of the mavros repository.
+ * https://github.com/mavlink/mavros/tree/master/LICENSE.md
+ */
+
+#include <cassert>
+
+#include <mavconn/console_bridge_compat.h>
+#include <mavconn/loopback.h>
+
+namespace mavconn {
+
+using mavlink::mavlink_message_t;
+
+#define PFX	"mavconn: loop"
+#define PFXd	PFX "%zu: "
+
+
+MAVConnLoopback::MAVConnLoopback(uint8_t system_id, uint8_t component_id) :
+	MAVConnInterface(system_id, component_id),
+	io_service(IOReactor::instance().get_io_service()),
+	strand(io_service),
+	open_flag(true)
+{
+	CONSOLE_BRIDGE_logInform(PFXd "Loopback channel open", conn_id);
+}
+
+MAVConnLoopback::~MAVConnLoopback()
+{
+	close();
+}
+
+void MAVConnLoopback::close()
+{
+	if (!open_flag.exchange(false))
+		return;
+
+	if (port_closed_cb)
+		port_closed_cb();
+}
+
+void MAVConnLoopback::deliver(std::shared_ptr<MsgBuffer> buf)
+{
+	auto sthis = shared_from_this();
+	strand.post([sthis, buf] () {
+				if (!sthis->open_flag)
+					return;
+
+				sthis->parse_buffer(PFX,
+						const_cast<uint8_t *>(buf->dpos()),
+						buf->nbytes(), buf->nbytes());
+			});
+}
+
+void MAVConnLoopback::send_message(const mavlink_message_t *message)
+{
+	assert(message != nullptr);
+
+	if (!is_open()) {
+		CONSOLE_BRIDGE_logError(PFXd "send: channel closed!", conn_id);
+		return;
+	}
+
+	log_send(PFX, message);
+
+	auto buf = std::make_shared<MsgBuffer>(message);
+
+	msg_stat_tx_add(message);
+	iostat_tx_add(buf->nbytes());
+	deliver(buf);
+}
+
+void MAVConnLoopback::send_message(const mavlink::Message &message, const uint8_t source_compid)
+{
+	if (!is_open()) {
+		CONSOLE_BRIDGE_logError(PFXd "send: channel closed!", conn_id);
+		return;
+	}
+
+	log_send_obj(PFX, message);
+
+	auto buf = std::make_shared<MsgBuffer>(message, get_status_p(), sys_id, source_compid);
+
+	msg_stat_tx_add(message);
+	iostat_tx_add(buf->nbytes());
+	deliver(buf);
+}
+
+void MAVConnLoopback::send_bytes(const uint8_t *bytes, size_t length)
+{
+	if (!is_open()) {
+		CONSOLE_BRIDGE_logError(PFXd "send: channel closed!", conn_id);
+		return;
+	}
+
+	auto buf = std::make_shared<MsgBuffer>(bytes, length);
+
+	iostat_tx_add(buf->nbytes());
+	deliver(buf);
+}
+}	// namespace mavconn
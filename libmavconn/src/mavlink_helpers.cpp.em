@@ -30,26 +30,32 @@ using mavconn::MAVConnInterface;
 
 void MAVConnInterface::init_msg_entry()
 {
-	CONSOLE_BRIDGE_logDebug("mavconn: Initialize message_entries map");
+	CONSOLE_BRIDGE_logDebug("mavconn: Initialize message_entries table");
+
+	std::vector<const mavlink::mavlink_msg_entry_t *> entries;
 
 	auto load = [&](const char *dialect, const mavlink::mavlink_msg_entry_t & e) {
-		auto it = message_entries.find(e.msgid);
-		if (it != message_entries.end()) {
-			if (memcmp(&e, it->second, sizeof(e)) != 0) {
+		for (auto *known : entries) {
+			if (known->msgid != e.msgid)
+				continue;
+
+			if (memcmp(&e, known, sizeof(e)) != 0) {
 				CONSOLE_BRIDGE_logDebug("mavconn: init: message from %s, MSG-ID %d ignored! Table has different entry.", dialect, e.msgid);
 			}
 			else {
 				CONSOLE_BRIDGE_logDebug("mavconn: init: message from %s, MSG-ID %d in table.", dialect, e.msgid);
 			}
+			return;
 		}
-		else {
-			CONSOLE_BRIDGE_logDebug("mavconn: init: add message entry for %s, MSG-ID %d", dialect, e.msgid);
-			message_entries[e.msgid] = &e;
-		}
+
+		CONSOLE_BRIDGE_logDebug("mavconn: init: add message entry for %s, MSG-ID %d", dialect, e.msgid);
+		entries.push_back(&e);
 	};
 
 	@[for dialect in MAVLINK_V20_DIALECTS]for (auto &e : mavlink::@dialect::MESSAGE_ENTRIES) @(' ' * (20 - len(dialect))) load("@dialect", e);
 	@[end for]
+
+	message_entries.build(entries);
 }
 
 std::vector<std::string> MAVConnInterface::get_known_dialects()
@@ -65,9 +71,5 @@ std::vector<std::string> MAVConnInterface::get_known_dialects()
  */
 const mavlink::mavlink_msg_entry_t* mavlink::mavlink_get_msg_entry(uint32_t msgid)
 {
-	auto it = MAVConnInterface::message_entries.find(msgid);
-	if (it != MAVConnInterface::message_entries.end())
-		return it->second;
-	else
-		return nullptr;
+	return MAVConnInterface::message_entries.find(msgid);
 }
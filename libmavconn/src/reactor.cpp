@@ -0,0 +1,97 @@
+/**
+ * @brief MAVConn shared IO reactor
+ * @file reactor.cpp
+ * @author Vladimir Ermakov <vooon341@gmail.com>
+ *
+ * @addtogroup mavconn
+ * @{
+ */
+/*
+ * libmavconn
+ * Copyright 2013,2014,2015,2016 Vladimir Ermakov, All rights reserved.
+ *
+ * This file is part of the mavros package and subject to the license terms
+ * in the top-level LICENSE file of the mavros repository.
+ * https://github.com/mavlink/mavros/tree/master/LICENSE.md
+ */
+
+#include <atomic>
+
+#include <mavconn/console_bridge_compat.h>
+#include <mavconn/thread_utils.h>
+#include <mavconn/reactor.h>
+
+namespace mavconn {
+
+#define PFX	"mavconn: reactor: "
+
+//! Pool size requested before the reactor starts.
+static std::atomic<size_t> requested_thread_count {IOReactor::DEFAULT_THREAD_COUNT};
+//! SCHED_FIFO priority for io workers, 0 keeps SCHED_OTHER.
+static std::atomic<int> requested_rt_priority {0};
+//! CPU pinning mask for io workers, 0 leaves placement to the scheduler.
+static std::atomic<uintmax_t> requested_cpu_affinity {0};
+
+
+IOReactor &IOReactor::instance()
+{
+	static IOReactor reactor;
+	return reactor;
+}
+
+void IOReactor::set_thread_count(size_t count)
+{
+	if (count == 0)
+		count = 1;
+
+	requested_thread_count.store(count);
+}
+
+void IOReactor::set_rt_priority(int priority)
+{
+	requested_rt_priority.store(priority);
+}
+
+void IOReactor::set_cpu_affinity(uintmax_t cpu_mask)
+{
+	requested_cpu_affinity.store(cpu_mask);
+}
+
+IOReactor::IOReactor() :
+	io_service(),
+	io_work(new boost::asio::io_service::work(io_service))
+{
+	size_t count = requested_thread_count.load();
+
+	CONSOLE_BRIDGE_logInform(PFX "starting %zu io worker(s)", count);
+
+	int rt_priority = requested_rt_priority.load();
+	uintmax_t cpu_affinity = requested_cpu_affinity.load();
+
+	pool.reserve(count);
+	for (size_t i = 0; i < count; i++) {
+		pool.emplace_back([this, i, rt_priority, cpu_affinity] () {
+					utils::set_this_thread_name("mavconn_io%zu", i);
+
+					if (rt_priority > 0 && !utils::set_this_thread_rt_prio(rt_priority))
+						CONSOLE_BRIDGE_logWarn(PFX "SCHED_FIFO prio %d rejected, check RLIMIT_RTPRIO", rt_priority);
+
+					if (cpu_affinity != 0 && !utils::set_this_thread_affinity(cpu_affinity))
+						CONSOLE_BRIDGE_logWarn(PFX "CPU affinity 0x%jx rejected", cpu_affinity);
+
+					io_service.run();
+				});
+	}
+}
+
+IOReactor::~IOReactor()
+{
+	io_work.reset();
+	io_service.stop();
+
+	for (auto &thd : pool) {
+		if (thd.joinable())
+			thd.join();
+	}
+}
+}	// namespace mavconn
@@ -0,0 +1,113 @@
+/**
+ * @brief MAVConn message router
+ * @file router.cpp
+ * @author Vladimir Ermakov <vooon341@gmail.com>
+ *
+ * @addtogroup mavconn
+ * @{
+ */
+/*
+ * libmavconn
+ * Copyright 2013,2014,2015,2016 Vladimir Ermakov, All rights reserved.
+ *
+ * This file is part of the mavros package and subject to the license terms
+ * in the top-level LICENSE file of the mavros repository.
+ * https://github.com/mavlink/mavros/tree/master/LICENSE.md
+ */
+
+#include <cassert>
+
+#include <mavconn/console_bridge_compat.h>
+#include <mavconn/msgbuffer.h>
+#include <mavconn/router.h>
+
+namespace mavconn {
+
+using mavlink::mavlink_message_t;
+
+#define PFX	"mavconn: router: "
+
+
+MAVRouter::MAVRouter()
+{
+	for (auto &r : sysid_routes)
+		r.store(0, std::memory_order_relaxed);
+}
+
+size_t MAVRouter::add_endpoint(const MAVConnInterface::Ptr &link)
+{
+	lock_guard lock(mutex);
+
+	for (size_t i = 0; i < MAX_ENDPOINTS; i++) {
+		if (endpoints[i])
+			continue;
+
+		endpoints[i] = link;
+
+		auto sthis = shared_from_this();
+		link->message_received_cb = [sthis, i] (const mavlink_message_t *msg, Framing framing) {
+					sthis->route(i, msg, framing);
+				};
+
+		CONSOLE_BRIDGE_logInform(PFX "endpoint %zu attached (channel %zu)", i, link->conn_id);
+		return i;
+	}
+
+	throw DeviceError("router", "endpoint limit reached");
+}
+
+void MAVRouter::remove_endpoint(size_t idx)
+{
+	lock_guard lock(mutex);
+
+	if (idx >= MAX_ENDPOINTS || !endpoints[idx])
+		return;
+
+	endpoints[idx]->message_received_cb = MAVConnInterface::ReceivedCb();
+	endpoints[idx].reset();
+
+	// forget routes learned through this endpoint
+	uint32_t keep = ~(uint32_t(1) << idx);
+	for (auto &r : sysid_routes)
+		r.fetch_and(keep, std::memory_order_relaxed);
+
+	CONSOLE_BRIDGE_logInform(PFX "endpoint %zu detached", idx);
+}
+
+void MAVRouter::route(size_t src_idx, const mavlink_message_t *msg, Framing framing)
+{
+	if (framing != Framing::ok)
+		return;
+
+	// learn: the source system lives behind this endpoint
+	sysid_routes[msg->sysid].fetch_or(uint32_t(1) << src_idx, std::memory_order_relaxed);
+
+	// resolve the addressed system, 0 means broadcast
+	uint8_t target_sysid = 0;
+	auto *entry = MAVConnInterface::message_entries.find(msg->msgid);
+	if (entry != nullptr && (entry->flags & MAV_MSG_ENTRY_FLAG_HAVE_TARGET_SYSTEM) &&
+			msg->len > entry->target_system_ofs)
+		target_sysid = reinterpret_cast<const uint8_t *>(msg->payload64)[entry->target_system_ofs];
+
+	uint32_t dst_mask = ~uint32_t(0);
+	if (target_sysid != 0) {
+		uint32_t known = sysid_routes[target_sysid].load(std::memory_order_relaxed);
+		// unknown targets fan out so the route can be learned
+		if (known != 0)
+			dst_mask = known;
+	}
+
+	dst_mask &= ~(uint32_t(1) << src_idx);
+	if (dst_mask == 0)
+		return;
+
+	// serialize once, share the frame across every destination queue
+	auto payload = std::make_shared<const MsgBuffer>(msg);
+
+	lock_guard lock(mutex);
+	for (size_t i = 0; dst_mask != 0; i++, dst_mask >>= 1) {
+		if ((dst_mask & 1) && endpoints[i])
+			endpoints[i]->send_shared(payload, TxPrio::NORMAL);
+	}
+}
+}	// namespace mavconn
@@ -16,6 +16,7 @@
  */
 
 #include <cassert>
+#include <algorithm>
 
 #include <mavconn/console_bridge_compat.h>
 #include <mavconn/thread_utils.h>
@@ -42,8 +43,11 @@ MAVConnSerial::MAVConnSerial(uint8_t system_id, uint8_t component_id,
 	MAVConnInterface(system_id, component_id),
 	tx_in_progress(false),
 	tx_q {},
+	tx_band(nullptr),
+	tx_coalesce_bytes(DEFAULT_TX_COALESCE_BYTES),
 	rx_buf {},
-	io_service(),
+	io_service(IOReactor::instance().get_io_service()),
+	strand(io_service),
 	serial_dev(io_service)
 {
 	using SPB = boost::asio::serial_port_base;
@@ -109,14 +113,8 @@ MAVConnSerial::MAVConnSerial(uint8_t system_id, uint8_t component_id,
 
 	// NOTE: shared_from_this() should not be used in constructors
 
-	// give some work to io_service before start
-	io_service.post(std::bind(&MAVConnSerial::do_read, this));
-
-	// run io_service for async io
-	io_thread = std::thread([this] () {
-				utils::set_this_thread_name("mserial%zu", conn_id);
-				io_service.run();
-			});
+	// start receive on the shared reactor
+	strand.post(std::bind(&MAVConnSerial::do_read, this));
 }
 
 MAVConnSerial::~MAVConnSerial()
@@ -133,12 +131,7 @@ void MAVConnSerial::close()
 	serial_dev.cancel();
 	serial_dev.close();
 
-	io_service.stop();
-
-	if (io_thread.joinable())
-		io_thread.join();
-
-	io_service.reset();
+	// pending handlers drain on the shared reactor pool
 
 	if (port_closed_cb)
 		port_closed_cb();
@@ -151,65 +144,105 @@ void MAVConnSerial::send_bytes(const uint8_t *bytes, size_t length)
 		return;
 	}
 
-	{
-		lock_guard lock(mutex);
+	if (!tx_q.emplace(TxPrio::NORMAL, bytes, length))
+		throw std::length_error("MAVConnSerial::send_bytes: TX queue overflow");
 
-		if (tx_q.size() >= MAX_TXQ_SIZE)
-			throw std::length_error("MAVConnSerial::send_bytes: TX queue overflow");
-
-		tx_q.emplace_back(bytes, length);
-	}
-	io_service.post(std::bind(&MAVConnSerial::do_write, shared_from_this(), true));
+	update_backpressure(tx_q.size());
+	strand.post(std::bind(&MAVConnSerial::do_write, shared_from_this(), true));
 }
 
 void MAVConnSerial::send_message(const mavlink_message_t *message)
+{
+	send_message(message, TxPrio::NORMAL);
+}
+
+void MAVConnSerial::send_message(const mavlink_message_t *message, TxPrio prio)
+{
+	if (!try_send_message(message, prio) && is_open())
+		throw std::length_error("MAVConnSerial::send_message: TX queue overflow");
+}
+
+bool MAVConnSerial::try_send_message(const mavlink_message_t *message, TxPrio prio)
 {
 	assert(message != nullptr);
 
 	if (!is_open()) {
 		CONSOLE_BRIDGE_logError(PFXd "send: channel closed!", conn_id);
-		return;
+		return false;
 	}
 
 	log_send(PFX, message);
 
-	{
-		lock_guard lock(mutex);
+	if (!tx_q.emplace(prio, message))
+		return false;
 
-		if (tx_q.size() >= MAX_TXQ_SIZE)
-			throw std::length_error("MAVConnSerial::send_message: TX queue overflow");
-
-		tx_q.emplace_back(message);
-	}
-	io_service.post(std::bind(&MAVConnSerial::do_write, shared_from_this(), true));
+	msg_stat_tx_add(message);
+	update_backpressure(tx_q.size());
+	strand.post(std::bind(&MAVConnSerial::do_write, shared_from_this(), true));
+	return true;
 }
 
 void MAVConnSerial::send_message(const mavlink::Message &message, const uint8_t source_compid)
+{
+	send_message(message, source_compid, TxPrio::NORMAL);
+}
+
+void MAVConnSerial::send_message(const mavlink::Message &message, const uint8_t source_compid, TxPrio prio)
+{
+	if (!try_send_message(message, source_compid, prio) && is_open())
+		throw std::length_error("MAVConnSerial::send_message: TX queue overflow");
+}
+
+bool MAVConnSerial::try_send_message(const mavlink::Message &message, const uint8_t source_compid, TxPrio prio)
 {
 	if (!is_open()) {
 		CONSOLE_BRIDGE_logError(PFXd "send: channel closed!", conn_id);
-		return;
+		return false;
 	}
 
 	log_send_obj(PFX, message);
 
-	{
-		lock_guard lock(mutex);
+	if (!tx_q.emplace(prio, message, get_status_p(), sys_id, source_compid))
+		return false;
 
-		if (tx_q.size() >= MAX_TXQ_SIZE)
-			throw std::length_error("MAVConnSerial::send_message: TX queue overflow");
+	msg_stat_tx_add(message);
+	update_backpressure(tx_q.size());
+	strand.post(std::bind(&MAVConnSerial::do_write, shared_from_this(), true));
+	return true;
+}
+
+void MAVConnSerial::send_shared(std::shared_ptr<const MsgBuffer> payload, TxPrio prio)
+{
+	if (!is_open()) {
+		CONSOLE_BRIDGE_logError(PFXd "send: channel closed!", conn_id);
+		return;
+	}
 
-		tx_q.emplace_back(message, get_status_p(), sys_id, source_compid);
+	if (!tx_q.emplace(prio, std::move(payload))) {
+		// router fanout: a full link drops, others keep the payload
+		CONSOLE_BRIDGE_logWarn(PFXd "send: TX queue overflow, shared payload dropped", conn_id);
+		return;
 	}
-	io_service.post(std::bind(&MAVConnSerial::do_write, shared_from_this(), true));
+
+	update_backpressure(tx_q.size());
+	strand.post(std::bind(&MAVConnSerial::do_write, shared_from_this(), true));
 }
 
 void MAVConnSerial::do_read(void)
 {
-	auto sthis = shared_from_this();
+	std::shared_ptr<MAVConnSerial> sthis;
+	try {
+		sthis = shared_from_this();
+	}
+	catch (const std::bad_weak_ptr &) {
+		// constructor did not finish yet; retry via the reactor
+		strand.post(std::bind(&MAVConnSerial::do_read, this));
+		return;
+	}
+
 	serial_dev.async_read_some(
 			buffer(rx_buf),
-			[sthis] (error_code error, size_t bytes_transferred) {
+			strand.wrap([sthis] (error_code error, size_t bytes_transferred) {
 				if (error) {
 					CONSOLE_BRIDGE_logError(PFXd "receive: %s", sthis->conn_id, error.message().c_str());
 					sthis->close();
@@ -218,7 +251,7 @@ void MAVConnSerial::do_read(void)
 
 				sthis->parse_buffer(PFX, sthis->rx_buf.data(), sthis->rx_buf.size(), bytes_transferred);
 				sthis->do_read();
-			});
+			}));
 }
 
 void MAVConnSerial::do_write(bool check_tx_state)
@@ -226,18 +259,36 @@ void MAVConnSerial::do_write(bool check_tx_state)
 	if (check_tx_state && tx_in_progress)
 		return;
 
-	lock_guard lock(mutex);
-	if (tx_q.empty())
+	auto *band = tx_q.active_band();
+	if (band == nullptr) {
+		tx_in_progress = false;
 		return;
+	}
 
+	tx_band = band;
+	auto *buf_ptr = band->front();
 	tx_in_progress = true;
+
+	// gather queued buffers into one write, bounded by the byte budget;
+	// the front buffer goes regardless of its size
+	tx_seg.clear();
+	tx_seg.emplace_back(buffer(buf_ptr->dpos(), buf_ptr->nbytes()));
+
+	size_t budget = (tx_coalesce_bytes > size_t(buf_ptr->nbytes())) ?
+		tx_coalesce_bytes - buf_ptr->nbytes() : 0;
+	for (size_t idx = 1; ; idx++) {
+		auto *next = band->peek(idx);
+		if (next == nullptr || size_t(next->nbytes()) > budget)
+			break;
+
+		tx_seg.emplace_back(buffer(next->dpos(), next->nbytes()));
+		budget -= next->nbytes();
+	}
+
 	auto sthis = shared_from_this();
-	auto &buf_ref = tx_q.front();
 	serial_dev.async_write_some(
-			buffer(buf_ref.dpos(), buf_ref.nbytes()),
-			[sthis, &buf_ref] (error_code error, size_t bytes_transferred) {
-				assert(bytes_transferred <= buf_ref.len);
-
+			tx_seg,
+			strand.wrap([sthis] (error_code error, size_t bytes_transferred) {
 				if (error) {
 					CONSOLE_BRIDGE_logError(PFXd "write: %s", sthis->conn_id, error.message().c_str());
 					sthis->close();
@@ -245,22 +296,23 @@ void MAVConnSerial::do_write(bool check_tx_state)
 				}
 
 				sthis->iostat_tx_add(bytes_transferred);
-				lock_guard lock(sthis->mutex);
 
-				if (sthis->tx_q.empty()) {
-					sthis->tx_in_progress = false;
-					return;
-				}
+				// advance through (possibly partially) sent buffers
+				while (bytes_transferred > 0) {
+					auto *buf = sthis->tx_band->front();
+					assert(buf != nullptr);
+
+					size_t nsent = std::min(bytes_transferred, size_t(buf->nbytes()));
+					buf->pos += nsent;
+					bytes_transferred -= nsent;
 
-				buf_ref.pos += bytes_transferred;
-				if (buf_ref.nbytes() == 0) {
-					sthis->tx_q.pop_front();
+					if (buf->nbytes() == 0)
+						sthis->tx_band->pop_front();
 				}
 
-				if (!sthis->tx_q.empty())
-					sthis->do_write(false);
-				else
-					sthis->tx_in_progress = false;
-			});
+				sthis->update_backpressure(sthis->tx_q.size());
+
+				sthis->do_write(false);
+			}));
 }
 }	// namespace mavconn
@@ -16,18 +16,12 @@
  */
 
 #include <cassert>
+#include <algorithm>
 
 #include <mavconn/console_bridge_compat.h>
 #include <mavconn/thread_utils.h>
 #include <mavconn/tcp.h>
 
-// Ensure the correct io_service() is called based on boost version
-#if BOOST_VERSION >= 107000
-#define GET_IO_SERVICE(s) ((boost::asio::io_context&)(s).get_executor().context())
-#else
-#define GET_IO_SERVICE(s) ((s).get_io_service())
-#endif
-
 namespace mavconn {
 
 using boost::system::error_code;
@@ -80,9 +74,11 @@ MAVConnTCPClient::MAVConnTCPClient(uint8_t system_id, uint8_t component_id,
 	is_destroying(false),
 	tx_in_progress(false),
 	tx_q {},
+	tx_band(nullptr),
+	tx_coalesce_bytes(DEFAULT_TX_COALESCE_BYTES),
 	rx_buf {},
-	io_service(),
-	io_work(new io_service::work(io_service)),
+	io_service(IOReactor::instance().get_io_service()),
+	strand(io_service),
 	socket(io_service)
 {
 	if (!resolve_address_tcp(io_service, conn_id, server_host, server_port, server_ep))
@@ -100,14 +96,8 @@ MAVConnTCPClient::MAVConnTCPClient(uint8_t system_id, uint8_t component_id,
 
 	// NOTE: shared_from_this() should not be used in constructors
 
-	// give some work to io_service before start
-	io_service.post(std::bind(&MAVConnTCPClient::do_recv, this));
-
-	// run io_service for async io
-	io_thread = std::thread([this] () {
-				utils::set_this_thread_name("mtcp%zu", conn_id);
-				io_service.run();
-			});
+	// start receive on the shared reactor
+	strand.post(std::bind(&MAVConnTCPClient::do_recv, this));
 }
 
 MAVConnTCPClient::MAVConnTCPClient(uint8_t system_id, uint8_t component_id,
@@ -115,8 +105,12 @@ MAVConnTCPClient::MAVConnTCPClient(uint8_t system_id, uint8_t component_id,
 	MAVConnInterface(system_id, component_id),
 	tx_in_progress(false),
 	tx_q {},
+	tx_band(nullptr),
+	tx_coalesce_bytes(DEFAULT_TX_COALESCE_BYTES),
 	rx_buf {},
-	socket(server_io)
+	io_service(server_io),
+	strand(io_service),
+	socket(io_service)
 {
 	// waiting when server call client_connected()
 }
@@ -127,7 +121,7 @@ void MAVConnTCPClient::client_connected(size_t server_channel)
 			server_channel, conn_id, to_string_ss(server_ep).c_str());
 
 	// start recv
-	GET_IO_SERVICE(socket).post(std::bind(&MAVConnTCPClient::do_recv, shared_from_this()));
+	strand.post(std::bind(&MAVConnTCPClient::do_recv, shared_from_this()));
 }
 
 MAVConnTCPClient::~MAVConnTCPClient()
@@ -146,13 +140,7 @@ void MAVConnTCPClient::close()
 	socket.cancel();
 	socket.close();
 
-	io_work.reset();
-	io_service.stop();
-
-	if (io_thread.joinable())
-		io_thread.join();
-
-	io_service.reset();
+	// pending handlers drain on the shared reactor pool
 
 	if (port_closed_cb)
 		port_closed_cb();
@@ -165,57 +153,88 @@ void MAVConnTCPClient::send_bytes(const uint8_t *bytes, size_t length)
 		return;
 	}
 
-	{
-		lock_guard lock(mutex);
-
-		if (tx_q.size() >= MAX_TXQ_SIZE)
-			throw std::length_error("MAVConnTCPClient::send_bytes: TX queue overflow");
+	if (!tx_q.emplace(TxPrio::NORMAL, bytes, length))
+		throw std::length_error("MAVConnTCPClient::send_bytes: TX queue overflow");
 
-		tx_q.emplace_back(bytes, length);
-	}
-	GET_IO_SERVICE(socket).post(std::bind(&MAVConnTCPClient::do_send, shared_from_this(), true));
+	update_backpressure(tx_q.size());
+	strand.post(std::bind(&MAVConnTCPClient::do_send, shared_from_this(), true));
 }
 
 void MAVConnTCPClient::send_message(const mavlink_message_t *message)
+{
+	send_message(message, TxPrio::NORMAL);
+}
+
+void MAVConnTCPClient::send_message(const mavlink_message_t *message, TxPrio prio)
+{
+	if (!try_send_message(message, prio) && is_open())
+		throw std::length_error("MAVConnTCPClient::send_message: TX queue overflow");
+}
+
+bool MAVConnTCPClient::try_send_message(const mavlink_message_t *message, TxPrio prio)
 {
 	assert(message != nullptr);
 
 	if (!is_open()) {
 		CONSOLE_BRIDGE_logError(PFXd "send: channel closed!", conn_id);
-		return;
+		return false;
 	}
 
 	log_send(PFX, message);
 
-	{
-		lock_guard lock(mutex);
-
-		if (tx_q.size() >= MAX_TXQ_SIZE)
-			throw std::length_error("MAVConnTCPClient::send_message: TX queue overflow");
+	if (!tx_q.emplace(prio, message))
+		return false;
 
-		tx_q.emplace_back(message);
-	}
-	GET_IO_SERVICE(socket).post(std::bind(&MAVConnTCPClient::do_send, shared_from_this(), true));
+	msg_stat_tx_add(message);
+	update_backpressure(tx_q.size());
+	strand.post(std::bind(&MAVConnTCPClient::do_send, shared_from_this(), true));
+	return true;
 }
 
 void MAVConnTCPClient::send_message(const mavlink::Message &message, const uint8_t source_compid)
+{
+	send_message(message, source_compid, TxPrio::NORMAL);
+}
+
+void MAVConnTCPClient::send_message(const mavlink::Message &message, const uint8_t source_compid, TxPrio prio)
+{
+	if (!try_send_message(message, source_compid, prio) && is_open())
+		throw std::length_error("MAVConnTCPClient::send_message: TX queue overflow");
+}
+
+bool MAVConnTCPClient::try_send_message(const mavlink::Message &message, const uint8_t source_compid, TxPrio prio)
 {
 	if (!is_open()) {
 		CONSOLE_BRIDGE_logError(PFXd "send: channel closed!", conn_id);
-		return;
+		return false;
 	}
 
 	log_send_obj(PFX, message);
 
-	{
-		lock_guard lock(mutex);
+	if (!tx_q.emplace(prio, message, get_status_p(), sys_id, source_compid))
+		return false;
 
-		if (tx_q.size() >= MAX_TXQ_SIZE)
-			throw std::length_error("MAVConnTCPClient::send_message: TX queue overflow");
+	msg_stat_tx_add(message);
+	update_backpressure(tx_q.size());
+	strand.post(std::bind(&MAVConnTCPClient::do_send, shared_from_this(), true));
+	return true;
+}
+
+void MAVConnTCPClient::send_shared(std::shared_ptr<const MsgBuffer> payload, TxPrio prio)
+{
+	if (!is_open()) {
+		CONSOLE_BRIDGE_logError(PFXd "send: channel closed!", conn_id);
+		return;
+	}
 
-		tx_q.emplace_back(message, get_status_p(), sys_id, source_compid);
+	if (!tx_q.emplace(prio, std::move(payload))) {
+		// one slow viewer must not abort the broadcast to the others
+		CONSOLE_BRIDGE_logWarn(PFXd "send: TX queue overflow, broadcast dropped for this client", conn_id);
+		return;
 	}
-	GET_IO_SERVICE(socket).post(std::bind(&MAVConnTCPClient::do_send, shared_from_this(), true));
+
+	update_backpressure(tx_q.size());
+	strand.post(std::bind(&MAVConnTCPClient::do_send, shared_from_this(), true));
 }
 
 void MAVConnTCPClient::do_recv()
@@ -223,10 +242,20 @@ void MAVConnTCPClient::do_recv()
 	if (is_destroying) {
 		return;
 	}
-	auto sthis = shared_from_this();
+
+	std::shared_ptr<MAVConnTCPClient> sthis;
+	try {
+		sthis = shared_from_this();
+	}
+	catch (const std::bad_weak_ptr &) {
+		// constructor did not finish yet; retry via the reactor
+		strand.post(std::bind(&MAVConnTCPClient::do_recv, this));
+		return;
+	}
+
 	socket.async_receive(
 			buffer(rx_buf),
-			[sthis] (error_code error, size_t bytes_transferred) {
+			strand.wrap([sthis] (error_code error, size_t bytes_transferred) {
 				if (error) {
 					CONSOLE_BRIDGE_logError(PFXd "receive: %s", sthis->conn_id, error.message().c_str());
 					sthis->close();
@@ -235,7 +264,7 @@ void MAVConnTCPClient::do_recv()
 
 				sthis->parse_buffer(PFX, sthis->rx_buf.data(), sthis->rx_buf.size(), bytes_transferred);
 				sthis->do_recv();
-			});
+			}));
 }
 
 void MAVConnTCPClient::do_send(bool check_tx_state)
@@ -243,18 +272,36 @@ void MAVConnTCPClient::do_send(bool check_tx_state)
 	if (check_tx_state && tx_in_progress)
 		return;
 
-	lock_guard lock(mutex);
-	if (tx_q.empty())
+	auto *band = tx_q.active_band();
+	if (band == nullptr) {
+		tx_in_progress = false;
 		return;
+	}
 
+	tx_band = band;
+	auto *buf_ptr = band->front();
 	tx_in_progress = true;
+
+	// gather queued buffers into one write, bounded by the byte budget;
+	// the front buffer goes regardless of its size
+	tx_seg.clear();
+	tx_seg.emplace_back(buffer(buf_ptr->dpos(), buf_ptr->nbytes()));
+
+	size_t budget = (tx_coalesce_bytes > size_t(buf_ptr->nbytes())) ?
+		tx_coalesce_bytes - buf_ptr->nbytes() : 0;
+	for (size_t idx = 1; ; idx++) {
+		auto *next = band->peek(idx);
+		if (next == nullptr || size_t(next->nbytes()) > budget)
+			break;
+
+		tx_seg.emplace_back(buffer(next->dpos(), next->nbytes()));
+		budget -= next->nbytes();
+	}
+
 	auto sthis = shared_from_this();
-	auto &buf_ref = tx_q.front();
 	socket.async_send(
-			buffer(buf_ref.dpos(), buf_ref.nbytes()),
-			[sthis, &buf_ref] (error_code error, size_t bytes_transferred) {
-				assert(bytes_transferred <= buf_ref.len);
-
+			tx_seg,
+			strand.wrap([sthis] (error_code error, size_t bytes_transferred) {
 				if (error) {
 					CONSOLE_BRIDGE_logError(PFXd "send: %s", sthis->conn_id, error.message().c_str());
 					sthis->close();
@@ -262,23 +309,24 @@ void MAVConnTCPClient::do_send(bool check_tx_state)
 				}
 
 				sthis->iostat_tx_add(bytes_transferred);
-				lock_guard lock(sthis->mutex);
 
-				if (sthis->tx_q.empty()) {
-					sthis->tx_in_progress = false;
-					return;
-				}
+				// advance through (possibly partially) sent buffers
+				while (bytes_transferred > 0) {
+					auto *buf = sthis->tx_band->front();
+					assert(buf != nullptr);
+
+					size_t nsent = std::min(bytes_transferred, size_t(buf->nbytes()));
+					buf->pos += nsent;
+					bytes_transferred -= nsent;
 
-				buf_ref.pos += bytes_transferred;
-				if (buf_ref.nbytes() == 0) {
-					sthis->tx_q.pop_front();
+					if (buf->nbytes() == 0)
+						sthis->tx_band->pop_front();
 				}
 
-				if (!sthis->tx_q.empty())
-					sthis->do_send(false);
-				else
-					sthis->tx_in_progress = false;
-			});
+				sthis->update_backpressure(sthis->tx_q.size());
+
+				sthis->do_send(false);
+			}));
 }
 
 
@@ -287,7 +335,8 @@ void MAVConnTCPClient::do_send(bool check_tx_state)
 MAVConnTCPServer::MAVConnTCPServer(uint8_t system_id, uint8_t component_id,
 		std::string server_host, unsigned short server_port) :
 	MAVConnInterface(system_id, component_id),
-	io_service(),
+	io_service(IOReactor::instance().get_io_service()),
+	strand(io_service),
 	acceptor(io_service),
 	is_destroying(false)
 {
@@ -306,14 +355,8 @@ MAVConnTCPServer::MAVConnTCPServer(uint8_t system_id, uint8_t component_id,
 		throw DeviceError("tcp-l", err);
 	}
 
-	// give some work to io_service before start
-	io_service.post(std::bind(&MAVConnTCPServer::do_accept, this));
-
-	// run io_service for async io
-	io_thread = std::thread([this] () {
-				utils::set_this_thread_name("mtcps%zu", conn_id);
-				io_service.run();
-			});
+	// start accepting on the shared reactor
+	strand.post(std::bind(&MAVConnTCPServer::do_accept, this));
 }
 
 MAVConnTCPServer::~MAVConnTCPServer()
@@ -331,11 +374,14 @@ void MAVConnTCPServer::close()
 	CONSOLE_BRIDGE_logInform(PFXd "Terminating server. "
 			"All connections will be closed.", conn_id);
 
-	io_service.stop();
+	acceptor.cancel();
 	acceptor.close();
 
-	if (io_thread.joinable())
-		io_thread.join();
+	// close accepted connections; their handlers drain on the shared
+	// reactor. Iterate over a copy: close() removes from client_list.
+	auto clients_copy = client_list;
+	for (auto &instp : clients_copy)
+		instp->close();
 
 	if (port_closed_cb)
 		port_closed_cb();
@@ -390,25 +436,54 @@ MAVConnInterface::IOStat MAVConnTCPServer::get_iostat()
 
 void MAVConnTCPServer::send_bytes(const uint8_t *bytes, size_t length)
 {
+	auto payload = std::make_shared<const MsgBuffer>(bytes, length);
+
 	lock_guard lock(mutex);
 	for (auto &instp : client_list) {
-		instp->send_bytes(bytes, length);
+		instp->send_shared(payload, TxPrio::NORMAL);
 	}
 }
 
 void MAVConnTCPServer::send_message(const mavlink_message_t *message)
 {
+	send_message(message, TxPrio::NORMAL);
+}
+
+void MAVConnTCPServer::send_message(const mavlink_message_t *message, TxPrio prio)
+{
+	assert(message != nullptr);
+
+	// serialize once, share the bytes across every client queue
+	auto payload = std::make_shared<const MsgBuffer>(message);
+
 	lock_guard lock(mutex);
 	for (auto &instp : client_list) {
-		instp->send_message(message);
+		instp->send_shared(payload, prio);
 	}
 }
 
 void MAVConnTCPServer::send_message(const mavlink::Message &message, const uint8_t source_compid)
 {
+	send_message(message, source_compid, TxPrio::NORMAL);
+}
+
+void MAVConnTCPServer::send_message(const mavlink::Message &message, const uint8_t source_compid, TxPrio prio)
+{
+	// serialize once with the server channel status,
+	// share the bytes across every client queue
+	auto payload = std::make_shared<const MsgBuffer>(message, get_status_p(), sys_id, source_compid);
+
 	lock_guard lock(mutex);
 	for (auto &instp : client_list) {
-		instp->send_message(message, source_compid);
+		instp->send_shared(payload, prio);
+	}
+}
+
+void MAVConnTCPServer::send_shared(std::shared_ptr<const MsgBuffer> payload, TxPrio prio)
+{
+	lock_guard lock(mutex);
+	for (auto &instp : client_list) {
+		instp->send_shared(payload, prio);
 	}
 }
 
@@ -417,12 +492,22 @@ void MAVConnTCPServer::do_accept()
 	if (is_destroying) {
 		return;
 	}
-	auto sthis = shared_from_this();
+
+	std::shared_ptr<MAVConnTCPServer> sthis;
+	try {
+		sthis = shared_from_this();
+	}
+	catch (const std::bad_weak_ptr &) {
+		// constructor did not finish yet; retry via the reactor
+		strand.post(std::bind(&MAVConnTCPServer::do_accept, this));
+		return;
+	}
+
 	auto acceptor_client = std::make_shared<MAVConnTCPClient>(sys_id, comp_id, io_service);
 	acceptor.async_accept(
 			acceptor_client->socket,
 			acceptor_client->server_ep,
-			[sthis, acceptor_client] (error_code error) {
+			strand.wrap([sthis, acceptor_client] (error_code error) {
 				if (error) {
 					CONSOLE_BRIDGE_logError(PFXd "accept: %s", sthis->conn_id, error.message().c_str());
 					sthis->close();
@@ -438,7 +523,7 @@ void MAVConnTCPServer::do_accept()
 
 				sthis->client_list.push_back(acceptor_client);
 				sthis->do_accept();
-			});
+			}));
 }
 
 void MAVConnTCPServer::client_closed(std::weak_ptr<MAVConnTCPClient> weak_instp)
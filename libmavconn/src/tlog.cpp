@@ -0,0 +1,208 @@
+/**
+ * @brief MAVConn telemetry log replay class
+ * @file tlog.cpp
+ * @author Vladimir Ermakov <vooon341@gmail.com>
+ *
+ * @addtogroup mavconn
+ * @{
+ */
+/*
+ * libmavconn
+ * Copyright 2013,2014,2015,2016 Vladimir Ermakov, All rights reserved.
+ *
+ * This file is part of the mavros package and subject to the license terms
+ * in the top-level LICENSE file of the mavros repository.
+ * https://github.com/mavlink/mavros/tree/master/LICENSE.md
+ */
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <mavconn/console_bridge_compat.h>
+#include <mavconn/tlog.h>
+
+namespace mavconn {
+
+#define PFX	"mavconn: tlog"
+#define PFXd	PFX "%zu: "
+
+//! tlog record header: 8 byte big-endian timestamp [usec]
+static constexpr size_t STAMP_LEN = 8;
+
+
+static uint64_t read_stamp(const uint8_t *p)
+{
+	uint64_t stamp = 0;
+
+	for (size_t i = 0; i < STAMP_LEN; i++)
+		stamp = (stamp << 8) | p[i];
+
+	return stamp;
+}
+
+/**
+ * @brief Frame length from the mavlink header, 0 when not a frame start.
+ */
+static size_t frame_size(const uint8_t *p, size_t avail)
+{
+	if (avail < 3)
+		return 0;
+
+	if (p[0] == MAVLINK_STX)
+		return p[1] + MAVLINK_NUM_NON_PAYLOAD_BYTES +
+		       ((p[2] & MAVLINK_IFLAG_SIGNED) ? MAVLINK_SIGNATURE_BLOCK_LEN : 0);
+
+	if (p[0] == MAVLINK_STX_MAVLINK1)
+		return p[1] + MAVLINK_CORE_HEADER_MAVLINK1_LEN + 3;
+
+	return 0;
+}
+
+MAVConnTlog::MAVConnTlog(uint8_t system_id, uint8_t component_id,
+		std::string path, double speed) :
+	MAVConnInterface(system_id, component_id),
+	io_service(IOReactor::instance().get_io_service()),
+	strand(io_service),
+	timer(io_service),
+	open_flag(false),
+	fd(-1),
+	map_data(nullptr),
+	map_size(0),
+	offset(0),
+	last_stamp(0),
+	speed(speed)
+{
+	fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		throw DeviceError("tlog: open", ::strerror(errno));
+
+	struct stat st;
+	if (::fstat(fd, &st) < 0) {
+		::close(fd);
+		throw DeviceError("tlog: stat", ::strerror(errno));
+	}
+
+	map_size = st.st_size;
+	map_data = static_cast<const uint8_t *>(::mmap(nullptr, map_size, PROT_READ, MAP_PRIVATE, fd, 0));
+	if (map_data == MAP_FAILED) {
+		::close(fd);
+		throw DeviceError("tlog: mmap", ::strerror(errno));
+	}
+
+	open_flag = true;
+	CONSOLE_BRIDGE_logInform(PFXd "Replaying %s (%zu bytes, speed %s)",
+			conn_id, path.c_str(), map_size,
+			(speed > 0.0) ? "paced" : "max");
+
+	// NOTE: shared_from_this() should not be used in constructors
+
+	// start replay on the shared reactor
+	strand.post(std::bind(&MAVConnTlog::do_replay, this));
+}
+
+MAVConnTlog::~MAVConnTlog()
+{
+	close();
+
+	if (map_data != nullptr)
+		::munmap(const_cast<uint8_t *>(map_data), map_size);
+	if (fd >= 0)
+		::close(fd);
+}
+
+void MAVConnTlog::close()
+{
+	if (!open_flag.exchange(false))
+		return;
+
+	timer.cancel();
+
+	if (port_closed_cb)
+		port_closed_cb();
+}
+
+void MAVConnTlog::do_replay()
+{
+	if (!open_flag)
+		return;
+
+	std::shared_ptr<MAVConnTlog> sthis;
+	try {
+		sthis = shared_from_this();
+	}
+	catch (const std::bad_weak_ptr &) {
+		// constructor did not finish yet; retry via the reactor
+		strand.post(std::bind(&MAVConnTlog::do_replay, this));
+		return;
+	}
+
+	for (size_t fed = 0; fed < REPLAY_BATCH; fed++) {
+		if (offset + STAMP_LEN >= map_size) {
+			CONSOLE_BRIDGE_logInform(PFXd "End of log.", conn_id);
+			close();
+			return;
+		}
+
+		uint64_t stamp = read_stamp(map_data + offset);
+		const uint8_t *frame = map_data + offset + STAMP_LEN;
+		size_t avail = map_size - offset - STAMP_LEN;
+		size_t flen = frame_size(frame, avail);
+
+		if (flen == 0 || flen > avail) {
+			// corrupted record: resynchronize on the next timestamp
+			offset++;
+			continue;
+		}
+
+		if (speed > 0.0 && last_stamp != 0 && stamp > last_stamp) {
+			// paced replay: wait out the recorded gap, then re-enter
+			// (last_stamp is advanced so the wait happens only once)
+			uint64_t gap_usec = static_cast<uint64_t>((stamp - last_stamp) / speed);
+			last_stamp = stamp;
+
+			timer.expires_from_now(boost::posix_time::microseconds(gap_usec));
+			timer.async_wait(strand.wrap([sthis] (boost::system::error_code error) {
+						if (error)
+							return;
+
+						sthis->do_replay();
+					}));
+			return;
+		}
+
+		last_stamp = stamp;
+		offset += STAMP_LEN + flen;
+
+		parse_buffer(PFX, const_cast<uint8_t *>(frame), flen, flen);
+	}
+
+	// share the reactor with other connections between batches
+	strand.post(std::bind(&MAVConnTlog::do_replay, sthis));
+}
+
+void MAVConnTlog::send_message(const mavlink::mavlink_message_t *message)
+{
+	(void)message;
+	CONSOLE_BRIDGE_logDebug(PFXd "send: ignored on replay link", conn_id);
+}
+
+void MAVConnTlog::send_message(const mavlink::Message &message, const uint8_t source_compid)
+{
+	(void)message;
+	(void)source_compid;
+	CONSOLE_BRIDGE_logDebug(PFXd "send: ignored on replay link", conn_id);
+}
+
+void MAVConnTlog::send_bytes(const uint8_t *bytes, size_t length)
+{
+	(void)bytes;
+	(void)length;
+	CONSOLE_BRIDGE_logDebug(PFXd "send: ignored on replay link", conn_id);
+}
+}	// namespace mavconn
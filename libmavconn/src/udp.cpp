@@ -17,6 +17,13 @@
 
 #include <cassert>
 
+#if defined(__linux__)
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#endif
+
 #include <mavconn/console_bridge_compat.h>
 #include <mavconn/thread_utils.h>
 #include <mavconn/udp.h>
@@ -72,9 +79,10 @@ MAVConnUDP::MAVConnUDP(uint8_t system_id, uint8_t component_id,
 	remote_exists(false),
 	tx_in_progress(false),
 	tx_q {},
+	tx_band(nullptr),
 	rx_buf {},
-	io_service(),
-	io_work(new io_service::work(io_service)),
+	io_service(IOReactor::instance().get_io_service()),
+	strand(io_service),
 	socket(io_service),
 	permanent_broadcast(false)
 {
@@ -122,14 +130,8 @@ MAVConnUDP::MAVConnUDP(uint8_t system_id, uint8_t component_id,
 
 	// NOTE: shared_from_this() should not be used in constructors
 
-	// give some work to io_service before start
-	io_service.post(std::bind(&MAVConnUDP::do_recvfrom, this));
-
-	// run io_service for async io
-	io_thread = std::thread([this] () {
-				utils::set_this_thread_name("mudp%zu", conn_id);
-				io_service.run();
-			});
+	// start receive on the shared reactor
+	strand.post(std::bind(&MAVConnUDP::do_recvfrom, this));
 }
 
 MAVConnUDP::~MAVConnUDP()
@@ -146,13 +148,7 @@ void MAVConnUDP::close()
 	socket.cancel();
 	socket.close();
 
-	io_work.reset();
-	io_service.stop();
-
-	if (io_thread.joinable())
-		io_thread.join();
-
-	io_service.reset();
+	// pending handlers drain on the shared reactor pool
 
 	if (port_closed_cb)
 		port_closed_cb();
@@ -170,76 +166,137 @@ void MAVConnUDP::send_bytes(const uint8_t *bytes, size_t length)
 		return;
 	}
 
-	{
-		lock_guard lock(mutex);
-
-		if (tx_q.size() >= MAX_TXQ_SIZE)
-			throw std::length_error("MAVConnUDP::send_bytes: TX queue overflow");
+	if (!tx_q.emplace(TxPrio::NORMAL, bytes, length))
+		throw std::length_error("MAVConnUDP::send_bytes: TX queue overflow");
 
-		tx_q.emplace_back(bytes, length);
-	}
-	io_service.post(std::bind(&MAVConnUDP::do_sendto, shared_from_this(), true));
+	update_backpressure(tx_q.size());
+	strand.post(std::bind(&MAVConnUDP::do_sendto, shared_from_this(), true));
 }
 
 void MAVConnUDP::send_message(const mavlink_message_t *message)
+{
+	send_message(message, TxPrio::NORMAL);
+}
+
+void MAVConnUDP::send_message(const mavlink_message_t *message, TxPrio prio)
+{
+	if (!try_send_message(message, prio) && is_open())
+		throw std::length_error("MAVConnUDP::send_message: TX queue overflow");
+}
+
+bool MAVConnUDP::try_send_message(const mavlink_message_t *message, TxPrio prio)
 {
 	assert(message != nullptr);
 
 	if (!is_open()) {
 		CONSOLE_BRIDGE_logError(PFXd "send: channel closed!", conn_id);
-		return;
+		return false;
 	}
 
 	if (!remote_exists) {
 		CONSOLE_BRIDGE_logDebug(PFXd "send: Remote not known, message dropped.", conn_id);
-		return;
+		return true;
 	}
 
 	log_send(PFX, message);
 
-	{
-		lock_guard lock(mutex);
-
-		if (tx_q.size() >= MAX_TXQ_SIZE)
-			throw std::length_error("MAVConnUDP::send_message: TX queue overflow");
+	if (!tx_q.emplace(prio, message))
+		return false;
 
-		tx_q.emplace_back(message);
-	}
-	io_service.post(std::bind(&MAVConnUDP::do_sendto, shared_from_this(), true));
+	msg_stat_tx_add(message);
+	update_backpressure(tx_q.size());
+	strand.post(std::bind(&MAVConnUDP::do_sendto, shared_from_this(), true));
+	return true;
 }
 
 void MAVConnUDP::send_message(const mavlink::Message &message, const uint8_t source_compid)
+{
+	send_message(message, source_compid, TxPrio::NORMAL);
+}
+
+void MAVConnUDP::send_message(const mavlink::Message &message, const uint8_t source_compid, TxPrio prio)
+{
+	if (!try_send_message(message, source_compid, prio) && is_open())
+		throw std::length_error("MAVConnUDP::send_message: TX queue overflow");
+}
+
+bool MAVConnUDP::try_send_message(const mavlink::Message &message, const uint8_t source_compid, TxPrio prio)
 {
 	if (!is_open()) {
 		CONSOLE_BRIDGE_logError(PFXd "send: channel closed!", conn_id);
-		return;
+		return false;
 	}
 
 	if (!remote_exists) {
 		CONSOLE_BRIDGE_logDebug(PFXd "send: Remote not known, message dropped.", conn_id);
-		return;
+		return true;
 	}
 
 	log_send_obj(PFX, message);
 
-	{
-		lock_guard lock(mutex);
+	if (!tx_q.emplace(prio, message, get_status_p(), sys_id, source_compid))
+		return false;
+
+	msg_stat_tx_add(message);
+	update_backpressure(tx_q.size());
+	strand.post(std::bind(&MAVConnUDP::do_sendto, shared_from_this(), true));
+	return true;
+}
+
+void MAVConnUDP::send_shared(std::shared_ptr<const MsgBuffer> payload, TxPrio prio)
+{
+	if (!is_open()) {
+		CONSOLE_BRIDGE_logError(PFXd "send: channel closed!", conn_id);
+		return;
+	}
 
-		if (tx_q.size() >= MAX_TXQ_SIZE)
-			throw std::length_error("MAVConnUDP::send_message: TX queue overflow");
+	if (!remote_exists) {
+		CONSOLE_BRIDGE_logDebug(PFXd "send: Remote not known, message dropped.", conn_id);
+		return;
+	}
 
-		tx_q.emplace_back(message, get_status_p(), sys_id, source_compid);
+	if (!tx_q.emplace(prio, std::move(payload))) {
+		// router fanout: a full link drops, others keep the payload
+		CONSOLE_BRIDGE_logWarn(PFXd "send: TX queue overflow, shared payload dropped", conn_id);
+		return;
 	}
-	io_service.post(std::bind(&MAVConnUDP::do_sendto, shared_from_this(), true));
+
+	update_backpressure(tx_q.size());
+	strand.post(std::bind(&MAVConnUDP::do_sendto, shared_from_this(), true));
 }
 
 void MAVConnUDP::do_recvfrom()
 {
-	auto sthis = shared_from_this();
+	std::shared_ptr<MAVConnUDP> sthis;
+	try {
+		sthis = shared_from_this();
+	}
+	catch (const std::bad_weak_ptr &) {
+		// constructor did not finish yet; retry via the reactor
+		strand.post(std::bind(&MAVConnUDP::do_recvfrom, this));
+		return;
+	}
+
+#if defined(__linux__)
+	// Fast path: wait for readability only, then drain a batch of
+	// datagrams with a single recvmmsg() syscall. At kHz message
+	// rates this saves one syscall + handler dispatch per packet.
+	socket.async_receive(
+			boost::asio::null_buffers(),
+			strand.wrap([sthis] (error_code error, size_t /*bytes_transferred*/) {
+				if (error) {
+					CONSOLE_BRIDGE_logError(PFXd "receive: %s", sthis->conn_id, error.message().c_str());
+					sthis->close();
+					return;
+				}
+
+				sthis->do_recvmmsg();
+			}));
+#else
 	socket.async_receive_from(
 			buffer(rx_buf),
 			permanent_broadcast ? recv_ep : remote_ep,
-			[sthis] (error_code error, size_t bytes_transferred) {
+			strand.wrap([sthis] (error_code error, size_t bytes_transferred) {
 				if (error) {
 					CONSOLE_BRIDGE_logError(PFXd "receive: %s", sthis->conn_id, error.message().c_str());
 					sthis->close();
@@ -254,26 +311,84 @@ void MAVConnUDP::do_recvfrom()
 
 				sthis->parse_buffer(PFX, sthis->rx_buf.data(), sthis->rx_buf.size(), bytes_transferred);
 				sthis->do_recvfrom();
-			});
+			}));
+#endif
+}
+
+#if defined(__linux__)
+void MAVConnUDP::do_recvmmsg()
+{
+	struct mmsghdr msgs[RX_BATCH_SIZE];
+	struct iovec iovs[RX_BATCH_SIZE];
+	struct sockaddr_in addrs[RX_BATCH_SIZE];
+
+	memset(msgs, 0, sizeof(msgs));
+	for (size_t i = 0; i < RX_BATCH_SIZE; i++) {
+		iovs[i].iov_base = rx_batch_buf[i].data();
+		iovs[i].iov_len = rx_batch_buf[i].size();
+		msgs[i].msg_hdr.msg_iov = &iovs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+		msgs[i].msg_hdr.msg_name = &addrs[i];
+		msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+	}
+
+	int ndgram = ::recvmmsg(socket.native_handle(), msgs, RX_BATCH_SIZE, MSG_DONTWAIT, nullptr);
+	if (ndgram < 0) {
+		if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+			// spurious wakeup, rearm the readiness wait
+			do_recvfrom();
+			return;
+		}
+
+		CONSOLE_BRIDGE_logError(PFXd "recvmmsg: %s", conn_id, ::strerror(errno));
+		close();
+		return;
+	}
+
+	for (int i = 0; i < ndgram; i++) {
+		if (!permanent_broadcast) {
+			remote_ep = udp::endpoint(
+					boost::asio::ip::address_v4(ntohl(addrs[i].sin_addr.s_addr)),
+					ntohs(addrs[i].sin_port));
+
+			if (remote_ep != last_remote_ep) {
+				CONSOLE_BRIDGE_logInform(PFXd "Remote address: %s", conn_id, to_string_ss(remote_ep).c_str());
+				remote_exists = true;
+				last_remote_ep = remote_ep;
+			}
+		}
+
+		parse_buffer(PFX, rx_batch_buf[i].data(), rx_batch_buf[i].size(), msgs[i].msg_len);
+	}
+
+	do_recvfrom();
 }
+#endif
 
 void MAVConnUDP::do_sendto(bool check_tx_state)
 {
 	if (check_tx_state && tx_in_progress)
 		return;
 
-	lock_guard lock(mutex);
-	if (tx_q.empty())
+	auto *band = tx_q.active_band();
+	if (band == nullptr) {
+		tx_in_progress = false;
 		return;
+	}
 
+	tx_band = band;
 	tx_in_progress = true;
+
+#if defined(__linux__)
+	do_sendmmsg();
+#else
+	auto *buf_ptr = band->front();
 	auto sthis = shared_from_this();
-	auto &buf_ref = tx_q.front();
 	socket.async_send_to(
-			buffer(buf_ref.dpos(), buf_ref.nbytes()),
+			buffer(buf_ptr->dpos(), buf_ptr->nbytes()),
 			remote_ep,
-			[sthis, &buf_ref] (error_code error, size_t bytes_transferred) {
-				assert(bytes_transferred <= buf_ref.len);
+			strand.wrap([sthis, buf_ptr] (error_code error, size_t bytes_transferred) {
+				assert(ssize_t(bytes_transferred) <= buf_ptr->len);
 
 				if (error == boost::asio::error::network_unreachable) {
 					CONSOLE_BRIDGE_logWarn(PFXd "sendto: %s, retrying", sthis->conn_id, error.message().c_str());
@@ -286,22 +401,83 @@ void MAVConnUDP::do_sendto(bool check_tx_state)
 				}
 
 				sthis->iostat_tx_add(bytes_transferred);
-				lock_guard lock(sthis->mutex);
 
-				if (sthis->tx_q.empty()) {
-					sthis->tx_in_progress = false;
-					return;
-				}
+				buf_ptr->pos += bytes_transferred;
+				if (buf_ptr->nbytes() == 0)
+					sthis->tx_band->pop_front();
 
-				buf_ref.pos += bytes_transferred;
-				if (buf_ref.nbytes() == 0) {
-					sthis->tx_q.pop_front();
-				}
+				sthis->update_backpressure(sthis->tx_q.size());
+				sthis->do_sendto(false);
+			}));
+#endif
+}
 
-				if (!sthis->tx_q.empty())
-					sthis->do_sendto(false);
-				else
-					sthis->tx_in_progress = false;
-			});
+#if defined(__linux__)
+void MAVConnUDP::do_sendmmsg()
+{
+	struct mmsghdr msgs[TX_BATCH_SIZE];
+	struct iovec iovs[TX_BATCH_SIZE];
+	struct sockaddr_in addr;
+
+	// one destination for the whole batch
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(remote_ep.address().to_v4().to_ulong());
+	addr.sin_port = htons(remote_ep.port());
+
+	// flush whatever is queued right now: a lone message still goes
+	// out immediately, batching only kicks in under load
+	memset(msgs, 0, sizeof(msgs));
+	unsigned int ndgram = 0;
+	for (; ndgram < TX_BATCH_SIZE; ndgram++) {
+		auto *buf_ptr = tx_band->peek(ndgram);
+		if (buf_ptr == nullptr)
+			break;
+
+		iovs[ndgram].iov_base = const_cast<uint8_t *>(buf_ptr->dpos());
+		iovs[ndgram].iov_len = buf_ptr->nbytes();
+		msgs[ndgram].msg_hdr.msg_iov = &iovs[ndgram];
+		msgs[ndgram].msg_hdr.msg_iovlen = 1;
+		msgs[ndgram].msg_hdr.msg_name = &addr;
+		msgs[ndgram].msg_hdr.msg_namelen = sizeof(addr);
+	}
+
+	int nsent = ::sendmmsg(socket.native_handle(), msgs, ndgram, MSG_DONTWAIT);
+	if (nsent < 0) {
+		if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR || errno == ENETUNREACH) {
+			if (errno == ENETUNREACH)
+				CONSOLE_BRIDGE_logWarn(PFXd "sendmmsg: %s, retrying", conn_id, ::strerror(errno));
+
+			// socket buffer full (or transient error): retry on writability
+			auto sthis = shared_from_this();
+			socket.async_send(
+					boost::asio::null_buffers(),
+					strand.wrap([sthis] (error_code error, size_t /*bytes_transferred*/) {
+						if (error) {
+							CONSOLE_BRIDGE_logError(PFXd "sendto: %s", sthis->conn_id, error.message().c_str());
+							sthis->close();
+							return;
+						}
+
+						sthis->do_sendmmsg();
+					}));
+			return;
+		}
+
+		CONSOLE_BRIDGE_logError(PFXd "sendmmsg: %s", conn_id, ::strerror(errno));
+		close();
+		return;
+	}
+
+	size_t bytes = 0;
+	for (int i = 0; i < nsent; i++) {
+		bytes += iovs[i].iov_len;
+		tx_band->pop_front();
+	}
+
+	iostat_tx_add(bytes);
+	update_backpressure(tx_q.size());
+	do_sendto(false);
 }
+#endif
 }	// namespace mavconn
@@ -0,0 +1,217 @@
+/**
+ * Microbenchmarks for mavconn library
+ *
+ * Build only when google-benchmark is installed (see CMakeLists.txt).
+ * Run with --benchmark_min_time=1 for stable numbers; loopback cases
+ * need free UDP/TCP ports 45020/57620 on localhost.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <condition_variable>
+
+#include <mavconn/interface.h>
+#include <mavconn/msgbuffer.h>
+#include <mavconn/msgbuffer_ring.h>
+#include <mavconn/udp.h>
+#include <mavconn/tcp.h>
+
+using namespace mavconn;
+using mavlink::mavlink_message_t;
+
+static mavlink::common::msg::HEARTBEAT make_heartbeat()
+{
+	using mavlink::common::MAV_TYPE;
+	using mavlink::common::MAV_AUTOPILOT;
+	using mavlink::common::MAV_MODE;
+	using mavlink::common::MAV_STATE;
+
+	mavlink::common::msg::HEARTBEAT hb;
+	hb.type = int(MAV_TYPE::ONBOARD_CONTROLLER);
+	hb.autopilot = int(MAV_AUTOPILOT::INVALID);
+	hb.base_mode = int(MAV_MODE::MANUAL_ARMED);
+	hb.custom_mode = 0;
+	hb.system_status = int(MAV_STATE::ACTIVE);
+
+	return hb;
+}
+
+static mavlink::common::msg::ATTITUDE make_attitude()
+{
+	mavlink::common::msg::ATTITUDE att;
+	att.time_boot_ms = 123456;
+	att.roll = 0.1f;
+	att.pitch = -0.2f;
+	att.yaw = 1.5f;
+	att.rollspeed = 0.01f;
+	att.pitchspeed = 0.02f;
+	att.yawspeed = -0.03f;
+
+	return att;
+}
+
+/* -*- serialize + finalize cost per message type -*- */
+
+template <typename MsgT>
+static void serialize_message(benchmark::State &state, const MsgT &obj)
+{
+	mavlink::mavlink_status_t status {};
+
+	while (state.KeepRunning()) {
+		MsgBuffer buf(obj, &status, 1, 1);
+		benchmark::DoNotOptimize(buf.dpos());
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_serialize_heartbeat(benchmark::State &state)
+{
+	serialize_message(state, make_heartbeat());
+}
+BENCHMARK(BM_serialize_heartbeat);
+
+static void BM_serialize_attitude(benchmark::State &state)
+{
+	serialize_message(state, make_attitude());
+}
+BENCHMARK(BM_serialize_attitude);
+
+static void BM_msg_to_send_buffer(benchmark::State &state)
+{
+	mavlink::mavlink_status_t status {};
+	mavlink_message_t msg;
+	mavlink::MsgMap map(msg);
+
+	auto obj = make_attitude();
+	auto mi = obj.get_message_info();
+	obj.serialize(map);
+	mavlink::mavlink_finalize_message_buffer(&msg, 1, 1, &status, mi.min_length, mi.length, mi.crc_extra);
+
+	while (state.KeepRunning()) {
+		MsgBuffer buf(&msg);
+		benchmark::DoNotOptimize(buf.dpos());
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_msg_to_send_buffer);
+
+/* -*- TX enqueue latency under producer contention -*- */
+
+static void BM_txq_emplace_contended(benchmark::State &state)
+{
+	static MsgBufferPrioRing *ring;
+	static mavlink_message_t msg;
+
+	if (state.thread_index == 0) {
+		ring = new MsgBufferPrioRing();
+
+		mavlink::mavlink_status_t status {};
+		mavlink::MsgMap map(msg);
+		auto obj = make_heartbeat();
+		auto mi = obj.get_message_info();
+		obj.serialize(map);
+		mavlink::mavlink_finalize_message_buffer(&msg, 1, 1, &status, mi.min_length, mi.length, mi.crc_extra);
+	}
+
+	while (state.KeepRunning()) {
+		if (state.thread_index == 0) {
+			// thread 0 plays the io thread: drain whatever queued up
+			auto *band = ring->active_band();
+			if (band != nullptr)
+				band->pop_front();
+		}
+		else {
+			while (!ring->emplace(TxPrio::NORMAL, &msg))
+				std::this_thread::yield();
+		}
+	}
+
+	if (state.thread_index == 0) {
+		state.SetItemsProcessed(state.iterations() * (state.threads - 1));
+		delete ring;
+		ring = nullptr;
+	}
+}
+BENCHMARK(BM_txq_emplace_contended)->ThreadRange(2, 8)->UseRealTime();
+
+/* -*- transport loopback round-trip -*- */
+
+class Loopback {
+public:
+	std::mutex mutex;
+	std::condition_variable cond;
+	std::atomic<size_t> received {0};
+
+	void recv_message(const mavlink_message_t *message, const Framing framing)
+	{
+		(void)message;
+		if (framing == Framing::ok) {
+			received++;
+			cond.notify_one();
+		}
+	}
+
+	bool wait_received(size_t count)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		return cond.wait_for(lock, std::chrono::seconds(2),
+				[&] { return received >= count; });
+	}
+};
+
+static void transport_loopback(benchmark::State &state,
+		MAVConnInterface::Ptr server, MAVConnInterface::Ptr client, Loopback &lb)
+{
+	auto hb = make_heartbeat();
+
+	// prime the UDP remote endpoint
+	client->send_message(hb);
+	server->send_message(hb);
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+	while (state.KeepRunning()) {
+		size_t expect = lb.received + 1;
+		client->send_message(hb);
+		if (!lb.wait_received(expect)) {
+			state.SkipWithError("loopback receive timeout");
+			break;
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_udp_loopback(benchmark::State &state)
+{
+	Loopback lb;
+
+	auto server = std::make_shared<MAVConnUDP>(42, 200, "localhost", 45020);
+	auto client = std::make_shared<MAVConnUDP>(44, 200, "localhost", 45021, "localhost", 45020);
+
+	server->message_received_cb = std::bind(&Loopback::recv_message, &lb,
+			std::placeholders::_1, std::placeholders::_2);
+
+	transport_loopback(state, server, client, lb);
+}
+BENCHMARK(BM_udp_loopback)->UseRealTime();
+
+static void BM_tcp_loopback(benchmark::State &state)
+{
+	Loopback lb;
+
+	auto server = std::make_shared<MAVConnTCPServer>(42, 200, "localhost", 57620);
+	auto client = std::make_shared<MAVConnTCPClient>(44, 200, "localhost", 57620);
+
+	server->message_received_cb = std::bind(&Loopback::recv_message, &lb,
+			std::placeholders::_1, std::placeholders::_2);
+
+	transport_loopback(state, server, client, lb);
+}
+BENCHMARK(BM_tcp_loopback)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,102 @@
+/**
+ * @brief Per-thread scratch arena
+ * @file arena.h
+ * @author Vladimir Ermakov <vooon341@gmail.com>
+ *
+ * @addtogroup nodelib
+ * @{
+ */
+/*
+ * Copyright 2014,2015,2016 Vladimir Ermakov.
+ *
+ * This file is part of the mavros package and subject to the license terms
+ * in the top-level LICENSE file of the mavros repository.
+ * https://github.com/mavlink/mavros/tree/master/LICENSE.md
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+namespace mavros {
+/**
+ * @brief Per-thread bump allocator for short-lived decode scratch
+ *
+ * The router decodes each arriving message into an object that lives
+ * only for the handler fan-out of that one message. A heap round-trip
+ * per message is pure overhead for that pattern, so thread_instance()
+ * hands out storage from a thread-local block instead.
+ *
+ * Frees are expected in LIFO order (latest allocation destroyed first):
+ * the block offset then rewinds and the arena never grows. Allocations
+ * that do not fit fall back to the heap, so misuse degrades to the old
+ * behavior instead of failing. Allocation and free must happen on the
+ * same thread.
+ */
+class ScratchArena {
+public:
+	static constexpr size_t BLOCK_SIZE = 16 * 1024;
+
+	static ScratchArena &thread_instance()
+	{
+		static thread_local ScratchArena arena;
+		return arena;
+	}
+
+	void *allocate(size_t size, size_t align)
+	{
+		size_t at = (used + align - 1) & ~(align - 1);
+		if (at + size > BLOCK_SIZE)
+			return ::operator new(size);
+
+		last = at;
+		used = at + size;
+		return block + at;
+	}
+
+	//! LIFO free: rewinds the block when @a p is the latest allocation
+	void deallocate(void *p)
+	{
+		auto *b = static_cast<uint8_t *>(p);
+		if (b < block || b >= block + BLOCK_SIZE) {
+			::operator delete(p);
+			return;
+		}
+
+		if (size_t(b - block) == last)
+			used = last;
+		// out-of-order frees park block space until the next rewind;
+		// the worst case is the heap fallback above, not a failure
+	}
+
+	template<class T, class... Args>
+	T *create(Args&&... args)
+	{
+		return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+	}
+
+	template<class T>
+	void destroy(T *p)
+	{
+		p->~T();
+		deallocate(p);
+	}
+
+	//! unique_ptr deleter returning the object to its thread's arena
+	struct Deleter {
+		template<class T>
+		void operator()(T *p) const
+		{
+			thread_instance().destroy(p);
+		}
+	};
+
+private:
+	alignas(alignof(std::max_align_t)) uint8_t block[BLOCK_SIZE];
+	size_t used = 0;
+	size_t last = 0;
+};
+}	// namespace mavros
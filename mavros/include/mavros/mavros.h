@@ -18,11 +18,19 @@
 #pragma once
 
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <ros/ros.h>
 #include <pluginlib/class_loader.h>
 #include <mavconn/interface.h>
 #include <mavros/mavros_plugin.h>
 #include <mavros/mavlink_diag.h>
+#include <mavros/rx_queue.h>
+#include <mavros/telemetry_recorder.h>
 #include <mavros/utils.h>
 
 namespace mavros {
@@ -35,48 +43,187 @@ class MavRos
 {
 public:
 	MavRos();
-	~MavRos() {};
+	~MavRos();
 
 	void spin();
 
 private:
-	ros::NodeHandle mavlink_nh;
-	// fcu_link stored in mav_uas
+	// fcu_link stored in each vehicle's UAS
 	mavconn::MAVConnInterface::Ptr gcs_link;
 	bool gcs_quiet_mode;
+	//! defer plugin initialize() to the first matching message
+	bool lazy_init_plugins;
 	ros::Time last_message_received_from_gcs;
 	ros::Duration conn_timeout;
 
-	ros::Publisher mavlink_pub;
-	ros::Subscriber mavlink_sub;
-
 	diagnostic_updater::Updater gcs_diag_updater;
 	MavlinkDiag fcu_link_diag;
 	MavlinkDiag gcs_link_diag;
 
+	//! shared by all vehicles: the plugin .so are mapped once per process
 	pluginlib::ClassLoader<plugin::PluginBase> plugin_loader;
-	std::vector<plugin::PluginBase::Ptr> loaded_plugins;
 
-	//! FCU link -> router -> plugin handler
-	std::unordered_map<mavlink::msgid_t, plugin::PluginBase::Subscriptions> plugin_subscriptions;
+	/**
+	 * Serializes createInstance() and the subscription-map merge when
+	 * plugins initialize on the ~startup/init_threads pool. Constructors
+	 * are cheap by contract, so holding it across createInstance costs
+	 * little; initialize() runs outside it, in parallel.
+	 */
+	std::mutex plugin_setup_mutex;
+
+	//! per-handler dispatch timing; rx_thread writes, diag thread reads
+	struct HandlerStat {
+		std::atomic<uint64_t> ns_total;
+		std::atomic<uint32_t> count;
+
+		// diag-thread shadow for rate computation
+		uint64_t prev_ns_total;
+		uint32_t prev_count;
+
+		HandlerStat() :
+			ns_total(0), count(0),
+			prev_ns_total(0), prev_count(0)
+		{ }
+	};
+
+	struct DispatchEntry {
+		mavlink::msgid_t msgid;
+		const plugin::PluginBase::Subscriptions *subs;
+		std::unique_ptr<HandlerStat[]> stats;	//!< one cell per handler
+
+		/**
+		 * Token-bucket governor, ~rate_limit/msgids (0 = off).
+		 * Bucket state lives in the flat dispatch entry the router
+		 * already found, so the governed fast path adds one clock
+		 * read and two integer ops. rx_thread only, except the
+		 * dropped counter which the diag thread reads.
+		 */
+		int64_t min_interval_ns = 0;
+		int64_t bucket_ns = 0;
+		std::chrono::steady_clock::time_point last_refill;
+		std::atomic<uint64_t> governor_dropped {0};
+
+		DispatchEntry() = default;
+		//! moves happen only while the table is built, before RX starts
+		DispatchEntry(DispatchEntry &&other) :
+			msgid(other.msgid),
+			subs(other.subs),
+			stats(std::move(other.stats)),
+			min_interval_ns(other.min_interval_ns),
+			bucket_ns(other.bucket_ns),
+			last_refill(other.last_refill),
+			governor_dropped(other.governor_dropped.load())
+		{ }
+
+		DispatchEntry &operator=(DispatchEntry &&other)
+		{
+			msgid = other.msgid;
+			subs = other.subs;
+			stats = std::move(other.stats);
+			min_interval_ns = other.min_interval_ns;
+			bucket_ns = other.bucket_ns;
+			last_refill = other.last_refill;
+			governor_dropped.store(other.governor_dropped.load());
+			return *this;
+		}
+	};
+
+	/**
+	 * @brief Per-vehicle hosting unit: one UAS, one plugin set, one
+	 *        dispatch table, one mavlink ROS bridge
+	 *
+	 * The primary vehicle (vehicles[0]) keeps the classic namespace
+	 * layout; additional ones prefix plugin and bridge topics with
+	 * "uasN/". The FCU link, io reactor, rx thread, spinner pools and
+	 * plugin class loader stay shared.
+	 */
+	struct Vehicle {
+		//! plugin namespace prefix, "" on the primary vehicle
+		std::string ns;
+		ros::NodeHandle mavlink_nh;
+
+		ros::Publisher mavlink_pub;
+		ros::Subscriber mavlink_sub;
+
+		//! recycled messages for the mavlink/from republish path (rx_thread only)
+		std::array<boost::shared_ptr<mavros_msgs::Mavlink>, 32> mavlink_pub_pool;
+
+		std::vector<plugin::PluginBase::Ptr> loaded_plugins;
+
+		//! FCU link -> router -> plugin handler (build-time container)
+		std::unordered_map<mavlink::msgid_t, plugin::PluginBase::Subscriptions> plugin_subscriptions;
+
+		//! msgid-sorted view of plugin_subscriptions, frozen after plugin loading
+		std::vector<DispatchEntry> plugin_dispatch;
 
-	//! UAS object passed to all plugins
-	UAS mav_uas;
+		ros::Time profile_last_update;
+
+		//! UAS object passed to this vehicle's plugins
+		UAS uas;
+
+		explicit Vehicle(const std::string &ns_) :
+			ns(ns_),
+			mavlink_nh(ns_ + "mavlink")	// allow to namespace it
+		{ }
+	};
+
+	//! hosted vehicles; [0] is the primary and owns the global bridges
+	std::vector<std::unique_ptr<Vehicle>> vehicles;
+
+	//! sysid -> vehicle demultiplexer; unknown ids fall back to the primary
+	std::array<Vehicle *, 256> sysid_route;
+
+	//! dispatch timing toggle, ~plugin_profiling (runtime changeable)
+	std::atomic<bool> plugin_profiling;
+
+	//! token-bucket depth of the msgid governor, ~rate_limit/burst
+	int governor_burst;
+
+	//! refresh period of the coarse RX clock, in messages
+	static constexpr size_t RX_CLOCK_REFRESH = 32;
+
+	//! coarse receive-path clock, see rx_worker(); rx_thread only
+	ros::Time rx_now;
+
+	//! raw byte stream recorder, ~record/path (optional)
+	std::unique_ptr<TelemetryRecorder> recorder;
+
+	//! FCU RX handoff: io thread enqueues, rx_thread runs publish and plugin handlers
+	RxQueue rx_queue;
+	std::thread rx_thread;
+	std::mutex rx_mutex;
+	std::condition_variable rx_cv;
+	std::atomic<bool> rx_sleeping;
+	std::atomic<bool> rx_should_exit;
+
+	//! fcu link -> rx_queue (io thread side)
+	void fcu_message_cb(const mavlink::mavlink_message_t *mmsg, const mavconn::Framing framing);
+	//! rx_queue consumer loop
+	void rx_worker();
 
 	//! fcu link -> ros
-	void mavlink_pub_cb(const mavlink::mavlink_message_t *mmsg, const mavconn::Framing framing);
-	//! ros -> fcu link
+	void mavlink_pub_cb(Vehicle &veh, const mavlink::mavlink_message_t *mmsg, const mavconn::Framing framing);
+	//! ros -> fcu link (shared by all vehicle bridges, frame carries sysid)
 	void mavlink_sub_cb(const mavros_msgs::Mavlink::ConstPtr &rmsg);
 
 	//! message router
-	void plugin_route_cb(const mavlink::mavlink_message_t *mmsg, const mavconn::Framing framing);
+	void plugin_route_cb(Vehicle &veh, const mavlink::mavlink_message_t *mmsg, const mavconn::Framing framing);
+
+	//! create plugin set, bridge and diag of one hosted vehicle
+	void setup_vehicle(Vehicle &veh, ros::V_string &blacklist, ros::V_string &whitelist);
 
 	//! load plugin
-	void add_plugin(std::string &pl_name, ros::V_string &blacklist, ros::V_string &whitelist);
+	void add_plugin(Vehicle &veh, std::string &pl_name, ros::V_string &blacklist, ros::V_string &whitelist);
+
+	//! freeze plugin_subscriptions into plugin_dispatch; call once after loading
+	void build_dispatch_table(Vehicle &veh);
+
+	//! diag task: per-handler time-per-message and message rate
+	void dispatch_diag_run(Vehicle &veh, diagnostic_updater::DiagnosticStatusWrapper &stat);
 
 	//! start mavlink app on USB
 	void startup_px4_usb_quirk();
-	void log_connect_change(bool connected);
+	void log_connect_change(Vehicle &veh, bool connected);
 };
 }	// namespace mavros
 
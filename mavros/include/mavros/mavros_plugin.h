@@ -17,11 +17,13 @@
 
 #pragma once
 
+#include <memory>
 #include <tuple>
 #include <vector>
 #include <functional>
 #include <diagnostic_updater/diagnostic_updater.h>
 #include <mavconn/interface.h>
+#include <mavros/arena.h>
 #include <mavros/mavros_uas.h>
 
 namespace mavros {
@@ -30,6 +32,25 @@ using mavros::UAS;
 typedef std::lock_guard<std::recursive_mutex> lock_guard;
 typedef std::unique_lock<std::recursive_mutex> unique_lock;
 
+/**
+ * @brief Type-erased holder for a decoded MAVLink message.
+ *
+ * Lets the router deserialize each arriving msgid once and hand the
+ * same object to every subscribed handler (add_plugin() verifies that
+ * all typed handlers of a msgid agree on the decoded type).
+ */
+struct DecodedMsg {
+	virtual ~DecodedMsg() {}
+};
+
+template<class _T>
+struct DecodedMsgT : DecodedMsg {
+	_T obj;
+};
+
+//! decoded object on the decoding thread's scratch arena, freed after the fan-out
+using DecodedMsgPtr = std::unique_ptr<DecodedMsg, ScratchArena::Deleter>;
+
 /**
  * @brief MAVROS Plugin base class
  */
@@ -38,11 +59,21 @@ class PluginBase
 private:
 	PluginBase(const PluginBase&) = delete;
 
+	//! vehicle ns applied to plugins constructed next, see set_vehicle_ns()
+	static std::string &vehicle_ns() {
+		static std::string ns;
+		return ns;
+	}
+
 public:
 	//! generic message handler callback
 	using HandlerCb = mavconn::MAVConnInterface::ReceivedCb;
-	//! Tuple: MSG ID, MSG NAME, message type into hash_code, message handler callback
-	using HandlerInfo = std::tuple<mavlink::msgid_t, const char*, size_t, HandlerCb>;
+	//! deserializes a message once for all typed handlers of a msgid
+	using DecodeCb = std::function<DecodedMsgPtr(const mavlink::mavlink_message_t *msg)>;
+	//! handler receiving the shared decoded object
+	using TypedCb = std::function<void(const mavlink::mavlink_message_t *msg, DecodedMsg &decoded)>;
+	//! Tuple: MSG ID, MSG NAME, message type hash_code, raw handler, decoder, typed handler
+	using HandlerInfo = std::tuple<mavlink::msgid_t, const char*, size_t, HandlerCb, DecodeCb, TypedCb>;
 	//! Subscriptions vector
 	using Subscriptions = std::vector<HandlerInfo>;
 
@@ -52,6 +83,18 @@ public:
 
 	virtual ~PluginBase() {};
 
+	/**
+	 * @brief Select the vehicle namespace for subsequently constructed plugins
+	 *
+	 * MavRos calls this before creating each vehicle's plugin set when
+	 * several UAS are hosted in one node. Empty (the default) keeps the
+	 * classic single-vehicle topic layout, "uasN/" prefixes every
+	 * plugin namespace of vehicle N.
+	 */
+	static void set_vehicle_ns(const std::string &ns) {
+		vehicle_ns() = ns;
+	}
+
 	/**
 	 * @brief Plugin initializer
 	 *
@@ -71,9 +114,23 @@ protected:
 	 * @brief Plugin constructor
 	 * Should not do anything before initialize()
 	 */
-	PluginBase() : m_uas(nullptr) {};
+	PluginBase() : m_uas(nullptr), m_vehicle_ns(vehicle_ns()) {};
 
 	UAS *m_uas;
+	//! plugin namespace prefix of the owning vehicle ("" or "uasN/")
+	std::string m_vehicle_ns;
+
+	/**
+	 * @brief Resolve this plugin's private namespace on its vehicle
+	 *
+	 * Returns "~<name>" on the primary vehicle, "~uasN/<name>" on
+	 * additional hosted ones. Plugins must build every NodeHandle
+	 * (including ad-hoc ones for cross-plugin service calls) through
+	 * this helper.
+	 */
+	std::string plugin_ns(const char *name) const {
+		return "~" + m_vehicle_ns + name;
+	}
 
 	// TODO: filtered handlers
 
@@ -88,7 +145,7 @@ protected:
 		auto bfn = std::bind(fn, static_cast<_C*>(this), std::placeholders::_1, std::placeholders::_2);
 		const auto type_hash_ = typeid(mavlink::mavlink_message_t).hash_code();
 
-		return HandlerInfo{ id, nullptr, type_hash_, bfn };
+		return HandlerInfo{ id, nullptr, type_hash_, bfn, DecodeCb(), TypedCb() };
 	}
 
 	/**
@@ -105,6 +162,7 @@ protected:
 
 		return HandlerInfo{
 			       id, name, type_hash_,
+			       // self-decoding fallback, used when the router can not share a decode
 			       [bfn](const mavlink::mavlink_message_t *msg, const mavconn::Framing framing) {
 				       if (framing != mavconn::Framing::ok)
 					       return;
@@ -114,6 +172,17 @@ protected:
 				       obj.deserialize(map);
 
 				       bfn(msg, obj);
+			       },
+			       [](const mavlink::mavlink_message_t *msg) -> DecodedMsgPtr {
+				       // scratch from the decoding thread's arena,
+				       // returned when the fan-out drops the pointer
+				       auto *d = ScratchArena::thread_instance().create<DecodedMsgT<_T>>();
+				       mavlink::MsgMap map(msg);
+				       d->obj.deserialize(map);
+				       return DecodedMsgPtr(d);
+			       },
+			       [bfn](const mavlink::mavlink_message_t *msg, DecodedMsg &decoded) {
+				       bfn(msg, static_cast<DecodedMsgT<_T> &>(decoded).obj);
 			       }
 		};
 	}
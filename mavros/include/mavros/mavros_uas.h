@@ -18,9 +18,16 @@
 #pragma once
 
 #include <array>
+#include <condition_variable>
+#include <deque>
+#include <memory>
 #include <mutex>
 #include <atomic>
+#include <thread>
+#include <vector>
+#include <functional>
 #include <type_traits>
+#include <ros/callback_queue.h>
 #include <eigen_conversions/eigen_msg.h>
 #include <tf2_ros/transform_listener.h>
 #include <tf2_ros/transform_broadcaster.h>
@@ -28,9 +35,11 @@
 #include <diagnostic_updater/diagnostic_updater.h>
 #include <mavconn/interface.h>
 #include <mavros/utils.h>
+#include <mavros/external_pose.h>
 #include <mavros/frame_tf.h>
 
 #include <GeographicLib/Geoid.hpp>
+#include <mavros/geoid_mmap.h>
 
 #include <sensor_msgs/Imu.h>
 #include <sensor_msgs/NavSatFix.h>
@@ -81,7 +90,7 @@ public:
 	using unique_lock = std::unique_lock<std::recursive_mutex>;
 
 	UAS();
-	~UAS() {};
+	~UAS();
 
 	/**
 	 * @brief MAVLink FCU device conection
@@ -93,6 +102,52 @@ public:
 	 */
 	diagnostic_updater::Updater diag_updater;
 
+	/**
+	 * @brief Arbitration between this vehicle's external pose sources
+	 *
+	 * Owned per UAS: a process-wide arbiter would let one hosted
+	 * vehicle's source permanently suppress another vehicle's.
+	 */
+	external_pose::Arbiter ep_arbiter;
+
+	/* -*- callback service classes -*- */
+
+	/**
+	 * @brief Plugin callback service classes
+	 *
+	 * Each class is served by its own spinner pool (see MavRos::spin()),
+	 * so a long-running BULK service call (FTP, mission transfer) can
+	 * not occupy the threads feeding REALTIME setpoint subscribers.
+	 */
+	enum class CbQueue {
+		REALTIME,	//!< control path: setpoints, actuator commands
+		NORMAL,		//!< default, the global ROS callback queue
+		BULK		//!< long transfers: ftp, param, waypoint
+	};
+
+	//! REALTIME class queue, spun by dedicated threads
+	ros::CallbackQueue realtime_cb_queue;
+	//! BULK class queue, spun by dedicated threads
+	ros::CallbackQueue bulk_cb_queue;
+
+	/**
+	 * @brief Route a node handle's callbacks to the given service class
+	 *
+	 * Plugins call this at the top of initialize(), before creating
+	 * subscriptions and services. NORMAL leaves the handle on the
+	 * global queue.
+	 */
+	void set_cb_queue(ros::NodeHandle &nh, CbQueue q);
+
+	/**
+	 * @brief Serve this UAS' plugin callbacks from another UAS' queues
+	 *
+	 * Additional vehicles hosted in the same node share the primary
+	 * vehicle's spinner pools instead of multiplying them; must be
+	 * called before the plugin set is initialized.
+	 */
+	void share_cb_queues(UAS &primary);
+
 	/**
 	 * @brief Return connection status
 	 */
@@ -238,9 +293,11 @@ public:
 	/**
 	 * @brief Geoid dataset used to convert between AMSL and WGS-84
 	 *
-	 * That class loads egm96_5 dataset to RAM, it is about 24 MiB.
+	 * The egm96-5 dataset (~24 MiB) is memory-mapped read-only, so
+	 * concurrent mavros instances share one page cache copy and
+	 * startup does not parse it into private heap.
 	 */
-	std::shared_ptr<GeographicLib::Geoid> egm96_5;
+	std::shared_ptr<GeoidMmap> egm96_5;
 
 	/**
 	 * @brief Conversion from height above geoid (AMSL)
@@ -294,14 +351,49 @@ public:
 	 */
 	void publish_static_transform(const std::string &frame_id, const std::string &child_id, const Eigen::Affine3d &tr);
 
+	//! Transform watch callback, see @a add_tf_watch()
+	using TfWatchCb = std::function<void(const geometry_msgs::TransformStamped &)>;
+
+	/**
+	 * @brief Register a periodic transform watch.
+	 *
+	 * All watches are multiplexed on one shared thread instead of a
+	 * polling thread per plugin. The callback fires at most at @a rate,
+	 * and only when the transform differs from the previously
+	 * delivered one (dirty check), so unchanged transforms cost
+	 * nothing downstream.
+	 *
+	 * @param frame_id        target frame
+	 * @param child_frame_id  source frame
+	 * @param rate            polling rate [Hz]
+	 * @param cb              called with the new transform
+	 */
+	void add_tf_watch(const std::string &frame_id, const std::string &child_frame_id,
+			double rate, TfWatchCb cb);
+
 	/* -*- time sync -*- */
 
+	//! Drift-corrected timesync estimate, published through @a tsync_seq
+	struct TimesyncState {
+		int64_t offset_ns;	//!< local time = remote time + offset, at @a ref_remote_ns
+		double skew;		//!< offset drift [ns per ns of remote time]
+		uint64_t ref_remote_ns;	//!< remote timestamp the estimate refers to
+	};
+
+	/**
+	 * @brief Publish new timesync estimate (called by sys_time plugin filter)
+	 */
+	void set_timesync_state(int64_t offset_ns, double skew, uint64_t ref_remote_ns);
+
+	//! Returns a consistent snapshot of the timesync estimate
+	TimesyncState get_timesync_state();
+
 	inline void set_time_offset(uint64_t offset_ns) {
-		time_offset = offset_ns;
+		set_timesync_state(offset_ns, 0.0, 0);
 	}
 
 	inline uint64_t get_time_offset(void) {
-		return time_offset;
+		return get_timesync_state().offset_ns;
 	}
 
 	inline void set_timesync_mode(timesync_mode mode) {
@@ -355,7 +447,7 @@ public:
 	/**
 	 * @brief Compute FCU message time from time_boot_ms or time_usec field
 	 *
-	 * Uses time_offset for calculation
+	 * Uses the timesync state (offset + skew extrapolation) for calculation
 	 *
 	 * @return FCU time if it is known else current wall time.
 	 */
@@ -447,6 +539,10 @@ public:
 private:
 	std::recursive_mutex mutex;
 
+	//! cb queue routing targets; point at another UAS' queues when shared
+	ros::CallbackQueue *realtime_q;
+	ros::CallbackQueue *bulk_q;
+
 	std::atomic<uint8_t> type;
 	std::atomic<uint8_t> autopilot;
 	std::atomic<uint8_t> base_mode;
@@ -455,19 +551,78 @@ private:
 	uint8_t target_component;
 
 	std::atomic<bool> connected;
-	std::vector<ConnectionCb> connection_cb_vec;
-	std::vector<CapabilitiesCb> capabilities_cb_vec;
 
+	// Change handler lists are copy-on-write: registration swaps in a
+	// fresh immutable vector, the notifier snapshots it with one atomic
+	// load. The handlers themselves run on notifier_thread, never on
+	// the RX path, so a slow callback (some re-read parameters) can not
+	// stall message processing; see notifier_worker().
+	std::shared_ptr<const std::vector<ConnectionCb>> connection_cb_list;
+	std::shared_ptr<const std::vector<CapabilitiesCb>> capabilities_cb_list;
+
+	//! one queued connection or capability change, see notifier_worker()
+	struct ChangeEvent {
+		enum class Kind {
+			CONNECTION,
+			CAPABILITIES
+		};
+
+		Kind kind;
+		bool connected;
+		uint64_t capabilities;
+	};
+
+	//! change fanout: RX path enqueues, notifier_thread delivers in order
+	std::deque<ChangeEvent> notify_queue;
+	std::mutex notify_mutex;
+	std::condition_variable notify_cv;
+	std::thread notifier_thread;
+	std::atomic<bool> notifier_should_exit;
+
+	void push_change_event(const ChangeEvent &ev);
+	void notifier_worker();
+
+	// Message snapshots are swapped RCU-style with boost::atomic_load /
+	// atomic_store: writers publish a fresh immutable message, readers
+	// grab a reference without ever touching the mutex.
 	sensor_msgs::Imu::Ptr imu_enu_data;
 	sensor_msgs::Imu::Ptr imu_ned_data;
-
 	sensor_msgs::NavSatFix::Ptr gps_fix;
-	float gps_eph;
-	float gps_epv;
-	int gps_fix_type;
-	int gps_satellites_visible;
 
-	std::atomic<uint64_t> time_offset;
+	//! GPS precision snapshot, published through @a gps_epts_seq
+	struct GpsEpts {
+		float eph;
+		float epv;
+		int fix_type;
+		int satellites_visible;
+	};
+
+	//! seqlock counter for gps_epts: even — stable, odd — update in flight
+	std::atomic<uint32_t> gps_epts_seq;
+	GpsEpts gps_epts;
+
+	//! One registered transform watch, owned by @a tf_watch_thread
+	struct TfWatch {
+		std::string frame_id;
+		std::string child_frame_id;
+		ros::Duration period;
+		ros::Time next_run;
+		TfWatchCb cb;
+		geometry_msgs::TransformStamped last;
+		bool have_last;
+	};
+
+	//! shared TF watch scheduler, see add_tf_watch()
+	std::vector<TfWatch> tf_watches;
+	std::mutex tf_watch_mutex;
+	std::thread tf_watch_thread;
+	std::atomic<bool> tf_watch_should_exit;
+
+	void tf_watch_worker();
+
+	//! seqlock counter for tsync_state: even — stable, odd — update in flight
+	std::atomic<uint32_t> tsync_seq;
+	TimesyncState tsync_state;
 	timesync_mode tsync_mode;
 
 	std::atomic<bool> fcu_caps_known;
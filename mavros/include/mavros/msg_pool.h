@@ -0,0 +1,62 @@
+/**
+ * @brief Preallocated ROS message pool
+ * @file msg_pool.h
+ * @author Vladimir Ermakov <vooon341@gmail.com>
+ *
+ * @addtogroup nodelib
+ * @{
+ */
+/*
+ * Copyright 2014,2015,2016 Vladimir Ermakov.
+ *
+ * This file is part of the mavros package and subject to the license terms
+ * in the top-level LICENSE file of the mavros repository.
+ * https://github.com/mavlink/mavros/tree/master/LICENSE.md
+ */
+
+#pragma once
+
+#include <array>
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+
+namespace mavros {
+/**
+ * @brief Fixed pool of preallocated messages for high-rate publishers
+ *
+ * Publishing a shared_ptr hands the same object to intra-process
+ * subscribers (nocopy), so a message may only be refilled after every
+ * holder dropped its reference. acquire() returns a pooled message the
+ * pool is the sole owner of, or falls back to a fresh allocation when
+ * slow subscribers still hold all of them — so the pool is always safe,
+ * merely allocation-free in the steady state.
+ *
+ * A reused message keeps its previous contents: callers must assign
+ * every field they publish. acquire() is meant to be called from the
+ * one thread that owns the publisher (the rx dispatch thread);
+ * subscribers may drop their references from any thread.
+ */
+template <typename MsgT, size_t PoolSize = 8>
+class MessagePool {
+public:
+	MessagePool()
+	{
+		for (auto &m : pool)
+			m = boost::make_shared<MsgT>();
+	}
+
+	//! @return a message not referenced outside the pool
+	boost::shared_ptr<MsgT> acquire()
+	{
+		for (auto &m : pool) {
+			if (m.unique())
+				return m;
+		}
+
+		return boost::make_shared<MsgT>();
+	}
+
+private:
+	std::array<boost::shared_ptr<MsgT>, PoolSize> pool;
+};
+}	// namespace mavros
@@ -0,0 +1,51 @@
+/**
+ * @brief Plugin registration macro
+ * @file plugin_register.h
+ * @author Vladimir Ermakov <vooon341@gmail.com>
+ *
+ * @addtogroup plugin
+ * @{
+ */
+/*
+ * Copyright 2014,2015,2016 Vladimir Ermakov.
+ *
+ * This file is part of the mavros package and subject to the license terms
+ * in the top-level LICENSE file of the mavros repository.
+ * https://github.com/mavlink/mavros/tree/master/LICENSE.md
+ */
+
+#pragma once
+
+/**
+ * MAVROS_PLUGIN_REGISTER(name, klass) replaces the raw
+ * PLUGINLIB_EXPORT_CLASS() in plugin translation units. By default it
+ * expands to exactly that; when the TU is compiled with
+ * -DMAVROS_STATIC_PLUGINS it instead drops a factory into the
+ * link-time PluginRegistry, allowing the same source file to be
+ * linked straight into the node executable.
+ *
+ * @a name must match the class name= attribute of the pluginlib XML.
+ */
+
+#ifdef MAVROS_STATIC_PLUGINS
+
+#include <boost/make_shared.hpp>
+#include <mavros/plugin_registry.h>
+
+#define MAVROS_PLUGIN_REGISTER(name, klass)			\
+	static mavros::plugin::PluginBase::Ptr			\
+	mavros_plugin_factory()					\
+	{							\
+		return boost::make_shared<klass>();		\
+	}							\
+	static mavros::plugin::RegisterPlugin			\
+	mavros_plugin_registrator(name, &mavros_plugin_factory);
+
+#else	// !MAVROS_STATIC_PLUGINS
+
+#include <pluginlib/class_list_macros.h>
+
+#define MAVROS_PLUGIN_REGISTER(name, klass)			\
+	PLUGINLIB_EXPORT_CLASS(klass, mavros::plugin::PluginBase)
+
+#endif
@@ -0,0 +1,88 @@
+/**
+ * @brief Static plugin registry
+ * @file plugin_registry.h
+ * @author Vladimir Ermakov <vooon341@gmail.com>
+ *
+ * @addtogroup plugin
+ * @{
+ */
+/*
+ * Copyright 2014,2015,2016 Vladimir Ermakov.
+ *
+ * This file is part of the mavros package and subject to the license terms
+ * in the top-level LICENSE file of the mavros repository.
+ * https://github.com/mavlink/mavros/tree/master/LICENSE.md
+ */
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+#include <mavros/mavros_plugin.h>
+
+namespace mavros {
+namespace plugin {
+/**
+ * @brief Compile-time plugin registry
+ *
+ * Alternative to pluginlib for fixed images: plugins built with
+ * -DMAVROS_STATIC_PLUGINS register a factory here from a static
+ * initializer and are linked into the node executable directly, so
+ * startup skips dlopen() and class_loader reflection and LTO can see
+ * across the plugin boundary.
+ *
+ * MavRos prefers this registry whenever it is non-empty and falls
+ * back to pluginlib otherwise, so one binary never mixes the two.
+ */
+class PluginRegistry {
+public:
+	using FactoryFn = PluginBase::Ptr (*)();
+
+	static PluginRegistry &instance();
+
+	void add(const char *name, FactoryFn fn)
+	{
+		factories.emplace_back(name, fn);
+	}
+
+	bool empty() const
+	{
+		return factories.empty();
+	}
+
+	//! Registered plugin names, analog of getDeclaredClasses()
+	std::vector<std::string> names() const
+	{
+		std::vector<std::string> out;
+		out.reserve(factories.size());
+		for (auto &f : factories)
+			out.push_back(f.first);
+
+		return out;
+	}
+
+	//! @return new instance or nullptr for unknown name
+	PluginBase::Ptr create(const std::string &name) const
+	{
+		for (auto &f : factories) {
+			if (f.first == name)
+				return f.second();
+		}
+
+		return PluginBase::Ptr();
+	}
+
+private:
+	std::vector<std::pair<std::string, FactoryFn>> factories;
+};
+
+//! Static-initializer hook used by MAVROS_PLUGIN_REGISTER()
+struct RegisterPlugin {
+	RegisterPlugin(const char *name, PluginRegistry::FactoryFn fn)
+	{
+		PluginRegistry::instance().add(name, fn);
+	}
+};
+}	// namespace plugin
+}	// namespace mavros
@@ -0,0 +1,103 @@
+/**
+ * @brief RX handoff queue
+ * @file rx_queue.h
+ * @author Vladimir Ermakov <vooon341@gmail.com>
+ *
+ * @addtogroup nodelib
+ * @{
+ */
+/*
+ * Copyright 2014,2015,2016 Vladimir Ermakov.
+ *
+ * This file is part of the mavros package and subject to the license terms
+ * in the top-level LICENSE file of the mavros repository.
+ * https://github.com/mavlink/mavros/tree/master/LICENSE.md
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mavconn/interface.h>
+
+namespace mavros {
+/**
+ * @brief Bounded lock-free SPSC queue of received messages.
+ *
+ * Hands messages from the mavconn io thread (single producer: the
+ * link strand serializes message_received_cb) to the RX worker
+ * (single consumer), so socket servicing never blocks on ROS
+ * publishing or plugin handlers. When the worker falls behind the
+ * queue rejects pushes instead of stalling the io thread.
+ */
+class RxQueue {
+public:
+	static constexpr size_t DEFAULT_CAPACITY = 1024;
+
+	struct Item {
+		mavlink::mavlink_message_t msg;
+		mavconn::Framing framing;
+	};
+
+	explicit RxQueue(size_t capacity = DEFAULT_CAPACITY) :
+		mask(round_up_pow2(capacity) - 1),
+		slots(new Item[mask + 1]),
+		head(0),
+		tail(0)
+	{ }
+
+	RxQueue(const RxQueue &) = delete;
+	RxQueue &operator=(const RxQueue &) = delete;
+
+	//! Producer side (io thread). @return false when full.
+	bool push(const mavlink::mavlink_message_t *msg, mavconn::Framing framing)
+	{
+		size_t h = head.load(std::memory_order_relaxed);
+		size_t t = tail.load(std::memory_order_acquire);
+
+		if (h - t > mask)
+			return false;
+
+		Item &it = slots[h & mask];
+		it.msg = *msg;
+		it.framing = framing;
+
+		head.store(h + 1, std::memory_order_release);
+		return true;
+	}
+
+	//! Consumer side (RX worker). @return false when empty.
+	bool pop(Item &out)
+	{
+		size_t t = tail.load(std::memory_order_relaxed);
+		size_t h = head.load(std::memory_order_acquire);
+
+		if (t == h)
+			return false;
+
+		out = slots[t & mask];
+		tail.store(t + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool empty() const
+	{
+		return tail.load(std::memory_order_relaxed) == head.load(std::memory_order_acquire);
+	}
+
+private:
+	static size_t round_up_pow2(size_t v)
+	{
+		size_t r = 1;
+		while (r < v)
+			r <<= 1;
+		return r;
+	}
+
+	const size_t mask;
+	std::unique_ptr<Item[]> slots;
+	//! Producer and consumer cursors on separate cache lines.
+	alignas(64) std::atomic<size_t> head;
+	alignas(64) std::atomic<size_t> tail;
+};
+}	// namespace mavros
@@ -70,7 +70,7 @@ public:
 		sp.afz = af.z();
 		// [[[end]]] (checksum: 6a9b9dacbcf85c5d428d754c20afe110)
 
-		UAS_FCU(m_uas_)->send_message_ignore_drop(sp);
+		UAS_FCU(m_uas_)->send_message_ignore_drop(sp, mavconn::TxPrio::REALTIME);
 	}
 };
 
@@ -116,7 +116,7 @@ public:
 		sp.afz = af.z();
 		// [[[end]]] (checksum: 30c9629ad309d488df1f63b683dac6a4)
 
-		UAS_FCU(m_uas_)->send_message_ignore_drop(sp);
+		UAS_FCU(m_uas_)->send_message_ignore_drop(sp, mavconn::TxPrio::REALTIME);
 	}
 };
 
@@ -153,12 +153,12 @@ public:
 		sp.body_yaw_rate = body_rate.z();
 		// [[[end]]] (checksum: aa941484927bb7a7d39a2c31d08fcfc1)
 
-		UAS_FCU(m_uas_)->send_message_ignore_drop(sp);
+		UAS_FCU(m_uas_)->send_message_ignore_drop(sp, mavconn::TxPrio::REALTIME);
 	}
 };
 
 /**
- * @brief This mixin adds TF2 listener thread to plugin
+ * @brief This mixin adds TF2 listener to plugin
  *
  * It requires tf_frame_id, tf_child_frame_id strings
  * tf_rate double and uas object pointer
@@ -172,7 +172,10 @@ public:
 	/**
 	 * @brief start tf listener
 	 *
-	 * @param _thd_name  listener thread name
+	 * Registers on the shared UAS watch scheduler (one thread serves
+	 * all plugins; the callback fires only on transform change).
+	 *
+	 * @param _thd_name  listener name (kept for log messages)
 	 * @param cbp        plugin callback function
 	 */
 	void tf2_start(const char *_thd_name, void (D::*cbp)(const geometry_msgs::TransformStamped &) )
@@ -180,29 +183,12 @@ public:
 		tf_thd_name = _thd_name;
 		auto tf_transform_cb = std::bind(cbp, static_cast<D *>(this), std::placeholders::_1);
 
-		tf_thread = std::thread([this, tf_transform_cb]() {
-			mavconn::utils::set_this_thread_name("%s", tf_thd_name.c_str());
-
-			mavros::UAS *m_uas_ = static_cast<D *>(this)->m_uas;
-			std::string &_frame_id = static_cast<D *>(this)->tf_frame_id;
-			std::string &_child_frame_id = static_cast<D *>(this)->tf_child_frame_id;
-
-			ros::Rate rate(static_cast<D *>(this)->tf_rate);
-			while (ros::ok()) {
-				// Wait up to 3s for transform
-				if (m_uas_->tf2_buffer.canTransform(_frame_id, _child_frame_id, ros::Time(0), ros::Duration(3.0))) {
-					try {
-						auto transform = m_uas_->tf2_buffer.lookupTransform(
-								_frame_id, _child_frame_id, ros::Time(0), ros::Duration(3.0));
-						tf_transform_cb(transform);
-					}
-					catch (tf2::LookupException &ex) {
-						ROS_ERROR_NAMED("tf2_buffer", "%s: %s", tf_thd_name.c_str(), ex.what());
-					}
-				}
-				rate.sleep();
-			}
-		});
+		mavros::UAS *m_uas_ = static_cast<D *>(this)->m_uas;
+		m_uas_->add_tf_watch(
+				static_cast<D *>(this)->tf_frame_id,
+				static_cast<D *>(this)->tf_child_frame_id,
+				static_cast<D *>(this)->tf_rate,
+				tf_transform_cb);
 	}
 
 	/**
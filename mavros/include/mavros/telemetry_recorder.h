@@ -0,0 +1,136 @@
+/**
+ * @brief Memory-mapped binary telemetry recorder
+ * @file telemetry_recorder.h
+ *
+ * @addtogroup nodelib
+ * @{
+ */
+/*
+ * This file is part of the mavros package and subject to the license terms
+ * in the top-level LICENSE file of the mavros repository.
+ * https://github.com/mavlink/mavros/tree/master/LICENSE.md
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <mavconn/interface.h>
+
+namespace mavros {
+/**
+ * @brief Native recorder for the raw FCU byte stream.
+ *
+ * Appends every received frame as 8-byte big-endian microsecond
+ * timestamp + wire bytes (the standard tlog layout, readable by
+ * mavlogdump and QGC) into preallocated mmap'd segment files. Compared
+ * to rosbagging /mavlink/from this skips the mavros_msgs::Mavlink
+ * payload copy, the ROS serialization and the bag framing entirely.
+ *
+ * record() runs on the RX worker and only serializes into a lock-free
+ * SPSC ring (same scheme as RxQueue); a dedicated writer thread drains
+ * the ring into the mapping, so a slow disk never backs up into message
+ * dispatch — when the writer falls behind, frames are dropped and
+ * counted instead.
+ */
+class TelemetryRecorder {
+public:
+	static constexpr size_t DEFAULT_RING_CAPACITY = 2048;
+
+	/**
+	 * @param[in] path_prefix  segment files are created as
+	 *                         <prefix>_<start time>-NNN.tlog
+	 * @param[in] segment_mb   preallocated size of one segment file
+	 * @throws std::runtime_error  when the first segment can not be created
+	 */
+	TelemetryRecorder(const std::string &path_prefix, size_t segment_mb,
+			size_t ring_capacity = DEFAULT_RING_CAPACITY);
+	~TelemetryRecorder();
+
+	TelemetryRecorder(const TelemetryRecorder &) = delete;
+	TelemetryRecorder &operator=(const TelemetryRecorder &) = delete;
+
+	/**
+	 * @brief Hand one received frame to the writer. RX worker only.
+	 * @param[in] usec  receive stamp, microseconds since epoch
+	 * @return false when the ring is full and the frame was dropped
+	 */
+	bool record(const mavlink::mavlink_message_t *msg, uint64_t usec)
+	{
+		size_t h = head.load(std::memory_order_relaxed);
+		size_t t = tail.load(std::memory_order_acquire);
+
+		if (h - t > ring_mask) {
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		Frame &fr = ring[h & ring_mask];
+		fr.usec = usec;
+		fr.len = mavlink::mavlink_msg_to_send_buffer(fr.data.data(), msg);
+
+		head.store(h + 1, std::memory_order_release);
+
+		// wake the writer only when it parked, keep record() lock-free
+		// otherwise; the fence pairs with the one in writer_worker()
+		// so either the writer sees our head store or we see its flag
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (writer_sleeping.load(std::memory_order_acquire)) {
+			std::lock_guard<std::mutex> lock(writer_mutex);
+			writer_cv.notify_one();
+		}
+		return true;
+	}
+
+	//! frames lost to ring overflow since start
+	uint64_t dropped_count() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+	struct Frame {
+		uint64_t usec;
+		uint16_t len;
+		std::array<uint8_t, MAVLINK_MAX_PACKET_LEN> data;
+	};
+
+	const std::string path_prefix;
+	const size_t segment_bytes;
+
+	//! SPSC ring: record() produces, writer_worker() consumes
+	const size_t ring_mask;
+	std::unique_ptr<Frame[]> ring;
+	alignas(64) std::atomic<size_t> head;
+	alignas(64) std::atomic<size_t> tail;
+
+	std::atomic<uint64_t> dropped;
+
+	std::thread writer_thread;
+	std::mutex writer_mutex;
+	std::condition_variable writer_cv;
+	std::atomic<bool> writer_sleeping;
+	std::atomic<bool> writer_should_exit;
+
+	//! current segment mapping
+	uint8_t *seg_data;
+	size_t seg_used;
+	int seg_fd;
+	size_t seg_index;
+	std::string start_stamp;
+
+	void open_segment();
+	void close_segment();
+	void append(const Frame &fr);
+	void writer_worker();
+
+	static size_t round_up_pow2(size_t v)
+	{
+		size_t r = 1;
+		while (r < v)
+			r <<= 1;
+		return r;
+	}
+};
+}	// namespace mavros
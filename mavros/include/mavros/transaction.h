@@ -0,0 +1,164 @@
+/**
+ * @brief Request/ack transaction helpers
+ * @file transaction.h
+ * @author Vladimir Ermakov <vooon341@gmail.com>
+ *
+ * @addtogroup nodelib
+ * @{
+ */
+/*
+ * Copyright 2014,2015,2016 Vladimir Ermakov.
+ *
+ * This file is part of the mavros package and subject to the license terms
+ * in the top-level LICENSE file of the mavros repository.
+ * https://github.com/mavlink/mavros/tree/master/LICENSE.md
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <ros/ros.h>
+
+namespace mavros {
+/**
+ * @brief One-shot completion gate for request/ack microservices
+ *
+ * The param, waypoint, ftp and command protocols all block a service
+ * thread until an rx handler signals the end of the transaction. The
+ * bare condition_variable each of them used could miss a notify that
+ * arrived before the waiter; this gate latches the completion, so
+ * signal and wait may come in any order.
+ *
+ * A successful wait consumes the completion, sequential transactions
+ * can reuse one gate. Call reset() before starting a new request to
+ * drop a completion a timed-out predecessor may have left behind.
+ */
+class TransactionWaiter {
+public:
+	TransactionWaiter() :
+		done(false),
+		ok(false)
+	{ }
+
+	//! forget the outcome of a previous transaction
+	void reset()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		done = false;
+		ok = false;
+	}
+
+	//! signal transaction end (any thread)
+	void complete(bool success)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			done = true;
+			ok = success;
+		}
+		cond.notify_all();
+	}
+
+	enum class Result {
+		TIMEDOUT,	//!< no completion within timeout
+		FAILED,		//!< transaction completed with failure
+		DONE		//!< transaction completed successfully
+	};
+
+	//! wait for and consume the completion
+	Result wait(const ros::Duration &timeout)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+
+		if (!cond.wait_for(lock, std::chrono::nanoseconds(timeout.toNSec()),
+				[this]() { return done; }))
+			return Result::TIMEDOUT;
+
+		done = false;	// consume
+		return (ok) ? Result::DONE : Result::FAILED;
+	}
+
+	//! @return false on timeout or failed completion
+	bool wait_for(const ros::Duration &timeout)
+	{
+		return wait(timeout) == Result::DONE;
+	}
+
+private:
+	std::mutex mutex;
+	std::condition_variable cond;
+	bool done;
+	bool ok;
+};
+
+/**
+ * @brief Timer-paced retransmit helper
+ *
+ * Factors the send -> arm timeout -> resend -> give up cycle out of
+ * the protocol plugins. The callbacks run on the owning NodeHandle's
+ * callback queue, exactly like the hand-rolled ros::Timer they
+ * replace; locking the plugin state inside them is the caller's job.
+ */
+class RetryTimer {
+public:
+	RetryTimer() :
+		max_retries(0),
+		retries_left(0)
+	{ }
+
+	void init(ros::NodeHandle &nh, const ros::Duration &period, int max_retries_,
+		std::function<void()> resend_, std::function<void()> give_up_)
+	{
+		max_retries = max_retries_;
+		resend = std::move(resend_);
+		give_up = std::move(give_up_);
+		timer = nh.createTimer(period, &RetryTimer::timeout_cb, this, true);
+		timer.stop();
+	}
+
+	//! (re)start with a full retry budget: new request or progress made
+	void arm()
+	{
+		retries_left = max_retries;
+		rearm();
+	}
+
+	//! restart the period only, keeping the remaining budget
+	void rearm()
+	{
+		timer.stop();
+		timer.start();
+	}
+
+	void disarm()
+	{
+		timer.stop();
+	}
+
+	int retries_remaining() const
+	{
+		return retries_left;
+	}
+
+private:
+	void timeout_cb(const ros::TimerEvent &event)
+	{
+		if (retries_left > 0) {
+			retries_left--;
+			resend();
+			rearm();
+		}
+		else
+			give_up();
+	}
+
+	ros::Timer timer;
+	int max_retries;
+	int retries_left;
+	std::function<void()> resend;
+	std::function<void()> give_up;
+};
+}	// namespace mavros
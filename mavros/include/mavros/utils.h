@@ -78,6 +78,27 @@ std::string to_string(mavlink::common::MAV_MISSION_RESULT e);
 std::string to_string(mavlink::common::MAV_FRAME e);
 std::string to_string(mavlink::common::MAV_DISTANCE_SENSOR e);
 std::string to_string(mavlink::common::LANDING_TARGET_TYPE e);
+
+/**
+ * Zero-allocation variants of to_string().
+ *
+ * Return pointers into constexpr tables, so no heap traffic per call
+ * (useful on the HEARTBEAT path). Return nullptr for values without
+ * a table entry; to_string() wraps these with a std::to_string fallback.
+ */
+const char *to_cstring(timesync_mode e);
+const char *to_cstring(mavlink::common::MAV_AUTOPILOT e);
+const char *to_cstring(mavlink::common::MAV_TYPE e);
+const char *to_cstring(mavlink::common::MAV_STATE e);
+const char *to_cstring(mavlink::common::MAV_COMPONENT e);
+const char *to_cstring(mavlink::common::MAV_ESTIMATOR_TYPE e);
+const char *to_cstring(mavlink::common::ADSB_ALTITUDE_TYPE e);
+const char *to_cstring(mavlink::common::ADSB_EMITTER_TYPE e);
+const char *to_cstring(mavlink::common::MAV_MISSION_RESULT e);
+const char *to_cstring(mavlink::common::MAV_FRAME e);
+const char *to_cstring(mavlink::common::MAV_DISTANCE_SENSOR e);
+const char *to_cstring(mavlink::common::LANDING_TARGET_TYPE e);
+
 /**
  * Helper to call to_string() for enum _T
  */
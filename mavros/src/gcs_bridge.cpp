@@ -11,6 +11,9 @@
  * https://github.com/mavlink/mavros/tree/master/LICENSE.md
  */
 
+#include <chrono>
+#include <vector>
+
 #include <ros/ros.h>
 #include <ros/console.h>
 
@@ -25,6 +28,119 @@ ros::Publisher mavlink_pub;
 ros::Subscriber mavlink_sub;
 MAVConnInterface::Ptr gcs_link;
 
+/* -*- endpoint profile -*-
+ *
+ * A range-safety GCS on a 9600-baud backup link only needs a handful of
+ * message ids, while the operator GCS takes everything. Each bridge
+ * instance (one per endpoint) can load a profile:
+ *
+ *   ~filter/whitelist   list of msgids to forward (empty = all)
+ *   ~filter/rate_limit  map msgid -> max Hz, applied after the whitelist
+ *
+ * The whitelist is one bit per possible 24-bit msgid (2 MiB, untouched
+ * pages stay zero and cost nothing), so a rejected message is one load
+ * and one mask. Rate state sits in a small open-addressed table probed
+ * from msgid, the same scheme the adsb plugin uses for contacts.
+ */
+
+bool whitelist_enabled = false;
+std::vector<uint32_t> whitelist_bitmap;
+
+struct RateSlot {
+	uint32_t msgid = UINT32_MAX;
+	int64_t min_interval_ns = 0;
+	std::chrono::steady_clock::time_point last_sent;
+};
+
+constexpr size_t RATE_TABLE_SIZE = 64;	// power of two, probed linearly
+std::array<RateSlot, RATE_TABLE_SIZE> rate_table;
+bool rate_limit_enabled = false;
+
+static inline bool whitelist_pass(uint32_t msgid)
+{
+	if (!whitelist_enabled)
+		return true;
+
+	return whitelist_bitmap[msgid >> 5] & (uint32_t(1) << (msgid & 31));
+}
+
+static RateSlot *rate_slot_find(uint32_t msgid, bool insert)
+{
+	for (size_t probe = 0; probe < RATE_TABLE_SIZE; probe++) {
+		auto &slot = rate_table[(msgid + probe) & (RATE_TABLE_SIZE - 1)];
+
+		if (slot.msgid == msgid)
+			return &slot;
+		if (slot.msgid == UINT32_MAX)
+			return (insert) ? &slot : nullptr;
+	}
+
+	return nullptr;
+}
+
+static inline bool rate_limit_pass(uint32_t msgid)
+{
+	if (!rate_limit_enabled)
+		return true;
+
+	auto *slot = rate_slot_find(msgid, false);
+	if (slot == nullptr)
+		return true;
+
+	auto now = std::chrono::steady_clock::now();
+	if (std::chrono::duration_cast<std::chrono::nanoseconds>(
+			now - slot->last_sent).count() < slot->min_interval_ns)
+		return false;
+
+	slot->last_sent = now;
+	return true;
+}
+
+static void load_profile(ros::NodeHandle &priv_nh)
+{
+	std::vector<int> wl{};
+	priv_nh.getParam("filter/whitelist", wl);
+
+	if (!wl.empty()) {
+		whitelist_enabled = true;
+		whitelist_bitmap.resize((size_t(1) << 24) / 32, 0);
+		for (int msgid : wl) {
+			if (msgid < 0 || msgid >= (1 << 24)) {
+				ROS_ERROR("filter: bad whitelist msgid %d", msgid);
+				continue;
+			}
+			whitelist_bitmap[msgid >> 5] |= uint32_t(1) << (msgid & 31);
+		}
+		ROS_INFO("filter: whitelist with %zu msgids", wl.size());
+	}
+
+	XmlRpc::XmlRpcValue limit_dict;
+	if (priv_nh.getParam("filter/rate_limit", limit_dict) &&
+			limit_dict.getType() == XmlRpc::XmlRpcValue::TypeStruct) {
+		for (auto &pair : limit_dict) {
+			try {
+				uint32_t msgid = std::stoi(pair.first);
+				double hz = (pair.second.getType() == XmlRpc::XmlRpcValue::TypeInt) ?
+					double(static_cast<int>(pair.second)) :
+					static_cast<double>(pair.second);
+
+				auto *slot = rate_slot_find(msgid, true);
+				if (slot == nullptr || hz <= 0.0) {
+					ROS_ERROR("filter: can not rate limit msgid %u", msgid);
+					continue;
+				}
+
+				slot->msgid = msgid;
+				slot->min_interval_ns = int64_t(1e9 / hz);
+				rate_limit_enabled = true;
+				ROS_INFO("filter: msgid %u capped at %.1f Hz", msgid, hz);
+			}
+			catch (std::invalid_argument &ex) {
+				ROS_ERROR_STREAM("filter: bad rate_limit msgid: " << pair.first);
+			}
+		}
+	}
+}
 
 void mavlink_pub_cb(const mavlink::mavlink_message_t *mmsg, const mavconn::Framing framing)
 {
@@ -37,10 +153,15 @@ void mavlink_pub_cb(const mavlink::mavlink_message_t *mmsg, const mavconn::Frami
 
 void mavlink_sub_cb(const mavros_msgs::Mavlink::ConstPtr &rmsg)
 {
-	mavlink::mavlink_message_t mmsg;
+	// profile check first: a filtered message costs no frame conversion
+	if (!whitelist_pass(rmsg->msgid) || !rate_limit_pass(rmsg->msgid))
+		return;
 
-	if (mavros_msgs::mavlink::convert(*rmsg, mmsg))
-		gcs_link->send_message(&mmsg);	// !!! queue exception -> fall of gcs_bridge. intentional.
+	std::array<uint8_t, MAVLINK_MAX_PACKET_LEN> buf;
+
+	ssize_t framelen = mavros_msgs::mavlink::convert_to_frame(*rmsg, buf.data(), buf.size());
+	if (framelen > 0)
+		gcs_link->send_bytes(buf.data(), framelen);	// !!! queue exception -> fall of gcs_bridge. intentional.
 	else
 		ROS_ERROR("Packet drop: convert error.");
 }
@@ -56,6 +177,8 @@ int main(int argc, char *argv[])
 	std::string gcs_url;
 	priv_nh.param<std::string>("gcs_url", gcs_url, "udp://@");
 
+	load_profile(priv_nh);
+
 	try {
 		gcs_link = MAVConnInterface::open_url(gcs_url);
 		gcs_link_diag.set_mavconn(gcs_link);
@@ -14,8 +14,8 @@
  * https://github.com/mavlink/mavros/tree/master/LICENSE.md
  */
 
+#include <array>
 #include <mavros/utils.h>
-#include <mavros/frame_tf.h>
 #include <ros/console.h>
 
 namespace mavros {
@@ -23,21 +23,22 @@ namespace utils {
 
 using mavlink::common::MAV_SENSOR_ORIENTATION;
 
-// internal type: name - rotation
-using OrientationPair = std::pair<const std::string, const Eigen::Quaterniond>;
-
-// internal data initializer
-static const OrientationPair make_orientation(const std::string &name,
-	const double roll,
-	const double pitch,
-	const double yaw)
-{
-	constexpr auto DEG_TO_RAD = (M_PI / 180.0);
-	const Eigen::Quaterniond rot = ftf::quaternion_from_rpy(Eigen::Vector3d(roll, pitch, yaw) * DEG_TO_RAD);
-	return std::make_pair(name, rot);
-}
+/**
+ * @brief Sensor orientation table entry
+ *
+ * Eigen::Quaterniond is not a literal type, so the table stores plain
+ * quaternion components. Components are precomputed by the generator
+ * below (same ZYX composition as ftf::quaternion_from_rpy()), which
+ * makes the whole table constexpr: no trig and no static initializers
+ * run at load time, lookup is a direct array index.
+ */
+struct OrientationEntry {
+	const char *name;
+	double w, x, y, z;
+};
 
 // [[[cog:
+// import math
 // import attr
 // import pymavlink.dialects.v20.common as common
 // ename = 'MAV_SENSOR_ORIENTATION'
@@ -64,60 +65,72 @@ static const OrientationPair make_orientation(const std::string &name,
 //             print(f"Parse Error: {ex}, desc: {desc}")
 //             return cls()
 //
-// cog.outl("static const std::array<const OrientationPair, %s> sensor_orientations{{" % len(enum))
+//     def quaternion(self):
+//         """ZYX composition, same as ftf::quaternion_from_rpy()"""
+//         r, p, y = (math.radians(v) for v in (self.Roll, self.Pitch, self.Yaw))
+//         cy, sy = math.cos(y / 2), math.sin(y / 2)
+//         cp, sp = math.cos(p / 2), math.sin(p / 2)
+//         cr, sr = math.cos(r / 2), math.sin(r / 2)
+//         return (cy * cp * cr + sy * sp * sr,
+//                 cy * cp * sr - sy * sp * cr,
+//                 cy * sp * cr + sy * cp * sr,
+//                 sy * cp * cr - cy * sp * sr)
+//
+// cog.outl("static constexpr std::array<OrientationEntry, %s> sensor_orientations{{" % len(enum))
 // for k, e in enum:
 //     name_short = e.name[len(pfx2):]
 //     vec = Vector3.parse_rpy(e.description)
+//     q = ", ".join("%+.16e" % v for v in vec.quaternion())
 //     whitespace = ' ' * (27 - len(name_short))
-//     cog.outl(f"""/* {k:>2} */ make_orientation("{name_short}",{whitespace}{vec.Roll:>5}, {vec.Pitch:>5}, {vec.Yaw:>5}),""")
+//     cog.outl(f"""/* {k:>2} */ {{"{name_short}",{whitespace}{q}}},""")
 //
 // cog.outl("}};")
 // ]]]
-static const std::array<const OrientationPair, 42> sensor_orientations{{
-/*  0 */ make_orientation("NONE",                         0.0,   0.0,   0.0),
-/*  1 */ make_orientation("YAW_45",                       0.0,   0.0,  45.0),
-/*  2 */ make_orientation("YAW_90",                       0.0,   0.0,  90.0),
-/*  3 */ make_orientation("YAW_135",                      0.0,   0.0, 135.0),
-/*  4 */ make_orientation("YAW_180",                      0.0,   0.0, 180.0),
-/*  5 */ make_orientation("YAW_225",                      0.0,   0.0, 225.0),
-/*  6 */ make_orientation("YAW_270",                      0.0,   0.0, 270.0),
-/*  7 */ make_orientation("YAW_315",                      0.0,   0.0, 315.0),
-/*  8 */ make_orientation("ROLL_180",                   180.0,   0.0,   0.0),
-/*  9 */ make_orientation("ROLL_180_YAW_45",            180.0,   0.0,  45.0),
-/* 10 */ make_orientation("ROLL_180_YAW_90",            180.0,   0.0,  90.0),
-/* 11 */ make_orientation("ROLL_180_YAW_135",           180.0,   0.0, 135.0),
-/* 12 */ make_orientation("PITCH_180",                    0.0, 180.0,   0.0),
-/* 13 */ make_orientation("ROLL_180_YAW_225",           180.0,   0.0, 225.0),
-/* 14 */ make_orientation("ROLL_180_YAW_270",           180.0,   0.0, 270.0),
-/* 15 */ make_orientation("ROLL_180_YAW_315",           180.0,   0.0, 315.0),
-/* 16 */ make_orientation("ROLL_90",                     90.0,   0.0,   0.0),
-/* 17 */ make_orientation("ROLL_90_YAW_45",              90.0,   0.0,  45.0),
-/* 18 */ make_orientation("ROLL_90_YAW_90",              90.0,   0.0,  90.0),
-/* 19 */ make_orientation("ROLL_90_YAW_135",             90.0,   0.0, 135.0),
-/* 20 */ make_orientation("ROLL_270",                   270.0,   0.0,   0.0),
-/* 21 */ make_orientation("ROLL_270_YAW_45",            270.0,   0.0,  45.0),
-/* 22 */ make_orientation("ROLL_270_YAW_90",            270.0,   0.0,  90.0),
-/* 23 */ make_orientation("ROLL_270_YAW_135",           270.0,   0.0, 135.0),
-/* 24 */ make_orientation("PITCH_90",                     0.0,  90.0,   0.0),
-/* 25 */ make_orientation("PITCH_270",                    0.0, 270.0,   0.0),
-/* 26 */ make_orientation("PITCH_180_YAW_90",             0.0, 180.0,  90.0),
-/* 27 */ make_orientation("PITCH_180_YAW_270",            0.0, 180.0, 270.0),
-/* 28 */ make_orientation("ROLL_90_PITCH_90",            90.0,  90.0,   0.0),
-/* 29 */ make_orientation("ROLL_180_PITCH_90",          180.0,  90.0,   0.0),
-/* 30 */ make_orientation("ROLL_270_PITCH_90",          270.0,  90.0,   0.0),
-/* 31 */ make_orientation("ROLL_90_PITCH_180",           90.0, 180.0,   0.0),
-/* 32 */ make_orientation("ROLL_270_PITCH_180",         270.0, 180.0,   0.0),
-/* 33 */ make_orientation("ROLL_90_PITCH_270",           90.0, 270.0,   0.0),
-/* 34 */ make_orientation("ROLL_180_PITCH_270",         180.0, 270.0,   0.0),
-/* 35 */ make_orientation("ROLL_270_PITCH_270",         270.0, 270.0,   0.0),
-/* 36 */ make_orientation("ROLL_90_PITCH_180_YAW_90",    90.0, 180.0,  90.0),
-/* 37 */ make_orientation("ROLL_90_YAW_270",             90.0,   0.0, 270.0),
-/* 38 */ make_orientation("ROLL_90_PITCH_68_YAW_293",    90.0,  68.0, 293.0),
-/* 39 */ make_orientation("PITCH_315",                    0.0, 315.0,   0.0),
-/* 40 */ make_orientation("ROLL_90_PITCH_315",           90.0, 315.0,   0.0),
-/* 100 */ make_orientation("CUSTOM",                       0.0,   0.0,   0.0),
+static constexpr std::array<OrientationEntry, 42> sensor_orientations{{
+/*  0 */ {"NONE",                       +1.0000000000000000e+00, +0.0000000000000000e+00, +0.0000000000000000e+00, +0.0000000000000000e+00},
+/*  1 */ {"YAW_45",                     +9.2387953251128674e-01, +0.0000000000000000e+00, +0.0000000000000000e+00, +3.8268343236508978e-01},
+/*  2 */ {"YAW_90",                     +7.0710678118654757e-01, +0.0000000000000000e+00, +0.0000000000000000e+00, +7.0710678118654746e-01},
+/*  3 */ {"YAW_135",                    +3.8268343236508984e-01, +0.0000000000000000e+00, +0.0000000000000000e+00, +9.2387953251128674e-01},
+/*  4 */ {"YAW_180",                    +6.1232339957367660e-17, +0.0000000000000000e+00, +0.0000000000000000e+00, +1.0000000000000000e+00},
+/*  5 */ {"YAW_225",                    -3.8268343236508973e-01, -0.0000000000000000e+00, +0.0000000000000000e+00, +9.2387953251128674e-01},
+/*  6 */ {"YAW_270",                    -7.0710678118654746e-01, -0.0000000000000000e+00, +0.0000000000000000e+00, +7.0710678118654757e-01},
+/*  7 */ {"YAW_315",                    -9.2387953251128674e-01, -0.0000000000000000e+00, +0.0000000000000000e+00, +3.8268343236508989e-01},
+/*  8 */ {"ROLL_180",                   +6.1232339957367660e-17, +1.0000000000000000e+00, +0.0000000000000000e+00, +0.0000000000000000e+00},
+/*  9 */ {"ROLL_180_YAW_45",            +5.6571305614385013e-17, +9.2387953251128674e-01, +3.8268343236508978e-01, +2.3432602026631493e-17},
+/* 10 */ {"ROLL_180_YAW_90",            +4.3297802811774670e-17, +7.0710678118654757e-01, +7.0710678118654746e-01, +4.3297802811774658e-17},
+/* 11 */ {"ROLL_180_YAW_135",           +2.3432602026631496e-17, +3.8268343236508984e-01, +9.2387953251128674e-01, +5.6571305614385013e-17},
+/* 12 */ {"PITCH_180",                  +6.1232339957367660e-17, +0.0000000000000000e+00, +1.0000000000000000e+00, +0.0000000000000000e+00},
+/* 13 */ {"ROLL_180_YAW_225",           -2.3432602026631487e-17, -3.8268343236508973e-01, +9.2387953251128674e-01, +5.6571305614385013e-17},
+/* 14 */ {"ROLL_180_YAW_270",           -4.3297802811774658e-17, -7.0710678118654746e-01, +7.0710678118654757e-01, +4.3297802811774670e-17},
+/* 15 */ {"ROLL_180_YAW_315",           -5.6571305614385013e-17, -9.2387953251128674e-01, +3.8268343236508989e-01, +2.3432602026631499e-17},
+/* 16 */ {"ROLL_90",                    +7.0710678118654757e-01, +7.0710678118654746e-01, +0.0000000000000000e+00, +0.0000000000000000e+00},
+/* 17 */ {"ROLL_90_YAW_45",             +6.5328148243818829e-01, +6.5328148243818818e-01, +2.7059805007309845e-01, +2.7059805007309851e-01},
+/* 18 */ {"ROLL_90_YAW_90",             +5.0000000000000011e-01, +5.0000000000000000e-01, +4.9999999999999989e-01, +5.0000000000000000e-01},
+/* 19 */ {"ROLL_90_YAW_135",            +2.7059805007309856e-01, +2.7059805007309851e-01, +6.5328148243818818e-01, +6.5328148243818829e-01},
+/* 20 */ {"ROLL_270",                   -7.0710678118654746e-01, +7.0710678118654757e-01, +0.0000000000000000e+00, -0.0000000000000000e+00},
+/* 21 */ {"ROLL_270_YAW_45",            -6.5328148243818818e-01, +6.5328148243818829e-01, +2.7059805007309851e-01, -2.7059805007309845e-01},
+/* 22 */ {"ROLL_270_YAW_90",            -5.0000000000000000e-01, +5.0000000000000011e-01, +5.0000000000000000e-01, -4.9999999999999989e-01},
+/* 23 */ {"ROLL_270_YAW_135",           -2.7059805007309851e-01, +2.7059805007309856e-01, +6.5328148243818829e-01, -6.5328148243818818e-01},
+/* 24 */ {"PITCH_90",                   +7.0710678118654757e-01, +0.0000000000000000e+00, +7.0710678118654746e-01, +0.0000000000000000e+00},
+/* 25 */ {"PITCH_270",                  -7.0710678118654746e-01, -0.0000000000000000e+00, +7.0710678118654757e-01, -0.0000000000000000e+00},
+/* 26 */ {"PITCH_180_YAW_90",           +4.3297802811774670e-17, -7.0710678118654746e-01, +7.0710678118654757e-01, +4.3297802811774658e-17},
+/* 27 */ {"PITCH_180_YAW_270",          -4.3297802811774658e-17, -7.0710678118654757e-01, -7.0710678118654746e-01, +4.3297802811774670e-17},
+/* 28 */ {"ROLL_90_PITCH_90",           +5.0000000000000011e-01, +5.0000000000000000e-01, +5.0000000000000000e-01, -4.9999999999999989e-01},
+/* 29 */ {"ROLL_180_PITCH_90",          +4.3297802811774670e-17, +7.0710678118654757e-01, +4.3297802811774658e-17, -7.0710678118654746e-01},
+/* 30 */ {"ROLL_270_PITCH_90",          -5.0000000000000000e-01, +5.0000000000000011e-01, -4.9999999999999989e-01, -5.0000000000000000e-01},
+/* 31 */ {"ROLL_90_PITCH_180",          +4.3297802811774670e-17, +4.3297802811774658e-17, +7.0710678118654757e-01, -7.0710678118654746e-01},
+/* 32 */ {"ROLL_270_PITCH_180",         -4.3297802811774658e-17, +4.3297802811774670e-17, -7.0710678118654746e-01, -7.0710678118654757e-01},
+/* 33 */ {"ROLL_90_PITCH_270",          -5.0000000000000000e-01, -4.9999999999999989e-01, +5.0000000000000011e-01, -5.0000000000000000e-01},
+/* 34 */ {"ROLL_180_PITCH_270",         -4.3297802811774658e-17, -7.0710678118654746e-01, +4.3297802811774670e-17, -7.0710678118654757e-01},
+/* 35 */ {"ROLL_270_PITCH_270",         +4.9999999999999989e-01, -5.0000000000000000e-01, -5.0000000000000000e-01, -5.0000000000000011e-01},
+/* 36 */ {"ROLL_90_PITCH_180_YAW_90",   +4.9999999999999994e-01, -4.9999999999999994e-01, +5.0000000000000011e-01, -4.9999999999999994e-01},
+/* 37 */ {"ROLL_90_YAW_270",            -5.0000000000000000e-01, -4.9999999999999989e-01, +5.0000000000000000e-01, +5.0000000000000011e-01},
+/* 38 */ {"ROLL_90_PITCH_68_YAW_293",   -2.7059805007309834e-01, -7.0707985672701623e-01, -6.1705924271653889e-03, +6.5328148243818829e-01},
+/* 39 */ {"PITCH_315",                  -9.2387953251128674e-01, -0.0000000000000000e+00, +3.8268343236508989e-01, -0.0000000000000000e+00},
+/* 40 */ {"ROLL_90_PITCH_315",          -6.5328148243818829e-01, -6.5328148243818818e-01, +2.7059805007309862e-01, -2.7059805007309856e-01},
+/* 100 */ {"CUSTOM",                     +1.0000000000000000e+00, +0.0000000000000000e+00, +0.0000000000000000e+00, +0.0000000000000000e+00},
 }};
-// [[[end]]] (checksum: 8da0773dfd7a53b866aa7cad6c9ee3d0)
+// [[[end]]] (checksum: c597867baec998c535b3bbd9e7137b55)
 
 
 std::string to_string(MAV_SENSOR_ORIENTATION orientation)
@@ -128,7 +141,7 @@ std::string to_string(MAV_SENSOR_ORIENTATION orientation)
 		return std::to_string(idx);
 	}
 
-	return sensor_orientations[idx].first;
+	return sensor_orientations[idx].name;
 }
 
 Eigen::Quaterniond sensor_orientation_matching(MAV_SENSOR_ORIENTATION orientation)
@@ -140,7 +153,8 @@ Eigen::Quaterniond sensor_orientation_matching(MAV_SENSOR_ORIENTATION orientatio
 		return Eigen::Quaterniond::Identity();
 	}
 
-	return sensor_orientations[idx].second;
+	const auto &e = sensor_orientations[idx];
+	return Eigen::Quaterniond(e.w, e.x, e.y, e.z);
 }
 
 int sensor_orientation_from_str(const std::string &sensor_orientation)
@@ -149,7 +163,7 @@ int sensor_orientation_from_str(const std::string &sensor_orientation)
 
 	// 1. try to find by name
 	for (size_t idx = 0; idx < sensor_orientations.size(); idx++) {
-		if (sensor_orientations[idx].first == sensor_orientation)
+		if (sensor_orientation == sensor_orientations[idx].name)
 			return idx;
 	}
 
@@ -61,18 +61,28 @@ using mavlink::common::LANDING_TARGET_TYPE;
 //     array = ename_array_name(name, suffix)
 //     cog.outl(f"""\
 // //! {name} values
-// static const std::array<const std::string, {len(enum)}> {array}{{{{""")
+// static constexpr std::array<const char *, {len(enum)}> {array}{{{{""")
 //
 // def to_string_outl(ename, funcname='to_string', suffix=None):
 //     array = ename_array_name(ename, suffix)
+//     cfuncname = 'to_cname' if funcname == 'to_name' else 'to_cstring'
 //     cog.outl(f"""\
-// std::string {funcname}({ename} e)
+// const char *{cfuncname}({ename} e)
 // {{
 // 	size_t idx = enum_value(e);
 // 	if (idx >= {array}.size())
-// 		return std::to_string(idx);
+// 		return nullptr;
 //
 // 	return {array}[idx];
+// }}
+//
+// std::string {funcname}({ename} e)
+// {{
+// 	const char *s = {cfuncname}(e);
+// 	if (s == nullptr)
+// 		return std::to_string(enum_value(e));
+//
+// 	return s;
 // }}""")
 //
 // def enum_name_is_value_outl(ename, suffix=None, funcname='to_string'):
@@ -105,7 +115,7 @@ using mavlink::common::LANDING_TARGET_TYPE;
 // to_string_outl(ename)
 // ]]]
 //! MAV_AUTOPILOT values
-static const std::array<const std::string, 20> mav_autopilot_strings{{
+static constexpr std::array<const char *, 20> mav_autopilot_strings{{
 /*  0 */ "Generic autopilot",             // Generic autopilot, full support for everything
 /*  1 */ "Reserved for future use",       // Reserved for future use.
 /*  2 */ "SLUGS autopilot",               // SLUGS autopilot, http://slugsuav.soe.ucsc.edu
@@ -128,14 +138,23 @@ static const std::array<const std::string, 20> mav_autopilot_strings{{
 /* 19 */ "AirRails",                      // AirRails - http://uaventure.com
 }};
 
-std::string to_string(MAV_AUTOPILOT e)
+const char *to_cstring(MAV_AUTOPILOT e)
 {
 	size_t idx = enum_value(e);
 	if (idx >= mav_autopilot_strings.size())
-		return std::to_string(idx);
+		return nullptr;
 
 	return mav_autopilot_strings[idx];
 }
+
+std::string to_string(MAV_AUTOPILOT e)
+{
+	const char *s = to_cstring(e);
+	if (s == nullptr)
+		return std::to_string(enum_value(e));
+
+	return s;
+}
 // [[[end]]] (checksum: 4b5a1e0cd8f9d21b956818e7efa3bc2e)
 
 // [[[cog:
@@ -153,7 +172,7 @@ std::string to_string(MAV_AUTOPILOT e)
 // to_string_outl(ename)
 // ]]]
 //! MAV_TYPE values
-static const std::array<const std::string, 33> mav_type_strings{{
+static constexpr std::array<const char *, 33> mav_type_strings{{
 /*  0 */ "Generic micro air vehicle",     // Generic micro air vehicle.
 /*  1 */ "Fixed wing aircraft",           // Fixed wing aircraft.
 /*  2 */ "Quadrotor",                     // Quadrotor
@@ -189,14 +208,23 @@ static const std::array<const std::string, 33> mav_type_strings{{
 /* 32 */ "FLARM collision avoidance system (standalone)", // FLARM collision avoidance system (standalone)
 }};
 
-std::string to_string(MAV_TYPE e)
+const char *to_cstring(MAV_TYPE e)
 {
 	size_t idx = enum_value(e);
 	if (idx >= mav_type_strings.size())
-		return std::to_string(idx);
+		return nullptr;
 
 	return mav_type_strings[idx];
 }
+
+std::string to_string(MAV_TYPE e)
+{
+	const char *s = to_cstring(e);
+	if (s == nullptr)
+		return std::to_string(enum_value(e));
+
+	return s;
+}
 // [[[end]]] (checksum: b441cfd88ee1a6fc8c8bc8f4e6df5825)
 
 // [[[cog:
@@ -204,7 +232,7 @@ std::string to_string(MAV_TYPE e)
 // enum_name_is_value_outl(ename, funcname='to_name', suffix='_names')
 // ]]]
 //! MAV_TYPE values
-static const std::array<const std::string, 33> mav_type_names{{
+static constexpr std::array<const char *, 33> mav_type_names{{
 /*  0 */ "GENERIC",                       // Generic micro air vehicle.
 /*  1 */ "FIXED_WING",                    // Fixed wing aircraft.
 /*  2 */ "QUADROTOR",                     // Quadrotor
@@ -240,14 +268,23 @@ static const std::array<const std::string, 33> mav_type_names{{
 /* 32 */ "FLARM",                         // FLARM collision avoidance system (standalone)
 }};
 
-std::string to_name(MAV_TYPE e)
+const char *to_cname(MAV_TYPE e)
 {
 	size_t idx = enum_value(e);
 	if (idx >= mav_type_names.size())
-		return std::to_string(idx);
+		return nullptr;
 
 	return mav_type_names[idx];
 }
+
+std::string to_name(MAV_TYPE e)
+{
+	const char *s = to_cname(e);
+	if (s == nullptr)
+		return std::to_string(enum_value(e));
+
+	return s;
+}
 // [[[end]]] (checksum: 6accf424d6136b55b15efbb86bb0c5cd)
 
 // [[[cog:
@@ -265,7 +302,7 @@ std::string to_name(MAV_TYPE e)
 // to_string_outl(ename)
 // ]]]
 //! MAV_STATE values
-static const std::array<const std::string, 9> mav_state_strings{{
+static constexpr std::array<const char *, 9> mav_state_strings{{
 /*  0 */ "Uninit",                        // Uninitialized system, state is unknown.
 /*  1 */ "Boot",                          // System is booting up.
 /*  2 */ "Calibrating",                   // System is calibrating and not flight-ready.
@@ -277,14 +314,23 @@ static const std::array<const std::string, 9> mav_state_strings{{
 /*  8 */ "Flight_Termination",            // System is terminating itself.
 }};
 
-std::string to_string(MAV_STATE e)
+const char *to_cstring(MAV_STATE e)
 {
 	size_t idx = enum_value(e);
 	if (idx >= mav_state_strings.size())
-		return std::to_string(idx);
+		return nullptr;
 
 	return mav_state_strings[idx];
 }
+
+std::string to_string(MAV_STATE e)
+{
+	const char *s = to_cstring(e);
+	if (s == nullptr)
+		return std::to_string(enum_value(e));
+
+	return s;
+}
 // [[[end]]] (checksum: 8af1e6916d0229c193aab7d3dc2c97e9)
 
 // [[[cog:
@@ -300,21 +346,30 @@ std::string to_string(MAV_STATE e)
 // to_string_outl(ename)
 // ]]]
 //! timesync_mode values
-static const std::array<const std::string, 4> timesync_mode_strings{{
+static constexpr std::array<const char *, 4> timesync_mode_strings{{
 /*  0 */ "NONE",
 /*  1 */ "MAVLINK",
 /*  2 */ "ONBOARD",
 /*  3 */ "PASSTHROUGH",
 }};
 
-std::string to_string(timesync_mode e)
+const char *to_cstring(timesync_mode e)
 {
 	size_t idx = enum_value(e);
 	if (idx >= timesync_mode_strings.size())
-		return std::to_string(idx);
+		return nullptr;
 
 	return timesync_mode_strings[idx];
 }
+
+std::string to_string(timesync_mode e)
+{
+	const char *s = to_cstring(e);
+	if (s == nullptr)
+		return std::to_string(enum_value(e));
+
+	return s;
+}
 // [[[end]]] (checksum: 2796eaa4f9361c2d7ca87f63e0401d4d)
 
 timesync_mode timesync_mode_from_str(const std::string &mode)
@@ -335,19 +390,28 @@ timesync_mode timesync_mode_from_str(const std::string &mode)
 // enum_name_is_value_outl(ename)
 // ]]]
 //! ADSB_ALTITUDE_TYPE values
-static const std::array<const std::string, 2> adsb_altitude_type_strings{{
+static constexpr std::array<const char *, 2> adsb_altitude_type_strings{{
 /*  0 */ "PRESSURE_QNH",                  // Altitude reported from a Baro source using QNH reference
 /*  1 */ "GEOMETRIC",                     // Altitude reported from a GNSS source
 }};
 
-std::string to_string(ADSB_ALTITUDE_TYPE e)
+const char *to_cstring(ADSB_ALTITUDE_TYPE e)
 {
 	size_t idx = enum_value(e);
 	if (idx >= adsb_altitude_type_strings.size())
-		return std::to_string(idx);
+		return nullptr;
 
 	return adsb_altitude_type_strings[idx];
 }
+
+std::string to_string(ADSB_ALTITUDE_TYPE e)
+{
+	const char *s = to_cstring(e);
+	if (s == nullptr)
+		return std::to_string(enum_value(e));
+
+	return s;
+}
 // [[[end]]] (checksum: dc127bf29aefa513471d13c5a0e1e6ec)
 
 // [[[cog:
@@ -355,7 +419,7 @@ std::string to_string(ADSB_ALTITUDE_TYPE e)
 // enum_name_is_value_outl(ename)
 // ]]]
 //! ADSB_EMITTER_TYPE values
-static const std::array<const std::string, 20> adsb_emitter_type_strings{{
+static constexpr std::array<const char *, 20> adsb_emitter_type_strings{{
 /*  0 */ "NO_INFO",
 /*  1 */ "LIGHT",
 /*  2 */ "SMALL",
@@ -378,14 +442,23 @@ static const std::array<const std::string, 20> adsb_emitter_type_strings{{
 /* 19 */ "POINT_OBSTACLE",
 }};
 
-std::string to_string(ADSB_EMITTER_TYPE e)
+const char *to_cstring(ADSB_EMITTER_TYPE e)
 {
 	size_t idx = enum_value(e);
 	if (idx >= adsb_emitter_type_strings.size())
-		return std::to_string(idx);
+		return nullptr;
 
 	return adsb_emitter_type_strings[idx];
 }
+
+std::string to_string(ADSB_EMITTER_TYPE e)
+{
+	const char *s = to_cstring(e);
+	if (s == nullptr)
+		return std::to_string(enum_value(e));
+
+	return s;
+}
 // [[[end]]] (checksum: 713e0304603321e421131d8552d0f8e0)
 
 // [[[cog:
@@ -393,7 +466,7 @@ std::string to_string(ADSB_EMITTER_TYPE e)
 // enum_name_is_value_outl(ename)
 // ]]]
 //! MAV_ESTIMATOR_TYPE values
-static const std::array<const std::string, 5> mav_estimator_type_strings{{
+static constexpr std::array<const char *, 5> mav_estimator_type_strings{{
 /*  1 */ "NAIVE",                         // This is a naive estimator without any real covariance feedback.
 /*  2 */ "VISION",                        // Computer vision based estimate. Might be up to scale.
 /*  3 */ "VIO",                           // Visual-inertial estimate.
@@ -401,14 +474,23 @@ static const std::array<const std::string, 5> mav_estimator_type_strings{{
 /*  5 */ "GPS_INS",                       // Estimator integrating GPS and inertial sensing.
 }};
 
-std::string to_string(MAV_ESTIMATOR_TYPE e)
+const char *to_cstring(MAV_ESTIMATOR_TYPE e)
 {
 	size_t idx = enum_value(e);
 	if (idx >= mav_estimator_type_strings.size())
-		return std::to_string(idx);
+		return nullptr;
 
 	return mav_estimator_type_strings[idx];
 }
+
+std::string to_string(MAV_ESTIMATOR_TYPE e)
+{
+	const char *s = to_cstring(e);
+	if (s == nullptr)
+		return std::to_string(enum_value(e));
+
+	return s;
+}
 // [[[end]]] (checksum: 47674f004bf6c515fdf999987b99e806)
 
 // [[[cog:
@@ -416,7 +498,7 @@ std::string to_string(MAV_ESTIMATOR_TYPE e)
 // enum_name_is_value_outl(ename)
 // ]]]
 //! GPS_FIX_TYPE values
-static const std::array<const std::string, 9> gps_fix_type_strings{{
+static constexpr std::array<const char *, 9> gps_fix_type_strings{{
 /*  0 */ "NO_GPS",                        // No GPS connected
 /*  1 */ "NO_FIX",                        // No position information, GPS is connected
 /*  2 */ "2D_FIX",                        // 2D position
@@ -428,14 +510,23 @@ static const std::array<const std::string, 9> gps_fix_type_strings{{
 /*  8 */ "PPP",                           // PPP, 3D position.
 }};
 
-std::string to_string(GPS_FIX_TYPE e)
+const char *to_cstring(GPS_FIX_TYPE e)
 {
 	size_t idx = enum_value(e);
 	if (idx >= gps_fix_type_strings.size())
-		return std::to_string(idx);
+		return nullptr;
 
 	return gps_fix_type_strings[idx];
 }
+
+std::string to_string(GPS_FIX_TYPE e)
+{
+	const char *s = to_cstring(e);
+	if (s == nullptr)
+		return std::to_string(enum_value(e));
+
+	return s;
+}
 // [[[end]]] (checksum: 7569b73b2d68ed1412bf0c36afeb131c)
 
 // [[[cog:
@@ -453,7 +544,7 @@ std::string to_string(GPS_FIX_TYPE e)
 // to_string_outl(ename)
 // ]]]
 //! MAV_MISSION_RESULT values
-static const std::array<const std::string, 16> mav_mission_result_strings{{
+static constexpr std::array<const char *, 16> mav_mission_result_strings{{
 /*  0 */ "mission accepted OK",           // mission accepted OK
 /*  1 */ "Generic error / not accepting mission commands at all right now.", // Generic error / not accepting mission commands at all right now.
 /*  2 */ "Coordinate frame is not supported.", // Coordinate frame is not supported.
@@ -472,14 +563,23 @@ static const std::array<const std::string, 16> mav_mission_result_strings{{
 /* 15 */ "Current mission operation cancelled (e.g. mission upload, mission download).", // Current mission operation cancelled (e.g. mission upload, mission download).
 }};
 
-std::string to_string(MAV_MISSION_RESULT e)
+const char *to_cstring(MAV_MISSION_RESULT e)
 {
 	size_t idx = enum_value(e);
 	if (idx >= mav_mission_result_strings.size())
-		return std::to_string(idx);
+		return nullptr;
 
 	return mav_mission_result_strings[idx];
 }
+
+std::string to_string(MAV_MISSION_RESULT e)
+{
+	const char *s = to_cstring(e);
+	if (s == nullptr)
+		return std::to_string(enum_value(e));
+
+	return s;
+}
 // [[[end]]] (checksum: d42db24957df1950d06edbf9480dde46)
 
 // [[[cog:
@@ -487,7 +587,7 @@ std::string to_string(MAV_MISSION_RESULT e)
 // enum_name_is_value_outl(ename)
 // ]]]
 //! MAV_FRAME values
-static const std::array<const std::string, 20> mav_frame_strings{{
+static constexpr std::array<const char *, 20> mav_frame_strings{{
 /*  0 */ "GLOBAL",                        // Global (WGS84) coordinate frame + MSL altitude. First value / x: latitude, second value / y: longitude, third value / z: positive altitude over mean sea level (MSL).
 /*  1 */ "LOCAL_NED",                     // Local coordinate frame, Z-down (x: north, y: east, z: down).
 /*  2 */ "MISSION",                       // NOT a coordinate frame, indicates a mission command.
@@ -510,14 +610,23 @@ static const std::array<const std::string, 20> mav_frame_strings{{
 /* 19 */ "ESTIM_ENU",                     // Odometry local coordinate frame of data given by an estimator running onboard the vehicle, Z-up (x: east, y: noth, z: up).
 }};
 
-std::string to_string(MAV_FRAME e)
+const char *to_cstring(MAV_FRAME e)
 {
 	size_t idx = enum_value(e);
 	if (idx >= mav_frame_strings.size())
-		return std::to_string(idx);
+		return nullptr;
 
 	return mav_frame_strings[idx];
 }
+
+std::string to_string(MAV_FRAME e)
+{
+	const char *s = to_cstring(e);
+	if (s == nullptr)
+		return std::to_string(enum_value(e));
+
+	return s;
+}
 // [[[end]]] (checksum: a075e35372e9be53a3a0ce79e45236c1)
 
 // [[[cog:
@@ -525,7 +634,7 @@ std::string to_string(MAV_FRAME e)
 // suffix = 'MAV_COMP_ID'
 // enum = get_enum(ename)
 //
-// cog.outl(f"static const std::unordered_map<size_t, const std::string> {suffix.lower()}_strings{{{{")
+// cog.outl(f"static const std::unordered_map<size_t, const char *> {suffix.lower()}_strings{{{{")
 // for k, e in enum:
 //     name_short =  e.name[len(suffix) + 1:]
 //     sp = make_whitespace(30, name_short)
@@ -536,7 +645,7 @@ std::string to_string(MAV_FRAME e)
 //
 // cog.outl("}};")
 // ]]]
-static const std::unordered_map<size_t, const std::string> mav_comp_id_strings{{
+static const std::unordered_map<size_t, const char *> mav_comp_id_strings{{
 {   0, "ALL" },                           // Used to broadcast messages to all components of the receiving system. Components should attempt to process messages with this component ID and forward to components on any other interfaces.
 {   1, "AUTOPILOT1" },                    // System flight controller component ("autopilot"). Only one autopilot is expected in a particular system.
 { 100, "CAMERA" },                        // Camera #1.
@@ -581,17 +690,26 @@ static const std::unordered_map<size_t, const std::string> mav_comp_id_strings{{
 }};
 // [[[end]]] (checksum: 794ea890a87beb831d74eb2920000ea9)
 
-std::string to_string(MAV_COMPONENT e)
+const char *to_cstring(MAV_COMPONENT e)
 {
 	size_t idx = enum_value(e);
 	auto it = mav_comp_id_strings.find(idx);
 
 	if (it == mav_comp_id_strings.end())
-		return std::to_string(idx);
+		return nullptr;
 
 	return it->second;
 }
 
+std::string to_string(MAV_COMPONENT e)
+{
+	const char *s = to_cstring(e);
+	if (s == nullptr)
+		return std::to_string(enum_value(e));
+
+	return s;
+}
+
 MAV_FRAME mav_frame_from_str(const std::string &mav_frame)
 {
 	for (size_t idx = 0; idx < mav_frame_strings.size(); idx++) {
@@ -622,7 +740,7 @@ MAV_TYPE mav_type_from_str(const std::string &mav_type)
 // enum_name_is_value_outl(ename)
 // ]]]
 //! MAV_DISTANCE_SENSOR values
-static const std::array<const std::string, 5> mav_distance_sensor_strings{{
+static constexpr std::array<const char *, 5> mav_distance_sensor_strings{{
 /*  0 */ "LASER",                         // Laser rangefinder, e.g. LightWare SF02/F or PulsedLight units
 /*  1 */ "ULTRASOUND",                    // Ultrasound rangefinder, e.g. MaxBotix units
 /*  2 */ "INFRARED",                      // Infrared rangefinder, e.g. Sharp units
@@ -630,14 +748,23 @@ static const std::array<const std::string, 5> mav_distance_sensor_strings{{
 /*  4 */ "UNKNOWN",                       // Broken or unknown type, e.g. analog units
 }};
 
-std::string to_string(MAV_DISTANCE_SENSOR e)
+const char *to_cstring(MAV_DISTANCE_SENSOR e)
 {
 	size_t idx = enum_value(e);
 	if (idx >= mav_distance_sensor_strings.size())
-		return std::to_string(idx);
+		return nullptr;
 
 	return mav_distance_sensor_strings[idx];
 }
+
+std::string to_string(MAV_DISTANCE_SENSOR e)
+{
+	const char *s = to_cstring(e);
+	if (s == nullptr)
+		return std::to_string(enum_value(e));
+
+	return s;
+}
 // [[[end]]] (checksum: 3f792ad01cdb3f2315a8907f578ab5b3)
 
 // [[[cog:
@@ -645,21 +772,30 @@ std::string to_string(MAV_DISTANCE_SENSOR e)
 // enum_name_is_value_outl(ename)
 // ]]]
 //! LANDING_TARGET_TYPE values
-static const std::array<const std::string, 4> landing_target_type_strings{{
+static constexpr std::array<const char *, 4> landing_target_type_strings{{
 /*  0 */ "LIGHT_BEACON",                  // Landing target signaled by light beacon (ex: IR-LOCK)
 /*  1 */ "RADIO_BEACON",                  // Landing target signaled by radio beacon (ex: ILS, NDB)
 /*  2 */ "VISION_FIDUCIAL",               // Landing target represented by a fiducial marker (ex: ARTag)
 /*  3 */ "VISION_OTHER",                  // Landing target represented by a pre-defined visual shape/feature (ex: X-marker, H-marker, square)
 }};
 
-std::string to_string(LANDING_TARGET_TYPE e)
+const char *to_cstring(LANDING_TARGET_TYPE e)
 {
 	size_t idx = enum_value(e);
 	if (idx >= landing_target_type_strings.size())
-		return std::to_string(idx);
+		return nullptr;
 
 	return landing_target_type_strings[idx];
 }
+
+std::string to_string(LANDING_TARGET_TYPE e)
+{
+	const char *s = to_cstring(e);
+	if (s == nullptr)
+		return std::to_string(enum_value(e));
+
+	return s;
+}
 // [[[end]]] (checksum: a42789c10cbebd5bc253abca2a07289b)
 
 LANDING_TARGET_TYPE landing_target_type_from_str(const std::string &landing_target_type)
@@ -70,6 +70,39 @@ static const Eigen::DiagonalMatrix<double,3> NED_ENU_REFLECTION_Z(1,1,-1);
 using Matrix6d = Eigen::Matrix<double, 6, 6>;
 using Matrix9d = Eigen::Matrix<double, 9, 9>;
 
+/**
+ * @brief Axis permutation / sign tables matching NED_ENU_REFLECTION_XY/_Z
+ * and AIRCRAFT_BASELINK_R, for the covariance permutation kernel.
+ */
+static const std::array<int, 3> NED_ENU_PERM = {{1, 0, 2}};
+static const std::array<int, 3> NED_ENU_SIGN = {{1, 1, -1}};
+static const std::array<int, 3> AIRCRAFT_BASELINK_PERM = {{0, 1, 2}};
+static const std::array<int, 3> AIRCRAFT_BASELINK_SIGN = {{1, -1, -1}};
+
+/**
+ * @brief Apply a constant axis permutation with sign flips to a covariance
+ * matrix built of 3x3 blocks.
+ *
+ * Equivalent to R * C * R^T where R is block-diagonal with the same signed
+ * 3x3 permutation in every block, but reduces to an element shuffle:
+ * out(i,j) = s_i * s_j * in(p_i, p_j). No matrix products needed since
+ * the static rotations are plain axis permutations.
+ */
+template<typename MapOut, typename MapIn>
+static void permute_covariance(MapOut cov_out, const MapIn cov_in,
+		const std::array<int, 3> &perm, const std::array<int, 3> &sign)
+{
+	const int n = cov_in.rows();
+
+	for (int i = 0; i < n; i++) {
+		const int pi = (i / 3) * 3 + perm[i % 3];
+		for (int j = 0; j < n; j++) {
+			const int pj = (j / 3) * 3 + perm[j % 3];
+			cov_out(i, j) = sign[i % 3] * sign[j % 3] * cov_in(pi, pj);
+		}
+	}
+}
+
 
 Eigen::Quaterniond transform_orientation(const Eigen::Quaterniond &q, const StaticTF transform)
 {
@@ -101,6 +134,19 @@ Eigen::Vector3d transform_static_frame(const Eigen::Vector3d &vec, const StaticT
 	}
 }
 
+Points3d transform_static_frame(const Points3d &points, const StaticTF transform)
+{
+	switch (transform) {
+	case StaticTF::NED_TO_ENU:
+	case StaticTF::ENU_TO_NED:
+		return NED_ENU_REFLECTION_XY * (NED_ENU_REFLECTION_Z * points);
+
+	case StaticTF::AIRCRAFT_TO_BASELINK:
+	case StaticTF::BASELINK_TO_AIRCRAFT:
+		return AIRCRAFT_BASELINK_R * points;
+	}
+}
+
 Covariance3d transform_static_frame(const Covariance3d &cov, const StaticTF transform)
 {
 	Covariance3d cov_out_;
@@ -110,8 +156,7 @@ Covariance3d transform_static_frame(const Covariance3d &cov, const StaticTF tran
 	switch (transform) {
 	case StaticTF::NED_TO_ENU:
 	case StaticTF::ENU_TO_NED:
-		cov_out = NED_ENU_REFLECTION_XY * (NED_ENU_REFLECTION_Z * cov_in * NED_ENU_REFLECTION_Z) *
-		          NED_ENU_REFLECTION_XY.transpose();
+		permute_covariance(cov_out, cov_in, NED_ENU_PERM, NED_ENU_SIGN);
 		return cov_out_;
 
 	case StaticTF::AIRCRAFT_TO_BASELINK:
@@ -124,7 +169,6 @@ Covariance3d transform_static_frame(const Covariance3d &cov, const StaticTF tran
 Covariance6d transform_static_frame(const Covariance6d &cov, const StaticTF transform)
 {
 	Covariance6d cov_out_;
-	Matrix6d R = Matrix6d::Zero();	// not `auto` because Zero ret is const
 
 	EigenMapConstCovariance6d cov_in(cov.data());
 	EigenMapCovariance6d cov_out(cov_out_.data());
@@ -132,22 +176,12 @@ Covariance6d transform_static_frame(const Covariance6d &cov, const StaticTF tran
 	switch (transform) {
 	case StaticTF::NED_TO_ENU:
 	case StaticTF::ENU_TO_NED:
-	{
-		Eigen::PermutationMatrix<6> NED_ENU_REFLECTION_XY_6 (NED_ENU_REFLECTION_XY.indices().replicate<2,1>());
-		NED_ENU_REFLECTION_XY_6.indices().middleRows<3>(3).array() += 3;
-		Eigen::DiagonalMatrix<double,6> NED_ENU_REFLECTION_Z_6(NED_ENU_REFLECTION_Z.diagonal().replicate<2,1>());
-
-		cov_out = NED_ENU_REFLECTION_XY_6 * (NED_ENU_REFLECTION_Z_6 * cov_in * NED_ENU_REFLECTION_Z_6) *
-		          NED_ENU_REFLECTION_XY_6.transpose();
-
+		permute_covariance(cov_out, cov_in, NED_ENU_PERM, NED_ENU_SIGN);
 		return cov_out_;
-        }
+
 	case StaticTF::AIRCRAFT_TO_BASELINK:
 	case StaticTF::BASELINK_TO_AIRCRAFT:
-		R.block<3, 3>(0, 0) =
-			R.block<3, 3>(3, 3) = AIRCRAFT_BASELINK_R;
-
-		cov_out = R * cov_in * R.transpose();
+		permute_covariance(cov_out, cov_in, AIRCRAFT_BASELINK_PERM, AIRCRAFT_BASELINK_SIGN);
 		return cov_out_;
 	}
 }
@@ -155,7 +189,6 @@ Covariance6d transform_static_frame(const Covariance6d &cov, const StaticTF tran
 Covariance9d transform_static_frame(const Covariance9d &cov, const StaticTF transform)
 {
 	Covariance9d cov_out_;
-	Matrix9d R = Matrix9d::Zero();
 
 	EigenMapConstCovariance9d cov_in(cov.data());
 	EigenMapCovariance9d cov_out(cov_out_.data());
@@ -163,24 +196,12 @@ Covariance9d transform_static_frame(const Covariance9d &cov, const StaticTF tran
 	switch (transform) {
 	case StaticTF::NED_TO_ENU:
 	case StaticTF::ENU_TO_NED:
-	{
-		Eigen::PermutationMatrix<9> NED_ENU_REFLECTION_XY_9 (NED_ENU_REFLECTION_XY.indices().replicate<3,1>());
-		NED_ENU_REFLECTION_XY_9.indices().middleRows<3>(3).array() += 3;
-		NED_ENU_REFLECTION_XY_9.indices().middleRows<3>(6).array() += 6;
-		Eigen::DiagonalMatrix<double,9> NED_ENU_REFLECTION_Z_9(NED_ENU_REFLECTION_Z.diagonal().replicate<3,1>());
-
-		cov_out = NED_ENU_REFLECTION_XY_9 * (NED_ENU_REFLECTION_Z_9 * cov_in * NED_ENU_REFLECTION_Z_9) *
-		          NED_ENU_REFLECTION_XY_9.transpose();
-
+		permute_covariance(cov_out, cov_in, NED_ENU_PERM, NED_ENU_SIGN);
 		return cov_out_;
-        }
+
 	case StaticTF::AIRCRAFT_TO_BASELINK:
 	case StaticTF::BASELINK_TO_AIRCRAFT:
-		R.block<3, 3>(0, 0) =
-			R.block<3, 3>(3, 3) =
-				R.block<3, 3>(6, 6) = AIRCRAFT_BASELINK_R;
-
-		cov_out = R * cov_in * R.transpose();
+		permute_covariance(cov_out, cov_in, AIRCRAFT_BASELINK_PERM, AIRCRAFT_BASELINK_SIGN);
 		return cov_out_;
 	}
 }
@@ -232,6 +253,11 @@ Eigen::Vector3d transform_frame(const Eigen::Vector3d &vec, const Eigen::Quatern
 	return transformation * vec;
 }
 
+Points3d transform_frame(const Points3d &points, const Eigen::Quaterniond &q)
+{
+	return q.normalized().toRotationMatrix() * points;
+}
+
 Covariance3d transform_frame(const Covariance3d &cov, const Eigen::Quaterniond &q)
 {
 	Covariance3d cov_out_;
@@ -0,0 +1,140 @@
+/**
+ * @brief Memory-mapped geoid dataset
+ * @file geoid_mmap.cpp
+ * @author Vladimir Ermakov <vooon341@gmail.com>
+ */
+/*
+ * Copyright 2014,2015,2016 Vladimir Ermakov.
+ *
+ * This file is part of the mavros package and subject to the license terms
+ * in the top-level LICENSE file of the mavros repository.
+ * https://github.com/mavlink/mavros/tree/master/LICENSE.md
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <GeographicLib/Geoid.hpp>
+#include <mavros/geoid_mmap.h>
+
+using namespace mavros;
+
+GeoidMmap::GeoidMmap(const std::string &name, const std::string &path) :
+	map_data(nullptr),
+	map_size(0),
+	raster(nullptr),
+	width(0),
+	height(0),
+	offset(0.0),
+	scale(1.0)
+{
+	std::string dir = path;
+	if (dir.empty()) {
+		const char *env = std::getenv("GEOGRAPHICLIB_GEOID_PATH");
+		dir = (env != nullptr) ? env : GeographicLib::Geoid::DefaultGeoidPath();
+	}
+
+	std::string file = dir + "/" + name + ".pgm";
+
+	int fd = ::open(file.c_str(), O_RDONLY);
+	if (fd < 0)
+		throw std::runtime_error("geoid: open " + file + ": " + std::strerror(errno));
+
+	struct stat st;
+	if (::fstat(fd, &st) < 0) {
+		::close(fd);
+		throw std::runtime_error("geoid: stat " + file + ": " + std::strerror(errno));
+	}
+
+	map_size = st.st_size;
+	map_data = static_cast<const uint8_t *>(::mmap(nullptr, map_size, PROT_READ, MAP_PRIVATE, fd, 0));
+	::close(fd);	// mapping holds its own reference
+	if (map_data == MAP_FAILED) {
+		map_data = nullptr;
+		throw std::runtime_error("geoid: mmap " + file + ": " + std::strerror(errno));
+	}
+
+	// parse the PGM header: magic, comments carrying Offset/Scale,
+	// width, height, maxval; binary raster follows the final newline
+	std::istringstream hdr(std::string(reinterpret_cast<const char *>(map_data),
+			std::min(map_size, size_t(4096))));
+
+	std::string magic;
+	hdr >> magic;
+	if (magic != "P5")
+		throw std::runtime_error("geoid: " + file + ": not a PGM file");
+
+	bool offset_seen = false, scale_seen = false;
+	size_t maxval = 0;
+	std::string token;
+	while (hdr >> token) {
+		if (token == "#") {
+			std::string key;
+			hdr >> key;
+			if (key == "Offset") {
+				hdr >> offset;
+				offset_seen = true;
+			}
+			else if (key == "Scale") {
+				hdr >> scale;
+				scale_seen = true;
+			}
+			hdr.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+		}
+		else {
+			// width height maxval terminate the header
+			width = std::stoul(token);
+			hdr >> height >> maxval;
+			hdr.ignore(1);	// single whitespace before the raster
+			break;
+		}
+	}
+
+	size_t data_offset = hdr.tellg();
+	if (width < 2 || height < 2 || maxval != 65535 || !offset_seen || !scale_seen ||
+			data_offset == size_t(-1) ||
+			map_size < data_offset + 2 * width * height)
+		throw std::runtime_error("geoid: " + file + ": malformed header");
+
+	raster = map_data + data_offset;
+	rlonres = width / 360.0;
+	rlatres = (height - 1) / 180.0;
+}
+
+GeoidMmap::~GeoidMmap()
+{
+	if (map_data != nullptr)
+		::munmap(const_cast<uint8_t *>(map_data), map_size);
+}
+
+double GeoidMmap::operator()(double lat, double lon) const
+{
+	if (lon < 0.0)
+		lon += 360.0;
+
+	// grid cell and fractional position, row 0 is 90N, column 0 is 0E
+	double fy = (90.0 - lat) * rlatres;
+	double fx = lon * rlonres;
+
+	size_t iy = std::min(size_t(std::max(fy, 0.0)), height - 2);
+	size_t ix = std::min(size_t(std::max(fx, 0.0)), width - 1);
+	fy -= iy;
+	fx -= ix;
+
+	size_t ix1 = (ix + 1 < width) ? ix + 1 : 0;	// longitude wraps
+
+	double v0 = (1.0 - fx) * raw(ix, iy) + fx * raw(ix1, iy);
+	double v1 = (1.0 - fx) * raw(ix, iy + 1) + fx * raw(ix1, iy + 1);
+
+	return offset + scale * ((1.0 - fy) * v0 + fy * v1);
+}
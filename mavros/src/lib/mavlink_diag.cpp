@@ -11,6 +11,9 @@
  * https://github.com/mavlink/mavros/tree/master/LICENSE.md
  */
 
+#include <algorithm>
+
+#include <mavros/utils.h>
 #include <mavros/mavlink_diag.h>
 
 using namespace mavros;
@@ -39,6 +42,22 @@ void MavlinkDiag::run(diagnostic_updater::DiagnosticStatusWrapper &stat)
 		stat.addf("Rx speed:", "%f", iostat.rx_speed);
 		stat.addf("Tx speed:", "%f", iostat.tx_speed);
 
+		// top bandwidth consumers by message id
+		auto msg_stats = link->get_msg_stats();
+		std::sort(msg_stats.begin(), msg_stats.end(),
+			[](const mavconn::MAVConnInterface::MsgStat &a, const mavconn::MAVConnInterface::MsgStat &b) {
+				return a.rx_bytes + a.tx_bytes > b.rx_bytes + b.tx_bytes;
+			});
+
+		size_t top = std::min<size_t>(msg_stats.size(), 10);
+		for (size_t i = 0; i < top; i++) {
+			auto &ms = msg_stats[i];
+			stat.addf(utils::format("Msg #%u", ms.msgid),
+				"rx: %u msgs / %llu bytes, tx: %u msgs / %llu bytes",
+				ms.rx_count, (unsigned long long)ms.rx_bytes,
+				ms.tx_count, (unsigned long long)ms.tx_bytes);
+		}
+
 		if (mav_status.packet_rx_drop_count > last_drop_count)
 			stat.summaryf(1, "%d packeges dropped since last report",
 				mav_status.packet_rx_drop_count - last_drop_count);
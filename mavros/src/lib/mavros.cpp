@@ -11,8 +11,17 @@
  * https://github.com/mavlink/mavros/tree/master/LICENSE.md
  */
 
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <map>
+
 #include <ros/console.h>
+#include <diagnostic_msgs/DiagnosticArray.h>
 #include <mavros/mavros.h>
+#include <mavconn/reactor.h>
+#include <mavconn/thread_utils.h>
+#include <mavros/plugin_registry.h>
 #include <mavros/utils.h>
 #include <fnmatch.h>
 
@@ -29,12 +38,14 @@ using utils::enum_value;
 
 
 MavRos::MavRos() :
-	mavlink_nh("mavlink"),		// allow to namespace it
 	fcu_link_diag("FCU connection"),
 	gcs_link_diag("GCS bridge"),
 	plugin_loader("mavros", "mavros::plugin::PluginBase"),
 	last_message_received_from_gcs(0),
-	plugin_subscriptions{}
+	plugin_profiling(false),
+	governor_burst(1),
+	rx_sleeping(false),
+	rx_should_exit(false)
 {
 	std::string fcu_url, gcs_url;
 	std::string fcu_protocol;
@@ -42,7 +53,9 @@ MavRos::MavRos() :
 	int tgt_system_id, tgt_component_id;
 	bool px4_usb_quirk;
 	double conn_timeout_d;
+	int conn_rt_priority, conn_cpu_affinity;
 	ros::V_string plugin_blacklist{}, plugin_whitelist{};
+	std::vector<int> extra_sysids{};
 	MAVConnInterface::Ptr fcu_link;
 
 	ros::NodeHandle nh("~");
@@ -50,21 +63,85 @@ MavRos::MavRos() :
 	nh.param<std::string>("fcu_url", fcu_url, "serial:///dev/ttyACM0");
 	nh.param<std::string>("gcs_url", gcs_url, "udp://@");
 	nh.param<bool>("gcs_quiet_mode", gcs_quiet_mode, false);
+	nh.param<bool>("lazy_init_plugins", lazy_init_plugins, false);
 	nh.param("conn/timeout", conn_timeout_d, 30.0);
 
 	nh.param<std::string>("fcu_protocol", fcu_protocol, "v2.0");
+	nh.param("conn/rt_priority", conn_rt_priority, 0);
+	nh.param("conn/cpu_affinity", conn_cpu_affinity, 0);
 	nh.param("system_id", system_id, 1);
 	nh.param<int>("component_id", component_id, mavconn::MAV_COMP_ID_UDP_BRIDGE);
 	nh.param("target_system_id", tgt_system_id, 1);
 	nh.param("target_component_id", tgt_component_id, 1);
 	nh.param("startup_px4_usb_quirk", px4_usb_quirk, false);
+	{
+		bool profiling;
+		nh.param("plugin_profiling", profiling, false);
+		plugin_profiling = profiling;
+	}
 	nh.getParam("plugin_blacklist", plugin_blacklist);
 	nh.getParam("plugin_whitelist", plugin_whitelist);
 
+	// native tlog recorder, cheaper than rosbagging mavlink/from
+	{
+		std::string record_path;
+		int record_segment_mb;
+		nh.param<std::string>("record/path", record_path, "");
+		nh.param("record/segment_size_mb", record_segment_mb, 64);
+
+		if (!record_path.empty()) {
+			try {
+				recorder.reset(new TelemetryRecorder(record_path, record_segment_mb));
+			}
+			catch (std::runtime_error &ex) {
+				ROS_ERROR("REC: %s, recording disabled", ex.what());
+			}
+		}
+	}
+
+	// Additional vehicles hosted by this node: every listed sysid
+	// gets its own UAS and plugin set under "uasN/", demultiplexed
+	// from the shared FCU link by source sysid. The io reactor, rx
+	// thread, spinner pools and plugin .so mapping stay shared.
+	nh.getParam("multi_uas/sysids", extra_sysids);
+
 	conn_timeout = ros::Duration(conn_timeout_d);
 
+	// primary vehicle keeps the classic single-UAS namespace layout
+	vehicles.emplace_back(new Vehicle(""));
+	auto &primary = *vehicles.front();
+
+	primary.uas.set_tgt(tgt_system_id, tgt_component_id);
+
+	for (int sysid : extra_sysids) {
+		if (sysid < 1 || sysid > 255 || sysid == tgt_system_id) {
+			ROS_WARN("multi_uas: ignoring invalid or duplicate sysid %d", sysid);
+			continue;
+		}
+
+		vehicles.emplace_back(new Vehicle(utils::format("uas%d/", sysid)));
+		auto &veh = *vehicles.back();
+
+		veh.uas.set_tgt(sysid, tgt_component_id);
+		// one spinner pool set per service class for the whole node
+		veh.uas.share_cb_queues(primary.uas);
+	}
+
+	// route unknown sysids (GCS heartbeats seen on the FCU link,
+	// broadcast components) to the primary, as a single-UAS node did
+	sysid_route.fill(&primary);
+	for (auto &veh : vehicles)
+		sysid_route[veh->uas.get_tgt_system()] = veh.get();
+
 	// Now we use FCU URL as a hardware Id
-	UAS_DIAG(&mav_uas).setHardwareID(fcu_url);
+	for (auto &veh : vehicles)
+		UAS_DIAG(&veh->uas).setHardwareID(fcu_url);
+
+	// io worker scheduling must be set before the first link starts the reactor
+	if (conn_rt_priority > 0)
+		mavconn::IOReactor::set_rt_priority(conn_rt_priority);
+	if (conn_cpu_affinity != 0)
+		mavconn::IOReactor::set_cpu_affinity(conn_cpu_affinity);
 
 	ROS_INFO_STREAM("FCU URL: " << fcu_url);
 	try {
@@ -74,7 +151,7 @@ MavRos::MavRos() :
 		component_id = fcu_link->get_component_id();
 
 		fcu_link_diag.set_mavconn(fcu_link);
-		UAS_DIAG(&mav_uas).add(fcu_link_diag);
+		UAS_DIAG(&primary.uas).add(fcu_link_diag);
 	}
 	catch (mavconn::DeviceError &ex) {
 		ROS_FATAL("FCU: %s", ex.what());
@@ -114,44 +191,26 @@ MavRos::MavRos() :
 	else
 		ROS_INFO("GCS bridge disabled");
 
-	// ROS mavlink bridge
-	mavlink_pub = mavlink_nh.advertise<mavros_msgs::Mavlink>("from", 100);
-	mavlink_sub = mavlink_nh.subscribe("to", 100, &MavRos::mavlink_sub_cb, this,
-		ros::TransportHints()
-			.unreliable().maxDatagramSize(1024)
-			.reliable());
-
-	// setup UAS and diag
-	mav_uas.set_tgt(tgt_system_id, tgt_component_id);
-	UAS_FCU(&mav_uas) = fcu_link;
-
-	mav_uas.add_connection_change_handler(std::bind(&MavlinkDiag::set_connection_status, &fcu_link_diag, std::placeholders::_1));
-	mav_uas.add_connection_change_handler(std::bind(&MavRos::log_connect_change, this, std::placeholders::_1));
-
 	// prepare plugin lists
 	// issue #257 2: assume that all plugins blacklisted
 	if (plugin_blacklist.empty() and !plugin_whitelist.empty())
 		plugin_blacklist.emplace_back("*");
 
-	for (auto &name : plugin_loader.getDeclaredClasses())
-		add_plugin(name, plugin_blacklist, plugin_whitelist);
+	// fcu link diag reflects the shared link, report it on the primary
+	primary.uas.add_connection_change_handler(std::bind(&MavlinkDiag::set_connection_status, &fcu_link_diag, std::placeholders::_1));
+
+	for (auto &veh : vehicles) {
+		UAS_FCU(&veh->uas) = fcu_link;
+		setup_vehicle(*veh, plugin_blacklist, plugin_whitelist);
+	}
 
 	// connect FCU link
 
-	// XXX TODO: move workers to ROS Spinner, let mavconn threads to do only IO
-	fcu_link->message_received_cb = [this](const mavlink_message_t *msg, const Framing framing) {
-		mavlink_pub_cb(msg, framing);
-		plugin_route_cb(msg, framing);
-
-		if (gcs_link) {
-			if (this->gcs_quiet_mode && msg->msgid != mavlink::common::msg::HEARTBEAT::MSG_ID &&
-				(ros::Time::now() - this->last_message_received_from_gcs > this->conn_timeout)) {
-				return;
-			}
-
-			gcs_link->send_message_ignore_drop(msg);
-		}
-	};
+	// publishing and plugin handlers run on rx_thread; the mavconn
+	// io thread only copies the frame into the handoff queue
+	rx_thread = std::thread(&MavRos::rx_worker, this);
+	fcu_link->message_received_cb = std::bind(&MavRos::fcu_message_cb, this,
+		std::placeholders::_1, std::placeholders::_2);
 
 	fcu_link->port_closed_cb = []() {
 		ROS_ERROR("FCU connection closed, mavros will be terminated.");
@@ -181,16 +240,126 @@ MavRos::MavRos() :
 	ROS_INFO("MAVROS started. MY ID %u.%u, TARGET ID %u.%u",
 		system_id, component_id,
 		tgt_system_id, tgt_component_id);
+	if (vehicles.size() > 1)
+		ROS_INFO("MAVROS hosts %zu vehicles on one FCU link", vehicles.size());
+}
+
+void MavRos::setup_vehicle(Vehicle &veh, ros::V_string &blacklist, ros::V_string &whitelist)
+{
+	// ROS mavlink bridge of this vehicle
+	veh.mavlink_pub = veh.mavlink_nh.advertise<mavros_msgs::Mavlink>("from", 100);
+	veh.mavlink_sub = veh.mavlink_nh.subscribe("to", 100, &MavRos::mavlink_sub_cb, this,
+		ros::TransportHints()
+			.unreliable().maxDatagramSize(1024)
+			.reliable());
+
+	veh.uas.add_connection_change_handler(std::bind(&MavRos::log_connect_change, this, std::ref(veh), std::placeholders::_1));
+
+	// all plugin NodeHandles constructed below resolve under this
+	// vehicle's namespace prefix
+	PluginBase::set_vehicle_ns(veh.ns);
+
+	// statically linked plugins take precedence over pluginlib: a
+	// binary built with MAVROS_STATIC_PLUGINS never touches dlopen
+	auto &static_registry = plugin::PluginRegistry::instance();
+	ros::V_string plugin_names = (!static_registry.empty()) ?
+		static_registry.names() :
+		plugin_loader.getDeclaredClasses();
+
+	if (!static_registry.empty())
+		ROS_INFO("Using %zu statically linked plugins", plugin_names.size());
+
+	// Startup is dominated by the initialize() advertisement bursts,
+	// which roscpp happily takes from several threads. Plugin
+	// construction and the subscription merge stay serialized on
+	// plugin_setup_mutex; the dispatch table is built below, after
+	// every worker has joined.
+	int init_threads;
+	ros::NodeHandle nh("~");
+	nh.param("startup/init_threads", init_threads,
+		int(std::min(4u, std::max(1u, std::thread::hardware_concurrency()))));
+
+	if (init_threads <= 1) {
+		for (auto &name : plugin_names)
+			add_plugin(veh, name, blacklist, whitelist);
+	}
+	else {
+		std::atomic<size_t> next_plugin {0};
+		std::vector<std::thread> pool;
+
+		for (int i = 0; i < init_threads; i++) {
+			pool.emplace_back([&]() {
+				mavconn::utils::set_this_thread_name("mav-init");
+				for (size_t idx; (idx = next_plugin.fetch_add(1)) < plugin_names.size(); )
+					add_plugin(veh, plugin_names[idx], blacklist, whitelist);
+			});
+		}
+
+		for (auto &worker : pool)
+			worker.join();
+	}
+
+	PluginBase::set_vehicle_ns("");
+
+	// subscriptions are frozen now; build the flat dispatch table
+	// used by plugin_route_cb before the first message can arrive
+	build_dispatch_table(veh);
+
+	veh.profile_last_update = ros::Time::now();
+	auto veh_ptr = &veh;
+	UAS_DIAG(&veh.uas).add("mavros dispatch",
+		[this, veh_ptr](diagnostic_updater::DiagnosticStatusWrapper &stat) {
+			dispatch_diag_run(*veh_ptr, stat);
+		});
+}
+
+MavRos::~MavRos()
+{
+	if (rx_thread.joinable()) {
+		{
+			std::lock_guard<std::mutex> lock(rx_mutex);
+			rx_should_exit = true;
+		}
+		rx_cv.notify_one();
+		rx_thread.join();
+	}
 }
 
 void MavRos::spin()
 {
-	ros::AsyncSpinner spinner(4 /* threads */);
+	int normal_threads, realtime_threads, bulk_threads;
 
-	auto diag_timer = mavlink_nh.createTimer(
+	ros::NodeHandle nh("~");
+	nh.param("spinner/normal_threads", normal_threads, 4);
+	nh.param("spinner/realtime_threads", realtime_threads, 1);
+	nh.param("spinner/bulk_threads", bulk_threads, 1);
+
+	// one spinner pool per callback service class: a long BULK
+	// service call never starves REALTIME setpoint subscribers.
+	// Hosted vehicles share these pools, see UAS::share_cb_queues().
+	auto &primary_uas = vehicles.front()->uas;
+	ros::AsyncSpinner spinner(normal_threads);
+	ros::AsyncSpinner realtime_spinner(realtime_threads, &primary_uas.realtime_cb_queue);
+	ros::AsyncSpinner bulk_spinner(bulk_threads, &primary_uas.bulk_cb_queue);
+
+	// the updater has no subscriber-count accessor; a second publisher
+	// on the same topic sees the same peers and lets us skip the whole
+	// refresh (string formatting in every task) while nothing listens
+	auto diag_probe_pub = nh.advertise<diagnostic_msgs::DiagnosticArray>("/diagnostics", 1);
+
+	auto diag_timer = vehicles.front()->mavlink_nh.createTimer(
 			ros::Duration(0.5),
 			[&](const ros::TimerEvent &) {
-				UAS_DIAG(&mav_uas).update();
+				// allow toggling the dispatch profiler at runtime
+				bool profiling = plugin_profiling;
+				nh.getParamCached("plugin_profiling", profiling);
+				plugin_profiling = profiling;
+
+				if (diag_probe_pub.getNumSubscribers() == 0)
+					return;
+
+				for (auto &veh : vehicles)
+					UAS_DIAG(&veh->uas).update();
 
 				if (gcs_link)
 					gcs_diag_updater.update();
@@ -198,42 +367,325 @@ void MavRos::spin()
 	diag_timer.start();
 
 	spinner.start();
+	realtime_spinner.start();
+	bulk_spinner.start();
 	ros::waitForShutdown();
 
 	ROS_INFO("Stopping mavros...");
 	spinner.stop();
+	realtime_spinner.stop();
+	bulk_spinner.stop();
 }
 
-void MavRos::mavlink_pub_cb(const mavlink_message_t *mmsg, Framing framing)
+void MavRos::fcu_message_cb(const mavlink_message_t *mmsg, const Framing framing)
 {
-	auto rmsg = boost::make_shared<mavros_msgs::Mavlink>();
+	if (!rx_queue.push(mmsg, framing)) {
+		ROS_WARN_THROTTLE(10, "FCU RX queue overflow: plugin handlers can not keep up, message dropped");
+		return;
+	}
+
+	// wake the worker only when it parked, keep the io thread lock-free
+	// otherwise; the fence pairs with the one in rx_worker() so either
+	// the worker sees our push or we see its sleeping flag
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (rx_sleeping.load(std::memory_order_acquire)) {
+		std::lock_guard<std::mutex> lock(rx_mutex);
+		rx_cv.notify_one();
+	}
+}
+
+void MavRos::rx_worker()
+{
+	mavconn::utils::set_this_thread_name("mavros-rx");
+
+	RxQueue::Item item;
+	for (;;) {
+		// coarse clock: the per-message stamp and quiet-mode checks
+		// reuse one clock_gettime per RX_CLOCK_REFRESH messages
+		// instead of calling ros::Time::now() twice per message
+		rx_now = ros::Time::now();
+
+		size_t batch = 0;
+		while (rx_queue.pop(item)) {
+			if (++batch >= RX_CLOCK_REFRESH) {
+				rx_now = ros::Time::now();
+				batch = 0;
+			}
+
+			// demultiplex by source sysid; one array load per message
+			auto &veh = *sysid_route[item.msg.sysid];
+			// re-serialization recomputes the CRC, so recording a
+			// bad-CRC frame would silently "repair" it: skip those
+			if (recorder && item.framing == Framing::ok)
+				recorder->record(&item.msg, rx_now.toNSec() / 1000);
+			mavlink_pub_cb(veh, &item.msg, item.framing);
+			plugin_route_cb(veh, &item.msg, item.framing);
+
+			if (gcs_link) {
+				if (gcs_quiet_mode && item.msg.msgid != mavlink::common::msg::HEARTBEAT::MSG_ID &&
+					(rx_now - last_message_received_from_gcs > conn_timeout)) {
+					continue;
+				}
+
+				gcs_link->send_message_ignore_drop(&item.msg);
+			}
+		}
+
+		std::unique_lock<std::mutex> lock(rx_mutex);
+		if (rx_should_exit)
+			break;
+
+		// recheck after raising the flag: the producer might have
+		// pushed between the drain above and this point. The seq_cst
+		// fence keeps the flag store and the empty check ordered
+		// against the producer's push + flag load (plain release/
+		// acquire would let both sides read stale values and sleep
+		// on a non-empty queue)
+		rx_sleeping.store(true, std::memory_order_release);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (rx_queue.empty() && !rx_should_exit)
+			rx_cv.wait(lock);
+		rx_sleeping.store(false, std::memory_order_release);
+	}
+}
 
-	if  (mavlink_pub.getNumSubscribers() == 0)
+void MavRos::mavlink_pub_cb(Vehicle &veh, const mavlink_message_t *mmsg, Framing framing)
+{
+	if (veh.mavlink_pub.getNumSubscribers() == 0)
 		return;
 
-	rmsg->header.stamp = ros::Time::now();
+	// grab a pooled message nobody references anymore: payload
+	// capacity survives the round trip, so the steady state
+	// publishes without allocations
+	boost::shared_ptr<mavros_msgs::Mavlink> rmsg;
+	for (auto &slot : veh.mavlink_pub_pool) {
+		if (!slot)
+			slot = boost::make_shared<mavros_msgs::Mavlink>();
+
+		if (slot.unique()) {
+			rmsg = slot;
+			break;
+		}
+	}
+
+	// every slot still held by subscribers, fall back to a fresh one
+	if (!rmsg)
+		rmsg = boost::make_shared<mavros_msgs::Mavlink>();
+
+	rmsg->header.stamp = rx_now;
 	mavros_msgs::mavlink::convert(*mmsg, *rmsg, enum_value(framing));
-	mavlink_pub.publish(rmsg);
+	veh.mavlink_pub.publish(rmsg);
 }
 
 void MavRos::mavlink_sub_cb(const mavros_msgs::Mavlink::ConstPtr &rmsg)
 {
-	mavlink_message_t mmsg;
+	// the ROS message already carries a complete frame: serialize it
+	// straight to wire bytes, skipping the mavlink_message_t staging copy
+	std::array<uint8_t, MAVLINK_MAX_PACKET_LEN> buf;
 
-	if (mavros_msgs::mavlink::convert(*rmsg, mmsg))
-		UAS_FCU(&mav_uas)->send_message_ignore_drop(&mmsg);
-	else
+	ssize_t framelen = mavros_msgs::mavlink::convert_to_frame(*rmsg, buf.data(), buf.size());
+	if (framelen <= 0) {
 		ROS_ERROR("Drop mavlink packet: convert error.");
+		return;
+	}
+
+	try {
+		UAS_FCU(&vehicles.front()->uas)->send_bytes(buf.data(), framelen);
+	}
+	catch (std::length_error &) {
+		// same drop semantics as send_message_ignore_drop()
+	}
+}
+
+void MavRos::build_dispatch_table(Vehicle &veh)
+{
+	// per-msgid rate caps, ~rate_limit/msgids (map msgid -> max Hz);
+	// protects plugin handlers from a misconfigured FCU flooding one
+	// stream, without touching FCU config mid-flight
+	ros::NodeHandle nh("~");
+	XmlRpc::XmlRpcValue limit_dict;
+	std::map<mavlink::msgid_t, double> rate_limits;
+
+	if (nh.getParam("rate_limit/msgids", limit_dict) &&
+			limit_dict.getType() == XmlRpc::XmlRpcValue::TypeStruct) {
+		for (auto &pair : limit_dict) {
+			try {
+				mavlink::msgid_t msgid = std::stoi(pair.first);
+				double hz = (pair.second.getType() == XmlRpc::XmlRpcValue::TypeInt) ?
+					double(static_cast<int>(pair.second)) :
+					static_cast<double>(pair.second);
+
+				if (msgid == mavlink::common::msg::HEARTBEAT::MSG_ID)
+					ROS_WARN("rate_limit: capping HEARTBEAT can trip the connection timeout");
+
+				if (hz > 0.0)
+					rate_limits[msgid] = hz;
+			}
+			catch (std::invalid_argument &ex) {
+				ROS_ERROR_STREAM("rate_limit: bad msgid: " << pair.first);
+			}
+		}
+	}
+
+	int burst;
+	nh.param("rate_limit/burst", burst, 1);
+	burst = std::max(1, burst);
+
+	veh.plugin_dispatch.clear();
+	veh.plugin_dispatch.reserve(veh.plugin_subscriptions.size());
+
+	for (auto &sub : veh.plugin_subscriptions) {
+		DispatchEntry e;
+		e.msgid = sub.first;
+		e.subs = &sub.second;
+		e.stats.reset(new HandlerStat[sub.second.size()]);
+
+		auto limit = rate_limits.find(sub.first);
+		if (limit != rate_limits.end()) {
+			e.min_interval_ns = int64_t(1e9 / limit->second);
+			// start with a full bucket so the first messages pass
+			e.bucket_ns = e.min_interval_ns * burst;
+			e.last_refill = std::chrono::steady_clock::now();
+			ROS_INFO("rate_limit: msgid %u capped at %.1f Hz (burst %d)",
+					sub.first, limit->second, burst);
+		}
+
+		veh.plugin_dispatch.emplace_back(std::move(e));
+	}
+
+	std::sort(veh.plugin_dispatch.begin(), veh.plugin_dispatch.end(),
+		[](const DispatchEntry &a, const DispatchEntry &b) {
+			return a.msgid < b.msgid;
+		});
+
+	governor_burst = burst;
+}
+
+void MavRos::plugin_route_cb(Vehicle &veh, const mavlink_message_t *mmsg, const Framing framing)
+{
+	// binary search over the flat table: no hashing, one contiguous
+	// array walk for the common miss case
+	auto it = std::lower_bound(veh.plugin_dispatch.begin(), veh.plugin_dispatch.end(), mmsg->msgid,
+		[](const DispatchEntry &e, mavlink::msgid_t id) {
+			return e.msgid < id;
+		});
+	if (it == veh.plugin_dispatch.end() || it->msgid != mmsg->msgid)
+		return;
+
+	// token-bucket governor: cheap early out before any handler or
+	// deserialization work happens for an over-rate stream
+	if (it->min_interval_ns > 0) {
+		auto now = std::chrono::steady_clock::now();
+
+		it->bucket_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+				now - it->last_refill).count();
+		it->last_refill = now;
+
+		const int64_t cap = it->min_interval_ns * governor_burst;
+		if (it->bucket_ns > cap)
+			it->bucket_ns = cap;
+
+		if (it->bucket_ns < it->min_interval_ns) {
+			it->governor_dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		it->bucket_ns -= it->min_interval_ns;
+	}
+
+	// deserialize once for all typed handlers: add_plugin() guarantees
+	// they agree on the decoded type for a given msgid; the decode
+	// scratch comes from this thread's arena, see mavros/arena.h
+	plugin::DecodedMsgPtr decoded;
+	if (framing == Framing::ok) {
+		for (auto &info : *it->subs) {
+			auto &decode = std::get<4>(info);
+			if (decode) {
+				decoded = decode(mmsg);
+				break;
+			}
+		}
+	}
+
+	// one relaxed load when profiling is off
+	const bool profiling = plugin_profiling.load(std::memory_order_relaxed);
+
+	size_t hidx = 0;
+	for (auto &info : *it->subs) {
+		std::chrono::steady_clock::time_point t0;
+		if (profiling)
+			t0 = std::chrono::steady_clock::now();
+
+		auto &typed = std::get<5>(info);
+		if (typed) {
+			// typed handlers only see well-framed messages
+			if (decoded)
+				typed(mmsg, *decoded);
+		}
+		else
+			std::get<3>(info)(mmsg, framing);
+
+		if (profiling) {
+			auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+					std::chrono::steady_clock::now() - t0).count();
+
+			auto &st = it->stats[hidx];
+			st.ns_total.store(st.ns_total.load(std::memory_order_relaxed) + ns,
+					std::memory_order_relaxed);
+			st.count.store(st.count.load(std::memory_order_relaxed) + 1,
+					std::memory_order_relaxed);
+		}
+
+		hidx++;
+	}
 }
 
-void MavRos::plugin_route_cb(const mavlink_message_t *mmsg, const Framing framing)
+void MavRos::dispatch_diag_run(Vehicle &veh, diagnostic_updater::DiagnosticStatusWrapper &stat)
 {
-	auto it = plugin_subscriptions.find(mmsg->msgid);
-	if (it == plugin_subscriptions.end())
+	// governor drops are reported whether or not profiling is on
+	for (auto &e : veh.plugin_dispatch) {
+		if (e.min_interval_ns <= 0)
+			continue;
+
+		stat.addf(utils::format("governor (%u)", e.msgid),
+				"%" PRIu64 " dropped", e.governor_dropped.load(std::memory_order_relaxed));
+	}
+
+	if (!plugin_profiling.load(std::memory_order_relaxed)) {
+		stat.summary(diagnostic_msgs::DiagnosticStatus::OK, "profiling disabled");
 		return;
+	}
+
+	auto now = ros::Time::now();
+	double dt = (now - veh.profile_last_update).toSec();
+	veh.profile_last_update = now;
+
+	stat.summary(diagnostic_msgs::DiagnosticStatus::OK, "profiling enabled");
+
+	for (auto &e : veh.plugin_dispatch) {
+		for (size_t i = 0; i < e.subs->size(); i++) {
+			auto &st = e.stats[i];
+
+			uint32_t count = st.count.load(std::memory_order_relaxed);
+			uint64_t ns = st.ns_total.load(std::memory_order_relaxed);
 
-	for (auto &info : it->second)
-		std::get<3>(info)(mmsg, framing);
+			uint32_t dcount = count - st.prev_count;
+			uint64_t dns = ns - st.prev_ns_total;
+			st.prev_count = count;
+			st.prev_ns_total = ns;
+
+			if (dcount == 0)
+				continue;
+
+			auto &info = (*e.subs)[i];
+			const char *name = std::get<1>(info);
+
+			stat.addf(
+				utils::format("%s (%u) #%zu", (name) ? name : "RAW", e.msgid, i),
+				"%.1f msg/s, %.1f us/msg",
+				(dt > 0.0) ? dcount / dt : 0.0,
+				dns / 1000.0 / dcount);
+		}
+	}
 }
 
 static bool pattern_match(std::string &pattern, std::string &pl_name)
@@ -288,7 +740,7 @@ inline bool is_mavlink_message_t(const size_t rt)
 /**
  * @brief Loads plugin (if not blacklisted)
  */
-void MavRos::add_plugin(std::string &pl_name, ros::V_string &blacklist, ros::V_string &whitelist)
+void MavRos::add_plugin(Vehicle &veh, std::string &pl_name, ros::V_string &blacklist, ros::V_string &whitelist)
 {
 	if (is_blacklisted(pl_name, blacklist, whitelist)) {
 		ROS_INFO_STREAM("Plugin " << pl_name << " blacklisted");
@@ -296,11 +748,69 @@ void MavRos::add_plugin(std::string &pl_name, ros::V_string &blacklist, ros::V_s
 	}
 
 	try {
-		auto plugin = plugin_loader.createInstance(pl_name);
+		plugin::PluginBase::Ptr plugin;
+		{
+			// neither pluginlib nor the static registry promise
+			// concurrent createInstance(); see plugin_setup_mutex
+			std::lock_guard<std::mutex> lock(plugin_setup_mutex);
+
+			auto &static_registry = plugin::PluginRegistry::instance();
+			plugin = (static_registry.empty()) ?
+				plugin_loader.createInstance(pl_name) :
+				static_registry.create(pl_name);
+		}
+		if (!plugin) {
+			ROS_ERROR_STREAM("Plugin " << pl_name << " not found in static registry");
+			return;
+		}
 
 		ROS_INFO_STREAM("Plugin " << pl_name << " loaded");
 
-		for (auto &info : plugin->get_subscriptions()) {
+		auto subscriptions = plugin->get_subscriptions();
+
+		// Lazy mode: constructors are cheap by contract, the topic
+		// and service advertisement burst in initialize() is not.
+		// Wrap the handlers so the first matching FCU message
+		// initializes the plugin on the RX worker; plugins without
+		// subscriptions initialize at once, nothing would ever
+		// trigger them.
+		const bool defer_init = lazy_init_plugins && !subscriptions.empty();
+		if (defer_init) {
+			auto initialized = boost::make_shared<bool>(false);
+			UAS *veh_uas = &veh.uas;
+
+			auto ensure_init = [plugin, initialized, veh_uas]() {
+				if (!*initialized) {
+					// rx_thread only, no locking needed
+					*initialized = true;
+					plugin->initialize(*veh_uas);
+				}
+			};
+
+			for (auto &info : subscriptions) {
+				auto cb = std::get<3>(info);
+				if (cb) {
+					std::get<3>(info) = [ensure_init, cb](const mavlink_message_t *msg, const Framing framing) {
+								ensure_init();
+								cb(msg, framing);
+							};
+				}
+
+				auto typed = std::get<5>(info);
+				if (typed) {
+					std::get<5>(info) = [ensure_init, typed](const mavlink_message_t *msg, plugin::DecodedMsg &decoded) {
+								ensure_init();
+								typed(msg, decoded);
+							};
+				}
+			}
+		}
+
+		// merge into the build-time subscription map under the setup
+		// mutex; pool workers fill it concurrently
+		std::unique_lock<std::mutex> merge_lock(plugin_setup_mutex);
+
+		for (auto &info : subscriptions) {
 			auto msgid = std::get<0>(info);
 			auto msgname = std::get<1>(info);
 			auto type_hash_ = std::get<2>(info);
@@ -314,12 +824,12 @@ void MavRos::add_plugin(std::string &pl_name, ros::V_string &blacklist, ros::V_s
 
 			ROS_DEBUG_STREAM("Route " << log_msgname << " to " << pl_name);
 
-			auto it = plugin_subscriptions.find(msgid);
-			if (it == plugin_subscriptions.end()) {
+			auto it = veh.plugin_subscriptions.find(msgid);
+			if (it == veh.plugin_subscriptions.end()) {
 				// new entry
 
 				ROS_DEBUG_STREAM(log_msgname << " - new element");
-				plugin_subscriptions[msgid] = PluginBase::Subscriptions{{info}};
+				veh.plugin_subscriptions[msgid] = PluginBase::Subscriptions{{info}};
 			}
 			else {
 				// existing: check handler message type
@@ -345,10 +855,21 @@ void MavRos::add_plugin(std::string &pl_name, ros::V_string &blacklist, ros::V_s
 			}
 		}
 
-		plugin->initialize(mav_uas);
-		loaded_plugins.push_back(plugin);
+		if (defer_init) {
+			veh.loaded_plugins.push_back(plugin);
+			merge_lock.unlock();
+			ROS_INFO_STREAM("Plugin " << pl_name << " initialization deferred");
+		}
+		else {
+			veh.loaded_plugins.push_back(plugin);
+			merge_lock.unlock();
+
+			// the expensive part: advertisement bursts run unlocked,
+			// so the pool overlaps them across plugins
+			plugin->initialize(veh.uas);
 
-		ROS_INFO_STREAM("Plugin " << pl_name << " initialized");
+			ROS_INFO_STREAM("Plugin " << pl_name << " initialized");
+		}
 	} catch (pluginlib::PluginlibException &ex) {
 		ROS_ERROR_STREAM("Plugin " << pl_name << " load exception: " << ex.what());
 	}
@@ -361,18 +882,18 @@ void MavRos::startup_px4_usb_quirk()
        const uint8_t nsh[] = "sh /etc/init.d/rc.usb\n";
 
        ROS_INFO("Autostarting mavlink via USB on PX4");
-       UAS_FCU(&mav_uas)->send_bytes(init, 3);
-       UAS_FCU(&mav_uas)->send_bytes(nsh, sizeof(nsh) - 1);
-       UAS_FCU(&mav_uas)->send_bytes(init, 4); /* NOTE in original init[3] */
+       UAS_FCU(&vehicles.front()->uas)->send_bytes(init, 3);
+       UAS_FCU(&vehicles.front()->uas)->send_bytes(nsh, sizeof(nsh) - 1);
+       UAS_FCU(&vehicles.front()->uas)->send_bytes(init, 4); /* NOTE in original init[3] */
 }
 
-void MavRos::log_connect_change(bool connected)
+void MavRos::log_connect_change(Vehicle &veh, bool connected)
 {
-	auto ap = utils::to_string(mav_uas.get_autopilot());
+	auto ap = utils::to_string(veh.uas.get_autopilot());
 
 	/* note: sys_status plugin required */
 	if (connected)
-		ROS_INFO("CON: Got HEARTBEAT, connected. FCU: %s", ap.c_str());
+		ROS_INFO("CON: %sGot HEARTBEAT, connected. FCU: %s", veh.ns.c_str(), ap.c_str());
 	else
-		ROS_WARN("CON: Lost connection, HEARTBEAT timed out.");
+		ROS_WARN("CON: %sLost connection, HEARTBEAT timed out.", veh.ns.c_str());
 }
@@ -0,0 +1,24 @@
+/**
+ * @brief Static plugin registry
+ * @file plugin_registry.cpp
+ * @author Vladimir Ermakov <vooon341@gmail.com>
+ */
+/*
+ * Copyright 2014,2015,2016 Vladimir Ermakov.
+ *
+ * This file is part of the mavros package and subject to the license terms
+ * in the top-level LICENSE file of the mavros repository.
+ * https://github.com/mavlink/mavros/tree/master/LICENSE.md
+ */
+
+#include <mavros/plugin_registry.h>
+
+using namespace mavros::plugin;
+
+PluginRegistry &PluginRegistry::instance()
+{
+	// constructed on first use: registration happens from static
+	// initializers in the plugin translation units
+	static PluginRegistry registry;
+	return registry;
+}
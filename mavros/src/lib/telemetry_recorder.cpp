@@ -0,0 +1,175 @@
+/**
+ * @brief Memory-mapped binary telemetry recorder
+ * @file telemetry_recorder.cpp
+ *
+ * @addtogroup nodelib
+ * @{
+ */
+/*
+ * This file is part of the mavros package and subject to the license terms
+ * in the top-level LICENSE file of the mavros repository.
+ * https://github.com/mavlink/mavros/tree/master/LICENSE.md
+ */
+
+#include <cerrno>
+#include <cinttypes>
+#include <cstring>
+#include <ctime>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <ros/console.h>
+#include <mavconn/thread_utils.h>
+#include <mavros/telemetry_recorder.h>
+
+using namespace mavros;
+
+TelemetryRecorder::TelemetryRecorder(const std::string &path_prefix_, size_t segment_mb,
+		size_t ring_capacity) :
+	path_prefix(path_prefix_),
+	segment_bytes(segment_mb * 1024 * 1024),
+	ring_mask(round_up_pow2(ring_capacity) - 1),
+	ring(new Frame[ring_mask + 1]),
+	head(0),
+	tail(0),
+	dropped(0),
+	writer_sleeping(false),
+	writer_should_exit(false),
+	seg_data(nullptr),
+	seg_used(0),
+	seg_fd(-1),
+	seg_index(0)
+{
+	// segments of one run share the start stamp in their name
+	char buf[32];
+	std::time_t now = std::time(nullptr);
+	std::strftime(buf, sizeof(buf), "%Y%m%d_%H%M%S", std::localtime(&now));
+	start_stamp = buf;
+
+	// open the first segment here so a bad path fails construction,
+	// not the writer thread mid-flight
+	open_segment();
+
+	writer_thread = std::thread(&TelemetryRecorder::writer_worker, this);
+}
+
+TelemetryRecorder::~TelemetryRecorder()
+{
+	{
+		std::lock_guard<std::mutex> lock(writer_mutex);
+		writer_should_exit = true;
+	}
+	writer_cv.notify_one();
+	if (writer_thread.joinable())
+		writer_thread.join();
+
+	close_segment();
+
+	uint64_t lost = dropped_count();
+	ROS_WARN_COND_NAMED(lost > 0, "recorder", "REC: %" PRIu64 " frames lost to ring overflow", lost);
+}
+
+void TelemetryRecorder::open_segment()
+{
+	auto file = mavconn::utils::format("%s_%s-%03zu.tlog",
+			path_prefix.c_str(), start_stamp.c_str(), seg_index);
+
+	seg_fd = ::open(file.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (seg_fd < 0)
+		throw std::runtime_error("recorder: open " + file + ": " + std::strerror(errno));
+
+	if (::ftruncate(seg_fd, segment_bytes) < 0) {
+		::close(seg_fd);
+		seg_fd = -1;
+		throw std::runtime_error("recorder: ftruncate " + file + ": " + std::strerror(errno));
+	}
+
+	seg_data = static_cast<uint8_t *>(::mmap(nullptr, segment_bytes,
+			PROT_READ | PROT_WRITE, MAP_SHARED, seg_fd, 0));
+	if (seg_data == MAP_FAILED) {
+		seg_data = nullptr;
+		::close(seg_fd);
+		seg_fd = -1;
+		throw std::runtime_error("recorder: mmap " + file + ": " + std::strerror(errno));
+	}
+
+	seg_used = 0;
+	seg_index++;
+	ROS_INFO_NAMED("recorder", "REC: recording to %s", file.c_str());
+}
+
+void TelemetryRecorder::close_segment()
+{
+	if (seg_data == nullptr)
+		return;
+
+	::munmap(seg_data, segment_bytes);
+	seg_data = nullptr;
+
+	// drop the unused preallocated tail, the file stays a valid tlog
+	if (::ftruncate(seg_fd, seg_used) < 0)
+		ROS_ERROR_NAMED("recorder", "REC: ftruncate: %s", std::strerror(errno));
+
+	::close(seg_fd);
+	seg_fd = -1;
+}
+
+void TelemetryRecorder::append(const Frame &fr)
+{
+	const size_t need = sizeof(uint64_t) + fr.len;
+
+	if (seg_used + need > segment_bytes) {
+		close_segment();
+		try {
+			open_segment();
+		}
+		catch (std::runtime_error &ex) {
+			// disk full or path gone: count the rest as dropped
+			ROS_ERROR_THROTTLE_NAMED(10, "recorder", "REC: %s", ex.what());
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+	}
+
+	// tlog layout: big-endian microseconds, then the raw frame
+	uint8_t *p = seg_data + seg_used;
+	for (int i = 0; i < 8; i++)
+		p[i] = fr.usec >> (8 * (7 - i));
+	std::memcpy(p + 8, fr.data.data(), fr.len);
+
+	seg_used += need;
+}
+
+void TelemetryRecorder::writer_worker()
+{
+	mavconn::utils::set_this_thread_name("mavros-rec");
+
+	for (;;) {
+		size_t t = tail.load(std::memory_order_relaxed);
+		while (t != head.load(std::memory_order_acquire)) {
+			if (seg_data != nullptr)
+				append(ring[t & ring_mask]);
+			tail.store(++t, std::memory_order_release);
+		}
+
+		std::unique_lock<std::mutex> lock(writer_mutex);
+		if (writer_should_exit)
+			break;
+
+		// recheck after raising the flag: the producer might have
+		// pushed between the drain above and this point. The seq_cst
+		// fence (paired with the one in record()) keeps the flag
+		// store ordered before the head load — release/acquire alone
+		// would let both sides miss each other and the writer sleep
+		// with frames in the ring
+		writer_sleeping.store(true, std::memory_order_release);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (tail.load(std::memory_order_relaxed) == head.load(std::memory_order_acquire) &&
+				!writer_should_exit)
+			writer_cv.wait(lock);
+		writer_sleeping.store(false, std::memory_order_release);
+	}
+}
@@ -23,26 +23,28 @@ using utils::enum_value;
 
 UAS::UAS() :
 	tf2_listener(tf2_buffer, true),
+	realtime_q(&realtime_cb_queue),
+	bulk_q(&bulk_cb_queue),
 	type(enum_value(MAV_TYPE::GENERIC)),
 	autopilot(enum_value(MAV_AUTOPILOT::GENERIC)),
 	base_mode(0),
 	target_system(1),
 	target_component(1),
 	connected(false),
-	gps_eph(NAN),
-	gps_epv(NAN),
-	gps_fix_type(0),
-	gps_satellites_visible(0),
-	time_offset(0),
+	gps_epts_seq(0),
+	gps_epts{NAN, NAN, 0, 0},
+	tf_watch_should_exit(false),
+	notifier_should_exit(false),
+	tsync_seq(0),
+	tsync_state{0, 0.0, 0},
 	tsync_mode(UAS::timesync_mode::NONE),
 	fcu_caps_known(false),
 	fcu_capabilities(0)
 {
 	try {
-		// Using smallest dataset with 5' grid,
-		// From default location,
-		// Use cubic interpolation, Thread safe
-		egm96_5 = std::make_shared<GeographicLib::Geoid>("egm96-5", "", true, true);
+		// Smallest dataset with 5' grid, from default location,
+		// memory-mapped: pages are shared between mavros instances
+		egm96_5 = std::make_shared<GeoidMmap>("egm96-5");
 	}
 	catch (const std::exception &e) {
 		// catch exception and shutdown node
@@ -60,6 +62,21 @@ UAS::UAS() :
 	tf2_static_broadcaster.sendTransform(transform_vector);
 }
 
+UAS::~UAS()
+{
+	tf_watch_should_exit = true;
+	if (tf_watch_thread.joinable())
+		tf_watch_thread.join();
+
+	{
+		std::lock_guard<std::mutex> lock(notify_mutex);
+		notifier_should_exit = true;
+	}
+	notify_cv.notify_one();
+	if (notifier_thread.joinable())
+		notifier_thread.join();
+}
+
 /* -*- heartbeat handlers -*- */
 
 void UAS::update_heartbeat(uint8_t type_, uint8_t autopilot_, uint8_t base_mode_)
@@ -74,16 +91,100 @@ void UAS::update_connection_status(bool conn_)
 	if (conn_ != connected) {
 		connected = conn_;
 
-		// call all change cb's
-		for (auto &cb : connection_cb_vec)
-			cb(conn_);
+		// fan out from the notifier thread: a slow handler must not
+		// stall the RX path that detected the change
+		ChangeEvent ev;
+		ev.kind = ChangeEvent::Kind::CONNECTION;
+		ev.connected = conn_;
+		push_change_event(ev);
+	}
+}
+
+void UAS::push_change_event(const ChangeEvent &ev)
+{
+	{
+		std::lock_guard<std::mutex> lock(notify_mutex);
+		notify_queue.push_back(ev);
+	}
+	notify_cv.notify_one();
+}
+
+void UAS::notifier_worker()
+{
+	mavconn::utils::set_this_thread_name("uas-notify");
+
+	std::unique_lock<std::mutex> lock(notify_mutex);
+	while (!notifier_should_exit) {
+		if (notify_queue.empty()) {
+			notify_cv.wait(lock);
+			continue;
+		}
+
+		ChangeEvent ev = notify_queue.front();
+		notify_queue.pop_front();
+
+		// run the handlers unlocked: they may take their own time and
+		// even register further handlers
+		lock.unlock();
+
+		if (ev.kind == ChangeEvent::Kind::CONNECTION) {
+			auto cbs = std::atomic_load(&connection_cb_list);
+			if (cbs)
+				for (auto &cb : *cbs)
+					cb(ev.connected);
+		}
+		else {
+			auto cbs = std::atomic_load(&capabilities_cb_list);
+			if (cbs)
+				for (auto &cb : *cbs)
+					cb(static_cast<MAV_CAP>(ev.capabilities));
+		}
+
+		lock.lock();
+	}
+}
+
+/* -*- callback service classes -*- */
+
+void UAS::set_cb_queue(ros::NodeHandle &nh, CbQueue q)
+{
+	switch (q) {
+	case CbQueue::REALTIME:
+		nh.setCallbackQueue(realtime_q);
+		break;
+
+	case CbQueue::BULK:
+		nh.setCallbackQueue(bulk_q);
+		break;
+
+	case CbQueue::NORMAL:
+		// the global queue, nothing to reroute
+		break;
 	}
 }
 
+void UAS::share_cb_queues(UAS &primary)
+{
+	realtime_q = &primary.realtime_cb_queue;
+	bulk_q = &primary.bulk_cb_queue;
+}
+
 void UAS::add_connection_change_handler(UAS::ConnectionCb cb)
 {
+	// copy-on-write under the registration lock; readers never take it
 	lock_guard lock(mutex);
-	connection_cb_vec.push_back(cb);
+
+	auto old = std::atomic_load(&connection_cb_list);
+	auto next = (old) ?
+		std::make_shared<std::vector<ConnectionCb>>(*old) :
+		std::make_shared<std::vector<ConnectionCb>>();
+	next->push_back(cb);
+	std::atomic_store(&connection_cb_list,
+			std::shared_ptr<const std::vector<ConnectionCb>>(std::move(next)));
+
+	// one shared thread delivers all change events
+	if (!notifier_thread.joinable())
+		notifier_thread = std::thread(&UAS::notifier_worker, this);
 }
 
 /* -*- autopilot version -*- */
@@ -124,49 +225,64 @@ void UAS::update_capabilities(bool known, uint64_t caps)
 
 	if (process_cb_queue) {
 		fcu_capabilities = caps;
-		for (auto &cb : capabilities_cb_vec) {
-			cb(static_cast<MAV_CAP>(caps));
-		}
+
+		ChangeEvent ev;
+		ev.kind = ChangeEvent::Kind::CAPABILITIES;
+		ev.capabilities = caps;
+		push_change_event(ev);
 	}
 }
 
 void UAS::add_capabilities_change_handler(UAS::CapabilitiesCb cb)
 {
+	// copy-on-write under the registration lock; readers never take it
 	lock_guard lock(mutex);
-	capabilities_cb_vec.push_back(cb);
+
+	auto old = std::atomic_load(&capabilities_cb_list);
+	auto next = (old) ?
+		std::make_shared<std::vector<CapabilitiesCb>>(*old) :
+		std::make_shared<std::vector<CapabilitiesCb>>();
+	next->push_back(cb);
+	std::atomic_store(&capabilities_cb_list,
+			std::shared_ptr<const std::vector<CapabilitiesCb>>(std::move(next)));
+
+	if (!notifier_thread.joinable())
+		notifier_thread = std::thread(&UAS::notifier_worker, this);
 }
 
 /* -*- IMU data -*- */
 
+// Attitude and GPS snapshots are hot state: setpoint plugins read them
+// at control rate while the RX thread updates them at telemetry rate.
+// Messages are published RCU-style (atomic shared_ptr swap of an
+// immutable message), the POD precision group goes through a seqlock,
+// so readers are wait-free and never contend with the writer.
+
 void UAS::update_attitude_imu_enu(sensor_msgs::Imu::Ptr &imu)
 {
-	lock_guard lock(mutex);
-	imu_enu_data = imu;
+	boost::atomic_store(&imu_enu_data, imu);
 }
 
 void UAS::update_attitude_imu_ned(sensor_msgs::Imu::Ptr &imu)
 {
-	lock_guard lock(mutex);
-	imu_ned_data = imu;
+	boost::atomic_store(&imu_ned_data, imu);
 }
 
 sensor_msgs::Imu::Ptr UAS::get_attitude_imu_enu()
 {
-	lock_guard lock(mutex);
-	return imu_enu_data;
+	return boost::atomic_load(&imu_enu_data);
 }
 
 sensor_msgs::Imu::Ptr UAS::get_attitude_imu_ned()
 {
-	lock_guard lock(mutex);
-	return imu_ned_data;
+	return boost::atomic_load(&imu_ned_data);
 }
 
 geometry_msgs::Quaternion UAS::get_attitude_orientation_enu()
 {
-	lock_guard lock(mutex);
-	if (imu_enu_data)
-		return imu_enu_data->orientation;
+	auto imu = boost::atomic_load(&imu_enu_data);
+	if (imu)
+		return imu->orientation;
 	else {
 		// fallback - return identity
 		geometry_msgs::Quaternion q;
@@ -177,9 +293,9 @@ geometry_msgs::Quaternion UAS::get_attitude_orientation_enu()
 
 geometry_msgs::Quaternion UAS::get_attitude_orientation_ned()
 {
-	lock_guard lock(mutex);
-	if (imu_ned_data)
-		return imu_ned_data->orientation;
+	auto imu = boost::atomic_load(&imu_ned_data);
+	if (imu)
+		return imu->orientation;
 	else {
 		// fallback - return identity
 		geometry_msgs::Quaternion q;
@@ -190,9 +306,9 @@ geometry_msgs::Quaternion UAS::get_attitude_orientation_ned()
 
 geometry_msgs::Vector3 UAS::get_attitude_angular_velocity_enu()
 {
-	lock_guard lock(mutex);
-	if (imu_enu_data)
-		return imu_enu_data->angular_velocity;
+	auto imu = boost::atomic_load(&imu_enu_data);
+	if (imu)
+		return imu->angular_velocity;
 	else {
 		// fallback
 		geometry_msgs::Vector3 v;
@@ -203,9 +319,9 @@ geometry_msgs::Vector3 UAS::get_attitude_angular_velocity_enu()
 
 geometry_msgs::Vector3 UAS::get_attitude_angular_velocity_ned()
 {
-	lock_guard lock(mutex);
-	if (imu_ned_data)
-		return imu_ned_data->angular_velocity;
+	auto imu = boost::atomic_load(&imu_ned_data);
+	if (imu)
+		return imu->angular_velocity;
 	else {
 		// fallback
 		geometry_msgs::Vector3 v;
@@ -221,31 +337,44 @@ void UAS::update_gps_fix_epts(sensor_msgs::NavSatFix::Ptr &fix,
 	float eph, float epv,
 	int fix_type, int satellites_visible)
 {
-	lock_guard lock(mutex);
+	boost::atomic_store(&gps_fix, fix);
 
-	gps_fix = fix;
-	gps_eph = eph;
-	gps_epv = epv;
-	gps_fix_type = fix_type;
-	gps_satellites_visible = satellites_visible;
+	// seqlock write (single writer): odd seq marks the update in flight
+	uint32_t seq = gps_epts_seq.load(std::memory_order_relaxed);
+	gps_epts_seq.store(seq + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	gps_epts.eph = eph;
+	gps_epts.epv = epv;
+	gps_epts.fix_type = fix_type;
+	gps_epts.satellites_visible = satellites_visible;
+
+	gps_epts_seq.store(seq + 2, std::memory_order_release);
 }
 
 //! Returns EPH, EPV, Fix type and satellites visible
 void UAS::get_gps_epts(float &eph, float &epv, int &fix_type, int &satellites_visible)
 {
-	lock_guard lock(mutex);
-
-	eph = gps_eph;
-	epv = gps_epv;
-	fix_type = gps_fix_type;
-	satellites_visible = gps_satellites_visible;
+	GpsEpts out;
+	uint32_t seq0, seq1;
+
+	do {
+		seq0 = gps_epts_seq.load(std::memory_order_acquire);
+		out = gps_epts;
+		std::atomic_thread_fence(std::memory_order_acquire);
+		seq1 = gps_epts_seq.load(std::memory_order_relaxed);
+	} while ((seq0 & 1) || seq0 != seq1);
+
+	eph = out.eph;
+	epv = out.epv;
+	fix_type = out.fix_type;
+	satellites_visible = out.satellites_visible;
 }
 
 //! Retunrs last GPS RAW message
 sensor_msgs::NavSatFix::Ptr UAS::get_gps_fix()
 {
-	lock_guard lock(mutex);
-	return gps_fix;
+	return boost::atomic_load(&gps_fix);
 }
 
 /* -*- transform -*- */
@@ -275,3 +404,83 @@ void UAS::publish_static_transform(const std::string &frame_id, const std::strin
 
 	tf2_static_broadcaster.sendTransform(static_transformStamped);
 }
+
+//! Dirty check for tf_watch_worker(): has the transform actually changed?
+static inline bool transform_changed(const geometry_msgs::TransformStamped &a, const geometry_msgs::TransformStamped &b)
+{
+	return a.header.stamp != b.header.stamp ||
+	       a.transform.translation.x != b.transform.translation.x ||
+	       a.transform.translation.y != b.transform.translation.y ||
+	       a.transform.translation.z != b.transform.translation.z ||
+	       a.transform.rotation.x != b.transform.rotation.x ||
+	       a.transform.rotation.y != b.transform.rotation.y ||
+	       a.transform.rotation.z != b.transform.rotation.z ||
+	       a.transform.rotation.w != b.transform.rotation.w;
+}
+
+void UAS::add_tf_watch(const std::string &frame_id, const std::string &child_frame_id,
+		double rate, TfWatchCb cb)
+{
+	TfWatch watch;
+
+	watch.frame_id = frame_id;
+	watch.child_frame_id = child_frame_id;
+	watch.period = ros::Duration(ros::Rate(rate));
+	watch.next_run = ros::Time::now();
+	watch.cb = cb;
+	watch.have_last = false;
+
+	std::lock_guard<std::mutex> lock(tf_watch_mutex);
+	tf_watches.emplace_back(std::move(watch));
+
+	// one shared thread serves all watches
+	if (!tf_watch_thread.joinable())
+		tf_watch_thread = std::thread(&UAS::tf_watch_worker, this);
+}
+
+void UAS::tf_watch_worker()
+{
+	mavconn::utils::set_this_thread_name("uas-tf-watch");
+
+	while (ros::ok() && !tf_watch_should_exit) {
+		auto now = ros::Time::now();
+		auto next_wakeup = now + ros::Duration(0.1);	// shutdown responsiveness cap
+
+		{
+			std::lock_guard<std::mutex> lock(tf_watch_mutex);
+			for (auto &watch : tf_watches) {
+				if (watch.next_run > now) {
+					next_wakeup = std::min(next_wakeup, watch.next_run);
+					continue;
+				}
+
+				watch.next_run = now + watch.period;
+				next_wakeup = std::min(next_wakeup, watch.next_run);
+
+				// non-blocking: one slow frame pair must not stall the others
+				if (!tf2_buffer.canTransform(watch.frame_id, watch.child_frame_id, ros::Time(0)))
+					continue;
+
+				try {
+					auto transform = tf2_buffer.lookupTransform(
+							watch.frame_id, watch.child_frame_id, ros::Time(0));
+
+					if (watch.have_last && !transform_changed(transform, watch.last))
+						continue;	// unchanged: don't wake the plugin
+
+					watch.last = transform;
+					watch.have_last = true;
+					watch.cb(transform);
+				}
+				catch (tf2::LookupException &ex) {
+					ROS_ERROR_NAMED("tf2_buffer", "tf_watch %s -> %s: %s",
+							watch.child_frame_id.c_str(), watch.frame_id.c_str(), ex.what());
+				}
+			}
+		}
+
+		auto sleep_time = next_wakeup - ros::Time::now();
+		if (sleep_time > ros::Duration(0))
+			sleep_time.sleep();
+	}
+}
@@ -12,6 +12,7 @@
  */
 
 #include <array>
+#include <atomic>
 #include <unordered_map>
 #include <stdexcept>
 #include <mavros/mavros_uas.h>
@@ -29,24 +30,64 @@ static inline ros::Time ros_time_from_ns(const uint64_t stamp_ns) {
 		stamp_ns % 1000000000UL);		// t_nsec
 }
 
+//! Offset at @a remote_ns: linear skew extrapolation from the reference point
+static inline int64_t drift_corrected_offset(const UAS::TimesyncState &state, const uint64_t remote_ns)
+{
+	int64_t offset_ns = state.offset_ns;
+
+	if (state.ref_remote_ns > 0)
+		offset_ns += int64_t(state.skew * double(int64_t(remote_ns) - int64_t(state.ref_remote_ns)));
+
+	return offset_ns;
+}
+
+void UAS::set_timesync_state(int64_t offset_ns, double skew, uint64_t ref_remote_ns)
+{
+	// seqlock write (single writer): odd seq marks the update in flight
+	uint32_t seq = tsync_seq.load(std::memory_order_relaxed);
+	tsync_seq.store(seq + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	tsync_state.offset_ns = offset_ns;
+	tsync_state.skew = skew;
+	tsync_state.ref_remote_ns = ref_remote_ns;
+
+	tsync_seq.store(seq + 2, std::memory_order_release);
+}
+
+UAS::TimesyncState UAS::get_timesync_state()
+{
+	TimesyncState out;
+	uint32_t seq0, seq1;
+
+	do {
+		seq0 = tsync_seq.load(std::memory_order_acquire);
+		out = tsync_state;
+		std::atomic_thread_fence(std::memory_order_acquire);
+		seq1 = tsync_seq.load(std::memory_order_relaxed);
+	} while ((seq0 & 1) || seq0 != seq1);
+
+	return out;
+}
+
 ros::Time UAS::synchronise_stamp(uint32_t time_boot_ms) {
-	// copy offset from atomic var
-	uint64_t offset_ns = time_offset;
+	// wait-free snapshot of (offset, skew, reference)
+	auto state = get_timesync_state();
 
-	if (offset_ns > 0 || tsync_mode == timesync_mode::PASSTHROUGH) {
-		uint64_t stamp_ns = static_cast<uint64_t>(time_boot_ms) * 1000000UL + offset_ns;
-		return ros_time_from_ns(stamp_ns);
+	if (state.offset_ns > 0 || tsync_mode == timesync_mode::PASSTHROUGH) {
+		uint64_t remote_ns = static_cast<uint64_t>(time_boot_ms) * 1000000UL;
+		return ros_time_from_ns(remote_ns + drift_corrected_offset(state, remote_ns));
 	}
 	else
 		return ros::Time::now();
 }
 
 ros::Time UAS::synchronise_stamp(uint64_t time_usec) {
-	uint64_t offset_ns = time_offset;
+	auto state = get_timesync_state();
 
-	if (offset_ns > 0 || tsync_mode == timesync_mode::PASSTHROUGH) {
-		uint64_t stamp_ns = time_usec * 1000UL + offset_ns;
-		return ros_time_from_ns(stamp_ns);
+	if (state.offset_ns > 0 || tsync_mode == timesync_mode::PASSTHROUGH) {
+		uint64_t remote_ns = time_usec * 1000UL;
+		return ros_time_from_ns(remote_ns + drift_corrected_offset(state, remote_ns));
 	}
 	else
 		return ros::Time::now();
@@ -14,6 +14,7 @@
  * https://github.com/mavlink/mavros/tree/master/LICENSE.md
  */
 
+#include <atomic>
 #include <mavros/mavros_plugin.h>
 
 #include <mavros_msgs/RadioStatus.h>
@@ -26,10 +27,18 @@ namespace std_plugins {
 class TDRRadioPlugin : public plugin::PluginBase {
 public:
 	TDRRadioPlugin() : PluginBase(),
-		nh("~"),
+		nh(plugin_ns("")),
 		has_radio_status(false),
 		diag_added(false),
-		low_rssi(0)
+		low_rssi(0),
+		governor(false),
+		txbuf_low(20),
+		txbuf_high(50),
+		throttle_rate(1),
+		restore_rate(4),
+		recovery_holdoff(5.0),
+		throttled(false),
+		tx_congested(false)
 	{ }
 
 	void initialize(UAS &uas_)
@@ -38,8 +47,26 @@ public:
 
 		nh.param("tdr_radio/low_rssi", low_rssi, 40);
 
+		// link governor: throttle FCU streams when the modem TX buffer
+		// collapses, restore once the link has recovered
+		nh.param("tdr_radio/governor", governor, false);
+		nh.param("tdr_radio/txbuf_low", txbuf_low, 20);
+		nh.param("tdr_radio/txbuf_high", txbuf_high, 50);
+		nh.param("tdr_radio/throttle_rate", throttle_rate, 1);
+		nh.param("tdr_radio/restore_rate", restore_rate, 4);
+		nh.param("tdr_radio/recovery_holdoff", recovery_holdoff, 5.0);
+
 		status_pub = nh.advertise<mavros_msgs::RadioStatus>("radio_status", 10);
 
+		if (governor) {
+			// the TX watermark crossings libmavconn already detects are a
+			// congestion signal too: reaching the high watermark means the
+			// link can not drain what mavros queues
+			UAS_FCU(m_uas)->tx_backpressure_cb = [this](bool congested) {
+				tx_congested = congested;
+			};
+		}
+
 		enable_connection_cb();
 	}
 
@@ -58,6 +85,16 @@ private:
 	bool diag_added;
 	int low_rssi;
 
+	bool governor;			//!< act on link quality instead of only reporting it
+	int txbuf_low;			//!< modem TX buffer [%] below which streams are throttled
+	int txbuf_high;			//!< modem TX buffer [%] required before restoring
+	int throttle_rate;		//!< stream rate while congested [Hz]
+	int restore_rate;		//!< stream rate after recovery [Hz]
+	double recovery_holdoff;	//!< seconds without congestion before restoring
+	bool throttled;
+	std::atomic<bool> tx_congested;	//!< set from the transport watermark callback
+	ros::Time last_congestion;
+
 	ros::Publisher status_pub;
 
 	std::mutex diag_mutex;
@@ -117,8 +154,52 @@ private:
 		}
 
 		status_pub.publish(msg);
+
+		if (governor)
+			update_governor(rst.txbuf);
+	}
+
+	/**
+	 * @brief Degrade stream rates gracefully instead of letting the link
+	 * death-spiral once the modem buffer is full.
+	 *
+	 * Runs on the rx dispatch thread only; hysteresis between txbuf_low
+	 * and txbuf_high plus the holdoff keeps it from flapping.
+	 */
+	void update_governor(uint8_t txbuf)
+	{
+		auto now = ros::Time::now();
+
+		bool congested = tx_congested || txbuf < txbuf_low;
+		if (congested)
+			last_congestion = now;
+
+		if (congested && !throttled) {
+			ROS_WARN_NAMED("radio", "radio: link congested (txbuf %u%%), throttling streams to %d Hz",
+					txbuf, throttle_rate);
+			throttled = true;
+			request_stream_rate(throttle_rate);
+		}
+		else if (throttled && txbuf >= txbuf_high &&
+				now - last_congestion > ros::Duration(recovery_holdoff)) {
+			ROS_INFO_NAMED("radio", "radio: link recovered, restoring %d Hz streams", restore_rate);
+			throttled = false;
+			request_stream_rate(restore_rate);
+		}
 	}
 
+	void request_stream_rate(uint16_t rate)
+	{
+		mavlink::common::msg::REQUEST_DATA_STREAM rq {};
+
+		rq.target_system = m_uas->get_tgt_system();
+		rq.target_component = m_uas->get_tgt_component();
+		rq.req_stream_id = utils::enum_value(mavlink::common::MAV_DATA_STREAM::ALL);
+		rq.req_message_rate = rate;
+		rq.start_stop = 1;
+
+		UAS_FCU(m_uas)->send_message_ignore_drop(rq);
+	}
 
 	void diag_run(diagnostic_updater::DiagnosticStatusWrapper &stat)
 	{
@@ -150,11 +231,12 @@ private:
 	{
 		UAS_DIAG(m_uas).removeByName("3DR Radio");
 		diag_added = false;
+		throttled = false;
 	}
 
 };
 }	// namespace std_plugins
 }	// namespace mavros
 
-#include <pluginlib/class_list_macros.h>
-PLUGINLIB_EXPORT_CLASS(mavros::std_plugins::TDRRadioPlugin, mavros::plugin::PluginBase)
+#include <mavros/plugin_register.h>
+MAVROS_PLUGIN_REGISTER("3dr_radio", mavros::std_plugins::TDRRadioPlugin)
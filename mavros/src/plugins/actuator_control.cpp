@@ -28,7 +28,7 @@ namespace std_plugins {
 class ActuatorControlPlugin : public plugin::PluginBase {
 public:
 	ActuatorControlPlugin() : PluginBase(),
-		nh("~")
+		nh(plugin_ns(""))
 	{ }
 
 	void initialize(UAS &uas_)
@@ -85,5 +85,5 @@ private:
 }	// namespace std_plugins
 }	// namespace mavros
 
-#include <pluginlib/class_list_macros.h>
-PLUGINLIB_EXPORT_CLASS(mavros::std_plugins::ActuatorControlPlugin, mavros::plugin::PluginBase)
+#include <mavros/plugin_register.h>
+MAVROS_PLUGIN_REGISTER("actuator_control", mavros::std_plugins::ActuatorControlPlugin)
@@ -14,19 +14,34 @@
  * https://github.com/mavlink/mavros/tree/master/LICENSE.md
  */
 
+#include <array>
+#include <cmath>
 #include <mavros/mavros_plugin.h>
 
+#include <std_msgs/Float64.h>
 #include <mavros_msgs/Altitude.h>
+#include <mavros_msgs/TerrainHeight.h>
 
 namespace mavros {
 namespace std_plugins {
 /**
  * @brief Altitude plugin.
+ *
+ * Besides republishing ALTITUDE, keeps a fixed-memory terrain tile
+ * cache fed from the TERRAIN_DATA/TERRAIN_REPORT stream, so local
+ * terrain height queries are served from memory instead of waiting
+ * on FCU request cycles.
  */
 class AltitudePlugin : public plugin::PluginBase {
 public:
 	AltitudePlugin() : PluginBase(),
-		nh("~")
+		nh(plugin_ns("")),
+		report_valid(false),
+		report_lat(0.0),
+		report_lon(0.0),
+		report_agl(0.0),
+		amsl_valid(false),
+		last_amsl(0.0)
 	{ }
 
 	/**
@@ -38,20 +53,127 @@ public:
 
 		nh.param<std::string>("frame_id", frame_id, "map");
 		altitude_pub = nh.advertise<mavros_msgs::Altitude>("altitude", 10);
+		terrain_agl_pub = nh.advertise<std_msgs::Float64>("terrain/agl", 10);
+		terrain_height_srv = nh.advertiseService("terrain/height", &AltitudePlugin::terrain_height_cb, this);
 	}
 
 	Subscriptions get_subscriptions()
 	{
 		return {
 			make_handler(&AltitudePlugin::handle_altitude),
+			make_handler(&AltitudePlugin::handle_terrain_data),
+			make_handler(&AltitudePlugin::handle_terrain_report),
 		};
 	}
 
 private:
+	using lock_guard = std::lock_guard<std::mutex>;
+	std::mutex mutex;
 	ros::NodeHandle nh;
 	std::string frame_id;
 
 	ros::Publisher altitude_pub;
+	ros::Publisher terrain_agl_pub;
+	ros::ServiceServer terrain_height_srv;
+
+	//! number of cached tiles: fixed memory, no allocation after startup
+	static constexpr size_t TILE_SLOTS = 64;
+	//! cells per tile side, TERRAIN_DATA carries one 4x4 block
+	static constexpr size_t TILE_SIDE = 4;
+	//! meters per degree of latitude, good enough for tile indexing
+	static constexpr double LAT_DEG_TO_M = 111318.845;
+
+	/** @brief One cached 4x4 terrain block */
+	struct TerrainTile {
+		bool valid;
+		double lat;		//!< SW corner [deg]
+		double lon;		//!< SW corner [deg]
+		double spacing;		//!< cell size [m]
+		std::array<int16_t, TILE_SIDE * TILE_SIDE> height;	//!< MSL [m], north rows
+
+		TerrainTile() :
+			valid(false),
+			lat(0.0), lon(0.0),
+			spacing(0.0)
+		{ }
+	};
+
+	std::array<TerrainTile, TILE_SLOTS> tiles;
+
+	bool report_valid;
+	double report_lat;	//!< position of the last TERRAIN_REPORT [deg]
+	double report_lon;
+	double report_agl;	//!< FCU AGL estimate from the last TERRAIN_REPORT [m]
+
+	bool amsl_valid;
+	double last_amsl;	//!< last ALTITUDE AMSL [m]
+
+	/* -*- terrain tile cache -*- */
+
+	//! Direct-mapped slot for a tile corner; collisions simply evict.
+	TerrainTile &tile_slot(double lat, double lon)
+	{
+		auto la = int32_t(lat * 1E7);
+		auto lo = int32_t(lon * 1E7);
+
+		return tiles[(size_t(la) * 73856093u ^ size_t(lo) * 19349663u) % TILE_SLOTS];
+	}
+
+	/**
+	 * @brief Terrain height lookup, O(TILE_SLOTS) scan over fixed memory.
+	 *
+	 * Requires mutex.
+	 *
+	 * @return true when a cached tile covers the point, sets @a height [m MSL]
+	 */
+	bool lookup_terrain(double lat, double lon, double &height)
+	{
+		for (const auto &tile : tiles) {
+			if (!tile.valid)
+				continue;
+
+			double north = (lat - tile.lat) * LAT_DEG_TO_M;
+			double east = (lon - tile.lon) * LAT_DEG_TO_M * std::cos(tile.lat * M_PI / 180.0);
+			double extent = TILE_SIDE * tile.spacing;
+
+			if (north < 0.0 || north >= extent || east < 0.0 || east >= extent)
+				continue;
+
+			size_t n = north / tile.spacing;
+			size_t e = east / tile.spacing;
+
+			height = tile.height[n * TILE_SIDE + e];
+			return true;
+		}
+
+		return false;
+	}
+
+	/**
+	 * @brief Publish AMSL fused with the cached terrain height.
+	 *
+	 * Falls back to the FCU AGL estimate until a tile covering the
+	 * current position is cached. Requires mutex.
+	 */
+	void publish_fused_agl()
+	{
+		if (terrain_agl_pub.getNumSubscribers() == 0)
+			return;
+
+		double terrain;
+		auto agl_msg = boost::make_shared<std_msgs::Float64>();
+
+		if (amsl_valid && report_valid && lookup_terrain(report_lat, report_lon, terrain))
+			agl_msg->data = last_amsl - terrain;
+		else if (report_valid)
+			agl_msg->data = report_agl;
+		else
+			return;
+
+		terrain_agl_pub.publish(agl_msg);
+	}
+
+	/* -*- rx handlers -*- */
 
 	void handle_altitude(const mavlink::mavlink_message_t *msg, mavlink::common::msg::ALTITUDE &altitude)
 	{
@@ -66,10 +188,62 @@ private:
 		ros_msg->bottom_clearance = altitude.bottom_clearance;
 
 		altitude_pub.publish(ros_msg);
+
+		lock_guard lock(mutex);
+		amsl_valid = std::isfinite(altitude.altitude_amsl);
+		last_amsl = altitude.altitude_amsl;
+		publish_fused_agl();
+	}
+
+	void handle_terrain_data(const mavlink::mavlink_message_t *msg, mavlink::common::msg::TERRAIN_DATA &data)
+	{
+		// gridbit addresses one 4x4 block of the 8x7 request grid,
+		// counted north-first from the SW corner (ArduPilot terrain protocol)
+		double north = (data.gridbit / 8) * TILE_SIDE * double(data.grid_spacing);
+		double east = (data.gridbit % 8) * TILE_SIDE * double(data.grid_spacing);
+
+		double lat = data.lat / 1E7 + north / LAT_DEG_TO_M;
+		double lon = data.lon / 1E7 + east / (LAT_DEG_TO_M * std::cos(lat * M_PI / 180.0));
+
+		lock_guard lock(mutex);
+
+		auto &tile = tile_slot(lat, lon);
+		tile.valid = true;
+		tile.lat = lat;
+		tile.lon = lon;
+		tile.spacing = data.grid_spacing;
+		std::copy(data.data.begin(), data.data.end(), tile.height.begin());
+	}
+
+	void handle_terrain_report(const mavlink::mavlink_message_t *msg, mavlink::common::msg::TERRAIN_REPORT &report)
+	{
+		lock_guard lock(mutex);
+
+		report_valid = true;
+		report_lat = report.lat / 1E7;
+		report_lon = report.lon / 1E7;
+		report_agl = report.current_height;
+		publish_fused_agl();
+	}
+
+	/* -*- callbacks -*- */
+
+	bool terrain_height_cb(mavros_msgs::TerrainHeight::Request &req,
+			mavros_msgs::TerrainHeight::Response &res)
+	{
+		lock_guard lock(mutex);
+
+		double height;
+
+		res.success = lookup_terrain(req.latitude, req.longitude, height);
+		if (res.success)
+			res.height = height;
+
+		return true;
 	}
 };
 }	// namespace std_plugins
 }	// namespace mavros
 
-#include <pluginlib/class_list_macros.h>
-PLUGINLIB_EXPORT_CLASS(mavros::std_plugins::AltitudePlugin, mavros::plugin::PluginBase)
+#include <mavros/plugin_register.h>
+MAVROS_PLUGIN_REGISTER("altitude", mavros::std_plugins::AltitudePlugin)
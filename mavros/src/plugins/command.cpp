@@ -14,10 +14,13 @@
  * https://github.com/mavlink/mavros/tree/master/LICENSE.md
  */
 
-#include <chrono>
-#include <condition_variable>
+#include <array>
+#include <list>
 #include <mavros/mavros_plugin.h>
+#include <mavros/transaction.h>
 
+#include <mavros_msgs/CommandAsync.h>
+#include <mavros_msgs/CommandResult.h>
 #include <mavros_msgs/CommandLong.h>
 #include <mavros_msgs/CommandInt.h>
 #include <mavros_msgs/CommandBool.h>
@@ -36,19 +39,32 @@ using unique_lock = std::unique_lock<std::mutex>;
 
 class CommandTransaction {
 public:
-	std::mutex cond_mutex;
-	std::condition_variable ack;
+	TransactionWaiter waiter;
 	uint16_t expected_command;
 	uint8_t result;
 
 	explicit CommandTransaction(uint16_t command) :
-		ack(),
 		expected_command(command),
 		// Default result if wait ack timeout
 		result(enum_value(mavlink::common::MAV_RESULT::FAILED))
 	{ }
 };
 
+/**
+ * @brief Queued command waiting for COMMAND_ACK
+ *
+ * Unlike CommandTransaction no thread blocks on it: the outcome is
+ * published on ~cmd/result, retries are paced by the engine timer.
+ */
+struct AsyncTransaction {
+	uint32_t token;
+	uint16_t command;
+	uint8_t confirmation;		//!< incremented on each retransmission
+	int tries_left;
+	ros::Time retry_deadline;
+	std::array<float, 7> params;
+};
+
 /**
  * @brief Command plugin.
  *
@@ -57,8 +73,10 @@ public:
 class CommandPlugin : public plugin::PluginBase {
 public:
 	CommandPlugin() : PluginBase(),
-		cmd_nh("~cmd"),
-		use_comp_id_system_control(false)
+		cmd_nh(plugin_ns("cmd")),
+		use_comp_id_system_control(false),
+		async_retries(3),
+		next_token(0)
 	{ }
 
 	void initialize(UAS &uas_)
@@ -66,13 +84,24 @@ public:
 		PluginBase::initialize(uas_);
 
 		double command_ack_timeout;
+		double async_retry_interval;
 
 		cmd_nh.param("command_ack_timeout", command_ack_timeout, ACK_TIMEOUT_DEFAULT);
 		cmd_nh.param("use_comp_id_system_control", use_comp_id_system_control, false);
+		cmd_nh.param("async_retry_interval", async_retry_interval, 1.0);
+		cmd_nh.param("async_retries", async_retries, 3);
 
 		command_ack_timeout_dt = ros::Duration(command_ack_timeout);
+		async_retry_dt = ros::Duration(async_retry_interval);
+
+		result_pub = cmd_nh.advertise<mavros_msgs::CommandResult>("result", 10);
+
+		// paces retransmissions; runs only while transactions pending
+		retry_timer = cmd_nh.createTimer(ros::Duration(RETRY_TICK_S),
+				&CommandPlugin::retry_cb, this, false, false);
 
 		command_long_srv = cmd_nh.advertiseService("command", &CommandPlugin::command_long_cb, this);
+		command_async_srv = cmd_nh.advertiseService("command_async", &CommandPlugin::command_async_cb, this);
 		command_int_srv = cmd_nh.advertiseService("command_int", &CommandPlugin::command_int_cb, this);
 		arming_srv = cmd_nh.advertiseService("arming", &CommandPlugin::arming_cb, this);
 		set_home_srv = cmd_nh.advertiseService("set_home", &CommandPlugin::set_home_cb, this);
@@ -96,7 +125,9 @@ private:
 	std::mutex mutex;
 
 	ros::NodeHandle cmd_nh;
+	ros::Publisher result_pub;
 	ros::ServiceServer command_long_srv;
+	ros::ServiceServer command_async_srv;
 	ros::ServiceServer command_int_srv;
 	ros::ServiceServer arming_srv;
 	ros::ServiceServer set_home_srv;
@@ -111,6 +142,15 @@ private:
 	L_CommandTransaction ack_waiting_list;
 	ros::Duration command_ack_timeout_dt;
 
+	//! retry deadline check granularity
+	static constexpr double RETRY_TICK_S = 0.1;
+
+	std::list<AsyncTransaction> async_list;
+	ros::Duration async_retry_dt;
+	int async_retries;
+	uint32_t next_token;
+	ros::Timer retry_timer;
+
 	/* -*- message handlers -*- */
 
 	void handle_command_ack(const mavlink::mavlink_message_t *msg, mavlink::common::msg::COMMAND_ACK &ack)
@@ -122,7 +162,18 @@ private:
 		for (auto &tr : ack_waiting_list) {
 			if (tr.expected_command == ack.command) {
 				tr.result = ack.result;
-				tr.ack.notify_all();
+				tr.waiter.complete(true);
+				return;
+			}
+		}
+
+		// oldest queued transaction for that command
+		for (auto it = async_list.begin(); it != async_list.end(); it++) {
+			if (it->command == ack.command) {
+				publish_result(it->token, it->command, ack.result);
+				async_list.erase(it);
+				if (async_list.empty())
+					retry_timer.stop();
 				return;
 			}
 		}
@@ -133,9 +184,62 @@ private:
 
 	/* -*- mid-level functions -*- */
 
+	void publish_result(uint32_t token, uint16_t command, uint8_t result)
+	{
+		using mavlink::common::MAV_RESULT;
+
+		auto msg = boost::make_shared<mavros_msgs::CommandResult>();
+
+		msg->header.stamp = ros::Time::now();
+		msg->token = token;
+		msg->command = command;
+		msg->result = result;
+		msg->success = result == enum_value(MAV_RESULT::ACCEPTED);
+
+		result_pub.publish(msg);
+	}
+
+	//! retransmit overdue queued commands, fail them after async_retries
+	void retry_cb(const ros::TimerEvent &event)
+	{
+		using mavlink::common::MAV_RESULT;
+
+		lock_guard lock(mutex);
+
+		auto now = ros::Time::now();
+		for (auto it = async_list.begin(); it != async_list.end(); ) {
+			if (it->retry_deadline > now) {
+				it++;
+				continue;
+			}
+
+			if (it->tries_left > 0) {
+				it->tries_left--;
+				it->confirmation++;	// confirmation counts retransmissions
+				it->retry_deadline = now + async_retry_dt;
+
+				ROS_DEBUG_NAMED("cmd", "CMD: retransmit command %u, tries left %d",
+					it->command, it->tries_left);
+				command_long(false, it->command, it->confirmation,
+					it->params[0], it->params[1],
+					it->params[2], it->params[3],
+					it->params[4], it->params[5],
+					it->params[6]);
+				it++;
+			}
+			else {
+				ROS_WARN_NAMED("cmd", "CMD: Command %u -- no ack after retries", it->command);
+				publish_result(it->token, it->command, enum_value(MAV_RESULT::FAILED));
+				it = async_list.erase(it);
+			}
+		}
+
+		if (async_list.empty())
+			retry_timer.stop();
+	}
+
 	bool wait_ack_for(CommandTransaction &tr) {
-		unique_lock lock(tr.cond_mutex);
-		if (tr.ack.wait_for(lock, std::chrono::nanoseconds(command_ack_timeout_dt.toNSec())) == std::cv_status::timeout) {
+		if (!tr.waiter.wait_for(command_ack_timeout_dt)) {
 			ROS_WARN_NAMED("cmd", "CMD: Command %u -- wait ack timeout", tr.expected_command);
 			return false;
 		} else {
@@ -309,6 +413,46 @@ private:
 			res.success, res.result);
 	}
 
+	bool command_async_cb(mavros_msgs::CommandAsync::Request &req,
+		mavros_msgs::CommandAsync::Response &res)
+	{
+		using mavlink::common::MAV_RESULT;
+
+		lock_guard lock(mutex);
+
+		const uint32_t token = next_token++;
+
+		command_long(req.broadcast,
+			req.command, req.confirmation,
+			req.param1, req.param2,
+			req.param3, req.param4,
+			req.param5, req.param6,
+			req.param7);
+
+		// same ack expectation rule as send_command_long_and_wait()
+		bool is_ack_required = (req.confirmation != 0 || m_uas->is_ardupilotmega() || m_uas->is_px4()) && !req.broadcast;
+		if (is_ack_required) {
+			AsyncTransaction tr;
+
+			tr.token = token;
+			tr.command = req.command;
+			tr.confirmation = req.confirmation;
+			tr.tries_left = async_retries;
+			tr.retry_deadline = ros::Time::now() + async_retry_dt;
+			tr.params = {{req.param1, req.param2, req.param3, req.param4,
+				      req.param5, req.param6, req.param7}};
+
+			async_list.push_back(tr);
+			retry_timer.start();
+		}
+		else
+			publish_result(token, req.command, enum_value(MAV_RESULT::ACCEPTED));
+
+		res.success = true;
+		res.token = token;
+		return true;
+	}
+
 	bool command_int_cb(mavros_msgs::CommandInt::Request &req,
 		mavros_msgs::CommandInt::Response &res)
 	{
@@ -409,5 +553,5 @@ private:
 }	// namespace std_plugins
 }	// namespace mavros
 
-#include <pluginlib/class_list_macros.h>
-PLUGINLIB_EXPORT_CLASS(mavros::std_plugins::CommandPlugin, mavros::plugin::PluginBase)
+#include <mavros/plugin_register.h>
+MAVROS_PLUGIN_REGISTER("command", mavros::std_plugins::CommandPlugin)
@@ -28,7 +28,7 @@ namespace std_plugins {
 class DummyPlugin : public plugin::PluginBase {
 public:
 	DummyPlugin() : PluginBase(),
-		nh("~")
+		nh(plugin_ns(""))
 	{ }
 
 	/**
@@ -83,5 +83,5 @@ private:
 }	// namespace std_plugins
 }	// namespace mavros
 
-#include <pluginlib/class_list_macros.h>
-PLUGINLIB_EXPORT_CLASS(mavros::std_plugins::DummyPlugin, mavros::plugin::PluginBase)
+#include <mavros/plugin_register.h>
+MAVROS_PLUGIN_REGISTER("dummy", mavros::std_plugins::DummyPlugin)
@@ -14,16 +14,29 @@
  * https://github.com/mavlink/mavros/tree/master/LICENSE.md
  */
 
-#include <chrono>
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cerrno>
 #include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
 #include <mavros/mavros_plugin.h>
+#include <mavros/transaction.h>
+#include <mavconn/thread_utils.h>
 
 #include <std_srvs/Empty.h>
 #include <mavros_msgs/FileEntry.h>
 #include <mavros_msgs/FileList.h>
 #include <mavros_msgs/FileOpen.h>
 #include <mavros_msgs/FileClose.h>
+#include <mavros_msgs/FileDownload.h>
 #include <mavros_msgs/FileRead.h>
 #include <mavros_msgs/FileWrite.h>
 #include <mavros_msgs/FileRemove.h>
@@ -55,7 +68,8 @@ public:
 		uint8_t		opcode;		///< Command opcode
 		uint8_t		size;		///< Size of data
 		uint8_t		req_opcode;	///< Request opcode returned in kRspAck, kRspNak message
-		uint8_t		padding[2];	///< 32 bit aligment padding
+		uint8_t		burst_complete;	///< Only used if req_opcode=kCmdBurstReadFile - 1: set of burst packets complete, 0: more coming
+		uint8_t		padding;	///< 32 bit aligment padding
 		uint32_t	offset;		///< Offsets for List and Read commands
 		uint8_t		data[];		///< command data, varies by Opcode
 	};
@@ -175,7 +189,7 @@ public:
 				hdr->seqNumber, hdr->session, hdr->opcode, hdr->size, hdr->offset);
 #endif
 
-		UAS_FCU(uas)->send_message_ignore_drop(*this);
+		UAS_FCU(uas)->send_message_ignore_drop(*this, mavconn::TxPrio::BULK);
 	}
 
 	FTPRequest() :
@@ -197,7 +211,8 @@ public:
 class FTPPlugin : public plugin::PluginBase {
 public:
 	FTPPlugin() : PluginBase(),
-		ftp_nh("~ftp"),
+		ftp_nh(plugin_ns("ftp")),
+		ftp_timer_nh(plugin_ns("ftp")),
 		op_state(OP::IDLE),
 		last_send_seqnr(0),
 		active_session(0),
@@ -208,10 +223,36 @@ public:
 		write_offset(0),
 		open_size(0),
 		read_size(0),
+		read_end(0),
 		read_buffer {},
+		burst_ok(false),
+		burst_enabled(true),
+		cache_enabled(true),
+		service_active(0),
+		prefetch_busy(false),
+		prefetch_should_exit(false),
+		read_window(8),
+		read_to_file(false),
+		download_fd(-1),
+		download_map(nullptr),
+		download_size(0),
+		download_crc(0),
+		download_crc_offset(0),
 		checksum_crc32(0)
 	{ }
 
+	~FTPPlugin()
+	{
+		if (prefetch_thread.joinable()) {
+			{
+				std::lock_guard<std::mutex> lock(cache_mutex);
+				prefetch_should_exit = true;
+			}
+			prefetch_cv.notify_all();
+			prefetch_thread.join();
+		}
+	}
+
 	void initialize(UAS &uas_)
 	{
 		PluginBase::initialize(uas_);
@@ -220,10 +261,31 @@ public:
 		FTPRequest r;
 		ROS_ASSERT(r.payload.size() - sizeof(FTPRequest::PayloadHeader) == r.DATA_MAXSZ);
 
+		// long transfers must not block the control-path spinners
+		m_uas->set_cb_queue(ftp_nh, UAS::CbQueue::BULK);
+
+		// burst_read streams chunks with kCmdBurstReadFile instead of
+		// requesting them one-by-one; read_window caps outstanding
+		// kCmdReadFile requests when retransmitting lost chunks.
+		ftp_nh.param("burst_read", burst_enabled, true);
+		ftp_nh.param("read_window", read_window, 8);
+
+		// listing cache: repeated ~ftp/list calls answer from memory,
+		// subdirectories of a listed directory are walked in background
+		ftp_nh.param("list_cache", cache_enabled, true);
+		if (cache_enabled)
+			prefetch_thread = std::thread(&FTPPlugin::prefetch_worker, this);
+
+		// the watchdog can not share the BULK queue: its single
+		// thread is blocked inside the service call during transfer
+		read_stall_timer = ftp_timer_nh.createTimer(ros::Duration(CHUNK_TIMEOUT_MS / 1000.0),
+				&FTPPlugin::read_stall_cb, this, true, false);
+
 		list_srv = ftp_nh.advertiseService("list", &FTPPlugin::list_cb, this);
 		open_srv = ftp_nh.advertiseService("open", &FTPPlugin::open_cb, this);
 		close_srv = ftp_nh.advertiseService("close", &FTPPlugin::close_cb, this);
 		read_srv = ftp_nh.advertiseService("read", &FTPPlugin::read_cb, this);
+		download_srv = ftp_nh.advertiseService("download", &FTPPlugin::download_cb, this);
 		write_srv = ftp_nh.advertiseService("write", &FTPPlugin::write_cb, this);
 		mkdir_srv = ftp_nh.advertiseService("mkdir", &FTPPlugin::mkdir_cb, this);
 		rmdir_srv = ftp_nh.advertiseService("rmdir", &FTPPlugin::rmdir_cb, this);
@@ -243,10 +305,12 @@ public:
 
 private:
 	ros::NodeHandle ftp_nh;
+	ros::NodeHandle ftp_timer_nh;	//!< stays on the normal cb queue, see initialize()
 	ros::ServiceServer list_srv;
 	ros::ServiceServer open_srv;
 	ros::ServiceServer close_srv;
 	ros::ServiceServer read_srv;
+	ros::ServiceServer download_srv;
 	ros::ServiceServer write_srv;
 	ros::ServiceServer mkdir_srv;
 	ros::ServiceServer rmdir_srv;
@@ -273,8 +337,7 @@ private:
 	uint16_t last_send_seqnr;	//!< seqNumber for send.
 	uint32_t active_session;	//!< session id of current operation
 
-	std::mutex cond_mutex;
-	std::condition_variable cond;	//!< wait condvar
+	TransactionWaiter waiter;	//!< service thread gate, completed by go_idle()
 	bool is_error;			//!< error signaling flag (timeout/proto error)
 	int r_errno;			//!< store errno from server
 
@@ -283,6 +346,52 @@ private:
 	std::string list_path;
 	std::vector<mavros_msgs::FileEntry> list_entries;
 
+	/* -*- listing cache -*-
+	 *
+	 * One kCmdListDirectory round-trip per directory offset makes SD
+	 * card browsing painful at radio latency, so successful listings
+	 * are cached by path and their subdirectories are listed in
+	 * background by prefetch_worker(). Write operations through this
+	 * plugin invalidate the affected paths; other writers (FCU itself,
+	 * a second GCS) are invisible, hence ~ftp/list_cache to opt out.
+	 *
+	 * The protocol machine has no locking of its own: services assume
+	 * they run alone on the BULK queue. The prefetch thread therefore
+	 * claims the machine only while service_active == 0, and services
+	 * wait out a running prefetch in ServiceGuard instead of failing
+	 * with Busy.
+	 */
+	bool cache_enabled;		//!< ~ftp/list_cache
+	std::unordered_map<std::string, std::vector<mavros_msgs::FileEntry>> list_cache;
+	std::deque<std::string> prefetch_queue;
+	std::mutex cache_mutex;		//!< cache, queue and the claim flags below
+	std::condition_variable prefetch_cv;
+	int service_active;		//!< service calls inside their guard
+	bool prefetch_busy;		//!< prefetch owns the protocol machine
+	bool prefetch_should_exit;
+	std::thread prefetch_thread;
+
+	//! Scoped service-side claim of the protocol machine
+	struct ServiceGuard {
+		FTPPlugin *p;
+
+		explicit ServiceGuard(FTPPlugin *p_) : p(p_)
+		{
+			std::unique_lock<std::mutex> lock(p->cache_mutex);
+			p->prefetch_cv.wait(lock, [this] { return !p->prefetch_busy; });
+			p->service_active++;
+		}
+
+		~ServiceGuard()
+		{
+			{
+				std::lock_guard<std::mutex> lock(p->cache_mutex);
+				p->service_active--;
+			}
+			p->prefetch_cv.notify_all();
+		}
+	};
+
 	// FTP:Open / FTP:Close
 	std::string open_path;
 	size_t open_size;
@@ -290,8 +399,32 @@ private:
 
 	// FTP:Read
 	size_t read_size;
-	uint32_t read_offset;
+	uint32_t read_offset;		//!< requested start offset
+	uint32_t read_end;		//!< offset past last expected byte, shrinks when EOF found
 	V_FileData read_buffer;
+	std::vector<bool> read_chunk_got;	//!< arrival mark per DATA_MAXSZ chunk
+	std::unordered_set<uint32_t> read_inflight;	//!< offsets requested via kCmdReadFile
+	bool burst_ok;			//!< burst usable for rest of current transfer
+	bool burst_enabled;		//!< ~ftp/burst_read
+	int read_window;		//!< ~ftp/read_window
+	ros::Timer read_stall_timer;	//!< retransmit kick when chunks stop arriving
+
+	/**
+	 * Serializes the read state machine between its three threads: the
+	 * rx thread (handle_file_transfer_protocol), the stall watchdog
+	 * (normal queue, see initialize()) and the service thread setting a
+	 * transfer up. Without it the watchdog's read_inflight.clear()
+	 * races handle_ack_read's insert/erase on the same set.
+	 */
+	std::mutex proto_mutex;
+
+	// FTP:Download (read streamed to mmap'ed local file, see download_cb)
+	bool read_to_file;		//!< chunk sink: local file instead of read_buffer
+	int download_fd;
+	uint8_t *download_map;
+	size_t download_size;
+	uint32_t download_crc;		//!< running CRC32 of [read_offset, download_crc_offset)
+	uint32_t download_crc_offset;	//!< contiguous frontier the CRC advanced to
 
 	// FTP:Write
 	uint32_t write_offset;
@@ -320,6 +453,8 @@ private:
 	//! handler for mavlink::common::msg::FILE_TRANSFER_PROTOCOL
 	void handle_file_transfer_protocol(const mavlink::mavlink_message_t *msg, FTPRequest &req)
 	{
+		std::lock_guard<std::mutex> lock(proto_mutex);
+
 		if (!req.decode_valid(m_uas)) {
 			ROS_DEBUG_NAMED("ftp", "FTP: Wrong System Id, MY %u, TGT %u",
 					UAS_FCU(m_uas)->get_system_id(), req.get_target_system_id());
@@ -329,10 +464,19 @@ private:
 		const uint16_t incoming_seqnr = req.header()->seqNumber;
 		const uint16_t expected_seqnr = last_send_seqnr + 1;
 		if (incoming_seqnr != expected_seqnr) {
-			ROS_WARN_NAMED("ftp", "FTP: Lost sync! seqnr: %u != %u",
-					incoming_seqnr, expected_seqnr);
-			go_idle(true, EILSEQ);
-			return;
+			if (op_state == OP::READ) {
+				// burst chunks may be lost in flight; the offset
+				// bookkeeping in handle_ack_read recovers the
+				// payload, so only resync the counter
+				ROS_DEBUG_NAMED("ftp", "FTP: read seqnr gap: %u != %u",
+						incoming_seqnr, expected_seqnr);
+			}
+			else {
+				ROS_WARN_NAMED("ftp", "FTP: Lost sync! seqnr: %u != %u",
+						incoming_seqnr, expected_seqnr);
+				go_idle(true, EILSEQ);
+				return;
+			}
 		}
 
 		last_send_seqnr = incoming_seqnr;
@@ -351,7 +495,11 @@ private:
 	void handle_req_ack(FTPRequest &req)
 	{
 		switch (op_state) {
-		case OP::IDLE:		send_reset();			break;
+		case OP::IDLE:
+			// tail of an already finished burst is not an error
+			if (req.header()->req_opcode != FTPRequest::kCmdBurstReadFile)
+				send_reset();
+			break;
 		case OP::ACK:		go_idle(false);			break;
 		case OP::LIST:		handle_ack_list(req);		break;
 		case OP::OPEN:		handle_ack_open(req);		break;
@@ -393,8 +541,23 @@ private:
 			return;
 		}
 		else if (prev_op == OP::READ && error_code == FTPRequest::kErrEOF) {
-			/* read done */
-			read_file_end();
+			/* a read request ran past end of file, transfer continues */
+			op_state = OP::READ;
+			if (hdr->req_opcode == FTPRequest::kCmdReadFile) {
+				read_inflight.erase(hdr->offset);
+				note_read_end(hdr->offset);
+			}
+			else
+				// burst EOF carries no end offset:
+				// probe the rest chunk-by-chunk
+				burst_ok = false;
+
+			request_next_read();
+			return;
+		}
+		else if (prev_op == OP::IDLE && error_code == FTPRequest::kErrEOF &&
+				hdr->req_opcode == FTPRequest::kCmdBurstReadFile) {
+			/* late EOF of an already finished burst */
 			return;
 		}
 
@@ -479,35 +642,56 @@ private:
 	void handle_ack_read(FTPRequest &req)
 	{
 		auto hdr = req.header();
+		const bool is_burst = hdr->req_opcode == FTPRequest::kCmdBurstReadFile;
 
-		ROS_DEBUG_NAMED("ftp", "FTP:m: ACK Read SZ(%u)", hdr->size);
+		ROS_DEBUG_NAMED("ftp", "FTP:m: ACK Read SZ(%u) OFF(%u) BC(%u)",
+				hdr->size, hdr->offset, hdr->burst_complete);
 		if (hdr->session != active_session) {
 			ROS_ERROR_NAMED("ftp", "FTP:Read unexpected session");
 			go_idle(true, EBADSLT);
 			return;
 		}
 
-		if (hdr->offset != read_offset) {
-			ROS_ERROR_NAMED("ftp", "FTP:Read different offset");
-			go_idle(true, EBADE);
+		if (hdr->offset < read_offset ||
+				(hdr->offset - read_offset) % FTPRequest::DATA_MAXSZ != 0) {
+			// stale chunk of a previous request, the current
+			// transfer is not harmed
+			ROS_DEBUG_NAMED("ftp", "FTP:m: Read stray chunk OFF(%u)", hdr->offset);
 			return;
 		}
 
-		// kCmdReadFile return cunks of DATA_MAXSZ or smaller (last chunk)
-		// We requested specific amount of data, that can be smaller,
-		// but not larger.
-		const size_t bytes_left = read_size - read_buffer.size();
-		const size_t bytes_to_copy = std::min<size_t>(bytes_left, hdr->size);
+		restart_read_stall_timer();
+
+		const uint32_t chunk = (hdr->offset - read_offset) / FTPRequest::DATA_MAXSZ;
+		if (!is_burst)
+			read_inflight.erase(hdr->offset);
 
-		read_buffer.insert(read_buffer.end(), req.data(), req.data() + bytes_to_copy);
+		// kCmdReadFile/kCmdBurstReadFile return chunks of DATA_MAXSZ
+		// or smaller (last chunk). Chunks may arrive out of order,
+		// place them by offset and mark arrival.
+		if (chunk < read_chunk_got.size() && !read_chunk_got[chunk]) {
+			const size_t buf_off = hdr->offset - read_offset;
+			const size_t range_sz = read_to_file ? download_size : read_buffer.size();
+			const size_t bytes_to_copy = std::min<size_t>(range_sz - buf_off, hdr->size);
 
-		if (bytes_to_copy == FTPRequest::DATA_MAXSZ) {
-			// Possibly more data
-			read_offset += bytes_to_copy;
-			send_read_command();
+			if (read_to_file)
+				std::memcpy(download_map + buf_off, req.data(), bytes_to_copy);
+			else
+				std::copy(req.data(), req.data() + bytes_to_copy, read_buffer.begin() + buf_off);
+			read_chunk_got[chunk] = true;
+
+			if (read_to_file)
+				download_advance_crc();
 		}
-		else
-			read_file_end();
+
+		// short chunk: EOF inside the requested range
+		if (hdr->size < FTPRequest::DATA_MAXSZ)
+			note_read_end(hdr->offset + hdr->size);
+
+		// mid-burst chunks are server paced,
+		// everything else advances the transfer
+		if (!is_burst || hdr->burst_complete)
+			request_next_read();
 	}
 
 	void handle_ack_write(FTPRequest &req)
@@ -570,11 +754,12 @@ private:
 	 */
 	void go_idle(bool is_error_, int r_errno_ = 0)
 	{
+		read_stall_timer.stop();
 		op_state = OP::IDLE;
 		is_error = is_error_;
 		if (is_error && r_errno_ != 0) r_errno = r_errno_;
 		else if (!is_error) r_errno = 0;
-		cond.notify_all();
+		waiter.complete(!is_error);
 	}
 
 	void send_reset()
@@ -626,16 +811,27 @@ private:
 		req.send(m_uas, last_send_seqnr);
 	}
 
-	void send_read_command()
+	void send_read_command(uint32_t offset)
 	{
 		// read operation always try read DATA_MAXSZ block (hdr->size ignored)
-		ROS_DEBUG_STREAM_NAMED("ftp", "FTP:m: kCmdReadFile: " << active_session << " off: " << read_offset);
+		ROS_DEBUG_STREAM_NAMED("ftp", "FTP:m: kCmdReadFile: " << active_session << " off: " << offset);
 		FTPRequest req(FTPRequest::kCmdReadFile, active_session);
-		req.header()->offset = read_offset;
+		req.header()->offset = offset;
 		req.header()->size = 0 /* FTPRequest::DATA_MAXSZ */;
 		req.send(m_uas, last_send_seqnr);
 	}
 
+	void send_burst_read_command(uint32_t offset)
+	{
+		// server streams chunks on its own pace until EOF,
+		// last one of a batch marked with burst_complete
+		ROS_DEBUG_STREAM_NAMED("ftp", "FTP:m: kCmdBurstReadFile: " << active_session << " off: " << offset);
+		FTPRequest req(FTPRequest::kCmdBurstReadFile, active_session);
+		req.header()->offset = offset;
+		req.header()->size = 0;
+		req.send(m_uas, last_send_seqnr);
+	}
+
 	void send_write_command(const size_t bytes_to_copy)
 	{
 		// write chunk from write_buffer [write_it..bytes_to_copy]
@@ -733,6 +929,104 @@ private:
 		send_list_command();
 	}
 
+	/* -*- listing cache -*- */
+
+	static std::string parent_of(const std::string &path)
+	{
+		auto pos = path.find_last_of('/');
+		if (pos == std::string::npos)
+			return "";
+
+		return (pos == 0) ? "/" : path.substr(0, pos);
+	}
+
+	//! Store a fresh listing and queue its subdirectories for prefetch
+	void cache_store(const std::string &path, const std::vector<mavros_msgs::FileEntry> &list)
+	{
+		std::lock_guard<std::mutex> lock(cache_mutex);
+
+		list_cache[path] = list;
+
+		for (auto &ent : list) {
+			if (ent.type != mavros_msgs::FileEntry::TYPE_DIRECTORY ||
+					ent.name == "." || ent.name == "..")
+				continue;
+
+			auto child = path;
+			if (child.empty() || child.back() != '/')
+				child += '/';
+			child += ent.name;
+
+			if (list_cache.count(child) == 0 &&
+					std::find(prefetch_queue.begin(), prefetch_queue.end(), child) == prefetch_queue.end())
+				prefetch_queue.push_back(child);
+		}
+
+		prefetch_cv.notify_all();
+	}
+
+	//! Drop the path, everything below it and its parent listing
+	void cache_invalidate(const std::string &path)
+	{
+		if (!cache_enabled)
+			return;
+
+		std::lock_guard<std::mutex> lock(cache_mutex);
+
+		list_cache.erase(parent_of(path));
+		list_cache.erase(path);
+
+		auto prefix = path + "/";
+		for (auto it = list_cache.begin(); it != list_cache.end(); )
+			it = (it->first.compare(0, prefix.size(), prefix) == 0) ?
+				list_cache.erase(it) : std::next(it);
+	}
+
+	void cache_clear()
+	{
+		std::lock_guard<std::mutex> lock(cache_mutex);
+		list_cache.clear();
+		prefetch_queue.clear();
+	}
+
+	void prefetch_worker()
+	{
+		mavconn::utils::set_this_thread_name("ftp-prefetch");
+
+		std::unique_lock<std::mutex> lock(cache_mutex);
+		while (!prefetch_should_exit) {
+			if (prefetch_queue.empty() || service_active > 0) {
+				prefetch_cv.wait(lock);
+				continue;
+			}
+
+			auto path = prefetch_queue.front();
+			prefetch_queue.pop_front();
+			if (list_cache.count(path) > 0)
+				continue;
+
+			prefetch_busy = true;
+			lock.unlock();
+
+			// machine claimed: no service runs until prefetch_busy drops
+			waiter.reset();
+			list_directory(path);
+			bool ok = wait_completion(LIST_TIMEOUT_MS);
+
+			if (ok) {
+				ROS_DEBUG_STREAM_NAMED("ftp", "FTP: prefetched " << path
+						<< " (" << list_entries.size() << " entries)");
+				cache_store(path, list_entries);
+				list_entries.clear();
+			}
+			// failure is not retried: the next explicit list will try again
+
+			lock.lock();
+			prefetch_busy = false;
+			prefetch_cv.notify_all();
+		}
+	}
+
 	bool open_file(std::string &path, int mode)
 	{
 		open_path = path;
@@ -772,11 +1066,15 @@ private:
 
 	void read_file_end() {
 		ROS_DEBUG_NAMED("ftp", "FTP:Read done");
+		if (read_end - read_offset < read_buffer.size())
+			read_buffer.resize(read_end - read_offset);
 		go_idle(false);
 	}
 
 	bool read_file(std::string &path, size_t off, size_t len)
 	{
+		std::lock_guard<std::mutex> lock(proto_mutex);
+
 		auto it = session_file_map.find(path);
 		if (it == session_file_map.end()) {
 			ROS_ERROR_NAMED("ftp", "FTP:Read %s: not opened", path.c_str());
@@ -788,17 +1086,226 @@ private:
 		active_session = it->second;
 		read_size = len;
 		read_offset = off;
+		read_end = off + len;
+		burst_ok = burst_enabled;
+		read_inflight.clear();
 		read_buffer.clear();
 		if (read_buffer.capacity() < len ||
 				read_buffer.capacity() > len + MAX_RESERVE_DIFF) {
 			// reserve memory
 			read_buffer.reserve(len);
 		}
+		read_buffer.resize(len);
+		read_chunk_got.assign(read_chunks_needed(), false);
 
-		send_read_command();
+		request_next_read();
+		restart_read_stall_timer();
 		return true;
 	}
 
+	//! number of chunks of the current transfer still meaningful
+	uint32_t read_chunks_needed()
+	{
+		if (read_end <= read_offset)
+			return 0;
+
+		return (read_end - read_offset + FTPRequest::DATA_MAXSZ - 1) / FTPRequest::DATA_MAXSZ;
+	}
+
+	//! shrink expected range when EOF shows up inside it
+	void note_read_end(uint32_t end_offset)
+	{
+		if (end_offset < read_end)
+			read_end = end_offset;
+	}
+
+	/**
+	 * @brief Request more file data
+	 *
+	 * Ends the transfer when all chunks arrived, (re)starts the burst
+	 * at the first hole when the rest of the range is all missing, or
+	 * selectively re-requests up to read_window lost chunks.
+	 */
+	void request_next_read()
+	{
+		const uint32_t nchunks = read_chunks_needed();
+
+		uint32_t first_missing = 0;
+		while (first_missing < nchunks && read_chunk_got[first_missing])
+			first_missing++;
+
+		if (first_missing == nchunks) {
+			read_file_end();
+			return;
+		}
+
+		bool tail_all_missing = burst_ok && read_inflight.empty();
+		for (uint32_t i = first_missing; i < nchunks && tail_all_missing; i++)
+			tail_all_missing = !read_chunk_got[i];
+
+		if (tail_all_missing) {
+			send_burst_read_command(read_offset + first_missing * FTPRequest::DATA_MAXSZ);
+			return;
+		}
+
+		for (uint32_t i = first_missing;
+				i < nchunks && read_inflight.size() < size_t(std::max(1, read_window));
+				i++) {
+			if (read_chunk_got[i])
+				continue;
+
+			const uint32_t offset = read_offset + i * FTPRequest::DATA_MAXSZ;
+			if (read_inflight.insert(offset).second)
+				send_read_command(offset);
+		}
+	}
+
+	void restart_read_stall_timer()
+	{
+		read_stall_timer.stop();
+		read_stall_timer.start();
+	}
+
+	//! no chunk arrived for CHUNK_TIMEOUT_MS: everything outstanding is lost
+	void read_stall_cb(const ros::TimerEvent &event)
+	{
+		std::lock_guard<std::mutex> lock(proto_mutex);
+
+		if (op_state != OP::READ)
+			return;
+
+		ROS_WARN_NAMED("ftp", "FTP: Read stalled, re-requesting missing chunks");
+		read_inflight.clear();
+		request_next_read();
+		if (op_state == OP::READ)
+			restart_read_stall_timer();
+	}
+
+	/* -*- download (streaming read) -*- */
+
+	/**
+	 * @brief CRC32 as used by kCmdCalcFileCRC32
+	 *
+	 * Poly 0xEDB88320, no init / final xor (same as px4 crc32part()).
+	 */
+	static uint32_t crc32part(const uint8_t *src, size_t len, uint32_t crc)
+	{
+		static std::array<uint32_t, 256> table = ([]() {
+			std::array<uint32_t, 256> t;
+
+			for (uint32_t i = 0; i < 256; i++) {
+				uint32_t c = i;
+				for (int j = 0; j < 8; j++)
+					c = (c & 1) ? (c >> 1) ^ 0xEDB88320 : c >> 1;
+				t[i] = c;
+			}
+
+			return t;
+		})();
+
+		for (size_t i = 0; i < len; i++)
+			crc = table[(crc ^ src[i]) & 0xff] ^ (crc >> 8);
+
+		return crc;
+	}
+
+	/**
+	 * @brief Advance the running CRC over the contiguous chunk prefix
+	 *
+	 * Chunks behind the frontier are still hot in the page cache, so
+	 * filling a hole adds no extra disk read pass.
+	 */
+	void download_advance_crc()
+	{
+		const uint32_t nchunks = read_chunks_needed();
+
+		uint32_t chunk = (download_crc_offset - read_offset) / FTPRequest::DATA_MAXSZ;
+		while (chunk < nchunks && read_chunk_got[chunk]) {
+			const size_t len = std::min<size_t>(FTPRequest::DATA_MAXSZ,
+					read_end - download_crc_offset);
+
+			download_crc = crc32part(download_map + (download_crc_offset - read_offset),
+					len, download_crc);
+			download_crc_offset += len;
+			chunk++;
+		}
+	}
+
+	/**
+	 * @brief Create + mmap local file and start transfer of the whole
+	 *        remote file (must be opened before)
+	 */
+	bool download_begin(const std::string &local_path)
+	{
+		std::lock_guard<std::mutex> lock(proto_mutex);
+
+		auto it = session_file_map.find(open_path);
+		if (it == session_file_map.end()) {
+			r_errno = EBADF;
+			return false;
+		}
+
+		download_size = open_size;
+		download_fd = ::open(local_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+		if (download_fd < 0) {
+			r_errno = errno;
+			ROS_ERROR_NAMED("ftp", "FTP:Download %s: %s", local_path.c_str(), strerror(r_errno));
+			return false;
+		}
+
+		if (::ftruncate(download_fd, download_size) != 0) {
+			r_errno = errno;
+			ROS_ERROR_NAMED("ftp", "FTP:Download %s: %s", local_path.c_str(), strerror(r_errno));
+			download_finish();
+			return false;
+		}
+
+		download_crc = 0;
+		if (download_size == 0)
+			// empty file: created, nothing to transfer
+			return true;
+
+		void *map = ::mmap(nullptr, download_size, PROT_READ | PROT_WRITE,
+				MAP_SHARED, download_fd, 0);
+		if (map == MAP_FAILED) {
+			r_errno = errno;
+			ROS_ERROR_NAMED("ftp", "FTP:Download %s: mmap: %s", local_path.c_str(), strerror(r_errno));
+			download_finish();
+			return false;
+		}
+		download_map = static_cast<uint8_t *>(map);
+
+		// same transfer engine as read_file(), kernel-backed sink
+		op_state = OP::READ;
+		active_session = it->second;
+		read_to_file = true;
+		read_size = download_size;
+		read_offset = 0;
+		read_end = download_size;
+		download_crc_offset = 0;
+		burst_ok = burst_enabled;
+		read_inflight.clear();
+		read_buffer.clear();
+		read_chunk_got.assign(read_chunks_needed(), false);
+
+		request_next_read();
+		restart_read_stall_timer();
+		return true;
+	}
+
+	void download_finish()
+	{
+		read_to_file = false;
+		if (download_map != nullptr) {
+			::munmap(download_map, download_size);
+			download_map = nullptr;
+		}
+		if (download_fd >= 0) {
+			::close(download_fd);
+			download_fd = -1;
+		}
+	}
+
 	void write_file_end() {
 		ROS_DEBUG_NAMED("ftp", "FTP:Write done");
 		go_idle(false);
@@ -865,36 +1372,47 @@ private:
 
 	bool wait_completion(const int msecs)
 	{
-		std::unique_lock<std::mutex> lock(cond_mutex);
-
-		bool is_timedout = cond.wait_for(lock, std::chrono::milliseconds(msecs))
-				== std::cv_status::timeout;
+		auto rc = waiter.wait(ros::Duration(msecs / 1000.0));
 
-		if (is_timedout) {
+		if (rc == TransactionWaiter::Result::TIMEDOUT) {
 			// If timeout occurs don't forget to reset state
 			op_state = OP::IDLE;
 			r_errno = ETIMEDOUT;
-			return false;
 		}
-		else
-			// if go_idle() occurs before timeout
-			return !is_error;
+
+		return rc == TransactionWaiter::Result::DONE;
 	}
 
 	/* -*- service callbacks -*- */
 
 	/**
 	 * Service handler common header code.
+	 * The guard waits out a running listing prefetch, then keeps the
+	 * prefetcher off the protocol machine until the service returns.
 	 */
 #define SERVICE_IDLE_CHECK()				\
+	ServiceGuard service_guard(this);		\
 	if (op_state != OP::IDLE) {			\
 		ROS_ERROR_NAMED("ftp", "FTP: Busy");	\
 		return false;				\
-	}
+	}						\
+	/* drop completion left by a timed-out op */	\
+	waiter.reset()
 
 	bool list_cb(mavros_msgs::FileList::Request &req,
 			mavros_msgs::FileList::Response &res)
 	{
+		if (cache_enabled) {
+			std::lock_guard<std::mutex> lock(cache_mutex);
+			auto it = list_cache.find(req.dir_path);
+			if (it != list_cache.end()) {
+				res.success = true;
+				res.r_errno = 0;
+				res.list = it->second;
+				return true;
+			}
+		}
+
 		SERVICE_IDLE_CHECK();
 
 		list_directory(req.dir_path);
@@ -903,6 +1421,8 @@ private:
 		if (res.success) {
 			res.list = std::move(list_entries);
 			list_entries.clear();	// not shure that it's needed
+			if (cache_enabled)
+				cache_store(req.dir_path, res.list);
 		}
 
 		return true;
@@ -926,6 +1446,8 @@ private:
 			res.success = wait_completion(OPEN_TIMEOUT_MS);
 			res.size = open_size;
 		}
+		if (req.mode != mavros_msgs::FileOpenRequest::MODE_READ)
+			cache_invalidate(req.file_path);	// create/write may add the file
 		res.r_errno = r_errno;
 
 		return true;
@@ -962,6 +1484,45 @@ private:
 		return true;
 	}
 
+	bool download_cb(mavros_msgs::FileDownload::Request &req,
+			mavros_msgs::FileDownload::Response &res)
+	{
+		SERVICE_IDLE_CHECK();
+
+		// session opened and closed here, no FTP::Open needed
+		auto it = session_file_map.find(req.file_path);
+		if (it != session_file_map.end()) {
+			ROS_ERROR_NAMED("ftp", "FTP: File %s: already opened",
+					req.file_path.c_str());
+			return false;
+		}
+
+		res.success = open_file(req.file_path, mavros_msgs::FileOpenRequest::MODE_READ);
+		if (res.success)
+			res.success = wait_completion(OPEN_TIMEOUT_MS);
+		if (!res.success) {
+			res.r_errno = r_errno;
+			return true;
+		}
+
+		res.success = download_begin(req.local_path);
+		if (res.success && download_size > 0)
+			res.success = wait_completion(compute_rw_timeout(download_size));
+
+		// latch transfer result before session close overwrites it
+		res.r_errno = r_errno;
+		download_finish();
+		if (res.success) {
+			res.size = download_size;
+			res.crc32 = download_crc;
+		}
+
+		if (close_file(req.file_path))
+			wait_completion(OPEN_TIMEOUT_MS);
+
+		return true;
+	}
+
 	bool write_cb(mavros_msgs::FileWrite::Request &req,
 			mavros_msgs::FileWrite::Response &res)
 	{
@@ -973,6 +1534,7 @@ private:
 			res.success = wait_completion(compute_rw_timeout(data_size));
 		}
 		write_buffer.clear();
+		cache_invalidate(req.file_path);
 		res.r_errno = r_errno;
 
 		return true;
@@ -985,6 +1547,7 @@ private:
 
 		remove_file(req.file_path);
 		res.success = wait_completion(OPEN_TIMEOUT_MS);
+		cache_invalidate(req.file_path);
 		res.r_errno = r_errno;
 
 		return true;
@@ -999,6 +1562,8 @@ private:
 		if (res.success) {
 			res.success = wait_completion(OPEN_TIMEOUT_MS);
 		}
+		cache_invalidate(req.old_path);
+		cache_invalidate(req.new_path);
 		res.r_errno = r_errno;
 
 		return true;
@@ -1013,6 +1578,7 @@ private:
 		// Note: emulated truncate() can take a while
 		truncate_file(req.file_path, req.length);
 		res.success = wait_completion(LIST_TIMEOUT_MS * 5);
+		cache_invalidate(req.file_path);
 		res.r_errno = r_errno;
 
 		return true;
@@ -1025,6 +1591,7 @@ private:
 
 		create_directory(req.dir_path);
 		res.success = wait_completion(OPEN_TIMEOUT_MS);
+		cache_invalidate(req.dir_path);
 		res.r_errno = r_errno;
 
 		return true;
@@ -1037,6 +1604,7 @@ private:
 
 		remove_directory(req.dir_path);
 		res.success = wait_completion(OPEN_TIMEOUT_MS);
+		cache_invalidate(req.dir_path);
 		res.r_errno = r_errno;
 
 		return true;
@@ -1064,6 +1632,7 @@ private:
 	bool reset_cb(std_srvs::Empty::Request &req,
 			std_srvs::Empty::Response &res)
 	{
+		cache_clear();
 		send_reset();
 		return true;
 	}
@@ -1071,5 +1640,5 @@ private:
 }	// namespace std_plugins
 }	// namespace mavros
 
-#include <pluginlib/class_list_macros.h>
-PLUGINLIB_EXPORT_CLASS(mavros::std_plugins::FTPPlugin, mavros::plugin::PluginBase)
+#include <mavros/plugin_register.h>
+MAVROS_PLUGIN_REGISTER("ftp", mavros::std_plugins::FTPPlugin)
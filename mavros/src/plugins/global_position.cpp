@@ -47,11 +47,20 @@ public:
 	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
 	GlobalPositionPlugin() : PluginBase(),
-		gp_nh("~global_position"),
+		gp_nh(plugin_ns("global_position")),
+		earth(GeographicLib::Constants::WGS84_a(), GeographicLib::Constants::WGS84_f()),
 		tf_send(false),
 		rot_cov(99999.0),
 		use_relative_alt(true),
-		is_map_init(false)
+		is_map_init(false),
+		lin_valid(false),
+		lin_threshold(500.0),
+		lin_mer_scale(0.0),
+		lin_par_scale(0.0),
+		geoid_valid(false),
+		geoid_lat(0.0),
+		geoid_lon(0.0),
+		geoid_offset(0.0)
 	{ }
 
 	void initialize(UAS &uas_)
@@ -64,6 +73,11 @@ public:
 		gp_nh.param("rot_covariance", rot_cov, 99999.0);
 		gp_nh.param("gps_uere", gps_uere, 1.0);
 		gp_nh.param("use_relative_alt", use_relative_alt, true);
+		// Re-derive the LLA->map linearization point after moving
+		// this far from it [m]; within it each fix converts with a
+		// few multiply-adds instead of the full ECEF trigonometry.
+		// 0 converts every fix exactly.
+		gp_nh.param("linearization_threshold", lin_threshold, 500.0);
 		// tf subsection
 		gp_nh.param("tf/send", tf_send, false);
 		gp_nh.param<std::string>("tf/frame_id", tf_frame_id, "map");
@@ -128,6 +142,8 @@ private:
 	std::string tf_global_frame_id;	//!< global origin for TF
 	std::string tf_child_frame_id;	//!< frame for TF and Pose
 
+	const GeographicLib::Geocentric earth;	//!< WGS-84 ellipsoid model
+
 	bool tf_send;
 	bool use_relative_alt;
 	bool is_map_init;
@@ -137,14 +153,98 @@ private:
 
 	Eigen::Vector3d map_origin {};	//!< geodetic origin of map frame [lla]
 	Eigen::Vector3d ecef_origin {};	//!< geocentric origin of map frame [m]
-	Eigen::Vector3d local_ecef {};	//!< local ECEF coordinates on map frame [m]
+
+	// local-tangent-plane linearization cache, see lla_to_map_enu()
+	bool lin_valid;
+	double lin_threshold;		//!< re-linearize beyond this offset [m]
+	double lin_mer_scale;		//!< north meters per radian of latitude
+	double lin_par_scale;		//!< east meters per radian of longitude
+	Eigen::Vector3d lin_lla {};	//!< linearization point [deg, deg, m]
+	Eigen::Vector3d lin_enu {};	//!< its exact ENU position on map frame [m]
+
+	// geoid undulation cache, see cached_geoid_offset()
+	bool geoid_valid;
+	double geoid_lat;
+	double geoid_lon;
+	double geoid_offset;
+
+	//! re-derive the cached geoid offset after moving this far [deg], ~1.1 km
+	static constexpr double GEOID_CACHE_DEG = 0.01;
+
+	/**
+	 * @brief Cached AMSL -> WGS-84 ellipsoid height offset
+	 *
+	 * The geoid undulation changes by centimeters per kilometer,
+	 * well below GPS altitude noise, so the interpolating dataset
+	 * lookup is repeated only after the vehicle has moved.
+	 */
+	double cached_geoid_offset(double lat, double lon)
+	{
+		if (!geoid_valid ||
+				std::abs(lat - geoid_lat) > GEOID_CACHE_DEG ||
+				std::abs(lon - geoid_lon) > GEOID_CACHE_DEG) {
+			struct { double latitude, longitude; } pt { lat, lon };
+
+			geoid_offset = m_uas->geoid_to_ellipsoid_height(&pt);
+			geoid_lat = lat;
+			geoid_lon = lon;
+			geoid_valid = true;
+		}
+
+		return geoid_offset;
+	}
+
+	/**
+	 * @brief Geodetic fix to ENU position on the map frame
+	 *
+	 * The exact conversion goes through ECEF and the ECEF->ENU
+	 * rotation at the map origin. The result is kept linearized
+	 * around the last exactly-converted fix: while the vehicle
+	 * stays within linearization_threshold of it, a fix costs a
+	 * few multiply-adds; the curvature error at the default 500 m
+	 * is millimeters, far below the fix covariance.
+	 */
+	Eigen::Vector3d lla_to_map_enu(double lat, double lon, double alt)
+	{
+		if (lin_valid && lin_threshold > 0.0) {
+			Eigen::Vector3d delta(
+				angles::from_degrees(lon - lin_lla.y()) * lin_par_scale,
+				angles::from_degrees(lat - lin_lla.x()) * lin_mer_scale,
+				alt - lin_lla.z());
+
+			if (delta.head<2>().squaredNorm() < lin_threshold * lin_threshold)
+				return lin_enu + delta;
+		}
+
+		// full conversion, then re-linearize at this fix
+		Eigen::Vector3d map_point;
+		earth.Forward(lat, lon, alt, map_point.x(), map_point.y(), map_point.z());
+
+		Eigen::Vector3d enu = ftf::transform_frame_ecef_enu(map_point - ecef_origin, map_origin);
+
+		const double a = GeographicLib::Constants::WGS84_a();
+		const double f = GeographicLib::Constants::WGS84_f();
+		const double e2 = f * (2.0 - f);
+		const double slat = std::sin(angles::from_degrees(lat));
+		const double clat = std::cos(angles::from_degrees(lat));
+		const double w = std::sqrt(1.0 - e2 * slat * slat);
+
+		// meridian and prime-vertical curvature radii at the fix
+		lin_mer_scale = a * (1.0 - e2) / (w * w * w) + alt;
+		lin_par_scale = (a / w + alt) * clat;
+		lin_lla << lat, lon, alt;
+		lin_enu = enu;
+		lin_valid = true;
+
+		return enu;
+	}
 
 	template<typename MsgT>
 	inline void fill_lla(MsgT &msg, sensor_msgs::NavSatFix::Ptr fix)
 	{
 		fix->latitude = msg.lat / 1E7;		// deg
 		fix->longitude = msg.lon / 1E7;		// deg
-		fix->altitude = msg.alt / 1E3 + m_uas->geoid_to_ellipsoid_height(fix);	// in meters
+		fix->altitude = msg.alt / 1E3 + cached_geoid_offset(fix->latitude, fix->longitude);	// in meters
 	}
 
 	inline void fill_unknown_cov(sensor_msgs::NavSatFix::Ptr fix)
@@ -236,9 +336,6 @@ private:
 			 * @brief Conversion from geodetic coordinates (LLA) to ECEF (Earth-Centered, Earth-Fixed)
 			 * Note: "earth" frame, in ECEF, of the global origin
 			 */
-			GeographicLib::Geocentric earth(GeographicLib::Constants::WGS84_a(),
-				GeographicLib::Constants::WGS84_f());
-
 			earth.Forward(g_origin->position.latitude, g_origin->position.longitude, g_origin->position.altitude,
 				g_origin->position.latitude, g_origin->position.longitude, g_origin->position.altitude);
 
@@ -311,49 +408,38 @@ private:
 		vel_cov_out.fill(0.0);
 		vel_cov_out(0) = -1.0;
 
-		// Current fix in ECEF
-		Eigen::Vector3d map_point;
+		// Current fix in ENU on the map frame
+		Eigen::Vector3d local_enu(Eigen::Vector3d::Zero());
 
 		try {
-			/**
-			 * @brief Conversion from geodetic coordinates (LLA) to ECEF (Earth-Centered, Earth-Fixed)
-			 *
-			 * Note: "ecef_origin" is the origin of "map" frame, in ECEF, and the local coordinates are
-			 * in spherical coordinates, with the orientation in ENU (just like what is applied
-			 * on Gazebo)
-			 */
-			GeographicLib::Geocentric map(GeographicLib::Constants::WGS84_a(),
-						GeographicLib::Constants::WGS84_f());
-
 			/**
 			 * @brief Checks if the "map" origin is set.
 			 * - If not, and the home position is also not received, it sets the current fix as the origin;
 			 * - If the home position is received, it sets the "map" origin;
-			 * - If the "map" origin is set, then it applies the rotations to the offset between the origin
-			 * and the current local geocentric coordinates.
+			 * - If the "map" origin is set, then the fix is projected onto the local tangent
+			 * plane, through the cached linearization when the vehicle has not moved far.
 			 */
-			// Current fix to ECEF
-			map.Forward(fix->latitude, fix->longitude, fix->altitude,
-						map_point.x(), map_point.y(), map_point.z());
-
 			// Set the current fix as the "map" origin if it's not set
 			if (!is_map_init && fix->status.status >= sensor_msgs::NavSatStatus::STATUS_FIX) {
 				map_origin.x() = fix->latitude;
 				map_origin.y() = fix->longitude;
 				map_origin.z() = fix->altitude;
 
-				ecef_origin = map_point; // Local position is zero
+				// Local position is zero
+				earth.Forward(map_origin.x(), map_origin.y(), map_origin.z(),
+							ecef_origin.x(), ecef_origin.y(), ecef_origin.z());
 				is_map_init = true;
+				lin_valid = false;
 			}
+
+			local_enu = lla_to_map_enu(fix->latitude, fix->longitude, fix->altitude);
 		}
 		catch (const std::exception& e) {
 			ROS_INFO_STREAM("GP: Caught exception: " << e.what() << std::endl);
 		}
 
-		// Compute the local coordinates in ECEF
-		local_ecef = map_point - ecef_origin;
-		// Compute the local coordinates in ENU
-		tf::pointEigenToMsg(ftf::transform_frame_ecef_enu(local_ecef, map_origin), odom->pose.pose.position);
+		// Local coordinates in ENU
+		tf::pointEigenToMsg(local_enu, odom->pose.pose.position);
 
 		/**
 		 * @brief By default, we are using the relative altitude instead of the geocentric
@@ -475,20 +561,16 @@ private:
 		map_origin.z() = req->geo.altitude;
 
 		try {
-			/**
-			 * @brief Conversion from geodetic coordinates (LLA) to ECEF (Earth-Centered, Earth-Fixed)
-			 */
-			GeographicLib::Geocentric map(GeographicLib::Constants::WGS84_a(),
-						GeographicLib::Constants::WGS84_f());
-
 			// map_origin to ECEF
-			map.Forward(map_origin.x(), map_origin.y(), map_origin.z(),
+			earth.Forward(map_origin.x(), map_origin.y(), map_origin.z(),
 						ecef_origin.x(), ecef_origin.y(), ecef_origin.z());
 		}
 		catch (const std::exception& e) {
 			ROS_INFO_STREAM("GP: Caught exception: " << e.what() << std::endl);
 		}
 
+		// positions linearized around the old origin are stale now
+		lin_valid = false;
 		is_map_init = true;
 	}
 
@@ -511,5 +593,5 @@ private:
 }	// namespace std_plugins
 }	// namespace mavros
 
-#include <pluginlib/class_list_macros.h>
-PLUGINLIB_EXPORT_CLASS(mavros::std_plugins::GlobalPositionPlugin, mavros::plugin::PluginBase)
+#include <mavros/plugin_register.h>
+MAVROS_PLUGIN_REGISTER("global_position", mavros::std_plugins::GlobalPositionPlugin)
@@ -16,6 +16,12 @@
  * in the top-level LICENSE file of the mavros repository.
  * https://github.com/mavlink/mavros/tree/master/LICENSE.md
  */
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <thread>
+
 #include <mavros/mavros_plugin.h>
 #include <eigen_conversions/eigen_msg.h>
 
@@ -42,8 +48,24 @@ public:
 	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
 	HilPlugin() : PluginBase(),
-		hil_nh("~hil")
-	{ }
+		hil_nh(plugin_ns("hil")),
+		ring_head(0),
+		ring_tail(0),
+		sender_running(true)
+	{
+		for (size_t i = 0; i < RING_SIZE; i++)
+			ring[i].seq.store(i, std::memory_order_relaxed);
+
+		sender_thread = std::thread(&HilPlugin::sender_loop, this);
+	}
+
+	~HilPlugin()
+	{
+		sender_running = false;
+		sender_cv.notify_one();
+		if (sender_thread.joinable())
+			sender_thread.join();
+	}
 
 	void initialize(UAS &uas_)
 	{
@@ -81,6 +103,109 @@ private:
 
 	Eigen::Quaterniond enu_orientation;
 
+	/* -*- batched ingestion ring -*- */
+
+	//! ring capacity, power of two; covers >32 ms of backlog at 1 kHz lockstep
+	static constexpr size_t RING_SIZE = 64;
+
+	/**
+	 * @brief One deposited HIL record, already converted to MAVLink fields
+	 *
+	 * Plain members instead of a union: the message classes have a vtable.
+	 */
+	struct HilRecord {
+		enum class Kind : uint8_t { SENSOR, GPS };
+
+		//! Vyukov slot sequence, see ring_push()
+		std::atomic<size_t> seq;
+		Kind kind;
+		mavlink::common::msg::HIL_SENSOR sensor;
+		mavlink::common::msg::HIL_GPS gps;
+	};
+
+	std::array<HilRecord, RING_SIZE> ring;
+	std::atomic<size_t> ring_head;		//!< next slot a producer claims
+	std::atomic<size_t> ring_tail;		//!< next slot the sender reads
+
+	std::thread sender_thread;
+	std::atomic<bool> sender_running;
+	std::condition_variable sender_cv;
+	std::mutex sender_mutex;		//!< only the sender sleeps on it, producers never lock
+
+	/**
+	 * @brief Deposit a record without taking any lock
+	 *
+	 * Multi-producer: the gps and imu_ned subscriptions are separate,
+	 * so the spinner pool may run their callbacks concurrently. Slots
+	 * are CAS-claimed with the same Vyukov sequence scheme as
+	 * mavconn::MsgBufferRing; the single consumer is sender_loop().
+	 */
+	template <typename MsgT>
+	void ring_push(HilRecord::Kind kind, const MsgT &msg, MsgT HilRecord::*field)
+	{
+		size_t pos = ring_head.load(std::memory_order_relaxed);
+		for (;;) {
+			auto &rec = ring[pos % RING_SIZE];
+			size_t seq = rec.seq.load(std::memory_order_acquire);
+			intptr_t dif = intptr_t(seq) - intptr_t(pos);
+
+			if (dif == 0) {
+				if (ring_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					rec.kind = kind;
+					rec.*field = msg;
+					rec.seq.store(pos + 1, std::memory_order_release);
+					break;
+				}
+			}
+			else if (dif < 0) {
+				ROS_WARN_THROTTLE_NAMED(10, "hil", "HIL: ingestion ring full, record dropped");
+				return;
+			}
+			else
+				pos = ring_head.load(std::memory_order_relaxed);
+		}
+
+		// notify without the mutex: cheaper for the producer, see sender_loop()
+		sender_cv.notify_one();
+	}
+
+	/**
+	 * @brief Drain deposited records back-to-back into the TX queue
+	 *
+	 * One wake serializes the whole backlog, so at 1 kHz lockstep the
+	 * transport lock is contended once per drain instead of per message.
+	 */
+	void sender_loop()
+	{
+		std::unique_lock<std::mutex> lock(sender_mutex);
+
+		while (sender_running) {
+			// producers never hold the mutex, so a notify may land between
+			// the emptiness check and the wait; the timed wait bounds that
+			// race to one lockstep period
+			sender_cv.wait_for(lock, std::chrono::milliseconds(1));
+
+			auto tail = ring_tail.load(std::memory_order_relaxed);
+
+			// a slot only counts as ready once its producer published
+			// the sequence: the head cursor alone would let us read a
+			// claimed-but-unwritten record
+			while (sender_running) {
+				auto &rec = ring[tail % RING_SIZE];
+				if (intptr_t(rec.seq.load(std::memory_order_acquire)) - intptr_t(tail + 1) < 0)
+					break;
+
+				if (rec.kind == HilRecord::Kind::SENSOR)
+					UAS_FCU(m_uas)->send_message_ignore_drop(rec.sensor, mavconn::TxPrio::REALTIME);
+				else
+					UAS_FCU(m_uas)->send_message_ignore_drop(rec.gps, mavconn::TxPrio::REALTIME);
+
+				rec.seq.store(tail + RING_SIZE, std::memory_order_release);
+				ring_tail.store(++tail, std::memory_order_relaxed);
+			}
+		}
+	}
+
 	/* -*- rx handlers -*- */
 
 	void handle_hil_controls(const mavlink::mavlink_message_t *msg, mavlink::common::msg::HIL_CONTROLS &hil_controls) {
@@ -204,7 +329,7 @@ private:
 		// [[[end]]] (checksum: a283bcc78f496cead2e9f893200d825d)
 		gps.satellites_visible = req->satellites_visible;
 
-		UAS_FCU(m_uas)->send_message_ignore_drop(gps);
+		ring_push(HilRecord::Kind::GPS, gps, &HilRecord::gps);
 	}
 
 	/**
@@ -250,7 +375,7 @@ private:
 		sensor.fields_updated = req->fields_updated;
 		// [[[end]]] (checksum: 316bef821ad6fc33d9726a1c8e8c5404)
 
-		UAS_FCU(m_uas)->send_message_ignore_drop(sensor);
+		ring_push(HilRecord::Kind::SENSOR, sensor, &HilRecord::sensor);
 	}
 
 	/**
@@ -335,5 +460,5 @@ private:
 }	// namespace std_plugins
 }	// namespace mavros
 
-#include <pluginlib/class_list_macros.h>
-PLUGINLIB_EXPORT_CLASS(mavros::std_plugins::HilPlugin, mavros::plugin::PluginBase)
+#include <mavros/plugin_register.h>
+MAVROS_PLUGIN_REGISTER("hil", mavros::std_plugins::HilPlugin)
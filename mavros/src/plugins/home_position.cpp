@@ -32,7 +32,7 @@ namespace std_plugins {
 class HomePositionPlugin : public plugin::PluginBase {
 public:
 	HomePositionPlugin() :
-		hp_nh("~home_position"),
+		hp_nh(plugin_ns("home_position")),
 		REQUEST_POLL_TIME_DT(REQUEST_POLL_TIME_MS / 1000.0)
 	{ }
 
@@ -75,7 +75,7 @@ private:
 		bool ret = false;
 
 		try {
-			ros::NodeHandle pnh("~");
+			ros::NodeHandle pnh(plugin_ns(""));
 			auto client = pnh.serviceClient<mavros_msgs::CommandLong>("cmd/command");
 
 			mavros_msgs::CommandLong cmd{};
@@ -177,5 +177,5 @@ private:
 }	// namespace std_plugins
 }	// namespace mavros
 
-#include <pluginlib/class_list_macros.h>
-PLUGINLIB_EXPORT_CLASS(mavros::std_plugins::HomePositionPlugin, mavros::plugin::PluginBase)
+#include <mavros/plugin_register.h>
+MAVROS_PLUGIN_REGISTER("home_position", mavros::std_plugins::HomePositionPlugin)
@@ -16,6 +16,7 @@
 
 #include <cmath>
 #include <mavros/mavros_plugin.h>
+#include <mavros/msg_pool.h>
 #include <eigen_conversions/eigen_msg.h>
 
 #include <sensor_msgs/Imu.h>
@@ -23,6 +24,7 @@
 #include <sensor_msgs/Temperature.h>
 #include <sensor_msgs/FluidPressure.h>
 #include <geometry_msgs/Vector3.h>
+#include <mavros_msgs/ImuBatch.h>
 
 namespace mavros {
 namespace std_plugins {
@@ -48,14 +50,19 @@ public:
 	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
 	IMUPlugin() : PluginBase(),
-		imu_nh("~imu"),
+		imu_nh(plugin_ns("imu")),
 		has_hr_imu(false),
 		has_raw_imu(false),
 		has_scaled_imu(false),
 		has_att_quat(false),
 		received_linear_accel(false),
 		linear_accel_vec_flu(Eigen::Vector3d::Zero()),
-		linear_accel_vec_frd(Eigen::Vector3d::Zero())
+		linear_accel_vec_frd(Eigen::Vector3d::Zero()),
+		hr_decimation(1),
+		hr_accum_count(0),
+		hr_gyro_flu_sum(Eigen::Vector3d::Zero()),
+		hr_accel_flu_sum(Eigen::Vector3d::Zero()),
+		hr_accel_frd_sum(Eigen::Vector3d::Zero())
 	{ }
 
 	void initialize(UAS &uas_)
@@ -76,6 +83,13 @@ public:
 		imu_nh.param("orientation_stdev", orientation_stdev, 1.0);
 		imu_nh.param("magnetic_stdev", mag_stdev, 0.0);
 
+		// Average every N HIGHRES_IMU samples into one ~imu/data_raw
+		// message (boxcar anti-alias filter, the group delay is
+		// (N-1)/2 samples). Full-rate consumers get the unaveraged
+		// samples batched N at a time on ~imu/data_raw_batch.
+		// 1 (default) disables decimation and the batch topic.
+		imu_nh.param("highres_decimation", hr_decimation, 1);
+
 		setup_covariance(linear_acceleration_cov, linear_stdev);
 		setup_covariance(angular_velocity_cov, angular_stdev);
 		setup_covariance(orientation_cov, orientation_stdev);
@@ -89,6 +103,8 @@ public:
 		static_press_pub = imu_nh.advertise<sensor_msgs::FluidPressure>("static_pressure", 10);
 		diff_press_pub = imu_nh.advertise<sensor_msgs::FluidPressure>("diff_pressure", 10);
 		imu_raw_pub = imu_nh.advertise<sensor_msgs::Imu>("data_raw", 10);
+		if (hr_decimation > 1)
+			imu_batch_pub = imu_nh.advertise<mavros_msgs::ImuBatch>("data_raw_batch", 10);
 
 		// Reset has_* flags on connection change
 		enable_connection_cb();
@@ -116,6 +132,7 @@ private:
 	ros::Publisher temp_baro_pub;
 	ros::Publisher static_press_pub;
 	ros::Publisher diff_press_pub;
+	ros::Publisher imu_batch_pub;
 
 	bool has_hr_imu;
 	bool has_raw_imu;
@@ -130,6 +147,24 @@ private:
 	ftf::Covariance3d unk_orientation_cov;
 	ftf::Covariance3d magnetic_cov;
 
+	// high-rate publishers reuse preallocated messages; separate
+	// pools per topic so a reused message never carries fields the
+	// refill path does not assign
+	MessagePool<sensor_msgs::Imu> imu_data_pool;
+	MessagePool<sensor_msgs::Imu> imu_raw_pool;
+	MessagePool<sensor_msgs::MagneticField> magn_pool;
+	MessagePool<sensor_msgs::Temperature> temp_pool;
+	MessagePool<sensor_msgs::FluidPressure> press_pool;
+	MessagePool<mavros_msgs::ImuBatch> imu_batch_pool;
+
+	// HIGHRES_IMU decimation state, see handle_highres_imu()
+	int hr_decimation;
+	int hr_accum_count;
+	Eigen::Vector3d hr_gyro_flu_sum;
+	Eigen::Vector3d hr_accel_flu_sum;
+	Eigen::Vector3d hr_accel_frd_sum;
+	mavros_msgs::ImuBatchPtr imu_batch;	//!< batch being filled
+
 	/* -*- helpers -*- */
 
 	/**
@@ -163,8 +198,8 @@ private:
 	void publish_imu_data(uint32_t time_boot_ms, Eigen::Quaterniond &orientation_enu,
 				Eigen::Quaterniond &orientation_ned, Eigen::Vector3d &gyro_flu, Eigen::Vector3d &gyro_frd)
 	{
-		auto imu_ned_msg = boost::make_shared<sensor_msgs::Imu>();
-		auto imu_enu_msg = boost::make_shared<sensor_msgs::Imu>();
+		auto imu_ned_msg = imu_data_pool.acquire();
+		auto imu_enu_msg = imu_data_pool.acquire();
 
 		// Fill message header
 		imu_enu_msg->header = m_uas->synchronized_header(frame_id, time_boot_ms);
@@ -230,7 +265,7 @@ private:
 	void publish_imu_data_raw(std_msgs::Header &header, Eigen::Vector3d &gyro_flu,
 				Eigen::Vector3d &accel_flu, Eigen::Vector3d &accel_frd)
 	{
-		auto imu_msg = boost::make_shared<sensor_msgs::Imu>();
+		auto imu_msg = imu_raw_pool.acquire();
 
 		// Fill message header
 		imu_msg->header = header;
@@ -258,7 +293,7 @@ private:
 	 */
 	void publish_mag(std_msgs::Header &header, Eigen::Vector3d &mag_field)
 	{
-		auto magn_msg = boost::make_shared<sensor_msgs::MagneticField>();
+		auto magn_msg = magn_pool.acquire();
 
 		// Fill message header
 		magn_msg->header = header;
@@ -270,6 +305,42 @@ private:
 		magn_pub.publish(magn_msg);
 	}
 
+	/**
+	 * @brief Append one full-rate sample to the ~imu/data_raw_batch message
+	 *
+	 * The batch is published every hr_decimation samples, together with
+	 * the averaged ~imu/data_raw message. Skipped while nothing
+	 * subscribes, so idle vehicles pay nothing for the full stream.
+	 */
+	void batch_imu_sample(std_msgs::Header &header, Eigen::Vector3d &gyro_flu, Eigen::Vector3d &accel_flu)
+	{
+		if (imu_batch_pub.getNumSubscribers() == 0) {
+			imu_batch.reset();
+			return;
+		}
+
+		if (!imu_batch) {
+			imu_batch = imu_batch_pool.acquire();
+			// keeps the sample capacity of the previous round
+			imu_batch->samples.clear();
+		}
+
+		imu_batch->samples.emplace_back();
+		auto &sample = imu_batch->samples.back();
+		sample.header = header;
+		tf::vectorEigenToMsg(gyro_flu, sample.angular_velocity);
+		tf::vectorEigenToMsg(accel_flu, sample.linear_acceleration);
+		sample.orientation_covariance = unk_orientation_cov;
+		sample.angular_velocity_covariance = angular_velocity_cov;
+		sample.linear_acceleration_covariance = linear_acceleration_cov;
+
+		if (imu_batch->samples.size() >= size_t(hr_decimation)) {
+			imu_batch->header = header;
+			imu_batch_pub.publish(imu_batch);
+			imu_batch.reset();
+		}
+	}
+
 	/* -*- message handlers -*- */
 
 	/**
@@ -385,7 +456,30 @@ private:
 			auto accel_frd = Eigen::Vector3d(imu_hr.xacc, imu_hr.yacc, imu_hr.zacc);
 			auto accel_flu = ftf::transform_frame_aircraft_baselink(accel_frd);
 
-			publish_imu_data_raw(header, gyro_flu, accel_flu, accel_frd);
+			bool emit = true;
+			if (hr_decimation > 1) {
+				batch_imu_sample(header, gyro_flu, accel_flu);
+
+				hr_gyro_flu_sum += gyro_flu;
+				hr_accel_flu_sum += accel_flu;
+				hr_accel_frd_sum += accel_frd;
+
+				emit = ++hr_accum_count >= hr_decimation;
+				if (emit) {
+					const double scale = 1.0 / hr_accum_count;
+					gyro_flu = hr_gyro_flu_sum * scale;
+					accel_flu = hr_accel_flu_sum * scale;
+					accel_frd = hr_accel_frd_sum * scale;
+
+					hr_gyro_flu_sum.setZero();
+					hr_accel_flu_sum.setZero();
+					hr_accel_frd_sum.setZero();
+					hr_accum_count = 0;
+				}
+			}
+
+			if (emit)
+				publish_imu_data_raw(header, gyro_flu, accel_flu, accel_frd);
 		}
 		// [accel_available]
 
@@ -406,7 +500,7 @@ private:
 		 */
 		// [static_pressure_available]
 		if (imu_hr.fields_updated & (1 << 9)) {
-			auto static_pressure_msg = boost::make_shared<sensor_msgs::FluidPressure>();
+			auto static_pressure_msg = press_pool.acquire();
 
 			static_pressure_msg->header = header;
 			static_pressure_msg->fluid_pressure = imu_hr.abs_pressure;
@@ -420,7 +514,7 @@ private:
 		 */
 		// [differential_pressure_available]
 		if (imu_hr.fields_updated & (1 << 10)) {
-			auto differential_pressure_msg = boost::make_shared<sensor_msgs::FluidPressure>();
+			auto differential_pressure_msg = press_pool.acquire();
 
 			differential_pressure_msg->header = header;
 			differential_pressure_msg->fluid_pressure = imu_hr.diff_pressure;
@@ -434,7 +528,7 @@ private:
 		 */
 		// [temperature_available]
 		if (imu_hr.fields_updated & (1 << 12)) {
-			auto temp_msg = boost::make_shared<sensor_msgs::Temperature>();
+			auto temp_msg = temp_pool.acquire();
 
 			temp_msg->header = header;
 			temp_msg->temperature = imu_hr.temperature;
@@ -458,7 +552,6 @@ private:
 		if (has_hr_imu || has_scaled_imu)
 			return;
 
-		auto imu_msg = boost::make_shared<sensor_msgs::Imu>();
 		auto header = m_uas->synchronized_header(frame_id, imu_raw.time_usec);
 
 		/** @note APM send SCALED_IMU data as RAW_IMU
@@ -510,7 +603,6 @@ private:
 		ROS_INFO_COND_NAMED(!has_scaled_imu, "imu", "IMU: Scaled IMU message used.");
 		has_scaled_imu = true;
 
-		auto imu_msg = boost::make_shared<sensor_msgs::Imu>();
 		auto header = m_uas->synchronized_header(frame_id, imu_raw.time_boot_ms);
 
 		auto gyro_flu = ftf::transform_frame_aircraft_baselink<Eigen::Vector3d>(
@@ -542,17 +634,17 @@ private:
 
 		auto header = m_uas->synchronized_header(frame_id, press.time_boot_ms);
 
-		auto temp_msg = boost::make_shared<sensor_msgs::Temperature>();
+		auto temp_msg = temp_pool.acquire();
 		temp_msg->header = header;
 		temp_msg->temperature = press.temperature / 100.0;
 		temp_baro_pub.publish(temp_msg);
 
-		auto static_pressure_msg = boost::make_shared<sensor_msgs::FluidPressure>();
+		auto static_pressure_msg = press_pool.acquire();
 		static_pressure_msg->header = header;
 		static_pressure_msg->fluid_pressure = press.press_abs * 100.0;
 		static_press_pub.publish(static_pressure_msg);
 
-		auto differential_pressure_msg = boost::make_shared<sensor_msgs::FluidPressure>();
+		auto differential_pressure_msg = press_pool.acquire();
 		differential_pressure_msg->header = header;
 		differential_pressure_msg->fluid_pressure = press.press_diff * 100.0;
 		diff_press_pub.publish(differential_pressure_msg);
@@ -564,10 +656,17 @@ private:
 		has_hr_imu = false;
 		has_scaled_imu = false;
 		has_att_quat = false;
+
+		// drop a partially accumulated decimation window
+		hr_accum_count = 0;
+		hr_gyro_flu_sum.setZero();
+		hr_accel_flu_sum.setZero();
+		hr_accel_frd_sum.setZero();
+		imu_batch.reset();
 	}
 };
 }	// namespace std_plugins
 }	// namespace mavros
 
-#include <pluginlib/class_list_macros.h>
-PLUGINLIB_EXPORT_CLASS(mavros::std_plugins::IMUPlugin, mavros::plugin::PluginBase)
+#include <mavros/plugin_register.h>
+MAVROS_PLUGIN_REGISTER("imu", mavros::std_plugins::IMUPlugin)
@@ -17,6 +17,7 @@
  */
 
 #include <mavros/mavros_plugin.h>
+#include <mavros/msg_pool.h>
 #include <eigen_conversions/eigen_msg.h>
 
 #include <geometry_msgs/AccelWithCovarianceStamped.h>
@@ -38,7 +39,7 @@ namespace std_plugins {
 class LocalPositionPlugin : public plugin::PluginBase {
 public:
 	LocalPositionPlugin() : PluginBase(),
-		lp_nh("~local_position"),
+		lp_nh(plugin_ns("local_position")),
 		tf_send(false),
 		has_local_position_ned(false),
 		has_local_position_ned_cov(false)
@@ -91,6 +92,14 @@ private:
 	bool has_local_position_ned;
 	bool has_local_position_ned_cov;
 
+	// high-rate publishers reuse preallocated messages
+	MessagePool<nav_msgs::Odometry> odom_pool;
+	MessagePool<geometry_msgs::PoseStamped> pose_pool;
+	MessagePool<geometry_msgs::PoseWithCovarianceStamped> pose_cov_pool;
+	MessagePool<geometry_msgs::TwistStamped> twist_pool;
+	MessagePool<geometry_msgs::TwistWithCovarianceStamped> twist_cov_pool;
+	MessagePool<geometry_msgs::AccelWithCovarianceStamped> accel_pool;
+
 	void publish_tf(boost::shared_ptr<nav_msgs::Odometry> &odom)
 	{
 		if (tf_send) {
@@ -122,44 +131,56 @@ private:
 		tf::quaternionMsgToEigen(enu_orientation_msg, enu_orientation);
 		auto baselink_linear = ftf::transform_frame_enu_baselink(enu_velocity, enu_orientation.inverse());
 
-		auto odom = boost::make_shared<nav_msgs::Odometry>();
+		auto odom = odom_pool.acquire();
 		odom->header = m_uas->synchronized_header(frame_id, pos_ned.time_boot_ms);
 		odom->child_frame_id = tf_child_frame_id;
+		// the pool is shared with the _COV handler: clear its covariances
+		odom->pose.covariance.fill(0.0);
+		odom->twist.covariance.fill(0.0);
 
 		tf::pointEigenToMsg(enu_position, odom->pose.pose.position);
 		odom->pose.pose.orientation = enu_orientation_msg;
 		tf::vectorEigenToMsg(baselink_linear, odom->twist.twist.linear);
 		odom->twist.twist.angular = baselink_angular_msg;
 
+		// The odometry message above is the single product of the
+		// transform chain; the other outputs are views into it and
+		// only get built while someone subscribes.
+
 		// publish odom if we don't have LOCAL_POSITION_NED_COV
-		if (!has_local_position_ned_cov) {
+		if (!has_local_position_ned_cov && local_odom.getNumSubscribers() > 0) {
 			local_odom.publish(odom);
 		}
 
-		// publish pose always
-		auto pose = boost::make_shared<geometry_msgs::PoseStamped>();
-		pose->header = odom->header;
-		pose->pose = odom->pose.pose;
-		local_position.publish(pose);
+		if (local_position.getNumSubscribers() > 0) {
+			auto pose = pose_pool.acquire();
+			pose->header = odom->header;
+			pose->pose = odom->pose.pose;
+			local_position.publish(pose);
+		}
 
-		// publish velocity always
 		// velocity in the body frame
-		auto twist_body = boost::make_shared<geometry_msgs::TwistStamped>();
-		twist_body->header.stamp = odom->header.stamp;
-		twist_body->header.frame_id = tf_child_frame_id;
-		twist_body->twist.linear = odom->twist.twist.linear;
-		twist_body->twist.angular = baselink_angular_msg;
-		local_velocity_body.publish(twist_body);
-
-		// velocity in the local frame
-		auto twist_local = boost::make_shared<geometry_msgs::TwistStamped>();
-		twist_local->header.stamp = twist_body->header.stamp;
-		twist_local->header.frame_id = tf_child_frame_id;
-		tf::vectorEigenToMsg(enu_velocity, twist_local->twist.linear);
-		tf::vectorEigenToMsg(ftf::transform_frame_baselink_enu(ftf::to_eigen(baselink_angular_msg), enu_orientation),
-						twist_local->twist.angular);
-
-		local_velocity_local.publish(twist_local);
+		if (local_velocity_body.getNumSubscribers() > 0) {
+			auto twist_body = twist_pool.acquire();
+			twist_body->header.stamp = odom->header.stamp;
+			twist_body->header.frame_id = tf_child_frame_id;
+			twist_body->twist.linear = odom->twist.twist.linear;
+			twist_body->twist.angular = baselink_angular_msg;
+			local_velocity_body.publish(twist_body);
+		}
+
+		// velocity in the local frame; the angular rotation is only
+		// done when the result is actually consumed
+		if (local_velocity_local.getNumSubscribers() > 0) {
+			auto twist_local = twist_pool.acquire();
+			twist_local->header.stamp = odom->header.stamp;
+			twist_local->header.frame_id = tf_child_frame_id;
+			tf::vectorEigenToMsg(enu_velocity, twist_local->twist.linear);
+			tf::vectorEigenToMsg(ftf::transform_frame_baselink_enu(ftf::to_eigen(baselink_angular_msg), enu_orientation),
+							twist_local->twist.angular);
+
+			local_velocity_local.publish(twist_local);
+		}
 
 		// publish tf
 		publish_tf(odom);
@@ -178,7 +199,7 @@ private:
 		tf::quaternionMsgToEigen(enu_orientation_msg, enu_orientation);
 		auto baselink_linear = ftf::transform_frame_enu_baselink(enu_velocity, enu_orientation.inverse());
 
-		auto odom = boost::make_shared<nav_msgs::Odometry>();
+		auto odom = odom_pool.acquire();
 		odom->header = m_uas->synchronized_header(frame_id, pos_ned.time_usec);
 		odom->child_frame_id = tf_child_frame_id;
 
@@ -196,55 +217,67 @@ private:
 		odom->twist.covariance[14] = pos_ned.covariance[35];	// vz
 		// TODO: orientation + angular velocity covariances from ATTITUDE_QUATERION_COV
 
-		// publish odom always
-		local_odom.publish(odom);
+		// as in handle_local_position_ned(): odom is the single
+		// product of the transform chain, the other outputs are
+		// views into it, built only while someone subscribes
 
-		// publish pose_cov always
-		auto pose_cov = boost::make_shared<geometry_msgs::PoseWithCovarianceStamped>();
-		pose_cov->header = odom->header;
-		pose_cov->pose = odom->pose;
-		local_position_cov.publish(pose_cov);
+		if (local_odom.getNumSubscribers() > 0)
+			local_odom.publish(odom);
 
-		// publish velocity_cov always
-		auto twist_cov = boost::make_shared<geometry_msgs::TwistWithCovarianceStamped>();
-		twist_cov->header.stamp = odom->header.stamp;
-		twist_cov->header.frame_id = odom->child_frame_id;
-		twist_cov->twist = odom->twist;
-		local_velocity_cov.publish(twist_cov);
+		if (local_position_cov.getNumSubscribers() > 0) {
+			auto pose_cov = pose_cov_pool.acquire();
+			pose_cov->header = odom->header;
+			pose_cov->pose = odom->pose;
+			local_position_cov.publish(pose_cov);
+		}
+
+		if (local_velocity_cov.getNumSubscribers() > 0) {
+			auto twist_cov = twist_cov_pool.acquire();
+			twist_cov->header.stamp = odom->header.stamp;
+			twist_cov->header.frame_id = odom->child_frame_id;
+			twist_cov->twist = odom->twist;
+			local_velocity_cov.publish(twist_cov);
+		}
 
 		// publish pose, velocity, tf if we don't have LOCAL_POSITION_NED
 		if (!has_local_position_ned) {
-			auto pose = boost::make_shared<geometry_msgs::PoseStamped>();
-			pose->header = odom->header;
-			pose->pose = odom->pose.pose;
-			local_position.publish(pose);
-
-			auto twist = boost::make_shared<geometry_msgs::TwistStamped>();
-			twist->header.stamp = odom->header.stamp;
-			twist->header.frame_id = odom->child_frame_id;
-			twist->twist = odom->twist.twist;
-			local_velocity_body.publish(twist);
+			if (local_position.getNumSubscribers() > 0) {
+				auto pose = pose_pool.acquire();
+				pose->header = odom->header;
+				pose->pose = odom->pose.pose;
+				local_position.publish(pose);
+			}
+
+			if (local_velocity_body.getNumSubscribers() > 0) {
+				auto twist = twist_pool.acquire();
+				twist->header.stamp = odom->header.stamp;
+				twist->header.frame_id = odom->child_frame_id;
+				twist->twist = odom->twist.twist;
+				local_velocity_body.publish(twist);
+			}
 
 			// publish tf
 			publish_tf(odom);
 		}
 
 		// publish accelerations
-		auto accel = boost::make_shared<geometry_msgs::AccelWithCovarianceStamped>();
-		accel->header = odom->header;
+		if (local_accel.getNumSubscribers() > 0) {
+			auto accel = accel_pool.acquire();
+			accel->header = odom->header;
 
-		auto enu_accel = ftf::transform_frame_ned_enu(Eigen::Vector3d(pos_ned.ax, pos_ned.ay, pos_ned.az));
-		tf::vectorEigenToMsg(enu_accel, accel->accel.accel.linear);
+			auto enu_accel = ftf::transform_frame_ned_enu(Eigen::Vector3d(pos_ned.ax, pos_ned.ay, pos_ned.az));
+			tf::vectorEigenToMsg(enu_accel, accel->accel.accel.linear);
 
-		accel->accel.covariance[0] = pos_ned.covariance[39];	// ax
-		accel->accel.covariance[7] = pos_ned.covariance[42];	// ay
-		accel->accel.covariance[14] = pos_ned.covariance[44];	// az
+			accel->accel.covariance[0] = pos_ned.covariance[39];	// ax
+			accel->accel.covariance[7] = pos_ned.covariance[42];	// ay
+			accel->accel.covariance[14] = pos_ned.covariance[44];	// az
 
-		local_accel.publish(accel);
+			local_accel.publish(accel);
+		}
 	}
 };
 }	// namespace std_plugins
 }	// namespace mavros
 
-#include <pluginlib/class_list_macros.h>
-PLUGINLIB_EXPORT_CLASS(mavros::std_plugins::LocalPositionPlugin, mavros::plugin::PluginBase)
+#include <mavros/plugin_register.h>
+MAVROS_PLUGIN_REGISTER("local_position", mavros::std_plugins::LocalPositionPlugin)
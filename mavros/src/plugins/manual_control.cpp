@@ -26,7 +26,7 @@ namespace std_plugins {
 class ManualControlPlugin : public plugin::PluginBase {
 public:
 	ManualControlPlugin() : PluginBase(),
-		manual_control_nh("~manual_control")
+		manual_control_nh(plugin_ns("manual_control"))
 	{ }
 
 	void initialize(UAS &uas_)
@@ -84,5 +84,5 @@ private:
 }	// namespace std_plugins
 }	// namespace mavros
 
-#include <pluginlib/class_list_macros.h>
-PLUGINLIB_EXPORT_CLASS(mavros::std_plugins::ManualControlPlugin, mavros::plugin::PluginBase)
+#include <mavros/plugin_register.h>
+MAVROS_PLUGIN_REGISTER("manual_control", mavros::std_plugins::ManualControlPlugin)
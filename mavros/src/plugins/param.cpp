@@ -14,9 +14,13 @@
  * https://github.com/mavlink/mavros/tree/master/LICENSE.md
  */
 
-#include <chrono>
-#include <condition_variable>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <unordered_set>
 #include <mavros/mavros_plugin.h>
+#include <mavros/transaction.h>
 
 #include <mavros_msgs/ParamSet.h>
 #include <mavros_msgs/ParamGet.h>
@@ -335,15 +339,12 @@ class ParamSetOpt {
 public:
 	ParamSetOpt(Parameter &_p, size_t _rem) :
 		param(_p),
-		retries_remaining(_rem),
-		is_timedout(false)
+		retries_remaining(_rem)
 	{ }
 
 	Parameter param;
 	size_t retries_remaining;
-	bool is_timedout;
-	std::mutex cond_mutex;
-	std::condition_variable ack;
+	TransactionWaiter waiter;
 };
 
 
@@ -353,10 +354,14 @@ public:
 class ParamPlugin : public plugin::PluginBase {
 public:
 	ParamPlugin() : PluginBase(),
-		param_nh("~param"),
+		param_nh(plugin_ns("param")),
+		param_timer_nh(plugin_ns("param")),
 		param_count(-1),
 		param_state(PR::IDLE),
-		is_timedout(false),
+		fetch_window(16),
+		cache_loaded(false),
+		have_cached_hash(false),
+		cached_hash(0),
 		RETRIES_COUNT(_RETRIES_COUNT),
 		param_rx_retries(RETRIES_COUNT),
 		BOOTUP_TIME_DT(BOOTUP_TIME_MS / 1000.0),
@@ -368,6 +373,24 @@ public:
 	{
 		PluginBase::initialize(uas_);
 
+		// full param pull can take seconds, keep it off the control path
+		m_uas->set_cb_queue(param_nh, UAS::CbQueue::BULK);
+
+		// In-flight window of targeted PARAM_REQUEST_READ used to fill
+		// gaps after the list stream: every received value immediately
+		// frees a slot for the next missing index, so lossy-link pulls
+		// are paced by the link round trip instead of 1 s timeouts.
+		// 1 restores the old one-request-at-a-time behaviour.
+		param_nh.param("fetch_window", fetch_window, 16);
+
+		// Directory for the on-disk parameter cache. When set, the
+		// last pulled table is stored per target system and served
+		// from disk right after reconnect, while the regular pull
+		// reconciles the values in the background. On PX4 the cached
+		// _HASH_CHECK value allows skipping the pull entirely when
+		// nothing changed. Empty (default) disables caching.
+		param_nh.param<std::string>("cache_dir", cache_dir, "");
+
 		pull_srv = param_nh.advertiseService("pull", &ParamPlugin::pull_cb, this);
 		push_srv = param_nh.advertiseService("push", &ParamPlugin::push_cb, this);
 		set_srv = param_nh.advertiseService("set", &ParamPlugin::set_cb, this);
@@ -377,7 +400,9 @@ public:
 
 		shedule_timer = param_nh.createTimer(BOOTUP_TIME_DT, &ParamPlugin::shedule_cb, this, true);
 		shedule_timer.stop();
-		timeout_timer = param_nh.createTimer(PARAM_TIMEOUT_DT, &ParamPlugin::timeout_cb, this, true);
+		// retransmits must not share the BULK queue: its thread is
+		// blocked inside the service call during a pull
+		timeout_timer = param_timer_nh.createTimer(PARAM_TIMEOUT_DT, &ParamPlugin::timeout_cb, this, true);
 		timeout_timer.stop();
 		enable_connection_cb();
 	}
@@ -395,6 +420,7 @@ private:
 
 	std::recursive_mutex mutex;
 	ros::NodeHandle param_nh;
+	ros::NodeHandle param_timer_nh;	//!< stays on the normal cb queue, see initialize()
 
 	ros::ServiceServer pull_srv;
 	ros::ServiceServer push_srv;
@@ -418,10 +444,14 @@ private:
 
 	std::unordered_map<std::string, Parameter> parameters;
 	std::list<uint16_t> parameters_missing_idx;
+	//! indices with an outstanding PARAM_REQUEST_READ, see request_missing_window()
+	std::unordered_set<uint16_t> fetch_inflight;
+	int fetch_window;
 	std::unordered_map<std::string, std::shared_ptr<ParamSetOpt>> set_parameters;
 	ssize_t param_count;
 	enum class PR {
 		IDLE,
+		HASHCHECK,
 		RXLIST,
 		RXPARAM,
 		RXPARAM_TIMEDOUT,
@@ -429,10 +459,15 @@ private:
 	};
 	PR param_state;
 
+	//! directory of the on-disk parameter cache, empty disables it
+	std::string cache_dir;
+	//! parameters were pre-loaded from cache, reconcile instead of clearing
+	bool cache_loaded;
+	bool have_cached_hash;
+	int32_t cached_hash;	//!< PX4 _HASH_CHECK value stored with the cache
+
 	size_t param_rx_retries;
-	bool is_timedout;
-	std::mutex list_cond_mutex;
-	std::condition_variable list_receiving;
+	TransactionWaiter list_waiter;
 
 	/* -*- message handlers -*- */
 
@@ -456,7 +491,7 @@ private:
 			// check that ack required
 			auto set_it = set_parameters.find(param_id);
 			if (set_it != set_parameters.end()) {
-				set_it->second->ack.notify_all();
+				set_it->second->waiter.complete(true);
 			}
 
 			param_value_pub.publish(p.to_msg());
@@ -488,6 +523,25 @@ private:
 			ROS_DEBUG_STREAM_NAMED("param", "PR: New param " << p.to_string());
 		}
 
+		if (param_state == PR::HASHCHECK && param_id == "_HASH_CHECK") {
+			int32_t fcu_hash = parameters[param_id].to_integer();
+
+			if (fcu_hash == cached_hash) {
+				ROS_INFO_NAMED("param", "PR: FCU param hash matches cache, full pull skipped");
+				go_idle();
+				list_waiter.complete(true);
+			}
+			else {
+				ROS_INFO_NAMED("param", "PR: param hash mismatch (cache 0x%08x, FCU 0x%08x), pulling",
+						cached_hash, fcu_hash);
+				param_state = PR::RXLIST;
+				param_rx_retries = RETRIES_COUNT;
+				restart_timeout_timer();
+				param_request_list();
+			}
+			return;
+		}
+
 		if (param_state == PR::RXLIST || param_state == PR::RXPARAM || param_state == PR::RXPARAM_TIMEDOUT) {
 
 			// we received first param. setup list timeout
@@ -496,6 +550,7 @@ private:
 				param_state = PR::RXPARAM;
 
 				parameters_missing_idx.clear();
+				fetch_inflight.clear();
 				if (param_count != UINT16_MAX) {
 					ROS_DEBUG_NAMED("param", "PR: waiting %zu parameters", param_count);
 					// declare that all parameters are missing
@@ -513,6 +568,7 @@ private:
 
 			// remove idx for that message
 			parameters_missing_idx.remove(pmsg.param_index);
+			fetch_inflight.erase(pmsg.param_index);
 
 			// in receiving mode we use param_rx_retries for LIST and PARAM
 			if (it_is_first_requested) {
@@ -533,12 +589,19 @@ private:
 				ROS_WARN_COND_NAMED(missed > 0, "param",
 						"PR: parameters list received, but %zd parametars are missed",
 						missed);
+
+				// reconcile finished, refresh the on-disk cache
+				if (missed <= 0)
+					save_param_cache();
+				cache_loaded = false;
+
 				go_idle();
-				list_receiving.notify_all();
+				// a partial table is still reported as success,
+				// missed params are already warned about above
+				list_waiter.complete(true);
 			} else if (param_state == PR::RXPARAM_TIMEDOUT) {
-				uint16_t first_miss_idx = parameters_missing_idx.front();
-				ROS_DEBUG_NAMED("param", "PR: requesting next timed out parameter idx=%u", first_miss_idx);
-				param_request_read("", first_miss_idx);
+				// top up the request window as the gaps fill
+				request_missing_window();
 			}
 		}
 	}
@@ -552,7 +615,7 @@ private:
 		mavlink::common::msg::PARAM_REQUEST_LIST rql{};
 		m_uas->msg_set_target(rql);
 
-		UAS_FCU(m_uas)->send_message_ignore_drop(rql);
+		UAS_FCU(m_uas)->send_message_ignore_drop(rql, mavconn::TxPrio::BULK);
 	}
 
 	void param_request_read(std::string id, int16_t index = -1)
@@ -565,11 +628,12 @@ private:
 		m_uas->msg_set_target(rqr);
 		rqr.param_index = index;
 
-		if (index != -1) {
+		// by-name read: FCU uses param_id when index is -1
+		if (index == -1) {
 			mavlink::set_string(rqr.param_id, id);
 		}
 
-		UAS_FCU(m_uas)->send_message_ignore_drop(rqr);
+		UAS_FCU(m_uas)->send_message_ignore_drop(rqr, mavconn::TxPrio::BULK);
 	}
 
 	void param_set(Parameter &param)
@@ -586,7 +650,7 @@ private:
 
 		m_uas->msg_set_target(ps);
 
-		UAS_FCU(m_uas)->send_message_ignore_drop(ps);
+		UAS_FCU(m_uas)->send_message_ignore_drop(ps, mavconn::TxPrio::BULK);
 	}
 
 	/* -*- mid-level functions -*- */
@@ -595,6 +659,10 @@ private:
 	{
 		lock_guard lock(mutex);
 		if (connected) {
+			if (parameters.empty() && load_param_cache())
+				ROS_INFO_NAMED("param", "PR: %zu parameters served from cache, reconciling in background",
+						parameters.size());
+
 			shedule_pull(BOOTUP_TIME_DT);
 		}
 		else {
@@ -618,10 +686,25 @@ private:
 			shedule_pull(BOOTUP_TIME_DT);
 		}
 
+		// PX4 publishes a CRC of the whole table as _HASH_CHECK: when
+		// it matches the cached one nothing changed since the last
+		// session and the full pull can be skipped entirely.
+		if (cache_loaded && have_cached_hash && m_uas->is_px4()) {
+			ROS_DEBUG_NAMED("param", "PR: cache loaded, checking FCU param hash");
+			param_state = PR::HASHCHECK;
+			param_rx_retries = RETRIES_COUNT;
+
+			restart_timeout_timer();
+			param_request_read("_HASH_CHECK");
+			return;
+		}
+
 		ROS_DEBUG_NAMED("param", "PR: start sheduled pull");
 		param_state = PR::RXLIST;
 		param_rx_retries = RETRIES_COUNT;
-		parameters.clear();
+		// cache-loaded values stay visible and get reconciled in place
+		if (!cache_loaded)
+			parameters.clear();
 
 		restart_timeout_timer();
 		param_request_list();
@@ -630,7 +713,22 @@ private:
 	void timeout_cb(const ros::TimerEvent &event)
 	{
 		lock_guard lock(mutex);
-		if (param_state == PR::RXLIST && param_rx_retries > 0) {
+		if (param_state == PR::HASHCHECK) {
+			if (param_rx_retries > 0) {
+				param_rx_retries--;
+				ROS_WARN_NAMED("param", "PR: hash check timeout, retries left %zu", param_rx_retries);
+				restart_timeout_timer();
+				param_request_read("_HASH_CHECK");
+			}
+			else {
+				ROS_WARN_NAMED("param", "PR: hash check got no answer, falling back to full pull");
+				param_state = PR::RXLIST;
+				param_rx_retries = RETRIES_COUNT;
+				restart_timeout_timer();
+				param_request_list();
+			}
+		}
+		else if (param_state == PR::RXLIST && param_rx_retries > 0) {
 			param_rx_retries--;
 			ROS_WARN_NAMED("param", "PR: request list timeout, retries left %zu", param_rx_retries);
 
@@ -643,30 +741,32 @@ private:
 						"maybe last rerequest fails. Params missed: %zd",
 						param_count - parameters.size());
 				go_idle();
-				list_receiving.notify_all();
+				list_waiter.complete(true);
 				return;
 			}
 
 			param_state = PR::RXPARAM_TIMEDOUT;
-			uint16_t first_miss_idx = parameters_missing_idx.front();
+			// whatever was outstanding is considered lost; the whole
+			// window gets retransmitted selectively over the gaps
+			fetch_inflight.clear();
 			if (param_rx_retries > 0) {
 				param_rx_retries--;
-				ROS_WARN_NAMED("param", "PR: request param #%u timeout, retries left %zu, and %zu params still missing",
-						first_miss_idx, param_rx_retries, parameters_missing_idx.size());
+				ROS_WARN_NAMED("param", "PR: request window timeout, retries left %zu, and %zu params still missing",
+						param_rx_retries, parameters_missing_idx.size());
 				restart_timeout_timer();
-				param_request_read("", first_miss_idx);
+				request_missing_window();
 			}
 			else {
+				uint16_t first_miss_idx = parameters_missing_idx.front();
 				ROS_ERROR_NAMED("param", "PR: request param #%u completely missing.", first_miss_idx);
 				parameters_missing_idx.pop_front();
 				restart_timeout_timer();
 				if (!parameters_missing_idx.empty()) {
 					param_rx_retries = RETRIES_COUNT;
-					first_miss_idx = parameters_missing_idx.front();
 
-					ROS_WARN_NAMED("param", "PR: %zu params still missing, trying to request next: #%u",
-							parameters_missing_idx.size(), first_miss_idx);
-					param_request_read("", first_miss_idx);
+					ROS_WARN_NAMED("param", "PR: %zu params still missing, requesting next window",
+							parameters_missing_idx.size());
+					request_missing_window();
 				}
 			}
 		}
@@ -689,8 +789,7 @@ private:
 			else {
 				ROS_ERROR_NAMED("param", "PR: Param set for %s timed out.",
 						it->second->param.param_id.c_str());
-				it->second->is_timedout = true;
-				it->second->ack.notify_all();
+				it->second->waiter.complete(false);
 			}
 		}
 		else {
@@ -698,9 +797,185 @@ private:
 		}
 	}
 
+	/**
+	 * @brief Keep up to fetch_window targeted index requests in flight
+	 *
+	 * Called on gap-fill timeouts and on every value received in
+	 * RXPARAM_TIMEDOUT: each arriving value frees a window slot for
+	 * the next missing index, so the remainder of a lossy pull is
+	 * paced by round trips instead of timeout periods.
+	 */
+	void request_missing_window()
+	{
+		const size_t window = std::max(1, fetch_window);
+
+		for (auto idx : parameters_missing_idx) {
+			if (fetch_inflight.size() >= window)
+				break;
+
+			if (fetch_inflight.insert(idx).second) {
+				ROS_DEBUG_NAMED("param", "PR: requesting missing parameter idx=%u", idx);
+				param_request_read("", idx);
+			}
+		}
+	}
+
+	/* -*- on-disk parameter cache -*- */
+
+	//! fixed-layout cache record, the table is mmap-loadable
+	struct CacheRecord {
+		char id[24];		//!< param_id, NUL-padded (wire limit is 16)
+		uint16_t index;
+		uint16_t count;
+		uint8_t type;		//!< XmlRpcValue::Type of the value
+		uint8_t _pad[3];
+		int64_t ivalue;
+		double rvalue;
+	};
+
+	struct CacheHeader {
+		uint32_t magic;
+		uint16_t version;
+		uint16_t reserved;
+		uint32_t count;
+		uint32_t key;		//!< vehicle identity, see cache_key()
+	};
+
+	static constexpr uint32_t CACHE_MAGIC = 0x4350564d;	// "MVPC"
+	static constexpr uint16_t CACHE_VERSION = 1;
+
+	//! cache files are keyed by target system, type and autopilot
+	uint32_t cache_key()
+	{
+		return m_uas->get_tgt_system()
+		       | (enum_value(m_uas->get_autopilot()) << 8)
+		       | (enum_value(m_uas->get_type()) << 16);
+	}
+
+	std::string cache_path()
+	{
+		return utils::format("%s/params_sys%u.bin", cache_dir.c_str(), m_uas->get_tgt_system());
+	}
+
+	/**
+	 * @brief Pre-load the parameter table from the on-disk cache
+	 *
+	 * Lets param/get and param/set work right after reconnect; the
+	 * regular pull then reconciles the values in the background.
+	 */
+	bool load_param_cache()
+	{
+		if (cache_dir.empty())
+			return false;
+
+		std::ifstream f(cache_path(), std::ios::binary);
+		if (!f)
+			return false;
+
+		CacheHeader hdr{};
+		f.read(reinterpret_cast<char *>(&hdr), sizeof(hdr));
+		if (!f || hdr.magic != CACHE_MAGIC || hdr.version != CACHE_VERSION || hdr.key != cache_key()) {
+			ROS_WARN_NAMED("param", "PR: parameter cache mismatch, ignored: %s", cache_path().c_str());
+			return false;
+		}
+
+		size_t loaded = 0;
+		for (uint32_t i = 0; i < hdr.count; i++) {
+			CacheRecord rec{};
+			f.read(reinterpret_cast<char *>(&rec), sizeof(rec));
+			if (!f)
+				break;
+
+			rec.id[sizeof(rec.id) - 1] = '\0';
+
+			Parameter p{};
+			p.param_id = rec.id;
+			p.param_index = rec.index;
+			p.param_count = rec.count;
+
+			switch (rec.type) {
+			case XmlRpc::XmlRpcValue::TypeBoolean:
+				p.param_value = (rec.ivalue != 0);
+				break;
+			case XmlRpc::XmlRpcValue::TypeInt:
+				p.param_value = static_cast<int>(rec.ivalue);
+				break;
+			case XmlRpc::XmlRpcValue::TypeDouble:
+				p.param_value = rec.rvalue;
+				break;
+			default:
+				continue;
+			}
+
+			if (p.param_id == "_HASH_CHECK") {
+				cached_hash = static_cast<int32_t>(rec.ivalue);
+				have_cached_hash = true;
+			}
+
+			parameters[p.param_id] = p;
+			loaded++;
+		}
+
+		cache_loaded = loaded > 0;
+		return cache_loaded;
+	}
+
+	//! Store the received table; called once after a complete pull
+	void save_param_cache()
+	{
+		if (cache_dir.empty())
+			return;
+
+		auto tmp_path = cache_path() + ".tmp";
+		std::ofstream f(tmp_path, std::ios::binary | std::ios::trunc);
+		if (!f) {
+			ROS_WARN_NAMED("param", "PR: can not write parameter cache: %s", tmp_path.c_str());
+			return;
+		}
+
+		CacheHeader hdr{};
+		hdr.magic = CACHE_MAGIC;
+		hdr.version = CACHE_VERSION;
+		hdr.count = parameters.size();
+		hdr.key = cache_key();
+		f.write(reinterpret_cast<const char *>(&hdr), sizeof(hdr));
+
+		for (auto &pp : parameters) {
+			auto &p = pp.second;
+			CacheRecord rec{};
+
+			strncpy(rec.id, p.param_id.c_str(), sizeof(rec.id) - 1);
+			rec.index = p.param_index;
+			rec.count = p.param_count;
+			rec.type = p.param_value.getType();
+
+			auto v = p.param_value;	// const XmlRpcValue can't cast
+			switch (rec.type) {
+			case XmlRpc::XmlRpcValue::TypeBoolean:
+				rec.ivalue = static_cast<bool>(v);
+				break;
+			case XmlRpc::XmlRpcValue::TypeInt:
+				rec.ivalue = static_cast<int>(v);
+				break;
+			case XmlRpc::XmlRpcValue::TypeDouble:
+				rec.rvalue = static_cast<double>(v);
+				break;
+			default:
+				break;
+			}
+
+			f.write(reinterpret_cast<const char *>(&rec), sizeof(rec));
+		}
+
+		f.close();
+		if (!f || std::rename(tmp_path.c_str(), cache_path().c_str()) != 0)
+			ROS_WARN_NAMED("param", "PR: parameter cache update failed: %s", cache_path().c_str());
+		else
+			ROS_DEBUG_NAMED("param", "PR: parameter cache updated: %s", cache_path().c_str());
+	}
+
 	void restart_timeout_timer()
 	{
-		is_timedout = false;
 		timeout_timer.stop();
 		timeout_timer.start();
 	}
@@ -708,25 +983,18 @@ private:
 	void go_idle()
 	{
 		param_state = PR::IDLE;
+		fetch_inflight.clear();
 		timeout_timer.stop();
 	}
 
 	bool wait_fetch_all()
 	{
-		std::unique_lock<std::mutex> lock(list_cond_mutex);
-
-		return list_receiving.wait_for(lock, std::chrono::nanoseconds(LIST_TIMEOUT_DT.toNSec()))
-		       == std::cv_status::no_timeout
-		       && !is_timedout;
+		return list_waiter.wait_for(LIST_TIMEOUT_DT);
 	}
 
 	bool wait_param_set_ack_for(std::shared_ptr<ParamSetOpt> opt)
 	{
-		std::unique_lock<std::mutex> lock(opt->cond_mutex);
-
-		return opt->ack.wait_for(lock, std::chrono::nanoseconds(PARAM_TIMEOUT_DT.toNSec()) * (RETRIES_COUNT + 2))
-		       == std::cv_status::no_timeout
-		       && !opt->is_timedout;
+		return opt->waiter.wait_for(PARAM_TIMEOUT_DT * (RETRIES_COUNT + 2));
 	}
 
 	bool send_param_set_and_wait(Parameter &param)
@@ -776,6 +1044,9 @@ private:
 	{
 		unique_lock lock(mutex);
 
+		// drop a completion left by a timed-out pull
+		list_waiter.reset();
+
 		if ((param_state == PR::IDLE && parameters.empty())
 				|| req.force_pull) {
 			if (!req.force_pull)
@@ -786,6 +1057,7 @@ private:
 			param_state = PR::RXLIST;
 			param_rx_retries = RETRIES_COUNT;
 			parameters.clear();
+			cache_loaded = false;
 
 			shedule_timer.stop();
 			restart_timeout_timer();
@@ -794,7 +1066,7 @@ private:
 			lock.unlock();
 			res.success = wait_fetch_all();
 		}
-		else if (param_state == PR::RXLIST || param_state == PR::RXPARAM || param_state == PR::RXPARAM_TIMEDOUT) {
+		else if (param_state == PR::HASHCHECK || param_state == PR::RXLIST || param_state == PR::RXPARAM || param_state == PR::RXPARAM_TIMEDOUT) {
 			lock.unlock();
 			res.success = wait_fetch_all();
 		}
@@ -871,7 +1143,7 @@ private:
 	{
 		unique_lock lock(mutex);
 
-		if (param_state == PR::RXLIST || param_state == PR::RXPARAM || param_state == PR::RXPARAM_TIMEDOUT) {
+		if (param_state == PR::HASHCHECK || param_state == PR::RXLIST || param_state == PR::RXPARAM || param_state == PR::RXPARAM_TIMEDOUT) {
 			ROS_ERROR_NAMED("param", "PR: receiving not complete");
 			return false;
 		}
@@ -933,5 +1205,5 @@ private:
 }	// namespace std_plugins
 }	// namespace mavros
 
-#include <pluginlib/class_list_macros.h>
-PLUGINLIB_EXPORT_CLASS(mavros::std_plugins::ParamPlugin, mavros::plugin::PluginBase)
+#include <mavros/plugin_register.h>
+MAVROS_PLUGIN_REGISTER("param", mavros::std_plugins::ParamPlugin)
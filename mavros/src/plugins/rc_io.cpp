@@ -14,7 +14,9 @@
  * https://github.com/mavlink/mavros/tree/master/LICENSE.md
  */
 
+#include <cstdlib>
 #include <mavros/mavros_plugin.h>
+#include <mavros/msg_pool.h>
 
 #include <mavros_msgs/RCIn.h>
 #include <mavros_msgs/RCOut.h>
@@ -28,16 +30,28 @@ namespace std_plugins {
 class RCIOPlugin : public plugin::PluginBase {
 public:
 	RCIOPlugin() : PluginBase(),
-		rc_nh("~rc"),
+		rc_nh(plugin_ns("rc")),
 		raw_rc_in(0),
 		raw_rc_out(0),
-		has_rc_channels_msg(false)
+		has_rc_channels_msg(false),
+		deadband(0),
+		last_rssi(-1)
 	{ }
 
 	void initialize(UAS &uas_)
 	{
 		PluginBase::initialize(uas_);
 
+		double keepalive_d;
+
+		// Republish in/out only when some channel moved by at least
+		// deadband [us] since the last published frame. A keepalive
+		// republish keeps late subscribers and bag tools supplied
+		// with the current state. 0 (default) publishes every frame.
+		rc_nh.param("deadband", deadband, 0);
+		rc_nh.param("keepalive", keepalive_d, 1.0);
+		keepalive_dt = ros::Duration(keepalive_d);
+
 		rc_in_pub = rc_nh.advertise<mavros_msgs::RCIn>("in", 10);
 		rc_out_pub = rc_nh.advertise<mavros_msgs::RCOut>("out", 10);
 		override_sub = rc_nh.subscribe("override", 10, &RCIOPlugin::override_cb, this);
@@ -62,10 +76,52 @@ private:
 	std::vector<uint16_t> raw_rc_out;
 	std::atomic<bool> has_rc_channels_msg;
 
+	int deadband;			//!< minimal per-channel delta to republish [us]
+	ros::Duration keepalive_dt;	//!< republish unchanged frames at this interval
+	std::vector<uint16_t> last_rc_in;	//!< channels of the last published RCIn
+	std::vector<uint16_t> last_rc_out;	//!< channels of the last published RCOut
+	int last_rssi;
+	ros::Time last_rc_in_pub;
+	ros::Time last_rc_out_pub;
+
+	MessagePool<mavros_msgs::RCIn> rcin_pool;
+	MessagePool<mavros_msgs::RCOut> rcout_pool;
+
 	ros::Publisher rc_in_pub;
 	ros::Publisher rc_out_pub;
 	ros::Subscriber override_sub;
 
+	/**
+	 * @brief Per-channel deadband filter with periodic keepalive
+	 *
+	 * Updates @a last and @a last_pub when the frame should go out.
+	 *
+	 * @return true if some channel moved by at least deadband since
+	 *         the last published frame, or the keepalive interval expired
+	 */
+	bool passes_deadband(const std::vector<uint16_t> &channels, std::vector<uint16_t> &last,
+			const ros::Time &stamp, ros::Time &last_pub, int extra_delta = 0)
+	{
+		if (deadband <= 0)
+			return true;
+
+		bool changed = extra_delta >= deadband || channels.size() != last.size();
+		if (!changed)
+			for (size_t i = 0; i < channels.size(); i++)
+				if (std::abs(int(channels[i]) - int(last[i])) >= deadband) {
+					changed = true;
+					break;
+				}
+
+		if (!changed && stamp - last_pub < keepalive_dt)
+			return false;
+
+		// assign() reuses the vector capacity: no allocation in steady state
+		last.assign(channels.begin(), channels.end());
+		last_pub = stamp;
+		return true;
+	}
+
 	/* -*- rx handlers -*- */
 
 	void handle_rc_channels_raw(const mavlink::mavlink_message_t *msg, mavlink::common::msg::RC_CHANNELS_RAW &port)
@@ -95,9 +151,16 @@ private:
 		raw_rc_in[offset + 7] = port.chan8_raw;
 		// [[[end]]] (checksum: fcb14b1ddfff9ce7dd02f5bd03825cff)
 
-		auto rcin_msg = boost::make_shared<mavros_msgs::RCIn>();
+		auto stamp = m_uas->synchronise_stamp(port.time_boot_ms);
+		if (!passes_deadband(raw_rc_in, last_rc_in, stamp, last_rc_in_pub,
+					std::abs(int(port.rssi) - last_rssi)))
+			return;
+
+		last_rssi = port.rssi;
 
-		rcin_msg->header.stamp = m_uas->synchronise_stamp(port.time_boot_ms);
+		auto rcin_msg = rcin_pool.acquire();
+
+		rcin_msg->header.stamp = stamp;
 		rcin_msg->rssi = port.rssi;
 		rcin_msg->channels = raw_rc_in;
 
@@ -150,9 +213,16 @@ private:
 		case  0: break;
 		}
 
-		auto rcin_msg = boost::make_shared<mavros_msgs::RCIn>();
+		auto stamp = m_uas->synchronise_stamp(channels.time_boot_ms);
+		if (!passes_deadband(raw_rc_in, last_rc_in, stamp, last_rc_in_pub,
+					std::abs(int(channels.rssi) - last_rssi)))
+			return;
+
+		last_rssi = channels.rssi;
 
-		rcin_msg->header.stamp = m_uas->synchronise_stamp(channels.time_boot_ms);
+		auto rcin_msg = rcin_pool.acquire();
+
+		rcin_msg->header.stamp = stamp;
 		rcin_msg->rssi = channels.rssi;
 		rcin_msg->channels = raw_rc_in;
 
@@ -205,12 +275,16 @@ private:
 			// [[[end]]] (checksum: 60a386cba6faa126ee7dfe1b22f50398)
 		}
 
-		auto rcout_msg = boost::make_shared<mavros_msgs::RCOut>();
-
 		// XXX: Why time_usec is 32 bit? We should test that.
 		uint64_t time_usec = port.time_usec;
 
-		rcout_msg->header.stamp = m_uas->synchronise_stamp(time_usec);
+		auto stamp = m_uas->synchronise_stamp(time_usec);
+		if (!passes_deadband(raw_rc_out, last_rc_out, stamp, last_rc_out_pub))
+			return;
+
+		auto rcout_msg = rcout_pool.acquire();
+
+		rcout_msg->header.stamp = stamp;
 		rcout_msg->channels = raw_rc_out;
 
 		rc_out_pub.publish(rcout_msg);
@@ -224,6 +298,13 @@ private:
 		raw_rc_in.clear();
 		raw_rc_out.clear();
 		has_rc_channels_msg = false;
+
+		// forget the deadband state: first frame after (re)connect always goes out
+		last_rc_in.clear();
+		last_rc_out.clear();
+		last_rssi = -1;
+		last_rc_in_pub = ros::Time();
+		last_rc_out_pub = ros::Time();
 	}
 
 	void override_cb(const mavros_msgs::OverrideRCIn::ConstPtr req)
@@ -255,5 +336,5 @@ private:
 }	// namespace std_plugins
 }	// namespace mavros
 
-#include <pluginlib/class_list_macros.h>
-PLUGINLIB_EXPORT_CLASS(mavros::std_plugins::RCIOPlugin, mavros::plugin::PluginBase)
+#include <mavros/plugin_register.h>
+MAVROS_PLUGIN_REGISTER("rc_io", mavros::std_plugins::RCIOPlugin)
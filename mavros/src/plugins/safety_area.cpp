@@ -15,9 +15,15 @@
  * https://github.com/mavlink/mavros/tree/master/LICENSE.md
  */
 
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
 #include <mavros/mavros_plugin.h>
 
 #include <geometry_msgs/PolygonStamped.h>
+#include <mavros_msgs/GeofenceStatus.h>
 
 namespace mavros {
 namespace std_plugins {
@@ -25,11 +31,13 @@ namespace std_plugins {
  * @brief Safety allopwed area plugin
  *
  * Send safety area to FCU controller.
+ * Optionally evaluates a local multi-polygon geofence against the
+ * LOCAL_POSITION_NED stream, see ~safety_area/geofence/polygons.
  */
 class SafetyAreaPlugin : public plugin::PluginBase {
 public:
 	SafetyAreaPlugin() : PluginBase(),
-		safety_nh("~safety_area")
+		safety_nh(plugin_ns("safety_area"))
 	{ }
 
 	void initialize(UAS &uas_)
@@ -68,12 +76,17 @@ public:
 
 		safetyarea_sub = safety_nh.subscribe("set", 10, &SafetyAreaPlugin::safetyarea_cb, this);
 		safetyarea_pub = safety_nh.advertise<geometry_msgs::PolygonStamped>("get",10);
+
+		load_geofence();
+		if (!polygons.empty())
+			geofence_pub = safety_nh.advertise<mavros_msgs::GeofenceStatus>("geofence/status", 10);
 	}
 
 	Subscriptions get_subscriptions()
 	{
 		return {
-		       make_handler(&SafetyAreaPlugin::handle_safety_allowed_area)
+		       make_handler(&SafetyAreaPlugin::handle_safety_allowed_area),
+		       make_handler(&SafetyAreaPlugin::handle_local_position_ned)
 		};
 	}
 
@@ -84,6 +97,138 @@ private:
 
 	ros::Subscriber safetyarea_sub;
 	ros::Publisher safetyarea_pub;
+	ros::Publisher geofence_pub;
+
+	/* -*- geofence engine -*-
+	 *
+	 * ~safety_area/geofence/polygons is a map name -> polygon, each
+	 * polygon a struct of "x" and "y" vertex arrays (ENU meters) plus
+	 * an optional "inclusion" flag (default true, false = keep-out).
+	 *
+	 * All edges of all polygons live in one structure-of-arrays table,
+	 * so both kernels below are flat branch-free loops the compiler
+	 * vectorizes without intrinsics.
+	 */
+	struct EdgeTable {
+		std::vector<float> x0;		//!< first vertex
+		std::vector<float> y0;
+		std::vector<float> y1;		//!< second vertex y, for the straddle test
+		std::vector<float> dx;		//!< second vertex minus first
+		std::vector<float> dy;
+		std::vector<float> slope;	//!< dx/dy, 0 on horizontal edges
+		std::vector<float> inv_len2;	//!< 1 / squared edge length
+
+		size_t size() const { return x0.size(); }
+	};
+
+	struct FencePolygon {
+		std::string name;
+		size_t first;		//!< offset into the edge table
+		size_t count;
+		bool inclusion;
+	};
+
+	EdgeTable edges;
+	std::vector<FencePolygon> polygons;
+
+	void load_geofence()
+	{
+		XmlRpc::XmlRpcValue fence_dict;
+		if (!safety_nh.getParam("geofence/polygons", fence_dict))
+			return;
+
+		ROS_ASSERT(fence_dict.getType() == XmlRpc::XmlRpcValue::TypeStruct);
+		for (auto &pair : fence_dict) {
+			auto &pv = pair.second;
+			if (pv.getType() != XmlRpc::XmlRpcValue::TypeStruct ||
+					!pv.hasMember("x") || !pv.hasMember("y")) {
+				ROS_ERROR_NAMED("safetyarea", "SA: geofence %s: need x and y vertex arrays",
+						pair.first.c_str());
+				continue;
+			}
+
+			auto &xs = pv["x"];
+			auto &ys = pv["y"];
+			if (xs.size() != ys.size() || xs.size() < 3) {
+				ROS_ERROR_NAMED("safetyarea", "SA: geofence %s: need >= 3 vertices",
+						pair.first.c_str());
+				continue;
+			}
+
+			auto as_float = [](XmlRpc::XmlRpcValue &v) {
+				return (v.getType() == XmlRpc::XmlRpcValue::TypeInt) ?
+					float(static_cast<int>(v)) :
+					float(static_cast<double>(v));
+			};
+
+			FencePolygon pg;
+			pg.name = pair.first;
+			pg.first = edges.size();
+			pg.count = xs.size();
+			pg.inclusion = !pv.hasMember("inclusion") || bool(pv["inclusion"]);
+
+			for (int i = 0; i < xs.size(); i++) {
+				int j = (i + 1) % xs.size();
+				float x0 = as_float(xs[i]), y0 = as_float(ys[i]);
+				float x1 = as_float(xs[j]), y1 = as_float(ys[j]);
+				float dx = x1 - x0, dy = y1 - y0;
+				float len2 = dx * dx + dy * dy;
+
+				edges.x0.push_back(x0);
+				edges.y0.push_back(y0);
+				edges.y1.push_back(y1);
+				edges.dx.push_back(dx);
+				edges.dy.push_back(dy);
+				edges.slope.push_back((dy != 0.0f) ? dx / dy : 0.0f);
+				edges.inv_len2.push_back((len2 > 0.0f) ? 1.0f / len2 : 0.0f);
+			}
+
+			polygons.push_back(std::move(pg));
+		}
+
+		if (!polygons.empty())
+			ROS_INFO_NAMED("safetyarea", "SA: geofence: %zu polygons, %zu edges loaded",
+					polygons.size(), edges.size());
+	}
+
+	//! crossing-number test over the flat edge table, branch-free body
+	bool polygon_contains(const FencePolygon &pg, float px, float py) const
+	{
+		unsigned crossings = 0;
+		const size_t last = pg.first + pg.count;
+
+		for (size_t i = pg.first; i < last; i++) {
+			unsigned straddles = (edges.y0[i] > py) != (edges.y1[i] > py);
+			unsigned left = px < edges.x0[i] + edges.slope[i] * (py - edges.y0[i]);
+			crossings += straddles & left;
+		}
+
+		return crossings & 1;
+	}
+
+	//! distance to the nearest edge of any polygon; argmin for the closing-speed step
+	float nearest_edge(float px, float py, size_t &argmin, float &t_out) const
+	{
+		float best = std::numeric_limits<float>::infinity();
+
+		for (size_t i = 0; i < edges.size(); i++) {
+			float t = ((px - edges.x0[i]) * edges.dx[i] +
+					(py - edges.y0[i]) * edges.dy[i]) * edges.inv_len2[i];
+			t = std::min(1.0f, std::max(0.0f, t));
+
+			float rx = edges.x0[i] + t * edges.dx[i] - px;
+			float ry = edges.y0[i] + t * edges.dy[i] - py;
+			float d2 = rx * rx + ry * ry;
+
+			if (d2 < best) {
+				best = d2;
+				argmin = i;
+				t_out = t;
+			}
+		}
+
+		return std::sqrt(best);
+	}
 
 	/* -*- rx handlers -*- */
 	void handle_safety_allowed_area(const mavlink::mavlink_message_t *msg, mavlink::common::msg::SAFETY_ALLOWED_AREA &saa)
@@ -111,6 +256,53 @@ private:
 		safetyarea_pub.publish(saa_msg);
 	}
 
+	void handle_local_position_ned(const mavlink::mavlink_message_t *msg, mavlink::common::msg::LOCAL_POSITION_NED &pos)
+	{
+		if (polygons.empty())
+			return;
+
+		auto p = ftf::transform_frame_ned_enu(Eigen::Vector3d(pos.x, pos.y, pos.z));
+		auto v = ftf::transform_frame_ned_enu(Eigen::Vector3d(pos.vx, pos.vy, pos.vz));
+		float px = p.x(), py = p.y();
+
+		bool inside = true;
+		for (auto &pg : polygons) {
+			bool in = polygon_contains(pg, px, py);
+			if (pg.inclusion ? !in : in) {
+				inside = false;
+				ROS_WARN_THROTTLE_NAMED(5, "safetyarea", "SA: geofence %s breached",
+						pg.name.c_str());
+			}
+		}
+
+		size_t argmin = 0;
+		float t = 0.0f;
+		float margin = nearest_edge(px, py, argmin, t);
+		if (!inside)
+			margin = -margin;
+
+		// closing speed: project horizontal velocity onto the direction
+		// of the nearest boundary point found above
+		float ttb = std::numeric_limits<float>::infinity();
+		if (!inside)
+			ttb = 0.0f;
+		else if (margin > 0.0f) {
+			float nx = edges.x0[argmin] + t * edges.dx[argmin];
+			float ny = edges.y0[argmin] + t * edges.dy[argmin];
+			float closing = (float(v.x()) * (nx - px) + float(v.y()) * (ny - py)) / margin;
+			if (closing > 0.0f)
+				ttb = margin / closing;
+		}
+
+		auto status = boost::make_shared<mavros_msgs::GeofenceStatus>();
+		status->header.stamp = m_uas->synchronise_stamp(pos.time_boot_ms);
+		status->header.frame_id = frame_id;
+		status->inside = inside;
+		status->breach_margin = margin;
+		status->time_to_breach = ttb;
+		geofence_pub.publish(status);
+	}
+
 	/* -*- mid-level helpers -*- */
 
 	/**
@@ -174,5 +366,5 @@ private:
 }	// namespace std_plugins
 }	// namespace mavros
 
-#include <pluginlib/class_list_macros.h>
-PLUGINLIB_EXPORT_CLASS(mavros::std_plugins::SafetyAreaPlugin, mavros::plugin::PluginBase)
+#include <mavros/plugin_register.h>
+MAVROS_PLUGIN_REGISTER("safety_area", mavros::std_plugins::SafetyAreaPlugin)
@@ -33,7 +33,7 @@ class SetpointAccelerationPlugin : public plugin::PluginBase,
 	private plugin::SetPositionTargetLocalNEDMixin<SetpointAccelerationPlugin> {
 public:
 	SetpointAccelerationPlugin() : PluginBase(),
-		sp_nh("~setpoint_accel"),
+		sp_nh(plugin_ns("setpoint_accel")),
 		send_force(false)
 	{ }
 
@@ -101,5 +101,5 @@ private:
 }	// namespace std_plugins
 }	// namespace mavros
 
-#include <pluginlib/class_list_macros.h>
-PLUGINLIB_EXPORT_CLASS(mavros::std_plugins::SetpointAccelerationPlugin, mavros::plugin::PluginBase)
+#include <mavros/plugin_register.h>
+MAVROS_PLUGIN_REGISTER("setpoint_accel", mavros::std_plugins::SetpointAccelerationPlugin)
@@ -45,7 +45,7 @@ class SetpointAttitudePlugin : public plugin::PluginBase,
 	private plugin::TF2ListenerMixin<SetpointAttitudePlugin> {
 public:
 	SetpointAttitudePlugin() : PluginBase(),
-		sp_nh("~setpoint_attitude"),
+		sp_nh(plugin_ns("setpoint_attitude")),
 		tf_rate(50.0),
 		use_quaternion(false),
 		reverse_thrust(false),
@@ -219,5 +219,5 @@ private:
 }	// namespace std_plugins
 }	// namespace mavros
 
-#include <pluginlib/class_list_macros.h>
-PLUGINLIB_EXPORT_CLASS(mavros::std_plugins::SetpointAttitudePlugin, mavros::plugin::PluginBase)
+#include <mavros/plugin_register.h>
+MAVROS_PLUGIN_REGISTER("setpoint_attitude", mavros::std_plugins::SetpointAttitudePlugin)
@@ -41,8 +41,8 @@ public:
 	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
 	SetpointPositionPlugin() : PluginBase(),
-		sp_nh("~setpoint_position"),
-		spg_nh("~"),
+		sp_nh(plugin_ns("setpoint_position")),
+		spg_nh(plugin_ns("")),
 		tf_rate(50.0),
 		tf_listen(false)
 	{ }
@@ -295,5 +295,5 @@ private:
 }	// namespace std_plugins
 }	// namespace mavros
 
-#include <pluginlib/class_list_macros.h>
-PLUGINLIB_EXPORT_CLASS(mavros::std_plugins::SetpointPositionPlugin, mavros::plugin::PluginBase)
+#include <mavros/plugin_register.h>
+MAVROS_PLUGIN_REGISTER("setpoint_position", mavros::std_plugins::SetpointPositionPlugin)
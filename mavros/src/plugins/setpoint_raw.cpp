@@ -14,8 +14,15 @@
  * https://github.com/mavlink/mavros/tree/master/LICENSE.md
  */
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
 #include <mavros/mavros_plugin.h>
 #include <mavros/setpoint_mixin.h>
+#include <mavconn/thread_utils.h>
 #include <eigen_conversions/eigen_msg.h>
 
 #include <mavros_msgs/AttitudeTarget.h>
@@ -24,6 +31,105 @@
 
 namespace mavros {
 namespace std_plugins {
+/**
+ * Setpoint stream regularity publisher
+ *
+ * Histograms the achieved inter-setpoint period against the nominal
+ * one, so OFFBOARD failsafe margins can be read off the diagnostics
+ * instead of reconstructed from flight logs.
+ */
+class SetpointStreamStatus : public diagnostic_updater::DiagnosticTask
+{
+public:
+	//! PX4 drops OFFBOARD mode when setpoints stall longer than this
+	static constexpr double FAILSAFE_WINDOW = 0.5;
+
+	SetpointStreamStatus(const std::string &name) :
+		diagnostic_updater::DiagnosticTask(name),
+		nominal_period(0.0)
+	{
+		clear();
+	}
+
+	void set_nominal_rate(double rate)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		nominal_period = (rate > 0.0) ? 1.0 / rate : 0.0;
+	}
+
+	void clear()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		send_count = 0;
+		resend_count = 0;
+		failsafe_violations = 0;
+		max_period = 0.0;
+		hist.fill(0);
+	}
+
+	/**
+	 * @brief Account one sent setpoint
+	 * @param period  time since the previous setpoint went out
+	 * @param resent  true when the keeper re-sent a cached target
+	 */
+	void tick(double period, bool resent)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		send_count++;
+		if (resent)
+			resend_count++;
+
+		max_period = std::max(max_period, period);
+		if (period > FAILSAFE_WINDOW)
+			failsafe_violations++;
+
+		// buckets in multiples of the nominal period
+		size_t idx = hist.size() - 1;
+		for (size_t i = 0; i < BUCKET_EDGES.size(); i++) {
+			if (period <= BUCKET_EDGES[i] * nominal_period) {
+				idx = i;
+				break;
+			}
+		}
+		hist[idx]++;
+	}
+
+	void run(diagnostic_updater::DiagnosticStatusWrapper &stat)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if (failsafe_violations > 0)
+			stat.summaryf(1, "Period exceeded OFFBOARD failsafe window %zu times", failsafe_violations);
+		else if (send_count == 0)
+			stat.summary(1, "No setpoints sent");
+		else
+			stat.summary(0, "Normal");
+
+		stat.addf("Nominal period (ms)", "%.3f", nominal_period * 1e3);
+		stat.addf("Setpoints sent", "%zu", send_count);
+		stat.addf("Keeper re-sends", "%zu", resend_count);
+		stat.addf("Max period (ms)", "%.3f", max_period * 1e3);
+		for (size_t i = 0; i < BUCKET_EDGES.size(); i++)
+			stat.addf(utils::format("Period <= %.2fx nominal", BUCKET_EDGES[i]), "%zu", hist[i]);
+		stat.addf("Period > 4.00x nominal", "%zu", hist.back());
+
+		// window statistics, peak hold resets each report
+		max_period = 0.0;
+	}
+
+private:
+	std::mutex mutex;
+	const std::array<double, 4> BUCKET_EDGES {{1.1, 1.5, 2.0, 4.0}};
+	std::array<size_t, 5> hist;
+	double nominal_period;
+	double max_period;
+	size_t send_count;
+	size_t resend_count;
+	size_t failsafe_violations;
+};
+
 /**
  * @brief Setpoint RAW plugin
  *
@@ -35,22 +141,54 @@ class SetpointRawPlugin : public plugin::PluginBase,
 	private plugin::SetPositionTargetGlobalIntMixin<SetpointRawPlugin>,
 	private plugin::SetAttitudeTargetMixin<SetpointRawPlugin> {
 public:
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
 	SetpointRawPlugin() : PluginBase(),
-		sp_nh("~setpoint_raw")
+		sp_nh(plugin_ns("setpoint_raw")),
+		stream_diag("Setpoint stream"),
+		stream_rate(0.0),
+		stream_rt_priority(0),
+		keeper_should_exit(false),
+		last_kind(Kind::NONE)
 	{ }
 
+	~SetpointRawPlugin()
+	{
+		keeper_should_exit.store(true);
+		if (keeper_thread.joinable())
+			keeper_thread.join();
+	}
+
 	void initialize(UAS &uas_)
 	{
 		PluginBase::initialize(uas_);
 
 		bool tf_listen;
 
+		// setpoints belong to the control path
+		m_uas->set_cb_queue(sp_nh, UAS::CbQueue::REALTIME);
+
+		// Minimum guaranteed setpoint rate (Hz). When upstream stalls,
+		// the stream keeper re-sends the last commanded target at this
+		// rate so PX4 does not trip the OFFBOARD failsafe. 0 disables.
+		sp_nh.param("stream_rate", stream_rate, 0.0);
+
+		// SCHED_FIFO priority for the stream keeper thread, 0 keeps
+		// SCHED_OTHER. Same semantics as conn/rt_priority.
+		sp_nh.param("stream_rt_priority", stream_rt_priority, 0);
+
 		local_sub = sp_nh.subscribe("local", 10, &SetpointRawPlugin::local_cb, this);
 		global_sub = sp_nh.subscribe("global", 10, &SetpointRawPlugin::global_cb, this);
 		attitude_sub = sp_nh.subscribe("attitude", 10, &SetpointRawPlugin::attitude_cb, this);
 		target_local_pub = sp_nh.advertise<mavros_msgs::PositionTarget>("target_local", 10);
 		target_global_pub = sp_nh.advertise<mavros_msgs::GlobalPositionTarget>("target_global", 10);
 		target_attitude_pub = sp_nh.advertise<mavros_msgs::AttitudeTarget>("target_attitude", 10);
+
+		if (stream_rate > 0.0) {
+			stream_diag.set_nominal_rate(stream_rate);
+			UAS_DIAG(m_uas).add(stream_diag);
+			keeper_thread = std::thread(&SetpointRawPlugin::stream_keeper, this);
+		}
 	}
 
 	Subscriptions get_subscriptions()
@@ -71,6 +209,52 @@ private:
 	ros::Subscriber local_sub, global_sub, attitude_sub;
 	ros::Publisher target_local_pub, target_global_pub, target_attitude_pub;
 
+	using steady_clock = std::chrono::steady_clock;
+
+	//! Which target type OFFBOARD is currently fed with
+	enum class Kind {
+		NONE,
+		LOCAL,
+		GLOBAL,
+		ATTITUDE,
+	};
+
+	//! Cached arguments of the last mixin call, already in MAVLink frames
+	struct LastLocal {
+		uint8_t coordinate_frame;
+		uint16_t type_mask;
+		Eigen::Vector3d position, velocity, af;
+		float yaw, yaw_rate;
+	};
+	struct LastGlobal {
+		uint8_t coordinate_frame;
+		uint16_t type_mask;
+		int32_t lat_int, lon_int;
+		float alt;
+		Eigen::Vector3d velocity, af;
+		float yaw, yaw_rate;
+	};
+	struct LastAttitude {
+		uint8_t type_mask;
+		Eigen::Quaterniond orientation;
+		Eigen::Vector3d body_rate;
+		float thrust;
+	};
+
+	SetpointStreamStatus stream_diag;
+	double stream_rate;
+	int stream_rt_priority;
+
+	std::thread keeper_thread;
+	std::atomic<bool> keeper_should_exit;
+
+	std::mutex last_sp_mutex;
+	Kind last_kind;
+	LastLocal last_local;
+	LastGlobal last_global;
+	LastAttitude last_attitude;
+	steady_clock::time_point last_send_time;
+
 	/* -*- message handlers -*- */
 	void handle_position_target_local_ned(const mavlink::mavlink_message_t *msg, mavlink::common::msg::POSITION_TARGET_LOCAL_NED &tgt)
 	{
@@ -180,6 +364,12 @@ private:
 		auto ang_vel_ned = ftf::transform_frame_ned_enu(ang_vel_enu);
 		yaw_rate = ang_vel_ned.z();
 
+		{
+			std::lock_guard<std::mutex> lock(last_sp_mutex);
+			last_local = LastLocal{req->coordinate_frame, req->type_mask, position, velocity, af, yaw, yaw_rate};
+			note_send(Kind::LOCAL, false);
+		}
+
 		set_position_target_local_ned(
 					req->header.stamp.toNSec() / 1000000,
 					req->coordinate_frame,
@@ -209,6 +399,14 @@ private:
 		auto ang_vel_ned = ftf::transform_frame_ned_enu(ang_vel_enu);
 		yaw_rate = ang_vel_ned.z();
 
+		{
+			std::lock_guard<std::mutex> lock(last_sp_mutex);
+			last_global = LastGlobal{req->coordinate_frame, req->type_mask,
+					int32_t(req->latitude * 1e7), int32_t(req->longitude * 1e7), float(req->altitude),
+					velocity, af, yaw, yaw_rate};
+			note_send(Kind::GLOBAL, false);
+		}
+
 		set_position_target_global_int(
 					req->header.stamp.toNSec() / 1000000,
 					req->coordinate_frame,
@@ -257,6 +455,12 @@ private:
 		body_rate = ftf::transform_frame_baselink_aircraft(
 			ftf::to_eigen(req->body_rate));
 
+		{
+			std::lock_guard<std::mutex> lock(last_sp_mutex);
+			last_attitude = LastAttitude{req->type_mask, ned_desired_orientation, body_rate, float(thrust)};
+			note_send(Kind::ATTITUDE, false);
+		}
+
 		set_attitude_target(
 					req->header.stamp.toNSec() / 1000000,
 					req->type_mask,
@@ -265,9 +469,96 @@ private:
 					thrust);
 
 	}
+
+	/* -*- stream keeper -*- */
+
+	//! Account one outgoing target. Caller holds last_sp_mutex.
+	void note_send(Kind kind, bool resent)
+	{
+		auto now = steady_clock::now();
+
+		if (last_kind != Kind::NONE && stream_rate > 0.0)
+			stream_diag.tick(std::chrono::duration<double>(now - last_send_time).count(), resent);
+		last_kind = kind;
+		last_send_time = now;
+	}
+
+	/**
+	 * @brief Deadline loop guaranteeing the minimum setpoint rate.
+	 *
+	 * Wakes on absolute deadlines so the achieved period does not
+	 * accumulate processing time; when the thread falls more than one
+	 * period behind it re-anchors instead of bursting stale targets.
+	 * Re-sends go out over the same REALTIME TX band as the mixins use.
+	 */
+	void stream_keeper()
+	{
+		mavconn::utils::set_this_thread_name("sp-stream");
+		if (stream_rt_priority > 0 && !mavconn::utils::set_this_thread_rt_prio(stream_rt_priority))
+			ROS_WARN_NAMED("setpoint_raw", "SP: SCHED_FIFO prio %d rejected, check RLIMIT_RTPRIO", stream_rt_priority);
+
+		const auto period = std::chrono::duration_cast<steady_clock::duration>(
+				std::chrono::duration<double>(1.0 / stream_rate));
+		auto deadline = steady_clock::now() + period;
+
+		while (ros::ok() && !keeper_should_exit.load()) {
+			std::this_thread::sleep_until(deadline);
+			auto now = steady_clock::now();
+
+			deadline += period;
+			if (now > deadline)
+				deadline = now + period;
+
+			Kind kind;
+			LastLocal l;
+			LastGlobal g;
+			LastAttitude a;
+			{
+				std::lock_guard<std::mutex> lock(last_sp_mutex);
+				if (last_kind == Kind::NONE || now - last_send_time < period)
+					continue;	// upstream is keeping up
+
+				kind = last_kind;
+				switch (kind) {
+				case Kind::LOCAL:	l = last_local;	break;
+				case Kind::GLOBAL:	g = last_global;	break;
+				case Kind::ATTITUDE:	a = last_attitude;	break;
+				default:		break;
+				}
+				note_send(kind, true);
+			}
+
+			// refresh the timestamp, the target itself is unchanged
+			uint32_t time_boot_ms = ros::Time::now().toNSec() / 1000000;
+
+			switch (kind) {
+			case Kind::LOCAL:
+				set_position_target_local_ned(time_boot_ms,
+						l.coordinate_frame, l.type_mask,
+						l.position, l.velocity, l.af,
+						l.yaw, l.yaw_rate);
+				break;
+			case Kind::GLOBAL:
+				set_position_target_global_int(time_boot_ms,
+						g.coordinate_frame, g.type_mask,
+						g.lat_int, g.lon_int, g.alt,
+						g.velocity, g.af,
+						g.yaw, g.yaw_rate);
+				break;
+			case Kind::ATTITUDE:
+				set_attitude_target(time_boot_ms,
+						a.type_mask,
+						a.orientation, a.body_rate,
+						a.thrust);
+				break;
+			default:
+				break;
+			}
+		}
+	}
 };
 }	// namespace std_plugins
 }	// namespace mavros
 
-#include <pluginlib/class_list_macros.h>
-PLUGINLIB_EXPORT_CLASS(mavros::std_plugins::SetpointRawPlugin, mavros::plugin::PluginBase)
+#include <mavros/plugin_register.h>
+MAVROS_PLUGIN_REGISTER("setpoint_raw", mavros::std_plugins::SetpointRawPlugin)
@@ -38,7 +38,8 @@ class SetpointTrajectoryPlugin : public plugin::PluginBase,
 	private plugin::SetPositionTargetLocalNEDMixin<SetpointTrajectoryPlugin> {
 public:
 	SetpointTrajectoryPlugin() : PluginBase(),
-		sp_nh("~setpoint_trajectory")
+		sp_nh(plugin_ns("setpoint_trajectory")),
+		prepared_index(0)
 	{ }
 
 	void initialize(UAS &uas_)
@@ -84,9 +85,24 @@ private:
 	ros::ServiceServer trajectory_reset_srv;
 	ros::ServiceServer mav_frame_srv;
 
-	trajectory_msgs::MultiDOFJointTrajectory::ConstPtr trajectory_target_msg;
-	std::vector<trajectory_msgs::MultiDOFJointTrajectoryPoint>::const_iterator setpoint_target;
-	std::vector<trajectory_msgs::MultiDOFJointTrajectoryPoint>::const_iterator next_setpoint_target;
+	/**
+	 * @brief One trajectory point, already transformed to the MAV frame
+	 *
+	 * The whole horizon is converted in one pass in local_cb(), so the
+	 * timer tick only copies precomputed fields into the setpoint message.
+	 */
+	struct PreparedSetpoint {
+		uint16_t type_mask;
+		Eigen::Vector3d position;
+		Eigen::Vector3d velocity;
+		Eigen::Vector3d af;
+		float yaw;
+		float yaw_rate;
+		ros::Duration time_from_start;
+	};
+
+	std::vector<PreparedSetpoint> prepared;	//!< capacity is kept across replans
+	size_t prepared_index;			//!< next point to send; == size() when idle
 
 	std::string frame_id;
 	MAV_FRAME mav_frame;
@@ -99,6 +115,9 @@ private:
 	}
 
 	void publish_path(const trajectory_msgs::MultiDOFJointTrajectory::ConstPtr &req){
+		if (desired_pub.getNumSubscribers() == 0)
+			return;
+
 		nav_msgs::Path msg;
 
 		msg.header.stamp = ros::Time::now();
@@ -121,93 +140,115 @@ private:
 
 	void local_cb(const trajectory_msgs::MultiDOFJointTrajectory::ConstPtr &req)
 	{
+		using mavlink::common::POSITION_TARGET_TYPEMASK;
 		lock_guard lock(mutex);
 
+		if (req->points.empty())
+			return;
+
 		if(static_cast<MAV_FRAME>(mav_frame) == MAV_FRAME::BODY_NED || static_cast<MAV_FRAME>(mav_frame) == MAV_FRAME::BODY_OFFSET_NED){
 			transform = ftf::StaticTF::BASELINK_TO_AIRCRAFT;
 		} else {
 			transform = ftf::StaticTF::ENU_TO_NED;
 		}
 
-		trajectory_target_msg = req;
+		// build the rotation matrix once: the per-point conversion below
+		// is then plain multiply-adds over the whole horizon
+		Eigen::Matrix3d rot;
+		rot.col(0) = ftf::detail::transform_static_frame(Eigen::Vector3d(Eigen::Vector3d::UnitX()), transform);
+		rot.col(1) = ftf::detail::transform_static_frame(Eigen::Vector3d(Eigen::Vector3d::UnitY()), transform);
+		rot.col(2) = ftf::detail::transform_static_frame(Eigen::Vector3d(Eigen::Vector3d::UnitZ()), transform);
 
-		// Read first duration of the setpoint and set the timer
-		setpoint_target = req->points.cbegin();
-		reset_timer(setpoint_target->time_from_start);
-		publish_path(req);
-	}
+		// clear() keeps the capacity: replans at a given horizon length
+		// do not allocate
+		prepared.clear();
+		prepared.reserve(req->points.size());
 
-	void reference_cb(const ros::TimerEvent &event)
-	{
-		using mavlink::common::POSITION_TARGET_TYPEMASK;
-		lock_guard lock(mutex);
+		for (const auto &p : req->points) {
+			PreparedSetpoint sp;
 
-		if(!trajectory_target_msg)
-			return;
+			sp.type_mask = 0;
+			sp.position.setZero();
+			sp.velocity.setZero();
+			sp.af.setZero();
+			sp.yaw = 0.0;
+			sp.yaw_rate = 0.0;
+			sp.time_from_start = p.time_from_start;
 
-		Eigen::Vector3d position, velocity, af;
-		Eigen::Quaterniond attitude;
-		float yaw, yaw_rate;
-		uint16_t type_mask = 0;		
-		if(!setpoint_target->transforms.empty()){
-			position = ftf::detail::transform_static_frame(ftf::to_eigen(setpoint_target->transforms[0].translation), transform);
-			attitude = ftf::detail::transform_orientation(ftf::to_eigen(setpoint_target->transforms[0].rotation), transform);
+			if(!p.transforms.empty()){
+				sp.position = rot * ftf::to_eigen(p.transforms[0].translation);
+				sp.yaw = ftf::quaternion_get_yaw(
+						ftf::detail::transform_orientation(ftf::to_eigen(p.transforms[0].rotation), transform));
 
-		} else {
-			type_mask = type_mask | uint16_t(POSITION_TARGET_TYPEMASK::X_IGNORE)
-							| uint16_t(POSITION_TARGET_TYPEMASK::Y_IGNORE) 
-							| uint16_t(POSITION_TARGET_TYPEMASK::Z_IGNORE)
-							| uint16_t(POSITION_TARGET_TYPEMASK::YAW_IGNORE);
+			} else {
+				sp.type_mask = sp.type_mask | uint16_t(POSITION_TARGET_TYPEMASK::X_IGNORE)
+								| uint16_t(POSITION_TARGET_TYPEMASK::Y_IGNORE)
+								| uint16_t(POSITION_TARGET_TYPEMASK::Z_IGNORE)
+								| uint16_t(POSITION_TARGET_TYPEMASK::YAW_IGNORE);
 
-		}
+			}
 
-		if(!setpoint_target->velocities.empty()){
-			velocity = ftf::detail::transform_static_frame(ftf::to_eigen(setpoint_target->velocities[0].linear), transform);
-			yaw_rate = setpoint_target->velocities[0].angular.z;
+			if(!p.velocities.empty()){
+				sp.velocity = rot * ftf::to_eigen(p.velocities[0].linear);
+				sp.yaw_rate = p.velocities[0].angular.z;
 
-		} else {
-			type_mask = type_mask | uint16_t(POSITION_TARGET_TYPEMASK::VX_IGNORE)
-							| uint16_t(POSITION_TARGET_TYPEMASK::VY_IGNORE) 
-							| uint16_t(POSITION_TARGET_TYPEMASK::VZ_IGNORE)
-							| uint16_t(POSITION_TARGET_TYPEMASK::YAW_RATE_IGNORE);
+			} else {
+				sp.type_mask = sp.type_mask | uint16_t(POSITION_TARGET_TYPEMASK::VX_IGNORE)
+								| uint16_t(POSITION_TARGET_TYPEMASK::VY_IGNORE)
+								| uint16_t(POSITION_TARGET_TYPEMASK::VZ_IGNORE)
+								| uint16_t(POSITION_TARGET_TYPEMASK::YAW_RATE_IGNORE);
 
-		}
-		
-		if(!setpoint_target->accelerations.empty()){
-			af = ftf::detail::transform_static_frame(ftf::to_eigen(setpoint_target->accelerations[0].linear), transform);
+			}
 
-		} else {
-			type_mask = type_mask | uint16_t(POSITION_TARGET_TYPEMASK::AX_IGNORE) 
-							| uint16_t(POSITION_TARGET_TYPEMASK::AY_IGNORE) 
-							| uint16_t(POSITION_TARGET_TYPEMASK::AZ_IGNORE);
+			if(!p.accelerations.empty()){
+				sp.af = rot * ftf::to_eigen(p.accelerations[0].linear);
 
+			} else {
+				sp.type_mask = sp.type_mask | uint16_t(POSITION_TARGET_TYPEMASK::AX_IGNORE)
+								| uint16_t(POSITION_TARGET_TYPEMASK::AY_IGNORE)
+								| uint16_t(POSITION_TARGET_TYPEMASK::AZ_IGNORE);
+
+			}
+
+			prepared.push_back(sp);
 		}
 
+		// Read first duration of the setpoint and set the timer
+		prepared_index = 0;
+		reset_timer(prepared.front().time_from_start);
+		publish_path(req);
+	}
+
+	void reference_cb(const ros::TimerEvent &event)
+	{
+		lock_guard lock(mutex);
+
+		if (prepared_index >= prepared.size())
+			return;
+
+		const auto &sp = prepared[prepared_index];
+
 		set_position_target_local_ned(
 					ros::Time::now().toNSec() / 1000000,
 					utils::enum_value(mav_frame),
-					type_mask,
-					position,
-					velocity,
-					af,
-					ftf::quaternion_get_yaw(attitude),
-					yaw_rate);
-	
-		next_setpoint_target = setpoint_target + 1;
-		if (next_setpoint_target != trajectory_target_msg->points.cend()) {
-			reset_timer(setpoint_target->time_from_start);
-			setpoint_target = next_setpoint_target;
-		} else {
-			trajectory_target_msg.reset();
-		}
-
-		return;
+					sp.type_mask,
+					sp.position,
+					sp.velocity,
+					sp.af,
+					sp.yaw,
+					sp.yaw_rate);
+
+		prepared_index++;
+		if (prepared_index < prepared.size())
+			reset_timer(sp.time_from_start);
 	}
 
 	bool reset_cb(std_srvs::Trigger::Request &req, std_srvs::Trigger::Response &res)
 	{
-		if(trajectory_target_msg){
-			trajectory_target_msg.reset();
+		lock_guard lock(mutex);
+
+		if (prepared_index < prepared.size()) {
+			prepared_index = prepared.size();
 			res.success = true;
 		} else {
 			res.success = false;
@@ -229,5 +270,5 @@ private:
 }	// namespace std_plugins
 }	// namespace mavros
 
-#include <pluginlib/class_list_macros.h>
-PLUGINLIB_EXPORT_CLASS(mavros::std_plugins::SetpointTrajectoryPlugin, mavros::plugin::PluginBase)
+#include <mavros/plugin_register.h>
+MAVROS_PLUGIN_REGISTER("setpoint_trajectory", mavros::std_plugins::SetpointTrajectoryPlugin)
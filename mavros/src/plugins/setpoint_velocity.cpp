@@ -36,7 +36,7 @@ class SetpointVelocityPlugin : public plugin::PluginBase,
 	private plugin::SetPositionTargetLocalNEDMixin<SetpointVelocityPlugin> {
 public:
 	SetpointVelocityPlugin() : PluginBase(),
-		sp_nh("~setpoint_velocity")
+		sp_nh(plugin_ns("setpoint_velocity"))
 	{ }
 
 	void initialize(UAS &uas_)
@@ -141,5 +141,5 @@ private:
 }	// namespace std_plugins
 }	// namespace mavros
 
-#include <pluginlib/class_list_macros.h>
-PLUGINLIB_EXPORT_CLASS(mavros::std_plugins::SetpointVelocityPlugin, mavros::plugin::PluginBase)
+#include <mavros/plugin_register.h>
+MAVROS_PLUGIN_REGISTER("setpoint_velocity", mavros::std_plugins::SetpointVelocityPlugin)
@@ -14,6 +14,14 @@
  * https://github.com/mavlink/mavros/tree/master/LICENSE.md
  */
 
+#include <pthread.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
 #include <mavros/mavros_plugin.h>
 
 #include <mavros_msgs/State.h>
@@ -152,18 +160,42 @@ class SystemStatusDiag : public diagnostic_updater::DiagnosticTask
 public:
 	SystemStatusDiag(const std::string &name) :
 		diagnostic_updater::DiagnosticTask(name),
-		last_st {}
+		last_st {},
+		dirty(true)
 	{ }
 
 	void set(mavlink::common::msg::SYS_STATUS &st)
 	{
 		std::lock_guard<std::mutex> lock(mutex);
+
+		// only fields shown in run() may invalidate the cache
+		if (st.onboard_control_sensors_present == last_st.onboard_control_sensors_present &&
+				st.onboard_control_sensors_enabled == last_st.onboard_control_sensors_enabled &&
+				st.onboard_control_sensors_health == last_st.onboard_control_sensors_health &&
+				st.load == last_st.load &&
+				st.drop_rate_comm == last_st.drop_rate_comm &&
+				st.errors_comm == last_st.errors_comm &&
+				st.errors_count1 == last_st.errors_count1 &&
+				st.errors_count2 == last_st.errors_count2 &&
+				st.errors_count3 == last_st.errors_count3 &&
+				st.errors_count4 == last_st.errors_count4)
+			return;
+
 		last_st = st;
+		dirty = true;
 	}
 
 	void run(diagnostic_updater::DiagnosticStatusWrapper &stat) {
 		std::lock_guard<std::mutex> lock(mutex);
 
+		// nothing changed since the last refresh: reuse the
+		// formatted key/value strings instead of rebuilding them
+		if (!dirty) {
+			stat.summary(cached.level, cached.message);
+			stat.values = cached.values;
+			return;
+		}
+
 		if ((last_st.onboard_control_sensors_health & last_st.onboard_control_sensors_enabled)
 				!= last_st.onboard_control_sensors_enabled)
 			stat.summary(2, "Sensor health");
@@ -264,11 +296,16 @@ public:
 		stat.addf("Errors count #2", "%d", last_st.errors_count2);
 		stat.addf("Errors count #3", "%d", last_st.errors_count3);
 		stat.addf("Errors count #4", "%d", last_st.errors_count4);
+
+		cached = stat;
+		dirty = false;
 	}
 
 private:
 	std::mutex mutex;
 	mavlink::common::msg::SYS_STATUS last_st;
+	diagnostic_msgs::DiagnosticStatus cached;
+	bool dirty;
 };
 
 
@@ -283,16 +320,19 @@ public:
 		voltage(-1.0),
 		current(0.0),
 		remaining(0.0),
-		min_voltage(6)
+		min_voltage(6),
+		dirty(true)
 	{ }
 
 	void set_min_voltage(float volt) {
 		std::lock_guard<std::mutex> lock(mutex);
+		dirty = dirty || min_voltage != volt;
 		min_voltage = volt;
 	}
 
 	void set(float volt, float curr, float rem) {
 		std::lock_guard<std::mutex> lock(mutex);
+		dirty = dirty || voltage != volt || current != curr || remaining != rem;
 		voltage = volt;
 		current = curr;
 		remaining = rem;
@@ -302,6 +342,12 @@ public:
 	{
 		std::lock_guard<std::mutex> lock(mutex);
 
+		if (!dirty) {
+			stat.summary(cached.level, cached.message);
+			stat.values = cached.values;
+			return;
+		}
+
 		if (voltage < 0)
 			stat.summary(2, "No data");
 		else if (voltage < min_voltage)
@@ -312,6 +358,9 @@ public:
 		stat.addf("Voltage", "%.2f", voltage);
 		stat.addf("Current", "%.1f", current);
 		stat.addf("Remaining", "%.1f", remaining * 100);
+
+		cached = stat;
+		dirty = false;
 	}
 
 private:
@@ -320,6 +369,8 @@ private:
 	float current;
 	float remaining;
 	float min_voltage;
+	diagnostic_msgs::DiagnosticStatus cached;
+	bool dirty;
 };
 
 
@@ -372,12 +423,15 @@ public:
 		diagnostic_updater::DiagnosticTask(name),
 		vcc(-1.0),
 		i2cerr(0),
-		i2cerr_last(0)
+		i2cerr_last(0),
+		dirty(true)
 	{ }
 
 	void set(uint16_t v, uint8_t e) {
 		std::lock_guard<std::mutex> lock(mutex);
-		vcc = v / 1000.0;
+		float vcc_ = v / 1000.0;
+		dirty = dirty || vcc != vcc_ || i2cerr != e;
+		vcc = vcc_;
 		i2cerr = e;
 	}
 
@@ -385,6 +439,13 @@ public:
 	{
 		std::lock_guard<std::mutex> lock(mutex);
 
+		if (!dirty) {
+			stat.summary(cached.level, cached.message);
+			stat.values = cached.values;
+			return;
+		}
+
+		dirty = false;
 		if (vcc < 0)
 			stat.summary(2, "No data");
 		else if (vcc < 4.5)
@@ -392,12 +453,16 @@ public:
 		else if (i2cerr != i2cerr_last) {
 			i2cerr_last = i2cerr;
 			stat.summary(1, "New I2C error");
+			// one-round warning: rebuild as Normal next time
+			dirty = true;
 		}
 		else
 			stat.summary(0, "Normal");
 
 		stat.addf("Core voltage", "%f", vcc);
 		stat.addf("I2C errors", "%zu", i2cerr);
+
+		cached = stat;
 	}
 
 private:
@@ -405,6 +470,8 @@ private:
 	float vcc;
 	size_t i2cerr;
 	size_t i2cerr_last;
+	diagnostic_msgs::DiagnosticStatus cached;
+	bool dirty;
 };
 
 
@@ -417,7 +484,7 @@ class SystemStatusPlugin : public plugin::PluginBase
 {
 public:
 	SystemStatusPlugin() : PluginBase(),
-		nh("~"),
+		nh(plugin_ns("")),
 		hb_diag("Heartbeat", 10),
 		mem_diag("APM Memory"),
 		hwst_diag("APM Hardware"),
@@ -427,9 +494,18 @@ public:
 		disable_diag(false),
 		has_battery_status(false),
 		battery_voltage(0.0),
-		conn_heartbeat_mav_type(MAV_TYPE::ONBOARD_CONTROLLER)
+		conn_heartbeat_mav_type(MAV_TYPE::ONBOARD_CONTROLLER),
+		hb_thread_run(false),
+		stream_retries(0)
 	{ }
 
+	~SystemStatusPlugin()
+	{
+		hb_thread_run = false;
+		if (hb_thread.joinable())
+			hb_thread.join();
+	}
+
 	void initialize(UAS &uas_)
 	{
 		PluginBase::initialize(uas_);
@@ -445,6 +521,16 @@ public:
 		nh.param("sys/min_voltage", min_voltage, 10.0);
 		nh.param("sys/disable_diag", disable_diag, false);
 
+		// Window for collapsing repeated STATUSTEXT into one
+		// message with a repeat counter (APM prearm failures flood
+		// several copies per second). 0 disables the filter.
+		double statustext_dedup_d;
+		nh.param("sys/statustext_dedup_window", statustext_dedup_d, 10.0);
+		statustext_dedup_dt = ros::Duration(statustext_dedup_d);
+
+		for (auto &c : statustext_chunks)
+			c.text.reserve(STATUSTEXT_REASSEMBLY_RESERVE);
+
 		// heartbeat rate parameter
 		if (nh.getParam("conn/heartbeat_rate", conn_heartbeat_d) && conn_heartbeat_d != 0.0) {
 			conn_heartbeat = ros::Duration(ros::Rate(conn_heartbeat_d));
@@ -471,9 +557,15 @@ public:
 		//timeout_timer.start();
 
 		if (!conn_heartbeat.isZero()) {
-			heartbeat_timer = nh.createTimer(conn_heartbeat,
-					&SystemStatusPlugin::heartbeat_cb, this);
-			//heartbeat_timer.start();
+			/**
+			 * Liveness runs on its own steady-clock thread, not the
+			 * shared ROS callback queue: under node load queued
+			 * timers have been observed to gap > 1.5 s, enough to
+			 * trip the FCU GCS-loss failsafe while mavros was alive.
+			 */
+			hb_period = std::chrono::nanoseconds(conn_heartbeat.toNSec());
+			hb_thread_run = true;
+			hb_thread = std::thread(&SystemStatusPlugin::hb_thread_fn, this);
 		}
 
 		// version request timer
@@ -481,6 +573,12 @@ public:
 				&SystemStatusPlugin::autopilot_version_cb, this);
 		autopilot_version_timer.stop();
 
+		// declarative stream rates, see apply_stream_intervals()
+		load_stream_intervals();
+		stream_interval_timer = nh.createTimer(ros::Duration(1.0),
+				&SystemStatusPlugin::stream_interval_cb, this);
+		stream_interval_timer.stop();
+
 		state_pub = nh.advertise<mavros_msgs::State>("state", 10, true);
 		extended_state_pub = nh.advertise<mavros_msgs::ExtendedState>("extended_state", 10);
 		batt_pub = nh.advertise<BatteryMsg>("battery", 10);
@@ -508,6 +606,7 @@ public:
 			make_handler(&SystemStatusPlugin::handle_extended_sys_state),
 			make_handler(&SystemStatusPlugin::handle_battery_status),
 			make_handler(&SystemStatusPlugin::handle_estimator_status),
+			make_handler(&SystemStatusPlugin::handle_message_interval),
 		};
 	}
 
@@ -520,8 +619,13 @@ private:
 	SystemStatusDiag sys_diag;
 	BatteryStatusDiag batt_diag;
 	ros::Timer timeout_timer;
-	ros::Timer heartbeat_timer;
 	ros::Timer autopilot_version_timer;
+	ros::Timer stream_interval_timer;
+
+	//! dedicated heartbeat thread, see hb_thread_fn()
+	std::thread hb_thread;
+	std::atomic<bool> hb_thread_run;
+	std::chrono::nanoseconds hb_period;
 
 	ros::Publisher state_pub;
 	ros::Publisher extended_state_pub;
@@ -541,6 +645,42 @@ private:
 	bool has_battery_status;
 	float battery_voltage;
 
+	//! MAVLink v2 long STATUSTEXT reassembly slot, see statustext_reassemble()
+	struct StatusTextChunks {
+		uint16_t id = 0;	//!< nonzero while the slot is busy
+		uint8_t next_seq = 0;
+		ros::Time last_rx;
+		std::string text;	//!< reserved in initialize()
+	};
+
+	//! repeated STATUSTEXT suppression slot, see statustext_is_repeat()
+	struct StatusTextSeen {
+		uint8_t severity = 0;
+		std::string text;
+		ros::Time last_pub;
+		uint32_t repeats = 0;
+	};
+
+	static constexpr size_t STATUSTEXT_CHUNK_SLOTS = 4;
+	static constexpr size_t STATUSTEXT_REASSEMBLY_RESERVE = 256;
+	static constexpr size_t STATUSTEXT_DEDUP_SLOTS = 8;
+	static constexpr double STATUSTEXT_CHUNK_TIMEOUT = 1.0;
+
+	std::array<StatusTextChunks, STATUSTEXT_CHUNK_SLOTS> statustext_chunks;
+	std::array<StatusTextSeen, STATUSTEXT_DEDUP_SLOTS> statustext_seen;
+	ros::Duration statustext_dedup_dt;
+
+	//! declarative msgid -> rate entry, see apply_stream_intervals()
+	struct StreamInterval {
+		uint32_t message_id;
+		float rate_hz;
+		bool verified;
+	};
+
+	static constexpr int STREAM_RETRIES_COUNT = 5;
+	std::vector<StreamInterval> stream_intervals;
+	int stream_retries;
+
 	using M_VehicleInfo = std::unordered_map<uint16_t, mavros_msgs::VehicleInfo>;
 	M_VehicleInfo vehicles;
 
@@ -616,6 +756,99 @@ private:
 		};
 	}
 
+	/**
+	 * Collect a MAVLink v2 chunked STATUSTEXT (nonzero id).
+	 *
+	 * The link is FIFO, so chunks of one train arrive in order; a
+	 * sequence gap means the remainder was lost and frees the slot.
+	 * The per-slot buffers are preallocated in initialize().
+	 *
+	 * @return true when @a text holds the complete message
+	 */
+	bool statustext_reassemble(uint16_t id, uint8_t seq, bool last_chunk,
+			const ros::Time &stamp, std::string &text)
+	{
+		StatusTextChunks *slot = nullptr;
+		StatusTextChunks *free_slot = nullptr;
+
+		for (auto &c : statustext_chunks) {
+			// a stale train will never complete, reuse its slot
+			if (c.id != 0 && (stamp - c.last_rx).toSec() > STATUSTEXT_CHUNK_TIMEOUT)
+				c.id = 0;
+
+			if (c.id == id)
+				slot = &c;
+			else if (c.id == 0 && free_slot == nullptr)
+				free_slot = &c;
+		}
+
+		if (slot == nullptr) {
+			if (seq != 0 || free_slot == nullptr) {
+				ROS_DEBUG_NAMED("sys", "ST: dropped chunk %u of text id %u", seq, id);
+				return false;
+			}
+
+			slot = free_slot;
+			slot->id = id;
+			slot->next_seq = 0;
+			slot->text.clear();
+		}
+		else if (seq != slot->next_seq) {
+			ROS_DEBUG_NAMED("sys", "ST: chunk gap in text id %u, dropping train", id);
+			slot->id = 0;
+			return false;
+		}
+
+		slot->text += text;
+		slot->next_seq = seq + 1;
+		slot->last_rx = stamp;
+
+		if (!last_chunk)
+			return false;
+
+		text = slot->text;
+		slot->id = 0;
+		return true;
+	}
+
+	/**
+	 * Collapse STATUSTEXT repeats within sys/statustext_dedup_window.
+	 *
+	 * @param[out] repeats  copies suppressed before this publication
+	 * @return true when this copy should be dropped
+	 */
+	bool statustext_is_repeat(uint8_t severity, const std::string &text,
+			const ros::Time &stamp, uint32_t &repeats)
+	{
+		if (statustext_dedup_dt.isZero())
+			return false;
+
+		StatusTextSeen *evict = &statustext_seen[0];
+		for (auto &s : statustext_seen) {
+			if (s.severity == severity && s.text == text && !s.last_pub.isZero()) {
+				if (stamp - s.last_pub < statustext_dedup_dt) {
+					s.repeats++;
+					return true;
+				}
+
+				repeats = s.repeats;
+				s.repeats = 0;
+				s.last_pub = stamp;
+				return false;
+			}
+
+			if (s.last_pub < evict->last_pub)
+				evict = &s;
+		}
+
+		// not seen recently: take the stalest slot
+		evict->severity = severity;
+		evict->text = text;
+		evict->last_pub = stamp;
+		evict->repeats = 0;
+		return false;
+	}
+
 	static std::string custom_version_to_hex_string(std::array<uint8_t, 8> &array)
 	{
 		// should be little-endian
@@ -791,13 +1024,32 @@ private:
 
 	void handle_statustext(const mavlink::mavlink_message_t *msg, mavlink::common::msg::STATUSTEXT &textm)
 	{
+		auto stamp = ros::Time::now();
 		auto text = mavlink::to_string(textm.text);
-		process_statustext_normal(textm.severity, text);
+
+		// nonzero id marks a MAVLink v2 chunk train; the final
+		// chunk is the one that does not fill the text field
+		if (textm.id != 0 &&
+				!statustext_reassemble(textm.id, textm.chunk_seq,
+					text.size() < textm.text.size(), stamp, text))
+			return;
+
+		uint32_t repeats = 0;
+		if (statustext_is_repeat(textm.severity, text, stamp, repeats))
+			return;
+
+		if (repeats > 0) {
+			auto annotated = utils::format("%s (%u duplicates suppressed)", text.c_str(), repeats);
+			process_statustext_normal(textm.severity, annotated);
+		}
+		else
+			process_statustext_normal(textm.severity, text);
 
 		auto st_msg = boost::make_shared<mavros_msgs::StatusText>();
-		st_msg->header.stamp = ros::Time::now();
+		st_msg->header.stamp = stamp;
 		st_msg->severity = textm.severity;
 		st_msg->text = text;
+		st_msg->repeats = repeats;
 		statustext_pub.publish(st_msg);
 	}
 
@@ -956,6 +1208,32 @@ private:
 		estimator_status_pub.publish(est_status_msg);
 	}
 
+	/**
+	 * @brief FCU reply to GET_MESSAGE_INTERVAL, see apply_stream_intervals()
+	 */
+	void handle_message_interval(const mavlink::mavlink_message_t *msg, mavlink::common::msg::MESSAGE_INTERVAL &mi)
+	{
+		if (!m_uas->is_my_target(msg->sysid, msg->compid))
+			return;
+
+		for (auto &si : stream_intervals) {
+			if (si.message_id != mi.message_id || si.verified)
+				continue;
+
+			// disabled streams report interval -1, default rate 0
+			bool want_off = si.rate_hz < 0.0f;
+			bool want_default = si.rate_hz == 0.0f;
+			si.verified = (want_off && mi.interval_us < 0) ||
+				(want_default && mi.interval_us == 0) ||
+				(!want_off && !want_default && mi.interval_us > 0 &&
+					std::abs(1000000.0f / mi.interval_us - si.rate_hz) < 0.5f);
+
+			ROS_WARN_COND_NAMED(!si.verified, "sys",
+					"STREAM: msgid %u reports interval %d us, want %f Hz",
+					si.message_id, mi.interval_us, si.rate_hz);
+		}
+	}
+
 	/* -*- timer callbacks -*- */
 
 	void timeout_cb(const ros::TimerEvent &event)
@@ -963,7 +1241,7 @@ private:
 		m_uas->update_connection_status(false);
 	}
 
-	void heartbeat_cb(const ros::TimerEvent &event)
+	void send_heartbeat()
 	{
 		using mavlink::common::MAV_MODE;
 
@@ -975,7 +1253,148 @@ private:
 		hb.custom_mode = 0;
 		hb.system_status = enum_value(MAV_STATE::ACTIVE);
 
-		UAS_FCU(m_uas)->send_message_ignore_drop(hb);
+		UAS_FCU(m_uas)->send_message_ignore_drop(hb, mavconn::TxPrio::REALTIME);
+	}
+
+	/**
+	 * @brief Heartbeat emission thread.
+	 *
+	 * Steady-clock absolute deadlines, so emission jitter is bounded by
+	 * the scheduler alone and drift never accumulates. Tries to raise
+	 * itself to SCHED_FIFO; without the privilege it still beats every
+	 * ROS timer stuck behind a loaded callback queue.
+	 */
+	void hb_thread_fn()
+	{
+		sched_param sp {};
+		sp.sched_priority = 1;
+		if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp) != 0)
+			ROS_DEBUG_NAMED("sys", "HB: SCHED_FIFO unavailable, using default scheduling");
+
+		auto next = std::chrono::steady_clock::now();
+		while (hb_thread_run) {
+			next += hb_period;
+			std::this_thread::sleep_until(next);
+
+			if (!hb_thread_run)
+				break;
+
+			send_heartbeat();
+		}
+	}
+
+	/**
+	 * @brief Load declarative stream rate table
+	 *
+	 * Parameter ~sys/message_intervals is a map msgid -> rate in Hz
+	 * (rate 0 restores the FCU default, negative disables the stream).
+	 * Replaces boot shell scripts that shape rates with one
+	 * `mavros/cmd/command` call per message after startup.
+	 */
+	void load_stream_intervals()
+	{
+		XmlRpc::XmlRpcValue map_dict;
+
+		if (!nh.getParam("sys/message_intervals", map_dict))
+			return;
+
+		if (map_dict.getType() != XmlRpc::XmlRpcValue::TypeStruct) {
+			ROS_ERROR_NAMED("sys", "STREAM: ~sys/message_intervals must be a map msgid -> rate");
+			return;
+		}
+
+		stream_intervals.reserve(map_dict.size());
+		for (auto &pair : map_dict) {
+			StreamInterval si{};
+
+			try {
+				si.message_id = std::stoi(pair.first);
+			}
+			catch (std::invalid_argument &ex) {
+				ROS_ERROR_STREAM_NAMED("sys", "STREAM: bad message id: " << pair.first);
+				continue;
+			}
+
+			if (pair.second.getType() == XmlRpc::XmlRpcValue::TypeInt)
+				si.rate_hz = static_cast<int>(pair.second);
+			else if (pair.second.getType() == XmlRpc::XmlRpcValue::TypeDouble)
+				si.rate_hz = static_cast<double>(pair.second);
+			else {
+				ROS_ERROR_STREAM_NAMED("sys", "STREAM: bad rate for msgid " << pair.first);
+				continue;
+			}
+
+			stream_intervals.push_back(si);
+		}
+	}
+
+	/**
+	 * @brief Apply not-yet-verified stream rates to the FCU
+	 *
+	 * Commands are pipelined: all SET_MESSAGE_INTERVAL go out
+	 * back-to-back without waiting for an ACK between them, so the
+	 * whole table lands within one link round-trip instead of one
+	 * service call per message. Each SET is followed by a
+	 * GET_MESSAGE_INTERVAL; the FCU answers with MESSAGE_INTERVAL and
+	 * handle_message_interval() ticks the entry off. Entries left
+	 * unverified are re-sent by stream_interval_cb().
+	 */
+	void apply_stream_intervals()
+	{
+		using mavlink::common::MAV_CMD;
+
+		for (auto &si : stream_intervals) {
+			if (si.verified)
+				continue;
+
+			float interval_us;
+			if (si.rate_hz < 0.0f)
+				interval_us = -1.0f;
+			else if (si.rate_hz == 0.0f)
+				interval_us = 0.0f;
+			else
+				interval_us = 1000000.0f / si.rate_hz;
+
+			mavlink::common::msg::COMMAND_LONG cmd {};
+			cmd.target_system = m_uas->get_tgt_system();
+			cmd.target_component = m_uas->get_tgt_component();
+			cmd.command = enum_value(MAV_CMD::SET_MESSAGE_INTERVAL);
+			cmd.param1 = si.message_id;
+			cmd.param2 = interval_us;
+			UAS_FCU(m_uas)->send_message_ignore_drop(cmd);
+
+			cmd.command = enum_value(MAV_CMD::GET_MESSAGE_INTERVAL);
+			cmd.param2 = 0.0f;
+			UAS_FCU(m_uas)->send_message_ignore_drop(cmd);
+
+			ROS_DEBUG_NAMED("sys", "STREAM: request msgid %u at %f Hz",
+					si.message_id, si.rate_hz);
+		}
+	}
+
+	void stream_interval_cb(const ros::TimerEvent &event)
+	{
+		bool done = std::all_of(stream_intervals.begin(), stream_intervals.end(),
+				[](const StreamInterval &si) { return si.verified; });
+
+		if (done) {
+			stream_interval_timer.stop();
+			ROS_INFO_NAMED("sys", "STREAM: all %zu message intervals verified",
+					stream_intervals.size());
+			return;
+		}
+
+		if (stream_retries > 0) {
+			stream_retries--;
+			apply_stream_intervals();
+		}
+		else {
+			stream_interval_timer.stop();
+			for (const auto &si : stream_intervals)
+				ROS_WARN_COND_NAMED(!si.verified, "sys",
+						"STREAM: msgid %u interval not verified, giving up",
+						si.message_id);
+		}
 	}
 
 	void autopilot_version_cb(const ros::TimerEvent &event)
@@ -1033,6 +1452,23 @@ private:
 		else
 			autopilot_version_timer.stop();
 
+		/**
+		 * (Re)apply declarative stream rates. An FCU reboot drops the
+		 * heartbeat long enough to cycle the connection, so this also
+		 * restores the rates after reboot without external scripting.
+		 */
+		if (connected && !stream_intervals.empty()) {
+			for (auto &si : stream_intervals)
+				si.verified = false;
+
+			stream_retries = STREAM_RETRIES_COUNT;
+			apply_stream_intervals();
+			stream_interval_timer.start();
+		}
+		else {
+			stream_interval_timer.stop();
+		}
+
 		// add/remove APM diag tasks
 		if (connected && disable_diag && m_uas->is_ardupilotmega()) {
 			UAS_DIAG(m_uas).add(mem_diag);
@@ -1195,5 +1631,5 @@ private:
 }	// namespace std_plugins
 }	// namespace mavros
 
-#include <pluginlib/class_list_macros.h>
-PLUGINLIB_EXPORT_CLASS(mavros::std_plugins::SystemStatusPlugin, mavros::plugin::PluginBase)
+#include <mavros/plugin_register.h>
+MAVROS_PLUGIN_REGISTER("sys_status", mavros::std_plugins::SystemStatusPlugin)
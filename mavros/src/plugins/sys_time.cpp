@@ -14,6 +14,8 @@
  * https://github.com/mavlink/mavros/tree/master/LICENSE.md
  */
 
+#include <algorithm>
+#include <vector>
 #include <mavros/mavros_plugin.h>
 
 #include <sensor_msgs/TimeReference.h>
@@ -137,13 +139,18 @@ private:
 class SystemTimePlugin : public plugin::PluginBase {
 public:
 	SystemTimePlugin() : PluginBase(),
-		nh("~"),
+		nh(plugin_ns("")),
 		dt_diag("Time Sync", 10),
 		time_offset(0.0),
 		time_skew(0.0),
+		last_remote_ns(0),
 		sequence(0),
 		filter_alpha(0),
 		filter_beta(0),
+		median_window(0),
+		mad_gate(0.0),
+		offset_window_next(0),
+		burst_active(false),
 		high_rtt_count(0),
 		high_deviation_count(0)
 	{ }
@@ -211,6 +218,34 @@ public:
 		nh.param("time/max_consecutive_high_rtt", max_cons_high_rtt, 5);
 		nh.param("time/max_consecutive_high_deviation", max_cons_high_deviation, 5);
 
+		// Median/MAD gate
+		//
+		// Offsets deviating from the median of the last timesync_median_window
+		// accepted samples by more than timesync_mad_gate times the median
+		// absolute deviation are rejected before they reach the filter, so a
+		// single congested-link RTT spike can not pollute the estimate.
+		// Set timesync_median_window below 3 to disable the gate.
+		nh.param("time/timesync_median_window", median_window, 15);
+		nh.param("time/timesync_mad_gate", mad_gate, 5.0);
+		if (median_window >= 3) {
+			offset_window.reserve(median_window);
+			gate_scratch.reserve(median_window);
+		}
+
+		// High-rate burst mode
+		//
+		// Run timesync at timesync_burst_rate for timesync_burst_duration
+		// seconds after start and after a filter reset, then fall back to
+		// conn/timesync_rate. Set either to zero to disable.
+		double burst_rate_d;
+		double burst_duration_d;
+		nh.param("time/timesync_burst_rate", burst_rate_d, 50.0);
+		nh.param("time/timesync_burst_duration", burst_duration_d, 2.0);
+		if (burst_rate_d > 0.0 && burst_duration_d > 0.0) {
+			burst_period = ros::Duration(ros::Rate(burst_rate_d));
+			burst_duration = ros::Duration(burst_duration_d);
+		}
+
 		// Set timesync mode
 		auto ts_mode = utils::timesync_mode_from_str(ts_mode_str);
 		m_uas->set_timesync_mode(ts_mode);
@@ -232,9 +267,11 @@ public:
 			// enable timesync diag only if that feature enabled
 			UAS_DIAG(m_uas).add(dt_diag);
 
+			timesync_period = conn_timesync;
 			timesync_timer = nh.createTimer(conn_timesync,
 						&SystemTimePlugin::timesync_cb, this);
 			timesync_timer.start();
+			start_burst();
 		}
 	}
 
@@ -262,6 +299,10 @@ private:
 	double time_offset;
 	double time_skew;
 
+	// Remote timestamp of the previous accepted sample,
+	// used to scale time_skew to ns-per-ns of remote time
+	uint64_t last_remote_ns;
+
 	// Filter parameters
 	uint32_t sequence;
 	double filter_alpha;
@@ -282,6 +323,21 @@ private:
 	int high_rtt_count;
 	int high_deviation_count;
 
+	// Median/MAD outlier gate: small fixed ring of accepted offsets,
+	// so the per-sample cost is constant
+	int median_window;
+	double mad_gate;
+	std::vector<int64_t> offset_window;
+	std::vector<int64_t> gate_scratch;
+	size_t offset_window_next;
+
+	// High-rate burst mode
+	ros::Duration timesync_period;
+	ros::Duration burst_period;
+	ros::Duration burst_duration;
+	ros::Time burst_end;
+	bool burst_active;
+
 	void handle_system_time(const mavlink::mavlink_message_t *msg, mavlink::common::msg::SYSTEM_TIME &mtime)
 	{
 		// date -d @1234567890: Sat Feb 14 02:31:30 MSK 2009
@@ -333,6 +389,12 @@ private:
 
 	void timesync_cb(const ros::TimerEvent &event)
 	{
+		// fall back to the normal rate once the burst window passed
+		if (burst_active && ros::Time::now() >= burst_end) {
+			timesync_timer.setPeriod(timesync_period);
+			burst_active = false;
+		}
+
 		auto ts_mode = m_uas->get_timesync_mode();
 		if (ts_mode == TSM::MAVLINK) {
 			send_timesync_msg(0, ros::Time::now().toNSec());
@@ -365,7 +427,24 @@ private:
 		uint64_t deviation = llabs(int64_t(time_offset) - offset_ns);
 
 		if (rtt_ns < max_rtt_sample * 1000000ULL) {	// Only use samples with low RTT
-			if (sync_converged() && (deviation > max_deviation_sample * 1000000ULL)) {
+			if (!offset_within_mad_gate(offset_ns)) {
+				// Outlier WRT the sliding-window median: keep it away from
+				// the filter. Consecutive rejections mean the remote clock
+				// really jumped, so share the reset path below.
+				high_deviation_count++;
+
+				if (high_deviation_count > max_cons_high_deviation) {
+					ROS_ERROR_NAMED("time", "TM : Time jump detected. Resetting time synchroniser.");
+
+					// Reset the filter
+					reset_filter();
+
+					// Reset diagnostics
+					dt_diag.clear();
+					dt_diag.set_timestamp(remote_time_ns);
+				}
+			}
+			else if (sync_converged() && (deviation > max_deviation_sample * 1000000ULL)) {
 				// Increment the counter if we have a good estimate and are getting samples far from the estimate
 				high_deviation_count++;
 
@@ -397,8 +476,18 @@ private:
 				// Perform filter update
 				add_sample(offset_ns);
 
-				// Save time offset for other components to use
-				m_uas->set_time_offset(sync_converged() ? time_offset : 0);
+				// time_skew is estimated per filter update: scale it to
+				// ns-per-ns of remote time for drift extrapolation
+				double skew_per_ns = 0.0;
+				if (last_remote_ns > 0 && remote_time_ns > last_remote_ns)
+					skew_per_ns = time_skew / double(remote_time_ns - last_remote_ns);
+				last_remote_ns = remote_time_ns;
+
+				// Save (offset, skew, reference) tuple for other components to use
+				if (sync_converged())
+					m_uas->set_timesync_state(time_offset, skew_per_ns, remote_time_ns);
+				else
+					m_uas->set_time_offset(0);
 
 				// Increment sequence counter after filter update
 				sequence++;
@@ -437,6 +526,59 @@ private:
 		dt_diag.tick(rtt_ns, remote_time_ns, time_offset);
 	}
 
+	/**
+	 * Median/MAD outlier gate.
+	 *
+	 * Accepted samples enter a small fixed-size ring; a new sample passes if
+	 * it lies within mad_gate median-absolute-deviations of the ring median.
+	 * The window is bounded, so each update costs a constant amount of work.
+	 *
+	 * @return true if the sample may be used for the filter update
+	 */
+	bool offset_within_mad_gate(int64_t offset_ns)
+	{
+		if (median_window < 3)
+			return true;	// gate disabled
+
+		if (offset_window.size() > size_t(median_window) / 2) {
+			gate_scratch = offset_window;
+			auto mid = gate_scratch.begin() + gate_scratch.size() / 2;
+
+			std::nth_element(gate_scratch.begin(), mid, gate_scratch.end());
+			const int64_t median = *mid;
+
+			for (auto &v : gate_scratch)
+				v = llabs(v - median);
+			std::nth_element(gate_scratch.begin(), mid, gate_scratch.end());
+			const int64_t mad = *mid;
+
+			// 1 ms floor keeps the gate usable on a very clean link
+			const int64_t gate = std::max<int64_t>(mad_gate * mad, 1000000);
+			if (llabs(offset_ns - median) > gate)
+				return false;	// outliers never enter the window
+		}
+
+		if (offset_window.size() < size_t(median_window)) {
+			offset_window.push_back(offset_ns);
+		} else {
+			offset_window[offset_window_next] = offset_ns;
+			offset_window_next = (offset_window_next + 1) % median_window;
+		}
+
+		return true;
+	}
+
+	//! Switch timesync to the high-rate burst period for burst_duration
+	void start_burst()
+	{
+		if (burst_period.isZero() || !timesync_timer.isValid())
+			return;
+
+		timesync_timer.setPeriod(burst_period);
+		burst_end = ros::Time::now() + burst_duration;
+		burst_active = true;
+	}
+
 	void add_sample(int64_t offset_ns)
 	{
 		/* Online exponential smoothing filter. The derivative of the estimate is also
@@ -463,10 +605,16 @@ private:
 		sequence = 0;
 		time_offset = 0.0;
 		time_skew = 0.0;
+		last_remote_ns = 0;
 		filter_alpha = filter_alpha_initial;
 		filter_beta = filter_beta_initial;
 		high_deviation_count = 0;
 		high_rtt_count = 0;
+		offset_window.clear();
+		offset_window_next = 0;
+
+		// reconverge quickly after a reset
+		start_burst();
 	}
 
 	inline bool sync_converged()
@@ -485,5 +633,5 @@ private:
 }	// namespace std_plugins
 }	// namespace mavros
 
-#include <pluginlib/class_list_macros.h>
-PLUGINLIB_EXPORT_CLASS(mavros::std_plugins::SystemTimePlugin, mavros::plugin::PluginBase)
+#include <mavros/plugin_register.h>
+MAVROS_PLUGIN_REGISTER("sys_time", mavros::std_plugins::SystemTimePlugin)
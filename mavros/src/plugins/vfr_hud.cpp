@@ -27,7 +27,7 @@ namespace std_plugins {
 class VfrHudPlugin : public plugin::PluginBase {
 public:
 	VfrHudPlugin() : PluginBase(),
-		nh("~")
+		nh(plugin_ns(""))
 	{ }
 
 	/**
@@ -69,5 +69,5 @@ private:
 }	// namespace std_plugins
 }	// namespace mavros
 
-#include <pluginlib/class_list_macros.h>
-PLUGINLIB_EXPORT_CLASS(mavros::std_plugins::VfrHudPlugin, mavros::plugin::PluginBase)
+#include <mavros/plugin_register.h>
+MAVROS_PLUGIN_REGISTER("vfr_hud", mavros::std_plugins::VfrHudPlugin)
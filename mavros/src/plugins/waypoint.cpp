@@ -14,13 +14,19 @@
  * https://github.com/mavlink/mavros/tree/master/LICENSE.md
  */
 
-#include <chrono>
+#include <cstdio>
+#include <fstream>
 #include <sstream>
 #include <iomanip>
 #include <string>
 
-#include <condition_variable>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <mavros/mavros_plugin.h>
+#include <mavros/transaction.h>
 
 #include <mavros_msgs/WaypointList.h>
 #include <mavros_msgs/WaypointSetCurrent.h>
@@ -214,23 +220,43 @@ std::string waypoint_to_string(const ITEM &wp){
 	return ss.str();
 }
 
+/**
+ * @brief Compare waypoints field by field
+ *
+ * is_current is ignored: it advances with mission progress and would
+ * make every table look changed. Use SetCurrent service to move it.
+ */
+bool waypoint_equal(const mavros_msgs::Waypoint &a, const mavros_msgs::Waypoint &b)
+{
+	return a.frame == b.frame &&
+	       a.command == b.command &&
+	       a.autocontinue == b.autocontinue &&
+	       a.param1 == b.param1 &&
+	       a.param2 == b.param2 &&
+	       a.param3 == b.param3 &&
+	       a.param4 == b.param4 &&
+	       a.x_lat == b.x_lat &&
+	       a.y_long == b.y_long &&
+	       a.z_alt == b.z_alt;
+}
+
 /**
  * @brief Mission manupulation plugin
  */
 class WaypointPlugin : public plugin::PluginBase {
 public:
 	WaypointPlugin() : PluginBase(),
-		wp_nh("~mission"),
+		wp_nh(plugin_ns("mission")),
+		wp_timer_nh(plugin_ns("mission")),
 		wp_state(WP::IDLE),
 		wp_count(0),
-		wp_retries(RETRIES_COUNT),
 		wp_cur_id(0),
 		wp_cur_active(0),
 		wp_set_active(0),
-		is_timedout(false),
 		do_pull_after_gcs(false),
 		enable_partial_push(false),
 		reschedule_pull(false),
+		mirror_valid(false),
 		BOOTUP_TIME_DT(BOOTUP_TIME_MS / 1000.0),
 		LIST_TIMEOUT_DT(LIST_TIMEOUT_MS / 1000.0),
 		WP_TIMEOUT_DT(WP_TIMEOUT_MS / 1000.0),
@@ -241,10 +267,15 @@ public:
 	{
 		PluginBase::initialize(uas_);
 
+		// mission push/pull are long transfers, keep them off the control path
+		m_uas->set_cb_queue(wp_nh, UAS::CbQueue::BULK);
+
 		wp_state = WP::IDLE;
 
 		wp_nh.param("pull_after_gcs", do_pull_after_gcs, true);
 		wp_nh.param("use_mission_item_int", use_mission_item_int, false);
+		// binary mission snapshot for restart recovery, empty disables
+		wp_nh.param<std::string>("snapshot_file", snapshot_file, "");
 
 		wp_list_pub = wp_nh.advertise<mavros_msgs::WaypointList>("waypoints", 2, true);
 		wp_reached_pub = wp_nh.advertise<mavros_msgs::WaypointReached>("reached", 10, true);
@@ -253,12 +284,20 @@ public:
 		clear_srv = wp_nh.advertiseService("clear", &WaypointPlugin::clear_cb, this);
 		set_cur_srv = wp_nh.advertiseService("set_current", &WaypointPlugin::set_cur_cb, this);
 
-		wp_timer = wp_nh.createTimer(WP_TIMEOUT_DT, &WaypointPlugin::timeout_cb, this, true);
-		wp_timer.stop();
+		// retransmits must not share the BULK queue: its thread is
+		// blocked inside the service call during pull/push
+		wp_retry.init(wp_timer_nh, WP_TIMEOUT_DT, RETRIES_COUNT,
+				std::bind(&WaypointPlugin::retry_resend, this),
+				std::bind(&WaypointPlugin::retry_give_up, this));
 		schedule_timer = wp_nh.createTimer(BOOTUP_TIME_DT, &WaypointPlugin::scheduled_pull_cb, this, true);
 		schedule_timer.stop();
 		enable_connection_cb();
 		enable_capabilities_cb();
+
+		if (load_mission_snapshot()) {
+			ROS_INFO_NAMED("wp", "WP: restored %zu mission items from snapshot", waypoints.size());
+			publish_waypoints();
+		}
 	}
 
 	Subscriptions get_subscriptions() {
@@ -280,6 +319,7 @@ private:
 
 	std::recursive_mutex mutex;
 	ros::NodeHandle wp_nh;
+	ros::NodeHandle wp_timer_nh;	//!< stays on the normal cb queue, see initialize()
 
 	ros::Publisher wp_list_pub;
 	ros::Publisher wp_reached_pub;
@@ -311,23 +351,25 @@ private:
 	size_t wp_cur_id;
 	size_t wp_cur_active;
 	size_t wp_set_active;
-	size_t wp_retries;
-	bool is_timedout;
-	std::mutex recv_cond_mutex;
-	std::mutex send_cond_mutex;
-	std::condition_variable list_receiving;
-	std::condition_variable list_sending;
-
-	ros::Timer wp_timer;
+	TransactionWaiter recv_waiter;
+	TransactionWaiter send_waiter;
+
+	RetryTimer wp_retry;
 	ros::Timer schedule_timer;
 	bool do_pull_after_gcs;
 	bool enable_partial_push;
 
 	bool reschedule_pull;
 
+	//! waypoints exactly mirrors the FCU mission:
+	//! no foreign mission transfer seen since the last sync
+	bool mirror_valid;
+
 	bool use_mission_item_int;
 	bool mission_item_int_support_confirmed;
 
+	std::string snapshot_file;	//!< path of the binary mission snapshot
+
 	static constexpr int BOOTUP_TIME_MS = 15000;	//! system startup delay before start pull
 	static constexpr int LIST_TIMEOUT_MS = 30000;	//! Timeout for pull/push operations
 	static constexpr int WP_TIMEOUT_MS = 1000;
@@ -529,7 +571,7 @@ private:
 			set_current_waypoint(wp_cur_active);
 
 			lock.unlock();
-			list_sending.notify_all();
+			send_waiter.complete(true);
 			publish_waypoints();
 		}
 		else if (wp_state == WP::IDLE && wp_cur_active != mcur.seq) {
@@ -561,6 +603,16 @@ private:
 			wp_count = mcnt.count;
 			wp_cur_id = 0;
 
+			if (mirror_valid && wp_count == waypoints.size() && wp_count > 0) {
+				// count unchanged and no foreign transfer seen
+				// since last sync: skip the item fetch
+				ROS_INFO_NAMED("wp", "WP: mission unchanged, skipping %zu item fetch", wp_count);
+				request_mission_done();
+				lock.unlock();
+				publish_waypoints();
+				return;
+			}
+
 			waypoints.clear();
 			waypoints.reserve(wp_count);
 
@@ -583,6 +635,7 @@ private:
 		}
 		else {
 			ROS_INFO_NAMED("wp", "WP: seems GCS requesting mission");
+			mirror_valid = false;
 			/* schedule pull after GCS done */
 			if (do_pull_after_gcs) {
 				ROS_INFO_NAMED("wp", "WP: scheduling pull after GCS is done");
@@ -628,9 +681,10 @@ private:
 			go_idle();
 			waypoints = send_waypoints;
 			send_waypoints.clear();
+			mirror_valid = true;
 			if (wp_state == WP::TXWPINT) mission_item_int_support_confirmed = true;
 			lock.unlock();
-			list_sending.notify_all();
+			send_waiter.complete(true);
 			publish_waypoints();
 			ROS_INFO_NAMED("wp", "WP: mission sended");
 		}
@@ -642,105 +696,105 @@ private:
 		}
 		else if (wp_state == WP::TXLIST || wp_state == WP::TXPARTIAL || wp_state == WP::TXWP || wp_state == WP::TXWPINT) {
 			go_idle();
-			/* use this flag for failure report */
-			is_timedout = true;
 			lock.unlock();
-			list_sending.notify_all();
+			send_waiter.complete(false);
 
 			ROS_ERROR_STREAM_NAMED("wp", "WP: upload failed: " << utils::to_string(ack_type));
 		}
 		else if (wp_state == WP::CLEAR) {
 			go_idle();
 			if (ack_type != MRES::ACCEPTED) {
-				is_timedout = true;
 				lock.unlock();
 				ROS_ERROR_STREAM_NAMED("wp", "WP: clear failed: " << utils::to_string(ack_type));
 			}
 			else {
 				waypoints.clear();
+				mirror_valid = true;
 				lock.unlock();
 				publish_waypoints();
 				ROS_INFO_NAMED("wp", "WP: mission cleared");
 			}
 
-			list_sending.notify_all();
+			send_waiter.complete(ack_type == MRES::ACCEPTED);
 		}
-		else
+		else {
 			ROS_DEBUG_NAMED("wp", "WP: not planned ACK, type: %d", mack.type);
+			// likely end of a GCS-side transfer
+			mirror_valid = false;
+		}
 	}
 
 	/* -*- mid-level helpers -*- */
 
 	/**
-	 * @brief Act on a timeout
+	 * @brief Act on a timeout (wp_retry resend callback)
 	 * Resend the message that may have been lost
 	 */
-	void timeout_cb(const ros::TimerEvent &event)
+	void retry_resend()
 	{
-		unique_lock lock(mutex);
-		if (wp_retries > 0) {
-			wp_retries--;
-			ROS_WARN_NAMED("wp", "WP: timeout, retries left %zu", wp_retries);
-
-			switch (wp_state) {
-			case WP::RXLIST:
-				mission_request_list();
-				break;
-			case WP::RXWP:
-				mission_request(wp_cur_id);
-				break;
-			case WP::RXWPINT:
-				mission_request(wp_cur_id);
-				break;
-			case WP::TXLIST:
-				mission_count(wp_count);
-				break;
-			case WP::TXPARTIAL:
-				mission_write_partial_list(wp_start_id, wp_end_id);
-				break;
-			case WP::TXWP:
-				send_waypoint<WP_ITEM>(wp_cur_id);
-				break;
-			case WP::TXWPINT:
-				send_waypoint<WP_ITEM_INT>(wp_cur_id);
-				break;
-			case WP::CLEAR:
-				mission_clear_all();
-				break;
-			case WP::SET_CUR:
-				mission_set_current(wp_set_active);
-				break;
-
-			case WP::IDLE:
-				break;
-			}
+		lock_guard lock(mutex);
 
-			restart_timeout_timer_int();
+		ROS_WARN_NAMED("wp", "WP: timeout, retries left %d", wp_retry.retries_remaining());
+
+		switch (wp_state) {
+		case WP::RXLIST:
+			mission_request_list();
+			break;
+		case WP::RXWP:
+			mission_request(wp_cur_id);
+			break;
+		case WP::RXWPINT:
+			mission_request(wp_cur_id);
+			break;
+		case WP::TXLIST:
+			mission_count(wp_count);
+			break;
+		case WP::TXPARTIAL:
+			mission_write_partial_list(wp_start_id, wp_end_id);
+			break;
+		case WP::TXWP:
+			send_waypoint<WP_ITEM>(wp_cur_id);
+			break;
+		case WP::TXWPINT:
+			send_waypoint<WP_ITEM_INT>(wp_cur_id);
+			break;
+		case WP::CLEAR:
+			mission_clear_all();
+			break;
+		case WP::SET_CUR:
+			mission_set_current(wp_set_active);
+			break;
+
+		case WP::IDLE:
+			break;
 		}
-		else {
-			if (wp_state == WP::TXWPINT && use_mission_item_int && !mission_item_int_support_confirmed) {
-				ROS_ERROR_NAMED("wp", "WP: mission_item_int timed out, falling back to mission_item.");
-				use_mission_item_int = false;
+	}
 
-				wp_state = WP::TXWP;
-				restart_timeout_timer();
-				send_waypoint<WP_ITEM>(wp_cur_id);
-			} else if (wp_state == WP::RXWPINT && use_mission_item_int && !mission_item_int_support_confirmed) {
-				ROS_ERROR_NAMED("wp", "WP: mission_item_int timed out, falling back to mission_item.");
-				//use_mission_item_int = false;
+	//! @brief Retries exhausted (wp_retry give-up callback)
+	void retry_give_up()
+	{
+		unique_lock lock(mutex);
 
-				wp_state = WP::RXWP;
-				restart_timeout_timer();
-				mission_request(wp_cur_id);
-			} else {
-				ROS_ERROR_NAMED("wp", "WP: timed out.");
-				go_idle();
-				is_timedout = true;
-				/* prevent waiting cond var timeout */
-				lock.unlock();
-				list_receiving.notify_all();
-				list_sending.notify_all();
-			}
+		if (wp_state == WP::TXWPINT && use_mission_item_int && !mission_item_int_support_confirmed) {
+			ROS_ERROR_NAMED("wp", "WP: mission_item_int timed out, falling back to mission_item.");
+			use_mission_item_int = false;
+
+			wp_state = WP::TXWP;
+			wp_retry.arm();
+			send_waypoint<WP_ITEM>(wp_cur_id);
+		} else if (wp_state == WP::RXWPINT && use_mission_item_int && !mission_item_int_support_confirmed) {
+			ROS_ERROR_NAMED("wp", "WP: mission_item_int timed out, falling back to mission_item.");
+			//use_mission_item_int = false;
+
+			wp_state = WP::RXWP;
+			wp_retry.arm();
+			mission_request(wp_cur_id);
+		} else {
+			ROS_ERROR_NAMED("wp", "WP: timed out.");
+			go_idle();
+			lock.unlock();
+			recv_waiter.complete(false);
+			send_waiter.complete(false);
 		}
 	}
 
@@ -749,6 +803,7 @@ private:
 	{
 		lock_guard lock(mutex);
 		if (connected) {
+			mirror_valid = false;
 			schedule_pull(BOOTUP_TIME_DT);
 
 			if (wp_nh.hasParam("enable_partial_push")) {
@@ -801,8 +856,9 @@ private:
 		/* possibly not needed if count == 0 (QGC impl) */
 		mission_ack(MRES::ACCEPTED);
 
+		mirror_valid = true;
 		go_idle();
-		list_receiving.notify_all();
+		recv_waiter.complete(true);
 		ROS_INFO_NAMED("wp", "WP: mission received");
 	}
 
@@ -810,20 +866,12 @@ private:
 	{
 		reschedule_pull = false;
 		wp_state = WP::IDLE;
-		wp_timer.stop();
+		wp_retry.disarm();
 	}
 
 	void restart_timeout_timer(void)
 	{
-		wp_retries = RETRIES_COUNT;
-		restart_timeout_timer_int();
-	}
-
-	void restart_timeout_timer_int(void)
-	{
-		is_timedout = false;
-		wp_timer.stop();
-		wp_timer.start();
+		wp_retry.arm();
 	}
 
 	void schedule_pull(const ros::Duration &dt)
@@ -850,10 +898,7 @@ private:
 	 */
 	bool wait_fetch_all()
 	{
-		std::unique_lock<std::mutex> lock(recv_cond_mutex);
-		return list_receiving.wait_for(lock, std::chrono::nanoseconds(LIST_TIMEOUT_DT.toNSec()))
-		       == std::cv_status::no_timeout
-		       && !is_timedout;
+		return recv_waiter.wait_for(LIST_TIMEOUT_DT);
 	}
 
 	/**
@@ -862,11 +907,7 @@ private:
 	 */
 	bool wait_push_all()
 	{
-		std::unique_lock<std::mutex> lock(send_cond_mutex);
-
-		return list_sending.wait_for(lock, std::chrono::nanoseconds(LIST_TIMEOUT_DT.toNSec()))
-		       == std::cv_status::no_timeout
-		       && !is_timedout;
+		return send_waiter.wait_for(LIST_TIMEOUT_DT);
 	}
 
 	//! @brief set the FCU current waypoint
@@ -886,14 +927,149 @@ private:
 		unique_lock lock(mutex);
 
 		wpl->current_seq = wp_cur_active;
-		wpl->waypoints.clear();
-		wpl->waypoints.reserve(waypoints.size());
-		for (auto &it : waypoints) {
-			wpl->waypoints.push_back(it);
-		}
+		// Waypoint has only scalar fields: one contiguous copy
+		wpl->waypoints.assign(waypoints.begin(), waypoints.end());
 
 		lock.unlock();
 		wp_list_pub.publish(wpl);
+		save_mission_snapshot(*wpl);
+	}
+
+	/* -*- mission snapshot -*- */
+
+	//! fixed-layout snapshot record, the table is mmap-loadable
+	struct SnapshotRecord {
+		uint8_t frame;
+		uint8_t is_current;
+		uint8_t autocontinue;
+		uint8_t _pad;
+		uint16_t command;
+		uint16_t _pad2;
+		float param1, param2, param3, param4;
+		double x_lat, y_long, z_alt;
+	};
+
+	struct SnapshotHeader {
+		uint32_t magic;
+		uint16_t version;
+		uint16_t current_seq;
+		uint32_t count;
+		uint32_t reserved;
+	};
+
+	static constexpr uint32_t SNAPSHOT_MAGIC = 0x534d564d;	// "MVMS"
+	static constexpr uint16_t SNAPSHOT_VERSION = 1;
+
+	/**
+	 * @brief Store the mission mirror; called whenever it changes
+	 *
+	 * Same .tmp + rename scheme as the parameter cache, so a crash
+	 * mid-write never corrupts the last good snapshot.
+	 */
+	void save_mission_snapshot(const mavros_msgs::WaypointList &wpl)
+	{
+		if (snapshot_file.empty())
+			return;
+
+		auto tmp_path = snapshot_file + ".tmp";
+		std::ofstream f(tmp_path, std::ios::binary | std::ios::trunc);
+		if (!f) {
+			ROS_WARN_NAMED("wp", "WP: can not write mission snapshot: %s", tmp_path.c_str());
+			return;
+		}
+
+		SnapshotHeader hdr{};
+		hdr.magic = SNAPSHOT_MAGIC;
+		hdr.version = SNAPSHOT_VERSION;
+		hdr.current_seq = wpl.current_seq;
+		hdr.count = wpl.waypoints.size();
+		f.write(reinterpret_cast<const char *>(&hdr), sizeof(hdr));
+
+		for (auto &wp : wpl.waypoints) {
+			SnapshotRecord rec{};
+
+			rec.frame = wp.frame;
+			rec.is_current = wp.is_current;
+			rec.autocontinue = wp.autocontinue;
+			rec.command = wp.command;
+			rec.param1 = wp.param1;
+			rec.param2 = wp.param2;
+			rec.param3 = wp.param3;
+			rec.param4 = wp.param4;
+			rec.x_lat = wp.x_lat;
+			rec.y_long = wp.y_long;
+			rec.z_alt = wp.z_alt;
+			f.write(reinterpret_cast<const char *>(&rec), sizeof(rec));
+		}
+
+		f.close();
+		if (!f || std::rename(tmp_path.c_str(), snapshot_file.c_str()) != 0)
+			ROS_WARN_NAMED("wp", "WP: mission snapshot write failed: %s", snapshot_file.c_str());
+	}
+
+	/**
+	 * @brief Restore the last mission mirror after node restart
+	 *
+	 * The snapshot is mmap()ed read-only and the fixed-layout records
+	 * copied straight into the table. mirror_valid stays false, so the
+	 * first scheduled pull still reconciles with the FCU.
+	 */
+	bool load_mission_snapshot()
+	{
+		if (snapshot_file.empty())
+			return false;
+
+		int fd = ::open(snapshot_file.c_str(), O_RDONLY);
+		if (fd < 0)
+			return false;
+
+		struct stat st;
+		if (::fstat(fd, &st) < 0 || size_t(st.st_size) < sizeof(SnapshotHeader)) {
+			::close(fd);
+			return false;
+		}
+
+		size_t map_size = st.st_size;
+		auto map = static_cast<const uint8_t *>(::mmap(nullptr, map_size, PROT_READ, MAP_PRIVATE, fd, 0));
+		::close(fd);	// mapping holds its own reference
+		if (map == MAP_FAILED)
+			return false;
+
+		auto hdr = reinterpret_cast<const SnapshotHeader *>(map);
+		bool ok = hdr->magic == SNAPSHOT_MAGIC && hdr->version == SNAPSHOT_VERSION &&
+			map_size >= sizeof(SnapshotHeader) + hdr->count * sizeof(SnapshotRecord);
+
+		if (ok) {
+			auto recs = reinterpret_cast<const SnapshotRecord *>(map + sizeof(SnapshotHeader));
+			lock_guard lock(mutex);
+
+			waypoints.clear();
+			waypoints.reserve(hdr->count);
+			for (uint32_t i = 0; i < hdr->count; i++) {
+				const auto &rec = recs[i];
+				mavros_msgs::Waypoint wp;
+
+				wp.frame = rec.frame;
+				wp.is_current = rec.is_current;
+				wp.autocontinue = rec.autocontinue;
+				wp.command = rec.command;
+				wp.param1 = rec.param1;
+				wp.param2 = rec.param2;
+				wp.param3 = rec.param3;
+				wp.param4 = rec.param4;
+				wp.x_lat = rec.x_lat;
+				wp.y_long = rec.y_long;
+				wp.z_alt = rec.z_alt;
+				waypoints.push_back(wp);
+			}
+
+			wp_cur_active = hdr->current_seq;
+		}
+		else
+			ROS_WARN_NAMED("wp", "WP: mission snapshot mismatch, ignored: %s", snapshot_file.c_str());
+
+		::munmap(const_cast<uint8_t *>(map), map_size);
+		return ok;
 	}
 
 	/* -*- low-level send functions -*- */
@@ -1003,6 +1179,9 @@ private:
 			// Wrong initial state, other operation in progress?
 			return false;
 
+		// drop completion left by a timed-out op
+		recv_waiter.reset();
+
 		wp_state = WP::RXLIST;
 		wp_count = 0;
 		restart_timeout_timer();
@@ -1026,6 +1205,8 @@ private:
 			// Wrong initial state, other operation in progress?
 			return false;
 
+		send_waiter.reset();
+
 		if (req.start_index) {
 			// Partial Waypoint update
 
@@ -1065,6 +1246,55 @@ private:
 
 			res.wp_transfered = wp_cur_id - wp_start_id + 1;
 		}
+		else if (enable_partial_push && mirror_valid &&
+				!waypoints.empty() && req.waypoints.size() == waypoints.size()) {
+			// Same count and trusted mirror: sync only the changed
+			// index range instead of re-transfering the whole table
+			const size_t sz = waypoints.size();
+
+			size_t first = sz;
+			for (size_t i = 0; i < sz; i++) {
+				if (!waypoint_equal(req.waypoints[i], waypoints[i])) {
+					first = i;
+					break;
+				}
+			}
+
+			if (first == sz) {
+				ROS_INFO_NAMED("wp", "WP: push matches mirror, nothing to send");
+				res.success = true;
+				res.wp_transfered = 0;
+				go_idle();
+				return true;
+			}
+
+			size_t last = first;
+			for (size_t i = sz; i-- > first; ) {
+				if (!waypoint_equal(req.waypoints[i], waypoints[i])) {
+					last = i;
+					break;
+				}
+			}
+
+			ROS_INFO_NAMED("wp", "WP: delta push #%zu..#%zu (%zu of %zu items)",
+					first, last, last - first + 1, sz);
+
+			wp_state = WP::TXPARTIAL;
+			send_waypoints = req.waypoints;
+
+			wp_count = last - first + 1;
+			wp_start_id = first;
+			wp_end_id = last + 1;
+			wp_cur_id = first;
+			restart_timeout_timer();
+
+			lock.unlock();
+			mission_write_partial_list(wp_start_id, wp_end_id);
+			res.success = wait_push_all();
+			lock.lock();
+
+			res.wp_transfered = wp_cur_id - wp_start_id + 1;
+		}
 		else {
 			// Full waypoint update
 			wp_state = WP::TXLIST;
@@ -1098,6 +1328,8 @@ private:
 		if (wp_state != WP::IDLE)
 			return false;
 
+		send_waiter.reset();
+
 		wp_state = WP::CLEAR;
 		restart_timeout_timer();
 
@@ -1118,6 +1350,8 @@ private:
 		if (wp_state != WP::IDLE)
 			return false;
 
+		send_waiter.reset();
+
 		wp_state = WP::SET_CUR;
 		wp_set_active = req.wp_seq;
 		restart_timeout_timer();
@@ -1134,5 +1368,5 @@ private:
 }	// namespace std_plugins
 }	// namespace mavros
 
-#include <pluginlib/class_list_macros.h>
-PLUGINLIB_EXPORT_CLASS(mavros::std_plugins::WaypointPlugin, mavros::plugin::PluginBase)
+#include <mavros/plugin_register.h>
+MAVROS_PLUGIN_REGISTER("waypoint", mavros::std_plugins::WaypointPlugin)
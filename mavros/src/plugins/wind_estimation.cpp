@@ -29,7 +29,7 @@ namespace std_plugins {
 class WindEstimationPlugin : public plugin::PluginBase {
 public:
 	WindEstimationPlugin() : PluginBase(),
-		nh("~")
+		nh(plugin_ns(""))
 	{ }
 
 	/**
@@ -100,5 +100,5 @@ private:
 }	// namespace std_plugins
 }	// namespace mavros
 
-#include <pluginlib/class_list_macros.h>
-PLUGINLIB_EXPORT_CLASS(mavros::std_plugins::WindEstimationPlugin, mavros::plugin::PluginBase)
+#include <mavros/plugin_register.h>
+MAVROS_PLUGIN_REGISTER("wind_estimation", mavros::std_plugins::WindEstimationPlugin)
@@ -0,0 +1,295 @@
+/**
+ * Microbenchmarks for mavros routing library
+ *
+ * Build only when google-benchmark is installed (see CMakeLists.txt).
+ * Pure kernels (frame_tf, decode, dispatch) run standalone; the
+ * UAS::synchronise_stamp cases need a running roscore and are skipped
+ * without one.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <ros/ros.h>
+#include <mavros/arena.h>
+#include <mavros/frame_tf.h>
+#include <mavros/mavros_plugin.h>
+#include <mavros/mavros_uas.h>
+
+using namespace mavros;
+using mavlink::mavlink_message_t;
+
+static mavlink_message_t make_attitude_message()
+{
+	mavlink::common::msg::ATTITUDE att;
+	att.time_boot_ms = 123456;
+	att.roll = 0.1f;
+	att.pitch = -0.2f;
+	att.yaw = 1.5f;
+	att.rollspeed = 0.01f;
+	att.pitchspeed = 0.02f;
+	att.yawspeed = -0.03f;
+
+	mavlink::mavlink_status_t status {};
+	mavlink_message_t msg;
+	mavlink::MsgMap map(msg);
+	auto mi = att.get_message_info();
+	att.serialize(map);
+	mavlink::mavlink_finalize_message_buffer(&msg, 1, 1, &status,
+			mi.min_length, mi.length, mi.crc_extra);
+
+	return msg;
+}
+
+/* -*- typed decode: heap vs per-thread arena -*- */
+
+static void BM_decode_heap(benchmark::State &state)
+{
+	auto msg = make_attitude_message();
+
+	while (state.KeepRunning()) {
+		std::unique_ptr<plugin::DecodedMsgT<mavlink::common::msg::ATTITUDE>> d(
+				new plugin::DecodedMsgT<mavlink::common::msg::ATTITUDE>());
+		mavlink::MsgMap map(&msg);
+		d->obj.deserialize(map);
+		benchmark::DoNotOptimize(d->obj.time_boot_ms);
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_decode_heap);
+
+static void BM_decode_arena(benchmark::State &state)
+{
+	auto msg = make_attitude_message();
+
+	while (state.KeepRunning()) {
+		plugin::DecodedMsgPtr d(ScratchArena::thread_instance()
+				.create<plugin::DecodedMsgT<mavlink::common::msg::ATTITUDE>>());
+		mavlink::MsgMap map(&msg);
+		static_cast<plugin::DecodedMsgT<mavlink::common::msg::ATTITUDE> &>(*d).obj.deserialize(map);
+		benchmark::DoNotOptimize(d.get());
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_decode_arena);
+
+/* -*- plugin dispatch -*-
+ *
+ * MavRos::plugin_route_cb needs a running node, so this models its exact
+ * data path on the same building blocks: make_handler() subscriptions in
+ * a msgid-sorted flat table, lower_bound lookup, decode-once, typed
+ * fan-out through the std::function handlers.
+ */
+
+class BenchPlugin : public plugin::PluginBase {
+public:
+	size_t handled = 0;
+
+	Subscriptions get_subscriptions() override
+	{
+		return {
+			make_handler(&BenchPlugin::handle_attitude),
+		};
+	}
+
+private:
+	void handle_attitude(const mavlink_message_t *msg, mavlink::common::msg::ATTITUDE &att)
+	{
+		(void)msg;
+		handled += att.time_boot_ms != 0;
+	}
+};
+
+struct BenchDispatchEntry {
+	mavlink::msgid_t msgid;
+	plugin::PluginBase::Subscriptions subs;
+};
+
+static std::vector<BenchDispatchEntry> make_dispatch_table(plugin::PluginBase &pl, size_t filler_entries)
+{
+	std::vector<BenchDispatchEntry> table;
+
+	// filler msgids model the ~100 routed ids of a full plugin set
+	for (size_t i = 1; i <= filler_entries; i++)
+		table.push_back({ mavlink::msgid_t(1000 + i), {} });
+
+	for (auto &info : pl.get_subscriptions()) {
+		auto msgid = std::get<0>(info);
+		auto it = std::find_if(table.begin(), table.end(),
+				[msgid](const BenchDispatchEntry &e) { return e.msgid == msgid; });
+		if (it == table.end()) {
+			table.push_back({ msgid, {} });
+			it = std::prev(table.end());
+		}
+		it->subs.push_back(info);
+	}
+
+	std::sort(table.begin(), table.end(),
+			[](const BenchDispatchEntry &a, const BenchDispatchEntry &b) {
+				return a.msgid < b.msgid;
+			});
+
+	return table;
+}
+
+static void route_one(std::vector<BenchDispatchEntry> &table, const mavlink_message_t *msg)
+{
+	auto it = std::lower_bound(table.begin(), table.end(), msg->msgid,
+			[](const BenchDispatchEntry &e, mavlink::msgid_t id) {
+				return e.msgid < id;
+			});
+	if (it == table.end() || it->msgid != msg->msgid)
+		return;
+
+	plugin::DecodedMsgPtr decoded;
+	for (auto &info : it->subs) {
+		auto &decode = std::get<4>(info);
+		if (decode) {
+			decoded = decode(msg);
+			break;
+		}
+	}
+
+	for (auto &info : it->subs) {
+		auto &typed = std::get<5>(info);
+		if (typed && decoded)
+			typed(msg, *decoded);
+		else if (!typed)
+			std::get<3>(info)(msg, mavconn::Framing::ok);
+	}
+}
+
+static void BM_route_dispatch_hit(benchmark::State &state)
+{
+	BenchPlugin pl;
+	auto table = make_dispatch_table(pl, state.range(0));
+	auto msg = make_attitude_message();
+
+	while (state.KeepRunning())
+		route_one(table, &msg);
+
+	benchmark::DoNotOptimize(pl.handled);
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_route_dispatch_hit)->Arg(8)->Arg(128);
+
+static void BM_route_dispatch_miss(benchmark::State &state)
+{
+	BenchPlugin pl;
+	auto table = make_dispatch_table(pl, state.range(0));
+	auto msg = make_attitude_message();
+	msg.msgid = 777;	// not in the table
+
+	while (state.KeepRunning())
+		route_one(table, &msg);
+
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_route_dispatch_miss)->Arg(8)->Arg(128);
+
+/* -*- timesync stamp translation -*- */
+
+//! UAS needs TF machinery and therefore a node; skip without roscore
+static UAS *bench_uas()
+{
+	static UAS *uas = nullptr;
+	if (uas == nullptr && ros::master::check())
+		uas = new UAS();
+
+	return uas;
+}
+
+static void BM_synchronise_stamp(benchmark::State &state)
+{
+	auto *uas = bench_uas();
+	if (uas == nullptr) {
+		state.SkipWithError("no roscore");
+		return;
+	}
+
+	uas->set_timesync_state(1234567890123LL, 1e-6, 987654321000ULL);
+
+	uint32_t boot_ms = 123456;
+	while (state.KeepRunning()) {
+		benchmark::DoNotOptimize(uas->synchronise_stamp(boot_ms));
+		boot_ms++;
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_synchronise_stamp);
+
+/* -*- frame_tf kernels -*- */
+
+static void BM_ftf_vector_ned_enu(benchmark::State &state)
+{
+	Eigen::Vector3d v(1.0, 2.0, 3.0);
+
+	while (state.KeepRunning()) {
+		v = ftf::transform_frame_ned_enu(v);
+		benchmark::DoNotOptimize(v.x());
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ftf_vector_ned_enu);
+
+static void BM_ftf_orientation_chain(benchmark::State &state)
+{
+	// the attitude path: NED->ENU frame plus aircraft->baselink body
+	auto q = ftf::quaternion_from_rpy(0.1, -0.2, 1.5);
+
+	while (state.KeepRunning()) {
+		auto out = ftf::transform_orientation_aircraft_baselink(
+				ftf::transform_orientation_ned_enu(q));
+		benchmark::DoNotOptimize(out.w());
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ftf_orientation_chain);
+
+static void BM_ftf_quaternion_from_rpy(benchmark::State &state)
+{
+	double r = 0.0;
+
+	while (state.KeepRunning()) {
+		benchmark::DoNotOptimize(ftf::quaternion_from_rpy(r, -r, 2 * r));
+		r += 1e-6;
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ftf_quaternion_from_rpy);
+
+static void BM_ftf_covariance6d(benchmark::State &state)
+{
+	ftf::Covariance6d cov {};
+	for (size_t i = 0; i < cov.size(); i++)
+		cov[i] = double(i % 7) * 0.1;
+
+	auto q = ftf::quaternion_from_rpy(0.1, -0.2, 1.5);
+
+	while (state.KeepRunning()) {
+		auto out = ftf::transform_frame_aircraft_enu(cov, q);
+		benchmark::DoNotOptimize(out[0]);
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ftf_covariance6d);
+
+int main(int argc, char *argv[])
+{
+	// no master required here; only the UAS cases check for one
+	ros::init(argc, argv, "bench_mavros", ros::init_options::AnonymousName);
+	ros::Time::init();
+
+	benchmark::Initialize(&argc, argv);
+	benchmark::RunSpecifiedBenchmarks();
+	return 0;
+}
@@ -70,6 +70,84 @@ TEST(FRAME_TF, transform_static_frame__ned_to_enu_123)
 	EXPECT_NEAR(expected.z(), out.z(), epsilon);
 }
 
+TEST(FRAME_TF, transform_frame__vector3d_fast_path_matches_detail)
+{
+	Eigen::Vector3d input(1, 2, 3);
+
+	// non-template Vector3d overloads vs the generic enum-switch path
+	auto ned_enu = ftf::transform_frame_ned_enu(input);
+	auto ned_enu_detail = ftf::detail::transform_static_frame(input, ftf::StaticTF::NED_TO_ENU);
+
+	EXPECT_NEAR(ned_enu_detail.x(), ned_enu.x(), epsilon);
+	EXPECT_NEAR(ned_enu_detail.y(), ned_enu.y(), epsilon);
+	EXPECT_NEAR(ned_enu_detail.z(), ned_enu.z(), epsilon);
+
+	auto ab = ftf::transform_frame_aircraft_baselink(input);
+	auto ab_detail = ftf::detail::transform_static_frame(input, ftf::StaticTF::AIRCRAFT_TO_BASELINK);
+
+	EXPECT_NEAR(ab_detail.x(), ab.x(), epsilon);
+	EXPECT_NEAR(ab_detail.y(), ab.y(), epsilon);
+	EXPECT_NEAR(ab_detail.z(), ab.z(), epsilon);
+}
+
+TEST(FRAME_TF, transform_orientation__quaterniond_fast_path_matches_detail)
+{
+	auto input = ftf::quaternion_from_rpy(1.0, 2.0, 3.0);
+
+	// non-template Quaterniond overloads vs the generic enum-switch path
+	auto ned_enu = ftf::transform_orientation_ned_enu(input);
+	auto ned_enu_detail = ftf::detail::transform_orientation(input, ftf::StaticTF::NED_TO_ENU);
+
+	EXPECT_QUATERNION(ned_enu_detail, ned_enu, epsilon);
+
+	auto ab = ftf::transform_orientation_aircraft_baselink(input);
+	auto ab_detail = ftf::detail::transform_orientation(input, ftf::StaticTF::AIRCRAFT_TO_BASELINK);
+
+	EXPECT_QUATERNION(ab_detail, ab, epsilon);
+}
+
+TEST(FRAME_TF, transform_static_frame__points3d_ned_to_enu)
+{
+	ftf::Points3d input(3, 2);
+	input << 1, 4,
+	         2, 5,
+	         3, 6;
+
+	auto out = ftf::detail::transform_static_frame(input, ftf::StaticTF::NED_TO_ENU);
+
+	ASSERT_EQ(input.cols(), out.cols());
+	for (int i = 0; i < input.cols(); i++) {
+		Eigen::Vector3d expected = ftf::detail::transform_static_frame(
+				Eigen::Vector3d(input.col(i)), ftf::StaticTF::NED_TO_ENU);
+
+		EXPECT_NEAR(expected.x(), out(0, i), epsilon);
+		EXPECT_NEAR(expected.y(), out(1, i), epsilon);
+		EXPECT_NEAR(expected.z(), out(2, i), epsilon);
+	}
+}
+
+TEST(FRAME_TF, transform_frame__points3d_q123)
+{
+	auto q = ftf::quaternion_from_rpy(1.0, 2.0, 3.0);
+
+	ftf::Points3d input(3, 2);
+	input << 1, 4,
+	         2, 5,
+	         3, 6;
+
+	auto out = ftf::detail::transform_frame(input, q);
+
+	ASSERT_EQ(input.cols(), out.cols());
+	for (int i = 0; i < input.cols(); i++) {
+		Eigen::Vector3d expected = ftf::detail::transform_frame(
+				Eigen::Vector3d(input.col(i)), q);
+
+		EXPECT_NEAR(expected.x(), out(0, i), epsilon);
+		EXPECT_NEAR(expected.y(), out(1, i), epsilon);
+		EXPECT_NEAR(expected.z(), out(2, i), epsilon);
+	}
+}
+
 TEST(FRAME_TF, transform_static_frame__ecef_to_enu_123_00)
 {
 	Eigen::Vector3d input(1, 2, 3);
@@ -122,6 +200,32 @@ TEST(FRAME_TF, transform_static_frame__enu_to_ecef_123_4030)
 	EXPECT_NEAR(expected.z(), out.z(), epsilon);
 }
 
+TEST(FRAME_TF, transform_static_frame__covariance6x6_permutation)
+{
+	ftf::Covariance6d input;
+	for (size_t i = 0; i < input.size(); i++)
+		input[i] = double(i + 1);
+
+	// reference: full R * C * R^T with R = blkdiag(reflection, reflection)
+	Eigen::Matrix3d refl;
+	refl <<  0, 1,  0,
+	         1, 0,  0,
+	         0, 0, -1;
+
+	Eigen::Matrix<double, 6, 6> R = Eigen::Matrix<double, 6, 6>::Zero();
+	R.block<3, 3>(0, 0) = R.block<3, 3>(3, 3) = refl;
+
+	ftf::EigenMapConstCovariance6d cov_in(input.data());
+	Eigen::Matrix<double, 6, 6> expected = R * cov_in * R.transpose();
+
+	auto out_ = ftf::detail::transform_static_frame(input, ftf::StaticTF::NED_TO_ENU);
+	ftf::EigenMapConstCovariance6d out(out_.data());
+
+	for (int i = 0; i < 6; i++)
+		for (int j = 0; j < 6; j++)
+			EXPECT_NEAR(expected(i, j), out(i, j), epsilon);
+}
+
 TEST(FRAME_TF, quaternion_transforms__ned_to_ned_123)
 {
 	auto input_aircraft_ned_orient = ftf::quaternion_from_rpy(1.0, 2.0, 3.0);
@@ -14,9 +14,15 @@
  * https://github.com/mavlink/mavros/tree/master/LICENSE.md
  */
 
+#include <array>
+#include <mutex>
+
 #include <mavros/mavros_plugin.h>
+#include <mavros/msg_pool.h>
 
 #include <mavros_msgs/ADSBVehicle.h>
+#include <mavros_msgs/ADSBVehicleList.h>
+#include <mavros_msgs/ADSBContacts.h>
 
 namespace mavros {
 namespace extra_plugins {
@@ -27,19 +33,44 @@ using mavlink::common::ADSB_ALTITUDE_TYPE;
  * @brief ADS-B Vehicle plugin
  *
  * Publish/subscribe Automatic dependent surveillance-broadcast data to/from a vehicle.
+ *
+ * Besides republishing each ADSB_VEHICLE message, the plugin keeps a
+ * deduplicated contact table keyed by ICAO address: a flat open-addressed
+ * array with generation-stamped slots, so aging needs no deletion pass -
+ * a slot whose generation fell behind is simply reusable. The table feeds
+ * a consolidated vehicle-list topic at a fixed rate and a contacts-within-
+ * radius query service for detect-and-avoid consumers.
  */
 class ADSBPlugin : public plugin::PluginBase {
 public:
 	ADSBPlugin() : PluginBase(),
-		adsb_nh("~adsb")
+		adsb_nh(plugin_ns("adsb")),
+		list_rate(1.0),
+		contact_timeout(10.0),
+		gen_counter(1),
+		timeout_gens(10)
 	{ }
 
 	void initialize(UAS &uas_)
 	{
 		PluginBase::initialize(uas_);
 
+		// consolidated list rate [Hz]; 0 disables the contact table
+		adsb_nh.param("list_rate", list_rate, 1.0);
+		// contact dropped after this silence [s]
+		adsb_nh.param("contact_timeout", contact_timeout, 10.0);
+
 		adsb_pub = adsb_nh.advertise<mavros_msgs::ADSBVehicle>("vehicle", 10);
 		adsb_sub = adsb_nh.subscribe("send", 10, &ADSBPlugin::adsb_cb, this);
+
+		if (list_rate > 0.0) {
+			timeout_gens = std::max<uint64_t>(1, std::ceil(contact_timeout * list_rate));
+
+			list_pub = adsb_nh.advertise<mavros_msgs::ADSBVehicleList>("vehicles", 10);
+			contacts_srv = adsb_nh.advertiseService("contacts", &ADSBPlugin::contacts_cb, this);
+			list_timer = adsb_nh.createTimer(ros::Duration(1.0 / list_rate),
+						&ADSBPlugin::list_cb, this);
+		}
 	}
 
 	Subscriptions get_subscriptions()
@@ -54,6 +85,70 @@ private:
 
 	ros::Publisher adsb_pub;
 	ros::Subscriber adsb_sub;
+	ros::Publisher list_pub;
+	ros::ServiceServer contacts_srv;
+	ros::Timer list_timer;
+
+	double list_rate;		//!< consolidated list rate [Hz]
+	double contact_timeout;		//!< contact silence before aging out [s]
+
+	/**
+	 * Contact table: open-addressed, linear probing, keyed by ICAO
+	 * address. Slots are never deleted, only generation-stamped; a
+	 * stale slot reads as free to insertion but still holds its place
+	 * in probe chains, so aging is O(1) per contact with no tombstones.
+	 */
+	static constexpr size_t TABLE_SIZE = 256;	//!< power of two (probe mask)
+
+	struct Contact {
+		uint64_t gen = 0;		//!< generation of last update; 0: never used
+		mavros_msgs::ADSBVehicle vehicle;
+	};
+
+	std::mutex table_mutex;
+	std::array<Contact, TABLE_SIZE> table;
+	uint64_t gen_counter;		//!< advanced once per list period
+	uint64_t timeout_gens;		//!< generations until a contact is stale
+
+	MessagePool<mavros_msgs::ADSBVehicleList, 2> list_pool;
+
+	bool contact_live(const Contact &c)
+	{
+		return c.gen != 0 && gen_counter - c.gen < timeout_gens;
+	}
+
+	//! Insert or refresh one contact (table_mutex held by caller)
+	void table_update(const mavros_msgs::ADSBVehicle &vehicle)
+	{
+		size_t idx = vehicle.ICAO_address & (TABLE_SIZE - 1);
+		size_t reuse = TABLE_SIZE;
+
+		for (size_t probe = 0; probe < TABLE_SIZE; probe++, idx = (idx + 1) & (TABLE_SIZE - 1)) {
+			auto &c = table[idx];
+
+			if (c.gen == 0) {	// never used: end of the probe chain
+				if (reuse == TABLE_SIZE)
+					reuse = idx;
+				break;
+			}
+			if (c.vehicle.ICAO_address == vehicle.ICAO_address) {
+				reuse = idx;
+				break;
+			}
+			// stale slot: reusable, but keep probing for a live match
+			if (reuse == TABLE_SIZE && !contact_live(c))
+				reuse = idx;
+		}
+
+		if (reuse == TABLE_SIZE) {
+			ROS_WARN_THROTTLE_NAMED(30, "adsb", "ADSB: contact table full, dropping ICAO %u",
+						vehicle.ICAO_address);
+			return;
+		}
+
+		table[reuse].gen = gen_counter;
+		table[reuse].vehicle = vehicle;
+	}
 
 	void handle_adsb(const mavlink::mavlink_message_t *msg, mavlink::common::msg::ADSB_VEHICLE &adsb)
 	{
@@ -108,9 +203,63 @@ private:
 				<< " emitter: " << utils::to_string_enum<ADSB_EMITTER_TYPE>(adsb.emitter_type)
 				<< " flags: 0x" << std::hex << adsb.flags);
 
+		if (list_rate > 0.0) {
+			std::lock_guard<std::mutex> lock(table_mutex);
+			table_update(*adsb_msg);
+		}
+
 		adsb_pub.publish(adsb_msg);
 	}
 
+	//! Publish the consolidated contact list and advance the generation
+	void list_cb(const ros::TimerEvent &event)
+	{
+		std::lock_guard<std::mutex> lock(table_mutex);
+
+		gen_counter++;
+
+		if (list_pub.getNumSubscribers() == 0)
+			return;
+
+		auto list = list_pool.acquire();
+
+		list->header.stamp = event.current_real;
+		list->header.frame_id.clear();
+		list->vehicles.clear();	// reuses pooled capacity
+
+		for (auto &c : table) {
+			if (contact_live(c))
+				list->vehicles.push_back(c.vehicle);
+		}
+
+		list_pub.publish(list);
+	}
+
+	//! Contacts-within-radius query, for detect-and-avoid planners
+	bool contacts_cb(mavros_msgs::ADSBContacts::Request &req, mavros_msgs::ADSBContacts::Response &res)
+	{
+		// flat-earth arc length: plenty at detect-and-avoid ranges,
+		// and far cheaper than a geodesic solve per contact
+		constexpr double DEG_TO_M = 6371000.0 * M_PI / 180.0;
+		const double cos_lat = std::cos(req.latitude * M_PI / 180.0);
+
+		std::lock_guard<std::mutex> lock(table_mutex);
+
+		for (auto &c : table) {
+			if (!contact_live(c))
+				continue;
+
+			double dn = (c.vehicle.latitude - req.latitude) * DEG_TO_M;
+			double de = (c.vehicle.longitude - req.longitude) * DEG_TO_M * cos_lat;
+
+			if (std::hypot(dn, de) <= req.radius)
+				res.vehicles.push_back(c.vehicle);
+		}
+
+		res.success = true;
+		return true;
+	}
+
 	void adsb_cb(const mavros_msgs::ADSBVehicle::ConstPtr &req)
 	{
 		mavlink::common::msg::ADSB_VEHICLE adsb{};
@@ -14,9 +14,14 @@
  * https://github.com/mavlink/mavros/tree/master/LICENSE.md
  */
 
+#include <array>
+#include <mutex>
+
 #include <mavros/mavros_plugin.h>
+#include <mavros/msg_pool.h>
 
 #include <mavros_msgs/CamIMUStamp.h>
+#include <sensor_msgs/CameraInfo.h>
 
 namespace mavros {
 namespace extra_plugins{
@@ -26,18 +31,41 @@ namespace extra_plugins{
  * This plugin publishes a timestamp for when a external camera system was
  * triggered by the FCU. Sequence ID from the message and the image sequence from
  * camera can be corellated to get the exact shutter trigger time.
+ *
+ * It can also do that correlation itself: with ~cam_imu_sync/camera_info
+ * remapped to the camera driver, triggers are kept in a small ring buffer
+ * indexed by sequence and each frame is re-stamped with its timesync-
+ * corrected trigger time in O(1). The trigger-to-frame sequence offset is
+ * learned (and relearned after drops) by matching stamps within
+ * ~cam_imu_sync/match_window, so neither side needs to start first.
  */
 class CamIMUSyncPlugin : public plugin::PluginBase {
 public:
 	CamIMUSyncPlugin() : PluginBase(),
-		cam_imu_sync_nh("~cam_imu_sync")
+		cam_imu_sync_nh(plugin_ns("cam_imu_sync")),
+		match_window(0.1),
+		have_offset(false),
+		seq_offset(0),
+		trigger_count(0),
+		frame_count(0),
+		matched_count(0),
+		overwritten_triggers(0),
+		unmatched_frames(0)
 	{ }
 
 	void initialize(UAS &uas_)
 	{
 		PluginBase::initialize(uas_);
 
+		// largest |trigger stamp - driver stamp| considered the same
+		// frame when (re)learning the sequence offset [s]
+		cam_imu_sync_nh.param("match_window", match_window, 0.1);
+
 		cam_imu_pub = cam_imu_sync_nh.advertise<mavros_msgs::CamIMUStamp>("cam_imu_stamp", 10);
+		cam_info_pub = cam_imu_sync_nh.advertise<sensor_msgs::CameraInfo>("camera_info_synced", 10);
+		cam_info_sub = cam_imu_sync_nh.subscribe("camera_info", 10, &CamIMUSyncPlugin::camera_info_cb, this);
+
+		UAS_DIAG(m_uas).add("cam_imu_sync", this, &CamIMUSyncPlugin::diag_run);
 	}
 
 	Subscriptions get_subscriptions()
@@ -51,15 +79,158 @@ private:
 	ros::NodeHandle cam_imu_sync_nh;
 
 	ros::Publisher cam_imu_pub;
+	ros::Publisher cam_info_pub;
+	ros::Subscriber cam_info_sub;
+
+	double match_window;		//!< stamp distance for offset (re)learning [s]
+
+	/**
+	 * Trigger ring: slot = trigger seq masked, so a frame whose trigger
+	 * seq is known is a single array read. Unmatched triggers are simply
+	 * overwritten one lap later and counted as drops.
+	 */
+	static constexpr size_t RING_SIZE = 32;	//!< power of two (index mask)
+
+	struct TrigSlot {
+		bool valid = false;	//!< slot ever written
+		bool consumed = false;	//!< already matched to a frame
+		uint32_t seq;		//!< trigger sequence
+		ros::Time stamp;	//!< timesync-corrected shutter time
+	};
+
+	std::mutex ring_mutex;
+	std::array<TrigSlot, RING_SIZE> ring;
+
+	bool have_offset;
+	uint32_t seq_offset;		//!< trigger seq - frame seq
+
+	// drop statistics (guarded by ring_mutex)
+	uint64_t trigger_count;
+	uint64_t frame_count;
+	uint64_t matched_count;
+	uint64_t overwritten_triggers;	//!< triggers replaced before any frame matched
+	uint64_t unmatched_frames;
+
+	MessagePool<mavros_msgs::CamIMUStamp> stamp_pool;
+	MessagePool<sensor_msgs::CameraInfo, 4> info_pool;
 
 	void handle_cam_trig(const mavlink::mavlink_message_t *msg, mavlink::common::msg::CAMERA_TRIGGER &ctrig)
 	{
-		auto sync_msg = boost::make_shared<mavros_msgs::CamIMUStamp>();
+		auto stamp = m_uas->synchronise_stamp(ctrig.time_usec);
+
+		{
+			std::lock_guard<std::mutex> lock(ring_mutex);
+			auto &slot = ring[ctrig.seq & (RING_SIZE - 1)];
+
+			trigger_count++;
+			if (slot.valid && !slot.consumed)
+				overwritten_triggers++;
+
+			slot.valid = true;
+			slot.consumed = false;
+			slot.seq = ctrig.seq;
+			slot.stamp = stamp;
+		}
+
+		if (cam_imu_pub.getNumSubscribers() > 0) {
+			auto sync_msg = stamp_pool.acquire();
+
+			sync_msg->frame_stamp = stamp;
+			sync_msg->frame_seq_id = ctrig.seq;
+
+			cam_imu_pub.publish(sync_msg);
+		}
+	}
+
+	/**
+	 * @brief Find the trigger for @a frame_stamp / @a frame_seq
+	 * (ring_mutex held by caller).
+	 * @return matched slot, or nullptr
+	 */
+	TrigSlot* match_trigger(const ros::Time &frame_stamp, uint32_t frame_seq)
+	{
+		if (have_offset) {
+			auto &slot = ring[(frame_seq + seq_offset) & (RING_SIZE - 1)];
+
+			if (slot.valid && !slot.consumed && slot.seq == frame_seq + seq_offset &&
+					std::abs((slot.stamp - frame_stamp).toSec()) <= match_window)
+				return &slot;
+
+			have_offset = false;	// drops desynced us: relearn below
+		}
+
+		// (re)learn the offset: nearest unconsumed trigger within the window
+		TrigSlot *best = nullptr;
+		double best_dt = match_window;
+
+		for (auto &slot : ring) {
+			if (!slot.valid || slot.consumed)
+				continue;
+
+			double dt = std::abs((slot.stamp - frame_stamp).toSec());
+			if (dt <= best_dt) {
+				best_dt = dt;
+				best = &slot;
+			}
+		}
+
+		if (best != nullptr) {
+			seq_offset = best->seq - frame_seq;
+			have_offset = true;
+		}
+
+		return best;
+	}
+
+	//! Re-stamp one camera driver frame with its trigger time
+	void camera_info_cb(const sensor_msgs::CameraInfo::ConstPtr &ci)
+	{
+		ros::Time trig_stamp;
+
+		{
+			std::lock_guard<std::mutex> lock(ring_mutex);
+			frame_count++;
+
+			auto slot = match_trigger(ci->header.stamp, ci->header.seq);
+			if (slot == nullptr) {
+				unmatched_frames++;
+				return;
+			}
+
+			slot->consumed = true;
+			matched_count++;
+			trig_stamp = slot->stamp;
+		}
+
+		if (cam_info_pub.getNumSubscribers() == 0)
+			return;
+
+		auto out = info_pool.acquire();
+
+		*out = *ci;	// full camera info, only the stamp corrected
+		out->header.stamp = trig_stamp;
+
+		cam_info_pub.publish(out);
+	}
+
+	void diag_run(diagnostic_updater::DiagnosticStatusWrapper &stat)
+	{
+		std::lock_guard<std::mutex> lock(ring_mutex);
 
-		sync_msg->frame_stamp = m_uas->synchronise_stamp(ctrig.time_usec);
-		sync_msg->frame_seq_id = ctrig.seq;
+		if (trigger_count == 0)
+			stat.summary(1, "No triggers");
+		else if (frame_count > 0 && !have_offset)
+			stat.summary(1, "Not correlated");
+		else
+			stat.summary(0, "Normal");
 
-		cam_imu_pub.publish(sync_msg);
+		stat.addf("Triggers", "%llu", (long long unsigned)trigger_count);
+		stat.addf("Frames", "%llu", (long long unsigned)frame_count);
+		stat.addf("Matched", "%llu", (long long unsigned)matched_count);
+		stat.addf("Overwritten triggers", "%llu", (long long unsigned)overwritten_triggers);
+		stat.addf("Unmatched frames", "%llu", (long long unsigned)unmatched_frames);
+		if (have_offset)
+			stat.addf("Sequence offset", "%d", (int32_t)seq_offset);
 	}
 };
 }	// namespace extra_plugins
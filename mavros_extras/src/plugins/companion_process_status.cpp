@@ -36,7 +36,7 @@ using utils::enum_value;
 class CompanionProcessStatusPlugin : public plugin::PluginBase {
 public:
 	CompanionProcessStatusPlugin() : PluginBase(),
-	status_nh("~companion_process")
+	status_nh(plugin_ns("companion_process"))
 	{ }
 
 	void initialize(UAS &uas_)
@@ -74,7 +74,8 @@ private:
 						utils::to_string_enum<MAV_COMPONENT>(req->component) << " companion process status: " <<
 						utils::to_string_enum<MAV_STATE>(heartbeat.system_status) << std::endl << heartbeat.to_yaml());
 
-		UAS_FCU(m_uas)->send_message_ignore_drop(heartbeat, req->component);
+		// liveness class: must not queue behind bulk telemetry
+		UAS_FCU(m_uas)->send_message_ignore_drop(heartbeat, req->component, mavconn::TxPrio::REALTIME);
 	}
 };
 }	// namespace extra_plugins
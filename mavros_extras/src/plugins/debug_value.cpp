@@ -14,7 +14,10 @@
  * https://github.com/mavlink/mavros/tree/master/LICENSE.md
  */
 
+#include <array>
+#include <cstring>
 #include <mavros/mavros_plugin.h>
+#include <mavros/msg_pool.h>
 
 #include <mavros_msgs/DebugValue.h>
 
@@ -24,13 +27,19 @@ namespace extra_plugins {
 class DebugValuePlugin : public plugin::PluginBase {
 public:
 	DebugValuePlugin() : PluginBase(),
-		debug_nh("~debug_value")
+		debug_nh(plugin_ns("debug_value")),
+		channel_count(0)
 	{ }
 
 	void initialize(UAS &uas_)
 	{
 		PluginBase::initialize(uas_);
 
+		// rate of the aggregate topic carrying the last value of every
+		// named channel in one message; 0 disables it
+		double aggregate_rate;
+		debug_nh.param("aggregate_rate", aggregate_rate, 10.0);
+
 		// subscribers
 		debug_sub = debug_nh.subscribe("send", 10, &DebugValuePlugin::debug_cb, this);
 
@@ -39,6 +48,12 @@ public:
 		debug_vector_pub = debug_nh.advertise<mavros_msgs::DebugValue>("debug_vector", 10);
 		named_value_float_pub = debug_nh.advertise<mavros_msgs::DebugValue>("named_value_float", 10);
 		named_value_int_pub = debug_nh.advertise<mavros_msgs::DebugValue>("named_value_int", 10);
+
+		if (aggregate_rate > 0.0) {
+			aggregate_pub = debug_nh.advertise<mavros_msgs::DebugValue>("named_value_array", 10);
+			aggregate_timer = debug_nh.createTimer(ros::Duration(1.0 / aggregate_rate),
+						&DebugValuePlugin::aggregate_cb, this);
+		}
 	}
 
 	Subscriptions get_subscriptions() {
@@ -51,6 +66,27 @@ public:
 	}
 
 private:
+	//! bound on distinct named channels; FCU names are 10 chars, counts are small
+	static constexpr size_t MAX_CHANNELS = 64;
+
+	//! mavlink name field type used as interning key (fixed 10 bytes, memcmp-comparable)
+	using NameKey = std::array<char, 10>;
+
+	/**
+	 * @brief One interned named channel.
+	 *
+	 * Name, per-channel publisher and topic string are built exactly
+	 * once, when the name is first seen; afterwards a message costs one
+	 * bounded memcmp scan and zero allocations.
+	 */
+	struct Channel {
+		NameKey key;
+		std::string name;
+		ros::Publisher pub;
+		float last_value;
+		ros::Time last_stamp;
+	};
+
 	ros::NodeHandle debug_nh;
 
 	ros::Subscriber debug_sub;
@@ -59,19 +95,60 @@ private:
 	ros::Publisher debug_vector_pub;
 	ros::Publisher named_value_float_pub;
 	ros::Publisher named_value_int_pub;
+	ros::Publisher aggregate_pub;
+	ros::Timer aggregate_timer;
+
+	std::mutex channels_mutex;	//!< guards channels/channel_count/agg_names
+	std::array<Channel, MAX_CHANNELS> channels;
+	size_t channel_count;
+	std::string agg_names;		//!< comma-joined channel names, rebuilt on intern only
+
+	MessagePool<mavros_msgs::DebugValue> dv_pool;
+	MessagePool<mavros_msgs::DebugValue, 2> agg_pool;
 
 	/* -*- helpers -*- */
 
 	/**
-	 * @brief Helper function to log debug messages
-	 * @param type	Type of debug message
-	 * @param dv	Data value
+	 * @brief Find or intern the channel for a mavlink name field.
+	 * @return nullptr when the channel table is full
 	 */
-	void debug_logger(const std::string &type, const mavros_msgs::DebugValue &dv)
+	Channel *channel_lookup(const NameKey &key, const char *base_topic)
 	{
-		using DV = mavros_msgs::DebugValue;
+		for (size_t i = 0; i < channel_count; i++)
+			if (std::memcmp(channels[i].key.data(), key.data(), key.size()) == 0)
+				return &channels[i];
+
+		if (channel_count == MAX_CHANNELS) {
+			ROS_WARN_THROTTLE_NAMED(60, "debug_value", "DV: channel table full, not demuxing new names");
+			return nullptr;
+		}
+
+		auto &c = channels[channel_count];
+		c.key = key;
+		c.name = mavlink::to_string(key);
+		c.pub = debug_nh.advertise<mavros_msgs::DebugValue>(std::string(base_topic) + "/" + c.name, 10);
+		c.last_value = 0.0;
+		channel_count++;
+
+		agg_names.clear();
+		for (size_t i = 0; i < channel_count; i++) {
+			if (i > 0)
+				agg_names += ",";
+			agg_names += channels[i].name;
+		}
 
-		std::string name = (dv.name == "") ? "UNK" : dv.name;
+		return &c;
+	}
+
+	/**
+	 * @brief Format the payload of a debug message for logging.
+	 *
+	 * Called from inside ROS_DEBUG_STREAM_NAMED so the string work only
+	 * happens when the logger is actually enabled.
+	 */
+	static std::string format_value(const mavros_msgs::DebugValue &dv)
+	{
+		using DV = mavros_msgs::DebugValue;
 
 		std::ostringstream ss;
 		if (dv.type == DV::TYPE_NAMED_VALUE_INT) {
@@ -95,12 +172,21 @@ private:
 			ss << dv.value_float;
 		}
 
+		return ss.str();
+	}
 
+	/**
+	 * @brief Helper function to log debug messages
+	 * @param type	Type of debug message
+	 * @param dv	Data value
+	 */
+	void debug_logger(const std::string &type, const mavros_msgs::DebugValue &dv)
+	{
 		ROS_DEBUG_STREAM_NAMED("debug_value", type << "\t"
 							   << dv.header.stamp   << "\t"
-							   << name    << "\t["
+							   << (dv.name.empty() ? "UNK" : dv.name)    << "\t["
 							   << dv.index   << "]\tvalue:"
-							   << ss.str());
+							   << format_value(dv));
 	}
 
 	/* -*- message handlers -*- */
@@ -113,33 +199,14 @@ private:
 	 */
 	void handle_debug(const mavlink::mavlink_message_t *msg, mavlink::common::msg::DEBUG &debug)
 	{
-		// [[[cog:
-		// p = "dv_msg"
-		// val = "debug"
-		//
-		// def common_filler(type_, time_f, index, name):
-		//     if isinstance(index, str):
-		//         index = val + "." + index
-		//
-		//     _args = globals()
-		//     _args.update(locals())
-		//
-		//     cog.outl("""auto {p} = boost::make_shared<mavros_msgs::DebugValue>();""".format(**_args))
-		//     cog.outl("""{p}->header.stamp = m_uas->synchronise_stamp({val}.{time_f});""".format(**_args))
-		//     cog.outl("""{p}->type = mavros_msgs::DebugValue::{type_};""".format(**_args))
-		//     cog.outl("""{p}->index = {index};""".format(**_args))
-		//     if name:
-		//         cog.outl("""{p}->name = mavlink::to_string({val}.{name});""".format(**_args))
-		//
-		// common_filler("TYPE_DEBUG", "time_boot_ms", "ind", None)
-		// cog.outl("""{p}->value_float = {val}.value;""".format(**locals()))
-		// ]]]
-		auto dv_msg = boost::make_shared<mavros_msgs::DebugValue>();
+		auto dv_msg = dv_pool.acquire();
 		dv_msg->header.stamp = m_uas->synchronise_stamp(debug.time_boot_ms);
 		dv_msg->type = mavros_msgs::DebugValue::TYPE_DEBUG;
 		dv_msg->index = debug.ind;
+		dv_msg->name.clear();
 		dv_msg->value_float = debug.value;
-		// [[[end]]] (checksum: 82e058cb699846b34885ce3defc6ac58)
+		dv_msg->value_int = 0;
+		dv_msg->data.clear();
 
 		debug_logger(debug.get_name(), *dv_msg);
 		debug_pub.publish(dv_msg);
@@ -153,25 +220,17 @@ private:
 	 */
 	void handle_debug_vector(const mavlink::mavlink_message_t *msg, mavlink::common::msg::DEBUG_VECT &debug)
 	{
-		// [[[cog:
-		// common_filler("TYPE_DEBUG_VECT", "time_usec", -1, "name")
-		//
-		// fields = "xyz"
-		// pd = p + "->data"
-		// cog.outl("""{pd}.resize({l});""".format(l=len(fields), **locals()))
-		// for i, f in enumerate(fields):
-		//     cog.outl("""{pd}[{i}] = {val}.{f};""".format(**locals()))
-		// ]]]
-		auto dv_msg = boost::make_shared<mavros_msgs::DebugValue>();
+		auto dv_msg = dv_pool.acquire();
 		dv_msg->header.stamp = m_uas->synchronise_stamp(debug.time_usec);
 		dv_msg->type = mavros_msgs::DebugValue::TYPE_DEBUG_VECT;
 		dv_msg->index = -1;
 		dv_msg->name = mavlink::to_string(debug.name);
+		dv_msg->value_float = 0.0;
+		dv_msg->value_int = 0;
 		dv_msg->data.resize(3);
 		dv_msg->data[0] = debug.x;
 		dv_msg->data[1] = debug.y;
 		dv_msg->data[2] = debug.z;
-		// [[[end]]] (checksum: 966bca4d95f06349cf065f3887c69471)
 
 		debug_logger(debug.get_name(), *dv_msg);
 		debug_vector_pub.publish(dv_msg);
@@ -189,21 +248,30 @@ private:
 	 */
 	void handle_named_value_float(const mavlink::mavlink_message_t *msg, mavlink::common::msg::NAMED_VALUE_FLOAT &value)
 	{
-		// [[[cog:
-		// val="value"
-		// common_filler("TYPE_NAMED_VALUE_FLOAT", "time_boot_ms", -1, "name")
-		// cog.outl("""{p}->value_float = {val}.value;""".format(**locals()))
-		// ]]]
-		auto dv_msg = boost::make_shared<mavros_msgs::DebugValue>();
+		std::lock_guard<std::mutex> lock(channels_mutex);
+
+		auto channel = channel_lookup(value.name, "named_value_float");
+
+		auto dv_msg = dv_pool.acquire();
 		dv_msg->header.stamp = m_uas->synchronise_stamp(value.time_boot_ms);
 		dv_msg->type = mavros_msgs::DebugValue::TYPE_NAMED_VALUE_FLOAT;
 		dv_msg->index = -1;
-		dv_msg->name = mavlink::to_string(value.name);
+		if (channel)
+			dv_msg->name = channel->name;	// string assign reuses capacity
+		else
+			dv_msg->name = mavlink::to_string(value.name);
 		dv_msg->value_float = value.value;
-		// [[[end]]] (checksum: 8d70c469d67ab346574c99d20b91a501)
+		dv_msg->value_int = 0;
+		dv_msg->data.clear();
 
 		debug_logger(value.get_name(), *dv_msg);
 		named_value_float_pub.publish(dv_msg);
+
+		if (channel) {
+			channel->last_value = value.value;
+			channel->last_stamp = dv_msg->header.stamp;
+			channel->pub.publish(dv_msg);
+		}
 	}
 
 	/**
@@ -214,24 +282,61 @@ private:
 	 */
 	void handle_named_value_int(const mavlink::mavlink_message_t *msg, mavlink::common::msg::NAMED_VALUE_INT &value)
 	{
-		// [[[cog:
-		// common_filler("TYPE_NAMED_VALUE_INT", "time_boot_ms", -1, "name")
-		// cog.outl("""{p}->value_int = {val}.value;""".format(**locals()))
-		// ]]]
-		auto dv_msg = boost::make_shared<mavros_msgs::DebugValue>();
+		std::lock_guard<std::mutex> lock(channels_mutex);
+
+		auto channel = channel_lookup(value.name, "named_value_int");
+
+		auto dv_msg = dv_pool.acquire();
 		dv_msg->header.stamp = m_uas->synchronise_stamp(value.time_boot_ms);
 		dv_msg->type = mavros_msgs::DebugValue::TYPE_NAMED_VALUE_INT;
 		dv_msg->index = -1;
-		dv_msg->name = mavlink::to_string(value.name);
+		if (channel)
+			dv_msg->name = channel->name;
+		else
+			dv_msg->name = mavlink::to_string(value.name);
+		dv_msg->value_float = 0.0;
 		dv_msg->value_int = value.value;
-		// [[[end]]] (checksum: b7ce125baba6e8918f6b866a9d5aa77c)
+		dv_msg->data.clear();
 
 		debug_logger(value.get_name(), *dv_msg);
 		named_value_int_pub.publish(dv_msg);
+
+		if (channel) {
+			channel->last_value = value.value;
+			channel->last_stamp = dv_msg->header.stamp;
+			channel->pub.publish(dv_msg);
+		}
 	}
 
 	/* -*- callbacks -*- */
 
+	/**
+	 * @brief Publish the last value of every named channel as one array
+	 * message; channel order matches the comma-joined names field.
+	 */
+	void aggregate_cb(const ros::TimerEvent &event)
+	{
+		if (aggregate_pub.getNumSubscribers() == 0)
+			return;
+
+		std::lock_guard<std::mutex> lock(channels_mutex);
+		if (channel_count == 0)
+			return;
+
+		auto msg = agg_pool.acquire();
+		msg->header.stamp = event.current_real;
+		msg->type = mavros_msgs::DebugValue::TYPE_DEBUG_ARRAY;
+		msg->index = -1;
+		msg->name = agg_names;
+		msg->value_float = 0.0;
+		msg->value_int = 0;
+		msg->data.clear();	// keeps capacity
+		for (size_t i = 0; i < channel_count; i++)
+			msg->data.push_back(channels[i].last_value);
+
+		aggregate_pub.publish(msg);
+	}
+
 	/**
 	 * @brief Debug callbacks
 	 * @param req	pointer to mavros_msgs/Debug.msg being published
@@ -13,12 +13,17 @@
  * in the top-level LICENSE file of the mavros repository.
  * https://github.com/mavlink/mavros/tree/master/LICENSE.md
  */
-#include <unordered_map>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
 #include <mavros/utils.h>
 #include <mavros/mavros_plugin.h>
+#include <mavros/msg_pool.h>
 #include <eigen_conversions/eigen_msg.h>
 
 #include <sensor_msgs/Range.h>
+#include <sensor_msgs/LaserScan.h>
 
 namespace mavros {
 namespace extra_plugins {
@@ -41,6 +46,8 @@ public:
 		field_of_view(0),
 		orientation(-1),
 		covariance(0),
+		yaw(0.0),
+		last_range(0.0),
 		owner(nullptr),
 		data_index(0)
 	{ }
@@ -55,6 +62,11 @@ public:
 	int covariance;		//!< in centimeters, current specification
 	std::string frame_id;	//!< frame id for send
 
+	// last reading, for the aggregated scan (guarded by owner scan_mutex)
+	double yaw;		//!< sensor heading in base frame, from orientation
+	float last_range;
+	ros::Time last_stamp;
+
 	// topic handle
 	ros::Publisher pub;
 	ros::Subscriber sub;
@@ -113,7 +125,11 @@ private:
 class DistanceSensorPlugin : public plugin::PluginBase {
 public:
 	DistanceSensorPlugin() : PluginBase(),
-		dist_nh("~distance_sensor")
+		dist_nh(plugin_ns("distance_sensor")),
+		aggregate(false),
+		aggregate_rate(20.0),
+		scan_range_min(0.0),
+		scan_range_max(0.0)
 	{ }
 
 	void initialize(UAS &uas_)
@@ -121,6 +137,9 @@ public:
 		PluginBase::initialize(uas_);
 
 		dist_nh.param<std::string>("base_frame_id", base_frame_id, "base_link");
+		// assemble all configured publisher sensors into one LaserScan
+		dist_nh.param("aggregate", aggregate, false);
+		dist_nh.param("aggregate_rate", aggregate_rate, 20.0);
 
 		XmlRpc::XmlRpcValue map_dict;
 		if (!dist_nh.getParam("", map_dict)) {
@@ -135,10 +154,32 @@ public:
 			auto it = DistanceSensorItem::create_item(this, pair.first);
 
 			if (it)
-				sensor_map[it->sensor_id] = it;
+				sensor_table[it->sensor_id] = it;
 			else
 				ROS_ERROR_NAMED("distance_sensor", "DS: bad config for %s", pair.first.c_str());
 		}
+
+		if (aggregate) {
+			for (auto &sensor : sensor_table) {
+				if (sensor && !sensor->is_subscriber && sensor->orientation >= 0)
+					scan_items.push_back(sensor);
+			}
+
+			std::sort(scan_items.begin(), scan_items.end(),
+					[](const DistanceSensorItem::Ptr &a, const DistanceSensorItem::Ptr &b) {
+						return a->yaw < b->yaw;
+					});
+
+			if (scan_items.size() < 2) {
+				ROS_WARN_NAMED("distance_sensor", "DS: aggregation needs at least two oriented publisher sensors");
+				aggregate = false;
+			}
+			else {
+				scan_pub = dist_nh.advertise<sensor_msgs::LaserScan>("scan", 10);
+				scan_timer = dist_nh.createTimer(ros::Duration(1.0 / aggregate_rate),
+						&DistanceSensorPlugin::scan_cb, this);
+			}
+		}
 	}
 
 	Subscriptions get_subscriptions()
@@ -155,7 +196,20 @@ private:
 
 	std::string base_frame_id;
 
-	std::unordered_map<uint8_t, DistanceSensorItem::Ptr> sensor_map;
+	//! flat table indexed by the 8-bit sensor id: one load instead of a hash lookup
+	std::array<DistanceSensorItem::Ptr, 256> sensor_table;
+
+	MessagePool<sensor_msgs::Range> range_pool;
+	MessagePool<sensor_msgs::LaserScan, 2> scan_pool;
+
+	bool aggregate;
+	double aggregate_rate;		//!< aggregated scan publish rate [Hz]
+	std::mutex scan_mutex;		//!< guards the last readings, see DistanceSensorItem
+	std::vector<DistanceSensorItem::Ptr> scan_items;	//!< publisher items sorted by yaw
+	float scan_range_min;
+	float scan_range_max;
+	ros::Publisher scan_pub;
+	ros::Timer scan_timer;
 
 	/* -*- low-level send -*- */
 	void distance_sensor(uint32_t time_boot_ms,
@@ -201,15 +255,13 @@ private:
 		using mavlink::common::MAV_SENSOR_ORIENTATION;
 		using mavlink::common::MAV_DISTANCE_SENSOR;
 
-		auto it = sensor_map.find(dist_sen.id);
-		if (it == sensor_map.end()) {
+		auto &sensor = sensor_table[dist_sen.id];
+		if (!sensor) {
 			ROS_ERROR_NAMED("distance_sensor",
 						"DS: no mapping for sensor id: %d, type: %d, orientation: %d",
 						dist_sen.id, dist_sen.type, dist_sen.orientation);
 			return;
 		}
-
-		auto sensor = it->second;
 		if (sensor->is_subscriber) {
 			ROS_ERROR_ONCE_NAMED("distance_sensor",
 					"DS: %s (id %d) is subscriber, but i got sensor data for that id from FCU",
@@ -226,7 +278,7 @@ private:
 						utils::to_string_enum<MAV_SENSOR_ORIENTATION>(sensor->orientation).c_str());
 		}
 
-		auto range = boost::make_shared<sensor_msgs::Range>();
+		auto range = range_pool.acquire();
 
 		range->header = m_uas->synchronized_header(sensor->frame_id, dist_sen.time_boot_ms);
 
@@ -269,8 +321,57 @@ private:
 			m_uas->tf2_broadcaster.sendTransform(transform);
 		}
 
+		if (aggregate) {
+			std::lock_guard<std::mutex> lock(scan_mutex);
+			sensor->last_range = range->range;
+			sensor->last_stamp = range->header.stamp;
+			scan_range_min = range->min_range;
+			scan_range_max = range->max_range;
+		}
+
 		sensor->pub.publish(range);
 	}
+
+	/**
+	 * @brief Publish one LaserScan assembled from the last reading of
+	 * every configured sensor.
+	 *
+	 * The ring is assumed uniform: beam angles come from the configured
+	 * sensor orientations sorted by yaw. Sensors that have not reported
+	 * for two cycles contribute an infinite range.
+	 */
+	void scan_cb(const ros::TimerEvent &event)
+	{
+		if (scan_pub.getNumSubscribers() == 0)
+			return;
+
+		auto scan = scan_pool.acquire();
+		auto stamp = ros::Time::now();
+		const ros::Duration stale(2.0 / aggregate_rate);
+
+		scan->header.stamp = stamp;
+		scan->header.frame_id = base_frame_id;
+
+		scan->angle_min = scan_items.front()->yaw;
+		scan->angle_increment = 2.0 * M_PI / scan_items.size();
+		scan->angle_max = scan->angle_min + scan->angle_increment * (scan_items.size() - 1);
+		scan->time_increment = 0.0;
+		scan->scan_time = 1.0 / aggregate_rate;
+
+		// clear() keeps the capacity of the pooled message
+		scan->ranges.clear();
+		scan->intensities.clear();
+
+		std::lock_guard<std::mutex> lock(scan_mutex);
+		scan->range_min = scan_range_min;
+		scan->range_max = scan_range_max;
+		for (auto &sensor : scan_items) {
+			bool no_data = sensor->last_stamp.isZero() || stamp - sensor->last_stamp > stale;
+			scan->ranges.push_back(no_data ? std::numeric_limits<float>::infinity() : sensor->last_range);
+		}
+
+		scan_pub.publish(scan);
+	}
 };
 
 void DistanceSensorItem::range_cb(const sensor_msgs::Range::ConstPtr &msg)
@@ -332,6 +433,11 @@ DistanceSensorItem::Ptr DistanceSensorItem::create_item(DistanceSensorPlugin *ow
 		// lookup for numeric value
 		p->orientation = utils::sensor_orientation_from_str(orientation_str);
 
+	if (p->orientation >= 0)
+		// beam heading for the aggregated scan
+		p->yaw = ftf::quaternion_get_yaw(utils::sensor_orientation_matching(
+				static_cast<mavlink::common::MAV_SENSOR_ORIENTATION>(p->orientation)));
+
 
 	if (!p->is_subscriber) {
 		// publisher params
@@ -43,7 +43,7 @@ public:
 	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
 	FakeGPSPlugin() : PluginBase(),
-		fp_nh("~fake_gps"),
+		fp_nh(plugin_ns("fake_gps")),
 		gps_rate(5.0),
 		use_mocap(true),
 		map_origin(0.0, 0.0, 0.0),
@@ -73,7 +73,7 @@ public:
 		fp_nh.param<int>("fix_type", ft_i, utils::enum_value(GPS_FIX_TYPE::NO_GPS));
 		fix_type = static_cast<GPS_FIX_TYPE>(ft_i);
 		fp_nh.param("gps_rate", _gps_rate, 5.0);		// GPS data rate of 5hz
-		gps_rate: _gps_rate;
+		gps_rate = ros::Rate(_gps_rate);
 		fp_nh.param("eph", eph, 2.0);
 		fp_nh.param("epv", epv, 2.0);
 		fp_nh.param<int>("satellites_visible", satellites_visible, 5);
@@ -98,6 +98,20 @@ public:
 			ROS_INFO_STREAM("FGPS: Caught exception: " << e.what() << std::endl);
 		}
 
+		// the origin never moves: build the ENU->ECEF rotation once from
+		// its basis vectors instead of recomputing the trig every sample
+		for (int i = 0; i < 3; i++)
+			enu_ecef_rot.col(i) = ftf::transform_frame_enu_ecef(
+					Eigen::Vector3d(Eigen::Vector3d::Unit(i)), map_origin);
+
+		// mocap volumes are tens of meters across, over which the geoid
+		// undulation is effectively constant: sample it once at the origin
+		if (m_uas->egm96_5)
+			origin_geoid_offset = GeographicLib::Geoid::ELLIPSOIDTOGEOID *
+					(*m_uas->egm96_5)(map_origin.x(), map_origin.y());
+		else
+			origin_geoid_offset = 0.0;
+
 		// source set params
 		fp_nh.param("use_mocap", use_mocap, true);		// listen to MoCap source
 		fp_nh.param("mocap_transform", mocap_transform, true);	// listen to MoCap source (TransformStamped if true; PoseStamped if false)
@@ -165,17 +179,26 @@ private:
 
 	Eigen::Vector3d map_origin;	//!< geodetic origin [lla]
 	Eigen::Vector3d ecef_origin;	//!< geocentric origin [m]
+	Eigen::Matrix3d enu_ecef_rot;	//!< cached ENU->ECEF rotation of the fixed origin
+	double origin_geoid_offset;	//!< geoid undulation at the origin [m]
 	Eigen::Vector3d old_ecef;	//!< previous geocentric position [m]
 	double old_stamp;		//!< previous stamp [s]
 
+	//! reused message: callbacks run on one thread and every field is reassigned
+	mavlink::common::msg::HIL_GPS fix;
+
 	/* -*- mid-level helpers and low-level send -*- */
 
 	/**
 	 * @brief Send fake GPS coordinates through HIL_GPS Mavlink msg
+	 *
+	 * Samples rejected by the rate gate cost nothing: the ENU->ECEF
+	 * rotation, geodetic reverse solve and message fill all happen
+	 * after the throttle check.
 	 */
-	void send_fake_gps(const ros::Time &stamp, const Eigen::Vector3d &ecef_offset) {
-		// Throttle incoming messages to 5hz
-		if ((ros::Time::now() - last_pos_time) < ros::Duration(gps_rate)) {
+	void send_fake_gps(const ros::Time &stamp, const Eigen::Vector3d &pos_enu) {
+		// Throttle incoming messages to gps_rate
+		if ((ros::Time::now() - last_pos_time) < gps_rate.expectedCycleTime()) {
 			return;
 		}
 		last_pos_time = ros::Time::now();
@@ -185,12 +208,8 @@ private:
 		 * if use_hil_gps flag is set (param MAV_USEHILGPS = 1).
 		 * @todo: add GPS_INPUT msg as an alternative, as Ardupilot already supports it
 		 */
-		mavlink::common::msg::HIL_GPS fix {};
-
 		Eigen::Vector3d geodetic;
-		Eigen::Vector3d current_ecef(ecef_origin.x() + ecef_offset.x(),
-					ecef_origin.y() + ecef_offset.y(),
-					ecef_origin.z() + ecef_offset.z());
+		Eigen::Vector3d current_ecef = ecef_origin + enu_ecef_rot * pos_enu;
 
 		try {
 			earth.Reverse(current_ecef.x(), current_ecef.y(), current_ecef.z(),
@@ -218,8 +237,7 @@ private:
 		fix.time_usec = stamp.toNSec() / 1000;	// [useconds]
 		fix.lat = geodetic.x() * 1e7;		// [degrees * 1e7]
 		fix.lon = geodetic.y() * 1e7;		// [degrees * 1e7]
-		fix.alt = (geodetic.z() + GeographicLib::Geoid::ELLIPSOIDTOGEOID *
-			  (*m_uas->egm96_5)(geodetic.x(), geodetic.y())) * 1e3;	// [meters * 1e3]
+		fix.alt = (geodetic.z() + origin_geoid_offset) * 1e3;	// [meters * 1e3]
 		fix.vel = vel.block<2, 1>(0, 0).norm();	// [cm/s]
 		fix.vn = vel.x();			// [cm/s]
 		fix.ve = vel.y();			// [cm/s]
@@ -243,7 +261,7 @@ private:
 		Eigen::Affine3d pos_enu;
 		tf::transformMsgToEigen(trans->transform, pos_enu);
 
-		send_fake_gps(trans->header.stamp, ftf::transform_frame_enu_ecef(Eigen::Vector3d(pos_enu.translation()), map_origin));
+		send_fake_gps(trans->header.stamp, Eigen::Vector3d(pos_enu.translation()));
 	}
 
 	void mocap_pose_cb(const geometry_msgs::PoseStamped::ConstPtr &req)
@@ -251,7 +269,7 @@ private:
 		Eigen::Affine3d pos_enu;
 		tf::poseMsgToEigen(req->pose, pos_enu);
 
-		send_fake_gps(req->header.stamp, ftf::transform_frame_enu_ecef(Eigen::Vector3d(pos_enu.translation()), map_origin));
+		send_fake_gps(req->header.stamp, Eigen::Vector3d(pos_enu.translation()));
 	}
 
 	void vision_cb(const geometry_msgs::PoseStamped::ConstPtr &req)
@@ -259,7 +277,7 @@ private:
 		Eigen::Affine3d pos_enu;
 		tf::poseMsgToEigen(req->pose, pos_enu);
 
-		send_fake_gps(req->header.stamp, ftf::transform_frame_enu_ecef(Eigen::Vector3d(pos_enu.translation()), map_origin));
+		send_fake_gps(req->header.stamp, Eigen::Vector3d(pos_enu.translation()));
 	}
 
 	void transform_cb(const geometry_msgs::TransformStamped &trans)
@@ -268,7 +286,7 @@ private:
 
 		tf::transformMsgToEigen(trans.transform, pos_enu);
 
-		send_fake_gps(trans.header.stamp, ftf::transform_frame_enu_ecef(Eigen::Vector3d(pos_enu.translation()), map_origin));
+		send_fake_gps(trans.header.stamp, Eigen::Vector3d(pos_enu.translation()));
 	}
 };
 }	// namespace extra_plugins
@@ -28,7 +28,7 @@ namespace extra_plugins {
 class GpsRtkPlugin : public plugin::PluginBase {
 public:
 	GpsRtkPlugin() : PluginBase(),
-		gps_rtk_nh("~gps_rtk")
+		gps_rtk_nh(plugin_ns("gps_rtk"))
 	{ }
 
 	void initialize(UAS &uas_)
@@ -46,16 +46,21 @@ private:
 	ros::NodeHandle gps_rtk_nh;
 	ros::Subscriber gps_rtk_sub;
 
+	//! reused fragment message: rtcm_cb runs on one callback thread,
+	//! so the buffer never needs to be rebuilt per burst
+	mavlink::common::msg::GPS_RTCM_DATA rtcm_data;
+
 	/* -*- callbacks -*- */
 	/**
 	 * @brief Handle mavros_msgs::RTCM message
 	 * It converts the message to the MAVLink GPS_RTCM_DATA message for GPS injection.
+	 * Fragments go out on the REALTIME TX band: correction age directly
+	 * degrades fix quality, so they must not queue behind bulk telemetry.
 	 * Message specification: https://mavlink.io/en/messages/common.html#GPS_RTCM_DATA
 	 * @param msg		Received ROS msg
 	 */
 	void rtcm_cb(const mavros_msgs::RTCM::ConstPtr &msg)
 	{
-		mavlink::common::msg::GPS_RTCM_DATA rtcm_data;
 		const size_t max_frag_len = rtcm_data.data.size();
 
 		uint8_t seq_u5 = uint8_t(msg->header.seq & 0x1F) << 3;
@@ -73,7 +78,7 @@ private:
 			rtcm_data.flags = seq_u5;
 			std::copy(data_it, end_it, rtcm_data.data.begin());
 			std::fill(rtcm_data.data.begin() + rtcm_data.len, rtcm_data.data.end(), 0);
-			UAS_FCU(m_uas)->send_message(rtcm_data);
+			UAS_FCU(m_uas)->send_message_ignore_drop(rtcm_data, mavconn::TxPrio::REALTIME);
 		} else {
 			for (uint8_t fragment_id = 0; fragment_id < 4 && data_it < end_it; fragment_id++) {
 				uint8_t len = std::min((size_t) std::distance(data_it, end_it), max_frag_len);
@@ -82,9 +87,11 @@ private:
 				rtcm_data.flags |= seq_u5;		// Next 5 bits are sequence id
 				rtcm_data.len = len;
 
+				// single pass: ROS message bytes land straight in the
+				// mavlink payload; only a short last fragment needs padding
 				std::copy(data_it, data_it + len, rtcm_data.data.begin());
 				std::fill(rtcm_data.data.begin() + len, rtcm_data.data.end(), 0);
-				UAS_FCU(m_uas)->send_message(rtcm_data);
+				UAS_FCU(m_uas)->send_message_ignore_drop(rtcm_data, mavconn::TxPrio::REALTIME);
 				std::advance(data_it, len);
 			}
 		}
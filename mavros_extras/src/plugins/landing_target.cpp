@@ -16,6 +16,7 @@
 
 #include <mavros/utils.h>
 #include <mavros/mavros_plugin.h>
+#include <mavros/msg_pool.h>
 #include <mavros/setpoint_mixin.h>
 #include <pluginlib/class_list_macros.h>
 #include <eigen_conversions/eigen_msg.h>
@@ -34,12 +35,17 @@ using mavlink::common::LANDING_TARGET_TYPE;
  *
  * This plugin is intended to publish the location of a landing area captured from a downward facing camera
  * to the FCU and/or receive landing target tracking data coming from the FCU.
+ *
+ * Everything derivable from parameters alone (angular target size, FOV
+ * pixel scale, target id, vision-type flag) is computed once in
+ * initialize(); the per-frame path only does the per-sample transform,
+ * so the camera-to-FCU latency stays bounded at tracker rates.
  */
 class LandingTargetPlugin : public plugin::PluginBase,
 	private plugin::TF2ListenerMixin<LandingTargetPlugin> {
 public:
 	LandingTargetPlugin() :
-		nh("~landing_target"),
+		nh(plugin_ns("landing_target")),
 		tf_rate(10.0),
 		send_tf(true),
 		listen_tf(false),
@@ -89,6 +95,14 @@ public:
 		nh.param<std::string>("tf/child_frame_id", tf_child_frame_id, "camera_center");
 		nh.param("tf/rate_limit", tf_rate, 50.0);
 
+		// constants of the per-frame math, derived from parameters only
+		is_vision_type = land_target_type.find("VISION") != std::string::npos;
+		fov_scale = {float(fov_x / image_width), float(fov_y / image_height)};
+		size_rad_static = {float(2 * (M_PI / 180.0) * atan(target_size_x / (2 * focal_length))),
+				   float(2 * (M_PI / 180.0) * atan(target_size_y / (2 * focal_length)))};
+		// the last char of frame_id is considered the number of the target
+		target_id = static_cast<uint8_t>(frame_id.back());
+
 		land_target_pub = nh.advertise<geometry_msgs::PoseStamped>("pose_in", 10);
 		lt_marker_pub = nh.advertise<geometry_msgs::Vector3Stamped>("lt_marker", 10);
 
@@ -137,6 +151,17 @@ private:
 	double focal_length;
 	int image_width, image_height;
 
+	bool is_vision_type;		//!< land_target_type names a vision tracker
+	Eigen::Vector2f fov_scale;	//!< FOV per pixel, precomputed [rad/px]
+	Eigen::Vector2f size_rad_static;	//!< angular target size at focal length, precomputed [rad]
+	uint8_t target_id;		//!< target number, from frame_id
+
+	MessagePool<geometry_msgs::PoseStamped> pose_pool;
+	MessagePool<geometry_msgs::Vector3Stamped> marker_pool;
+
+	int tf_num_cache = -1;		//!< target_num of the cached TF frame name
+	std::string tf_frame_cache;	//!< "landing_target_<num>", rebuilt on change only
+
 	MAV_FRAME frame;
 	std::string mav_frame;
 
@@ -219,6 +244,12 @@ private:
 	 * @brief Send landing target transform to FCU
 	 */
 	void send_landing_target(const ros::Time &stamp, const Eigen::Affine3d &tr) {
+		if (last_transform_stamp == stamp) {
+			ROS_DEBUG_THROTTLE_NAMED(10, "landing_target", "LT: Same transform as last one, dropped.");
+			return;
+		}
+		last_transform_stamp = stamp;
+
 		/**
 		 * @brief the position of the landing target WRT camera center - on the FCU,
 		 * the position WRT to the origin local NED frame can be computed to allow
@@ -232,28 +263,28 @@ private:
 
 		Eigen::Vector2f angle;
 		Eigen::Vector2f size_rad;
-		Eigen::Vector2f fov;
 
 		// the norm of the position vector is considered the distance to the landing target
 		float distance = pos.norm();
 
 		// if the landing target type is a vision type, compute the angular offsets
-		if (land_target_type.find("VISION")) {
+		if (is_vision_type) {
 			/**
 			 * @brief: the camera angular offsets can be computed by knowing the position
 			 * of the target center relative to the camera center, the field-of-view of
 			 * the camera and the image resolution being considered.
 			 * The target size is computed by the angle of view formula (similar to angular diameter).
 			 */
-			angle.x() = (pos.x() - image_width / 2.0) * fov.x() / image_width;
-			angle.y() = (pos.y() - image_height / 2.0) * fov.y() / image_height;
+			angle.x() = (pos.x() - image_width / 2.0) * fov_scale.x();
+			angle.y() = (pos.y() - image_height / 2.0) * fov_scale.y();
 			/**
 			 * @brief Angular diameter:
 			 * δ = 2 * atan(d / (2 * D))
 			 * where,	d = actual diameter; D = distance to the object (or focal length of a camera)
+			 *
+			 * with D the focal length, constant: precomputed in initialize()
 			 */
-			size_rad = {2 * (M_PI / 180.0) * atan(target_size_x / (2 * focal_length)),
-				    2 * (M_PI / 180.0) * atan(target_size_y / (2 * focal_length))};
+			size_rad = size_rad_static;
 		}
 		// else, the same values are computed considering the displacement relative to X and Y axes of the camera frame reference
 		else {
@@ -262,29 +293,20 @@ private:
 				    2 * (M_PI / 180.0) * atan(target_size_y / (2 * distance))};
 		}
 
-		if (last_transform_stamp == stamp) {
-			ROS_DEBUG_THROTTLE_NAMED(10, "landing_target", "LT: Same transform as last one, dropped.");
-			return;
-		}
-		last_transform_stamp = stamp;
-
 		auto rpy = ftf::quaternion_to_rpy(q);
 
-		// the last char of frame_id is considered the number of the target
-		uint8_t id = static_cast<uint8_t>(frame_id.back());
-
 		ROS_DEBUG_THROTTLE_NAMED(10, "landing_target", "Tx landing target: "
 					"ID: %d frame: %s angular offset: X:%1.3frad, Y:%1.3frad) "
 					"distance: %1.3fm position: X:%1.3fm, Y:%1.3fm, Z:%1.3fm) "
 					"orientation: roll:%1.4frad pitch:%1.4frad yaw:%1.4frad "
 					"size: X:%1.3frad by Y:%1.3frad type: %s",
-					id, utils::to_string(static_cast<MAV_FRAME>(frame)).c_str(),
+					target_id, utils::to_string(static_cast<MAV_FRAME>(frame)).c_str(),
 					angle.x(), angle.y(), distance, pos.x(), pos.y(), pos.z(),
 					rpy.x(), rpy.y(), rpy.z(), size_rad.x(), size_rad.y(),
 					utils::to_string(static_cast<LANDING_TARGET_TYPE>(type)).c_str());
 
 		landing_target(stamp.toNSec() / 1000,
-					id,
+					target_id,
 					utils::enum_value(frame),	// by default, in LOCAL_NED
 					angle,
 					distance,
@@ -317,33 +339,45 @@ private:
 					position.x(), position.y(), position.z(), rpy.x(), rpy.y(), rpy.z(), land_target.size_x, land_target.size_y,
 					utils::to_string(static_cast<LANDING_TARGET_TYPE>(land_target.type)).c_str());
 
-		auto pose = boost::make_shared<geometry_msgs::PoseStamped>();
-		pose->header = m_uas->synchronized_header(frame_id, land_target.time_usec);
+		auto header = m_uas->synchronized_header(frame_id, land_target.time_usec);
+
+		if (land_target_pub.getNumSubscribers() > 0) {
+			auto pose = pose_pool.acquire();
+			pose->header = header;
 
-		tf::pointEigenToMsg(position, pose->pose.position);
-		tf::quaternionEigenToMsg(orientation, pose->pose.orientation);
+			tf::pointEigenToMsg(position, pose->pose.position);
+			tf::quaternionEigenToMsg(orientation, pose->pose.orientation);
 
-		land_target_pub.publish(pose);
+			land_target_pub.publish(pose);
+		}
 
 		if (send_tf) {
 			geometry_msgs::TransformStamped transform;
 
-			transform.header.stamp = pose->header.stamp;
-			transform.header.frame_id = "landing_target_" + boost::lexical_cast<std::string>(land_target.target_num);
+			if (tf_num_cache != land_target.target_num) {
+				tf_num_cache = land_target.target_num;
+				tf_frame_cache = "landing_target_" + boost::lexical_cast<std::string>(land_target.target_num);
+			}
+
+			transform.header.stamp = header.stamp;
+			transform.header.frame_id = tf_frame_cache;
 			transform.child_frame_id = tf_child_frame_id;
 
-			transform.transform.rotation = pose->pose.orientation;
+			tf::quaternionEigenToMsg(orientation, transform.transform.rotation);
 			tf::vectorEigenToMsg(position, transform.transform.translation);
 
 			m_uas->tf2_broadcaster.sendTransform(transform);
 		}
 
-		auto tg_size_msg = boost::make_shared<geometry_msgs::Vector3Stamped>();
-		Eigen::Vector3d target_size(target_size_x, target_size_y, 0.0);
+		if (lt_marker_pub.getNumSubscribers() > 0) {
+			auto tg_size_msg = marker_pool.acquire();
+			Eigen::Vector3d target_size(target_size_x, target_size_y, 0.0);
 
-		tf::vectorEigenToMsg(target_size, tg_size_msg->vector);
+			tg_size_msg->header = header;
+			tf::vectorEigenToMsg(target_size, tg_size_msg->vector);
 
-		lt_marker_pub.publish(tg_size_msg);
+			lt_marker_pub.publish(tg_size_msg);
+		}
 	}
 
 	/* -*- callbacks -*- */
@@ -1,5 +1,15 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <map>
+
 #include <mavros/mavros_plugin.h>
 #include <mavros_msgs/LogData.h>
+#include <mavros_msgs/LogDownload.h>
+#include <mavros_msgs/LogDownloadProgress.h>
 #include <mavros_msgs/LogEntry.h>
 #include <mavros_msgs/LogRequestData.h>
 #include <mavros_msgs/LogRequestEnd.h>
@@ -7,17 +17,40 @@
 
 namespace mavros {
 namespace extra_plugins {
+//! LOG_DATA payload size: the unit of the download bitmap
+static constexpr uint64_t CHUNK = 90;
+
 class LogTransferPlugin : public plugin::PluginBase {
 public:
 	LogTransferPlugin() :
-		nh("~log_transfer") {}
+		nh(plugin_ns("log_transfer")),
+		dl_map(nullptr),
+		dl_id(0),
+		dl_size(0),
+		dl_chunks(0),
+		dl_received_chunks(0),
+		win_start(0),
+		win_chunks(512) {}
+
+	~LogTransferPlugin()
+	{
+		if (dl_map)
+			munmap(dl_map, dl_size);
+	}
 
 	void initialize(UAS& uas) override
 	{
 		PluginBase::initialize(uas);
 
+		int win_bytes;
+		double timeout;
+		nh.param("download/window", win_bytes, 46080);	// [bytes] pipelined request depth
+		nh.param("download/timeout", timeout, 1.0);	// [s] gap re-request delay
+		win_chunks = std::max<uint64_t>(1, win_bytes / CHUNK);
+
 		log_entry_pub = nh.advertise<mavros_msgs::LogEntry>("raw/log_entry", 1000);
 		log_data_pub = nh.advertise<mavros_msgs::LogData>("raw/log_data", 1000);
+		progress_pub = nh.advertise<mavros_msgs::LogDownloadProgress>("download/progress", 10);
 
 		log_request_list_srv = nh.advertiseService("raw/log_request_list",
 					&LogTransferPlugin::log_request_list_cb, this);
@@ -25,6 +58,11 @@ public:
 					&LogTransferPlugin::log_request_data_cb, this);
 		log_request_end_srv = nh.advertiseService("raw/log_request_end",
 					&LogTransferPlugin::log_request_end_cb, this);
+		download_srv = nh.advertiseService("download",
+					&LogTransferPlugin::download_cb, this);
+
+		retry_timer = nh.createTimer(ros::Duration(timeout),
+					&LogTransferPlugin::retry_cb, this, false, false);
 	}
 
 	Subscriptions get_subscriptions() override
@@ -37,8 +75,31 @@ public:
 
 private:
 	ros::NodeHandle nh;
-	ros::Publisher log_entry_pub, log_data_pub;
+	ros::Publisher log_entry_pub, log_data_pub, progress_pub;
 	ros::ServiceServer log_request_list_srv, log_request_data_srv, log_request_end_srv;
+	ros::ServiceServer download_srv;
+	ros::Timer retry_timer;
+
+	std::mutex mutex;
+	std::map<uint16_t, uint64_t> log_sizes;	//!< sizes learned from LOG_ENTRY
+
+	// active download: LOG_DATA payloads land straight in the mmap'd
+	// target file; chunk_map tracks which CHUNK-sized pieces arrived
+	uint8_t *dl_map;
+	uint16_t dl_id;
+	uint64_t dl_size;
+	uint64_t dl_chunks;
+	uint64_t dl_received_chunks;
+	uint64_t win_start;		//!< first chunk of the in-flight window
+	uint64_t win_chunks;		//!< window depth [chunks]
+	std::vector<uint8_t> chunk_map;
+	std::string dl_file;
+	ros::Time dl_start;
+	ros::Time dl_last_data;
+	ros::Time dl_last_progress;
+
+	bool chunk_seen(uint64_t c) const { return chunk_map[c / 8] & (1 << (c % 8)); }
+	void chunk_mark(uint64_t c) { chunk_map[c / 8] |= 1 << (c % 8); }
 
 	void handle_log_entry(const mavlink::mavlink_message_t*, mavlink::common::msg::LOG_ENTRY& le)
 	{
@@ -50,21 +111,230 @@ private:
 		msg->time_utc = ros::Time(le.time_utc);
 		msg->size = le.size;
 		log_entry_pub.publish(msg);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		log_sizes[le.id] = le.size;
 	}
 
 	void handle_log_data(const mavlink::mavlink_message_t*, mavlink::common::msg::LOG_DATA& ld)
 	{
-		auto msg = boost::make_shared<mavros_msgs::LogData>();
-		msg->header.stamp = ros::Time::now();
-		msg->id = ld.id;
-		msg->offset = ld.ofs;
-
 		auto count = ld.count;
 		if (count > ld.data.max_size()) {
 			count = ld.data.max_size();
 		}
-		msg->data.insert(msg->data.cbegin(), ld.data.cbegin(), ld.data.cbegin() + count);
-		log_data_pub.publish(msg);
+
+		if (log_data_pub.getNumSubscribers() > 0) {
+			auto msg = boost::make_shared<mavros_msgs::LogData>();
+			msg->header.stamp = ros::Time::now();
+			msg->id = ld.id;
+			msg->offset = ld.ofs;
+			msg->data.insert(msg->data.cbegin(), ld.data.cbegin(), ld.data.cbegin() + count);
+			log_data_pub.publish(msg);
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!dl_map || ld.id != dl_id || ld.ofs >= dl_size || count == 0)
+			return;
+
+		uint64_t len = std::min<uint64_t>(count, dl_size - ld.ofs);
+		std::memcpy(dl_map + ld.ofs, ld.data.data(), len);
+
+		for (uint64_t c = ld.ofs / CHUNK; c <= (ld.ofs + len - 1) / CHUNK; c++) {
+			if (!chunk_seen(c)) {
+				chunk_mark(c);
+				dl_received_chunks++;
+			}
+		}
+
+		dl_last_data = ros::Time::now();
+
+		if (dl_received_chunks >= dl_chunks) {
+			finish_download();
+			return;
+		}
+
+		// slide the window forward as soon as its head is solid, so the
+		// FCU always has win_chunks worth of requests in flight
+		while (win_start < dl_chunks && window_complete())
+			advance_window();
+
+		if (dl_last_data - dl_last_progress > ros::Duration(0.5)) {
+			dl_last_progress = dl_last_data;
+			publish_progress(false);
+		}
+	}
+
+	/* -*- download engine (requires mutex) -*- */
+
+	bool window_complete()
+	{
+		uint64_t end = std::min(win_start + win_chunks, dl_chunks);
+		for (uint64_t c = win_start; c < end; c++)
+			if (!chunk_seen(c))
+				return false;
+
+		return true;
+	}
+
+	void advance_window()
+	{
+		win_start = std::min(win_start + win_chunks, dl_chunks);
+		if (win_start < dl_chunks)
+			request_missing();
+	}
+
+	//! Re-request only the gaps: one LOG_REQUEST_DATA per missing run
+	void request_missing()
+	{
+		uint64_t end = std::min(win_start + win_chunks, dl_chunks);
+
+		for (uint64_t c = win_start; c < end; ) {
+			if (chunk_seen(c)) {
+				c++;
+				continue;
+			}
+
+			uint64_t run_end = c;
+			while (run_end < end && !chunk_seen(run_end))
+				run_end++;
+
+			mavlink::common::msg::LOG_REQUEST_DATA msg {};
+			m_uas->msg_set_target(msg);
+			msg.id = dl_id;
+			msg.ofs = c * CHUNK;
+			msg.count = std::min((run_end - c) * CHUNK, dl_size - c * CHUNK);
+			UAS_FCU(m_uas)->send_message_ignore_drop(msg);
+
+			c = run_end;
+		}
+	}
+
+	void publish_progress(bool complete)
+	{
+		if (progress_pub.getNumSubscribers() == 0)
+			return;
+
+		auto msg = boost::make_shared<mavros_msgs::LogDownloadProgress>();
+		msg->header.stamp = ros::Time::now();
+		msg->id = dl_id;
+		msg->size = dl_size;
+		msg->received = std::min(dl_received_chunks * CHUNK, dl_size);
+		double dt = (msg->header.stamp - dl_start).toSec();
+		msg->rate = dt > 0.0 ? msg->received / dt / 1e3 : 0.0;	// [kB/s]
+		msg->complete = complete;
+		progress_pub.publish(msg);
+	}
+
+	void finish_download()
+	{
+		double dt = (ros::Time::now() - dl_start).toSec();
+		ROS_INFO_NAMED("log_transfer", "LT: log %u done: %.1f MB in %.1f s (%.0f kB/s) -> %s",
+				dl_id, dl_size / 1e6, dt,
+				dt > 0.0 ? dl_size / dt / 1e3 : 0.0,
+				dl_file.c_str());
+
+		publish_progress(true);
+
+		msync(dl_map, dl_size, MS_SYNC);
+		munmap(dl_map, dl_size);
+		dl_map = nullptr;
+		retry_timer.stop();
+
+		mavlink::common::msg::LOG_REQUEST_END end {};
+		m_uas->msg_set_target(end);
+		UAS_FCU(m_uas)->send_message_ignore_drop(end);
+	}
+
+	void abort_download()
+	{
+		munmap(dl_map, dl_size);
+		dl_map = nullptr;
+		retry_timer.stop();
+		ROS_INFO_NAMED("log_transfer", "LT: log %u download aborted", dl_id);
+	}
+
+	/* -*- callbacks -*- */
+
+	void retry_cb(const ros::TimerEvent &event)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!dl_map || event.current_real - dl_last_data < ros::Duration(0.5))
+			return;
+
+		ROS_WARN_THROTTLE_NAMED(10, "log_transfer", "LT: log %u stalled at %.0f%%, re-requesting gaps",
+				dl_id, 100.0 * dl_received_chunks / dl_chunks);
+		request_missing();
+	}
+
+	bool download_cb(mavros_msgs::LogDownload::Request &req,
+				mavros_msgs::LogDownload::Response &res)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if (req.file.empty()) {
+			if (dl_map)
+				abort_download();
+
+			res.success = true;
+			return true;
+		}
+
+		if (dl_map) {
+			res.success = false;
+			res.message = "download already in progress";
+			return true;
+		}
+
+		uint64_t size = req.size;
+		if (size == 0) {
+			auto it = log_sizes.find(req.id);
+			if (it == log_sizes.end()) {
+				res.success = false;
+				res.message = "log size unknown, run raw/log_request_list first";
+				return true;
+			}
+			size = it->second;
+		}
+
+		int fd = open(req.file.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+		if (fd < 0) {
+			res.success = false;
+			res.message = "can not create " + req.file;
+			return true;
+		}
+
+		if (ftruncate(fd, size) < 0) {
+			close(fd);
+			res.success = false;
+			res.message = "can not size " + req.file;
+			return true;
+		}
+
+		auto map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		close(fd);	// the mapping holds its own reference
+		if (map == MAP_FAILED) {
+			res.success = false;
+			res.message = "mmap failed for " + req.file;
+			return true;
+		}
+
+		dl_map = static_cast<uint8_t *>(map);
+		dl_id = req.id;
+		dl_size = size;
+		dl_file = req.file;
+		dl_chunks = (size + CHUNK - 1) / CHUNK;
+		dl_received_chunks = 0;
+		chunk_map.assign((dl_chunks + 7) / 8, 0);
+		win_start = 0;
+		dl_start = dl_last_data = dl_last_progress = ros::Time::now();
+
+		request_missing();	// first window
+		retry_timer.start();
+
+		ROS_INFO_NAMED("log_transfer", "LT: downloading log %u (%.1f MB) to %s",
+				dl_id, dl_size / 1e6, dl_file.c_str());
+		res.success = true;
+		return true;
 	}
 
 	bool log_request_list_cb(mavros_msgs::LogRequestList::Request &req,
@@ -15,6 +15,7 @@
  * https://github.com/mavlink/mavros/tree/master/LICENSE.md
  */
 
+#include <mavros/external_pose.h>
 #include <mavros/mavros_plugin.h>
 #include <eigen_conversions/eigen_msg.h>
 
@@ -28,12 +29,25 @@ namespace extra_plugins{
  * @brief MocapPoseEstimate plugin
  *
  * Sends motion capture data to FCU.
+ * Registered with the external pose arbiter, so it can run alongside
+ * the vision/odometry sources without double-feeding the estimator.
+ *
+ * With ~mocap/rate set, the stream is downsampled to that link budget:
+ * bracketing samples are interpolated onto the send-slot time and
+ * time_usec is mapped onto the FCU timebase via the timesync offset,
+ * so a 250 Hz capture stream neither floods the link nor carries
+ * transport jitter into the EKF innovations.
  */
 class MocapPoseEstimatePlugin : public plugin::PluginBase
 {
 public:
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
 	MocapPoseEstimatePlugin() : PluginBase(),
-		mp_nh("~mocap")
+		mp_nh(plugin_ns("mocap")),
+		source_id(0),
+		rate(0.0),
+		have_prev(false)
 	{ }
 
 	void initialize(UAS &uas_)
@@ -42,6 +56,7 @@ public:
 
 		bool use_tf;
 		bool use_pose;
+		int source_priority;
 
 		/** @note For VICON ROS package, subscribe to TransformStamped topic */
 		mp_nh.param("use_tf", use_tf, false);
@@ -49,6 +64,15 @@ public:
 		/** @note For Optitrack ROS package, subscribe to PoseStamped topic */
 		mp_nh.param("use_pose", use_pose, true);
 
+		// arbitration between external localization sources
+		mp_nh.param("source_priority", source_priority, 10);
+		source_id = m_uas->ep_arbiter.add_source("mocap", source_priority);
+
+		// link budget [Hz]; 0 forwards every sample unchanged
+		mp_nh.param("rate", rate, 0.0);
+		if (rate > 0.0)
+			send_dt = ros::Duration(1.0 / rate);
+
 		if (use_tf && !use_pose) {
 			mocap_tf_sub = mp_nh.subscribe("tf", 1, &MocapPoseEstimatePlugin::mocap_tf_cb, this);
 		}
@@ -71,61 +95,112 @@ private:
 	ros::Subscriber mocap_pose_sub;
 	ros::Subscriber mocap_tf_sub;
 
+	external_pose::Arbiter::SourceId source_id;
+
+	double rate;			//!< send budget [Hz]; 0: forward all
+	ros::Duration send_dt;		//!< send slot length (1/rate)
+	bool have_prev;
+	ros::Time prev_stamp;		//!< previous sample, for interpolation
+	ros::Time last_sent;		//!< stamp of the last sent (slot) sample
+	Eigen::Vector3d prev_pos;
+	Eigen::Quaterniond prev_q;
+
 	/* -*- low-level send -*- */
-	void mocap_pose_send
-		(uint64_t usec,
-			Eigen::Quaterniond &q,
-			Eigen::Vector3d &v)
+	void mocap_pose_send(const external_pose::Sample &sample)
 	{
 		mavlink::common::msg::ATT_POS_MOCAP pos;
 
-		pos.time_usec = usec;
-		ftf::quaternion_to_mavlink(q, pos.q);
-		pos.x = v.x();
-		pos.y = v.y();
-		pos.z = v.z();
+		pos.time_usec = sample.usec;
+		ftf::quaternion_to_mavlink(sample.orientation, pos.q);
+		pos.x = sample.position.x();
+		pos.y = sample.position.y();
+		pos.z = sample.position.z();
 
 		UAS_FCU(m_uas)->send_message_ignore_drop(pos);
 	}
 
 	/* -*- mid-level helpers -*- */
+
+	//! Map a ROS stamp onto the FCU timebase using the timesync offset
+	uint64_t fcu_usec_from_stamp(const ros::Time &stamp)
+	{
+		uint64_t ros_ns = stamp.toNSec();
+		uint64_t offset_ns = m_uas->get_time_offset();
+
+		if (offset_ns > 0 && ros_ns > offset_ns)
+			return (ros_ns - offset_ns) / 1000;
+
+		return ros_ns / 1000;	// no timesync yet: fall back to ROS time
+	}
+
+	//! Convert and send one (possibly interpolated) sample, FCU-stamped
+	void send_at(const ros::Time &stamp, const Eigen::Vector3d &pos, const Eigen::Quaterniond &q)
+	{
+		auto sample = external_pose::sample_from_enu(stamp, pos, q);
+		sample.usec = fcu_usec_from_stamp(stamp);
+		mocap_pose_send(sample);
+	}
+
+	/**
+	 * @brief Downsample the capture stream to the link budget.
+	 *
+	 * One sample goes out per send slot. It is interpolated from the
+	 * two samples bracketing the slot time and stamped with the slot
+	 * time itself (back-dated), so transport jitter on the mocap side
+	 * never reaches the EKF.
+	 */
+	void process_sample(const ros::Time &stamp, const Eigen::Vector3d &pos, const Eigen::Quaterniond &q)
+	{
+		if (!m_uas->ep_arbiter.should_send(source_id))
+			return;
+
+		if (send_dt.isZero()) {
+			mocap_pose_send(external_pose::sample_from_enu(stamp, pos, q));
+			return;
+		}
+
+		// first sample or stream restart: send as-is and rearm
+		if (!have_prev || stamp <= prev_stamp || stamp - prev_stamp > ros::Duration(1.0)) {
+			send_at(stamp, pos, q);
+			last_sent = stamp;
+		}
+		else {
+			ros::Time target = last_sent + send_dt;
+			if (stamp >= target) {
+				double alpha = (target - prev_stamp).toSec() / (stamp - prev_stamp).toSec();
+				alpha = std::max(0.0, std::min(1.0, alpha));
+
+				Eigen::Vector3d p = prev_pos + alpha * (pos - prev_pos);
+				Eigen::Quaterniond rot = prev_q.slerp(alpha, q);
+
+				send_at(target, p, rot);
+				last_sent = target;
+			}
+			// else: inside the current send slot, sample only kept as
+			// the next interpolation bracket
+		}
+
+		have_prev = true;
+		prev_stamp = stamp;
+		prev_pos = pos;
+		prev_q = q;
+	}
+
+	/* -*- callbacks -*- */
 	void mocap_pose_cb(const geometry_msgs::PoseStamped::ConstPtr &pose)
 	{
 		Eigen::Quaterniond q_enu;
-
 		tf::quaternionMsgToEigen(pose->pose.orientation, q_enu);
-		auto q = ftf::transform_orientation_enu_ned(
-					ftf::transform_orientation_baselink_aircraft(q_enu));
-
-		auto position = ftf::transform_frame_enu_ned(
-				Eigen::Vector3d(
-					pose->pose.position.x,
-					pose->pose.position.y,
-					pose->pose.position.z));
-
-		mocap_pose_send(pose->header.stamp.toNSec() / 1000,
-				q,
-				position);
+
+		process_sample(pose->header.stamp, ftf::to_eigen(pose->pose.position), q_enu);
 	}
 
-	/* -*- callbacks -*- */
 	void mocap_tf_cb(const geometry_msgs::TransformStamped::ConstPtr &trans)
 	{
 		Eigen::Quaterniond q_enu;
-
 		tf::quaternionMsgToEigen(trans->transform.rotation, q_enu);
-		auto q = ftf::transform_orientation_enu_ned(
-					ftf::transform_orientation_baselink_aircraft(q_enu));
-
-		auto position = ftf::transform_frame_enu_ned(
-				Eigen::Vector3d(
-					trans->transform.translation.x,
-					trans->transform.translation.y,
-					trans->transform.translation.z));
-
-		mocap_pose_send(trans->header.stamp.toNSec() / 1000,
-				q,
-				position);
+
+		process_sample(trans->header.stamp, ftf::to_eigen(trans->transform.translation), q_enu);
 	}
 };
 }	// namespace extra_plugins
@@ -14,12 +14,15 @@
  * https://github.com/mavlink/mavros/tree/master/LICENSE.md
  */
 
+#include <mutex>
+
 #include <mavros/mavros_plugin.h>
 
 #include <mavros_msgs/CommandLong.h>
 #include <mavros_msgs/MountControl.h>
 #include <geometry_msgs/Quaternion.h>
 #include <mavros_msgs/MountConfigure.h>
+#include <std_msgs/Float64.h>
 
 namespace mavros {
 namespace extra_plugins {
@@ -34,20 +37,37 @@ using utils::enum_value;
  *
  * Publishes Mission commands to control the camera or antenna mount.
  * @see command_cb()
+ *
+ * With ~mount_control/send_rate set, command topic messages coalesce in
+ * a latest-wins slot drained at that rate: when the link backs up, stale
+ * targets are overwritten instead of queued, so a 50 Hz tracking loop
+ * never builds up commands in flight. Commands go through the realtime
+ * TX band, and the delay between a sent command and the next
+ * MOUNT_ORIENTATION feedback is published for loop-delay compensation.
  */
 class MountControlPlugin : public plugin::PluginBase {
 public:
 	MountControlPlugin() : PluginBase(),
-	nh("~"),
-	mount_nh("~mount_control")
+	nh(plugin_ns("")),
+	mount_nh(plugin_ns("mount_control")),
+	send_rate(0.0),
+	cmd_pending(false),
+	awaiting_feedback(false)
 	{ }
 
 	void initialize(UAS &uas_)
 	{
 		PluginBase::initialize(uas_);
 
+		// command slot drain rate [Hz]; 0 sends every message immediately
+		mount_nh.param("send_rate", send_rate, 0.0);
+		if (send_rate > 0.0)
+			send_timer = mount_nh.createTimer(ros::Duration(1.0 / send_rate),
+						&MountControlPlugin::send_slot_cb, this);
+
 		command_sub = mount_nh.subscribe("command", 10, &MountControlPlugin::command_cb, this);
 		mount_orientation_pub = mount_nh.advertise<geometry_msgs::Quaternion>("orientation", 10);
+		feedback_latency_pub = mount_nh.advertise<std_msgs::Float64>("feedback_latency", 10);
 		configure_srv = mount_nh.advertiseService("configure", &MountControlPlugin::mount_configure_cb, this);
 
 	}
@@ -64,7 +84,19 @@ private:
 	ros::NodeHandle mount_nh;
 	ros::Subscriber command_sub;
 	ros::Publisher mount_orientation_pub;
+	ros::Publisher feedback_latency_pub;
  	ros::ServiceServer configure_srv;
+	ros::Timer send_timer;
+
+	double send_rate;		//!< command slot drain rate [Hz]; 0: immediate
+
+	//! latest-wins command slot (guarded by cmd_mutex)
+	std::mutex cmd_mutex;
+	bool cmd_pending;
+	mavros_msgs::MountControl cmd_slot;
+
+	bool awaiting_feedback;		//!< a command is out, latency not yet measured
+	ros::Time last_cmd_time;
 
 	/**
 	 * @brief Publish the mount orientation
@@ -79,30 +111,86 @@ private:
 		geometry_msgs::Quaternion quaternion_msg;
 		tf::quaternionEigenToMsg(q, quaternion_msg);
 		mount_orientation_pub.publish(quaternion_msg);
+
+		// command-to-feedback delay, one measurement per sent command
+		ros::Time cmd_time;
+		{
+			std::lock_guard<std::mutex> lock(cmd_mutex);
+			if (!awaiting_feedback)
+				return;
+
+			awaiting_feedback = false;
+			cmd_time = last_cmd_time;
+		}
+
+		if (feedback_latency_pub.getNumSubscribers() > 0) {
+			std_msgs::Float64 latency;
+			latency.data = (ros::Time::now() - cmd_time).toSec();
+			feedback_latency_pub.publish(latency);
+		}
 	}
 
 	/**
-	 * @brief Send mount control commands to vehicle
+	 * @brief Send one mount control command to the vehicle
 	 *
 	 * Message specification: https://mavlink.io/en/messages/common.html#MAV_CMD_DO_MOUNT_CONTROL
-	 * @param req	received MountControl msg
+	 * @param req	MountControl msg to translate
 	 */
-	void command_cb(const mavros_msgs::MountControl::ConstPtr &req)
+	void send_command(const mavros_msgs::MountControl &req)
 	{
 		mavlink::common::msg::COMMAND_LONG cmd {};
 
 		cmd.target_system = m_uas->get_tgt_system();
 		cmd.target_component = m_uas->get_tgt_component();
 		cmd.command = enum_value(MAV_CMD::DO_MOUNT_CONTROL);
-		cmd.param1 = req->pitch;
-		cmd.param2 = req->roll;
-		cmd.param3 = req->yaw;
-		cmd.param4 = req->altitude; // 
-		cmd.param5 = req->latitude; // lattitude in degrees * 1E7
-		cmd.param6 = req->longitude; // longitude in degrees * 1E7
-		cmd.param7 = req->mode; // MAV_MOUNT_MODE
-
-		UAS_FCU(m_uas)->send_message_ignore_drop(cmd);
+		cmd.param1 = req.pitch;
+		cmd.param2 = req.roll;
+		cmd.param3 = req.yaw;
+		cmd.param4 = req.altitude; //
+		cmd.param5 = req.latitude; // lattitude in degrees * 1E7
+		cmd.param6 = req.longitude; // longitude in degrees * 1E7
+		cmd.param7 = req.mode; // MAV_MOUNT_MODE
+
+		// tracking commands must overtake queued telemetry
+		UAS_FCU(m_uas)->send_message_ignore_drop(cmd, mavconn::TxPrio::REALTIME);
+	}
+
+	/**
+	 * @brief Route one command: send immediately, or park it in the
+	 * latest-wins slot for the next drain.
+	 */
+	void command_cb(const mavros_msgs::MountControl::ConstPtr &req)
+	{
+		std::lock_guard<std::mutex> lock(cmd_mutex);
+
+		if (send_rate <= 0.0) {
+			send_command(*req);
+			last_cmd_time = ros::Time::now();
+			awaiting_feedback = true;
+			return;
+		}
+
+		// an unsent older target gets overwritten: latest wins
+		cmd_slot = *req;
+		cmd_pending = true;
+	}
+
+	void send_slot_cb(const ros::TimerEvent &event)
+	{
+		mavros_msgs::MountControl cmd;
+
+		{
+			std::lock_guard<std::mutex> lock(cmd_mutex);
+			if (!cmd_pending)
+				return;
+
+			cmd_pending = false;
+			cmd = cmd_slot;
+			last_cmd_time = event.current_real;
+			awaiting_feedback = true;
+		}
+
+		send_command(cmd);
 	}
 
     bool mount_configure_cb(mavros_msgs::MountConfigure::Request &req,
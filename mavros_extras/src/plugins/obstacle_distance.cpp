@@ -36,7 +36,7 @@ using mavlink::common::MAV_DISTANCE_SENSOR;
 class ObstacleDistancePlugin : public plugin::PluginBase {
 public:
 	ObstacleDistancePlugin() : PluginBase(),
-		obstacle_nh("~obstacle")
+		obstacle_nh(plugin_ns("obstacle"))
 	{ }
 
 	void initialize(UAS &uas_)
@@ -61,26 +61,34 @@ private:
 
 	mavlink::common::MAV_FRAME frame;
 
+	//! reused message: obstacle_cb runs on one callback thread and
+	//! every field is reassigned per scan
+	mavlink::common::msg::OBSTACLE_DISTANCE obstacle;
+
+	using BinArray = Eigen::Array<uint16_t, Eigen::Dynamic, 1>;
+
 	/**
 	 * @brief Send obstacle distance array to the FCU.
 	 *
+	 * The meters-to-centimeter-bin conversion runs as one fused Eigen
+	 * pass (scale, clamp, cast); NaN fails both clamp comparisons and
+	 * lands on "unknown" like out-of-range values.
+	 *
 	 * Message specification: https://mavlink.io/en/messages/common.html#OBSTACLE_DISTANCE
 	 * @param req	received ObstacleDistance msg
 	 */
 	void obstacle_cb(const sensor_msgs::LaserScan::ConstPtr &req)
 	{
-		mavlink::common::msg::OBSTACLE_DISTANCE obstacle {};
+		const float UNKNOWN = UINT16_MAX;
 
 		if (req->ranges.size() <= obstacle.distances.size()) {
 			// all distances from sensor will fit in obstacle distance message
-			for (int i = 0; i < req->ranges.size(); i++) {
-				float distance_cm = req->ranges[i] * 1e2;
-				if (std::isnan(distance_cm) || distance_cm >= UINT16_MAX || distance_cm < 0) {
-					obstacle.distances[i] = UINT16_MAX;
-				} else {
-					obstacle.distances[i] = static_cast<uint16_t>(distance_cm);
-				}
-			}
+			Eigen::Map<const Eigen::ArrayXf> ranges(req->ranges.data(), req->ranges.size());
+			Eigen::Map<BinArray> bins(obstacle.distances.data(), req->ranges.size());
+
+			auto cm = ranges * 1e2f;
+			bins = ((cm >= 0.0f) && (cm < UNKNOWN)).select(cm, UNKNOWN).cast<uint16_t>();
+
 			std::fill(obstacle.distances.begin() + req->ranges.size(), obstacle.distances.end(), UINT16_MAX);	//!< fill the rest of the array values as "Unknown"
 
 			const float increment_deg = req->angle_increment * RAD_TO_DEG;
@@ -90,18 +98,21 @@ private:
 			// all distances from sensor will not fit so we combine adjacent distances always taking the shortest distance
 			size_t scale_factor = ceil(double(req->ranges.size()) / obstacle.distances.size());
 			for (size_t i = 0; i < obstacle.distances.size(); i++) {
-				obstacle.distances[i] = UINT16_MAX;
-				for (size_t j = 0; j < scale_factor; j++) {
-					size_t req_index = i * scale_factor + j;
-					if (req_index < req->ranges.size()) {
-						float distance_cm = req->ranges[req_index] * 1e2;
-						if (!std::isnan(distance_cm) && distance_cm < UINT16_MAX && distance_cm > 0) {
-							obstacle.distances[i] = std::min(obstacle.distances[i], static_cast<uint16_t>(distance_cm));
-						}
-					}
+				size_t start = i * scale_factor;
+				if (start >= req->ranges.size()) {
+					obstacle.distances[i] = UINT16_MAX;
+					continue;
 				}
+
+				size_t len = std::min(scale_factor, req->ranges.size() - start);
+				auto cm = Eigen::Map<const Eigen::ArrayXf>(req->ranges.data() + start, len) * 1e2f;
+				obstacle.distances[i] = static_cast<uint16_t>(
+						((cm > 0.0f) && (cm < UNKNOWN)).select(cm, UNKNOWN).minCoeff());
 			}
-			obstacle.increment = ceil(req->angle_increment * RAD_TO_DEG * scale_factor);	//!< [degrees]
+
+			const float increment_deg = req->angle_increment * RAD_TO_DEG * scale_factor;
+			obstacle.increment = ceil(increment_deg);	//!< [degrees]
+			obstacle.increment_f = increment_deg;		//!< v2 extension: exact fractional increment
 		}
 
 		obstacle.time_usec = req->header.stamp.toNSec() / 1000;					//!< [microsecs]
@@ -109,6 +120,7 @@ private:
 		obstacle.min_distance = req->range_min * 1e2;							//!< [centimeters]
 		obstacle.max_distance = req->range_max * 1e2;							//!< [centimeters]
 		obstacle.frame = utils::enum_value(frame);
+		obstacle.angle_offset = req->angle_min * RAD_TO_DEG;	//!< v2 extension: scan start angle [degrees]
 
 		ROS_DEBUG_STREAM_NAMED("obstacle_distance", "OBSDIST: sensor type: " << utils::to_string_enum<MAV_DISTANCE_SENSOR>(obstacle.sensor_type)
 										     << std::endl << obstacle.to_yaml());
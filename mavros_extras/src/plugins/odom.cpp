@@ -16,6 +16,7 @@
  * https://github.com/mavlink/mavros/tree/master/LICENSE.md
  */
 
+#include <mavros/external_pose.h>
 #include <mavros/mavros_plugin.h>
 #include <tf2_eigen/tf2_eigen.h>
 #include <boost/algorithm/string.hpp>
@@ -45,9 +46,10 @@ public:
 	EIGEN_MAKE_ALIGNED_OPERATOR_NEW		// XXX(vooon): added to try to fix #1223. Not sure that it is needed because class do not have Eigen:: fields.
 
 	OdometryPlugin() : PluginBase(),
-		odom_nh("~odometry"),
+		odom_nh(plugin_ns("odometry")),
 		fcu_odom_parent_id_des("map"),
-		fcu_odom_child_id_des("base_link")
+		fcu_odom_child_id_des("base_link"),
+		source_id(0)
 	{ }
 
 	void initialize(UAS &uas_)
@@ -58,6 +60,12 @@ public:
 		odom_nh.param<std::string>("fcu/odom_parent_id_des", fcu_odom_parent_id_des, "map");
 		odom_nh.param<std::string>("fcu/odom_child_id_des", fcu_odom_child_id_des, "base_link");
 
+		// arbitration between external localization sources; odometry
+		// carries the richest state, so it outranks mocap/vision by default
+		int source_priority;
+		odom_nh.param("source_priority", source_priority, 30);
+		source_id = m_uas->ep_arbiter.add_source("odometry", source_priority);
+
 		// publishers
 		odom_pub = odom_nh.advertise<nav_msgs::Odometry>("in", 10);
 
@@ -80,6 +88,8 @@ private:
 	std::string fcu_odom_parent_id_des;			//!< desired orientation of the fcu odometry message's parent frame
 	std::string fcu_odom_child_id_des;			//!< desired orientation of the fcu odometry message's child frame
 
+	external_pose::Arbiter::SourceId source_id;		//!< this plugin's external pose source handle
+
 	/**
 	 * @brief Lookup static transform with error handling
 	 * @param[in] &target The parent frame of the transformation you want to get
@@ -196,6 +206,9 @@ private:
 	 */
 	void odom_cb(const nav_msgs::Odometry::ConstPtr &odom)
 	{
+		if (!m_uas->ep_arbiter.should_send(source_id))
+			return;
+
 		/**
 		 * Required affine rotations to apply transforms
 		 */
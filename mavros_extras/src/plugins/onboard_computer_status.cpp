@@ -14,6 +14,13 @@
  * https://github.com/mavlink/mavros/tree/master/LICENSE.md
  */
 
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <array>
+#include <cstdlib>
+#include <cstring>
+
 #include <mavros/mavros_plugin.h>
 
 #include <mavros_msgs/OnboardComputerStatus.h>
@@ -25,18 +32,65 @@ namespace extra_plugins {
  *
  * Publishes the status of the onboard computer
  * @see status_cb()
+ *
+ * With ~onboard_computer/self_sampling/rate set, the plugin originates
+ * ONBOARD_COMPUTER_STATUS itself: /proc/stat, /proc/meminfo, /proc/uptime
+ * and the thermal zones are re-read through file descriptors opened once
+ * at startup into a reused parse buffer, aggregated with an EWMA, and
+ * sent at a low configurable rate through the bulk TX band - health
+ * telemetry without a companion-side publisher or per-sample allocations.
  */
 class OnboardComputerStatusPlugin : public plugin::PluginBase {
 public:
 	OnboardComputerStatusPlugin() : PluginBase(),
-		status_nh("~onboard_computer")
-	{ }
+		status_nh(plugin_ns("onboard_computer")),
+		sample_rate(0.0),
+		send_rate(0.2),
+		ewma_alpha(0.2),
+		stat_fd(-1),
+		meminfo_fd(-1),
+		uptime_fd(-1),
+		zone_count(0),
+		have_prev_cpu(false),
+		have_sample(false),
+		ram_usage_ewma(-1.0f),
+		ram_total_mib(0),
+		uptime_ms(0)
+	{
+		zone_fds.fill(-1);
+		cpu_ewma.fill(-1.0f);
+		temp_ewma.fill(-1.0f);
+	}
+
+	~OnboardComputerStatusPlugin()
+	{
+		close_fd(stat_fd);
+		close_fd(meminfo_fd);
+		close_fd(uptime_fd);
+		for (auto &fd : zone_fds)
+			close_fd(fd);
+	}
 
 	void initialize(UAS &uas_)
 	{
 		PluginBase::initialize(uas_);
 
 		status_sub = status_nh.subscribe("status", 10, &OnboardComputerStatusPlugin::status_cb, this);
+
+		// self-sampling: /proc sample rate [Hz]; 0 keeps topic-only mode
+		status_nh.param("self_sampling/rate", sample_rate, 0.0);
+		// send rate towards GCS [Hz]
+		status_nh.param("self_sampling/send_rate", send_rate, 0.2);
+		// EWMA gain for the sampled loads/temperatures
+		status_nh.param("self_sampling/ewma_alpha", ewma_alpha, 0.2);
+
+		if (sample_rate > 0.0) {
+			open_sources();
+			sample_timer = status_nh.createTimer(ros::Duration(1.0 / sample_rate),
+						&OnboardComputerStatusPlugin::sample_cb, this);
+			send_timer = status_nh.createTimer(ros::Duration(1.0 / send_rate),
+						&OnboardComputerStatusPlugin::send_cb, this);
+		}
 	}
 
 	Subscriptions get_subscriptions()
@@ -47,6 +101,244 @@ public:
 private:
 	ros::NodeHandle status_nh;
 	ros::Subscriber status_sub;
+	ros::Timer sample_timer;
+	ros::Timer send_timer;
+
+	double sample_rate;		//!< /proc sample rate [Hz]; 0: topic-only
+	double send_rate;		//!< ONBOARD_COMPUTER_STATUS send rate [Hz]
+	double ewma_alpha;		//!< EWMA gain
+
+	static constexpr size_t MAX_CPUS = 8;	//!< cpu_cores[] size in the wire message
+	static constexpr size_t MAX_ZONES = 8;	//!< temperature_core[] size in the wire message
+
+	// preopened sources; /proc and sysfs files re-read with pread(,,0)
+	int stat_fd;
+	int meminfo_fd;
+	int uptime_fd;
+	std::array<int, MAX_ZONES> zone_fds;
+	size_t zone_count;
+	char parse_buf[8192];		//!< reused parse buffer, no per-sample allocation
+
+	struct CpuTimes {
+		uint64_t busy;
+		uint64_t total;
+	};
+	std::array<CpuTimes, MAX_CPUS + 1> prev_cpu;	//!< [0]: aggregate, [1..]: per core
+	bool have_prev_cpu;
+
+	// EWMA state (negative: no sample yet)
+	bool have_sample;
+	std::array<float, MAX_CPUS + 1> cpu_ewma;	//!< load [%]; [0]: aggregate
+	float ram_usage_ewma;				//!< [MiB]
+	uint32_t ram_total_mib;
+	std::array<float, MAX_ZONES> temp_ewma;		//!< [degC]
+	uint32_t uptime_ms;
+
+	static void close_fd(int &fd)
+	{
+		if (fd >= 0)
+			::close(fd);
+		fd = -1;
+	}
+
+	void open_sources()
+	{
+		stat_fd = ::open("/proc/stat", O_RDONLY);
+		meminfo_fd = ::open("/proc/meminfo", O_RDONLY);
+		uptime_fd = ::open("/proc/uptime", O_RDONLY);
+
+		if (stat_fd < 0 || meminfo_fd < 0)
+			ROS_WARN_NAMED("onboard_computer", "OCS: cannot open /proc: %s", strerror(errno));
+
+		char path[64];
+		for (size_t zone = 0; zone_count < MAX_ZONES && zone < 16; zone++) {
+			snprintf(path, sizeof(path), "/sys/class/thermal/thermal_zone%zu/temp", zone);
+
+			int fd = ::open(path, O_RDONLY);
+			if (fd >= 0)
+				zone_fds[zone_count++] = fd;
+		}
+
+		ROS_INFO_NAMED("onboard_computer", "OCS: self-sampling at %.1f Hz, %zu thermal zones",
+					sample_rate, zone_count);
+	}
+
+	//! Re-read one preopened file into the shared parse buffer
+	ssize_t read_source(int fd)
+	{
+		if (fd < 0)
+			return -1;
+
+		ssize_t len = ::pread(fd, parse_buf, sizeof(parse_buf) - 1, 0);
+		if (len >= 0)
+			parse_buf[len] = '\0';
+
+		return len;
+	}
+
+	void ewma_update(float &acc, float value)
+	{
+		if (acc < 0.0f)
+			acc = value;
+		else
+			acc += ewma_alpha * (value - acc);
+	}
+
+	/* -*- samplers -*- */
+
+	void sample_cpu()
+	{
+		if (read_source(stat_fd) <= 0)
+			return;
+
+		std::array<CpuTimes, MAX_CPUS + 1> cur = prev_cpu;
+
+		for (char *line = parse_buf; line != nullptr && *line != '\0'; ) {
+			char *next = strchr(line, '\n');
+			if (next != nullptr)
+				next++;
+
+			if (strncmp(line, "cpu", 3) != 0) {
+				line = next;
+				continue;
+			}
+
+			// "cpu" aggregate -> slot 0, "cpuN" -> slot N + 1
+			char *p = line + 3;
+			size_t slot = 0;
+			if (*p != ' ') {
+				size_t core = strtoul(p, &p, 10);
+				if (core >= MAX_CPUS) {
+					line = next;
+					continue;
+				}
+				slot = core + 1;
+			}
+
+			// user nice system idle iowait irq softirq steal
+			uint64_t v[8] = {};
+			for (auto &f : v)
+				f = strtoull(p, &p, 10);
+
+			uint64_t total = 0;
+			for (auto f : v)
+				total += f;
+
+			cur[slot].total = total;
+			cur[slot].busy = total - v[3] - v[4];	// - idle - iowait
+
+			line = next;
+		}
+
+		if (have_prev_cpu) {
+			for (size_t i = 0; i < cur.size(); i++) {
+				uint64_t dtotal = cur[i].total - prev_cpu[i].total;
+				if (dtotal == 0)
+					continue;
+
+				ewma_update(cpu_ewma[i], 100.0f * (cur[i].busy - prev_cpu[i].busy) / dtotal);
+			}
+		}
+
+		prev_cpu = cur;
+		have_prev_cpu = true;
+	}
+
+	//! @return value of a "Key:  N kB" meminfo row [kB], or 0
+	uint64_t meminfo_value(const char *key)
+	{
+		char *row = strstr(parse_buf, key);
+		if (row == nullptr)
+			return 0;
+
+		return strtoull(row + strlen(key), nullptr, 10);
+	}
+
+	void sample_memory()
+	{
+		if (read_source(meminfo_fd) <= 0)
+			return;
+
+		uint64_t total_kib = meminfo_value("MemTotal:");
+		uint64_t avail_kib = meminfo_value("MemAvailable:");
+
+		if (total_kib == 0)
+			return;
+
+		ram_total_mib = total_kib / 1024;
+		ewma_update(ram_usage_ewma, (total_kib - avail_kib) / 1024.0f);
+	}
+
+	void sample_thermal()
+	{
+		for (size_t i = 0; i < zone_count; i++) {
+			if (read_source(zone_fds[i]) <= 0)
+				continue;
+
+			// sysfs reports millidegree C
+			ewma_update(temp_ewma[i], strtol(parse_buf, nullptr, 10) / 1000.0f);
+		}
+	}
+
+	void sample_uptime()
+	{
+		if (read_source(uptime_fd) <= 0)
+			return;
+
+		uptime_ms = strtod(parse_buf, nullptr) * 1e3;
+	}
+
+	/* -*- timer callbacks -*- */
+
+	void sample_cb(const ros::TimerEvent &event)
+	{
+		sample_cpu();
+		sample_memory();
+		sample_thermal();
+		sample_uptime();
+		have_sample = true;
+	}
+
+	void send_cb(const ros::TimerEvent &event)
+	{
+		if (!have_sample)
+			return;
+
+		mavlink::common::msg::ONBOARD_COMPUTER_STATUS status {};
+
+		status.time_usec = ros::Time::now().toNSec() / 1000;
+		status.uptime = uptime_ms;
+		status.type = 0;	// mission computer
+
+		status.ram_total = ram_total_mib;
+		status.ram_usage = ram_usage_ewma < 0.0f ? 0 : ram_usage_ewma;
+
+		// unused array entries are flagged per the message spec
+		status.cpu_combined[0] = cpu_ewma[0] < 0.0f ? UINT8_MAX : cpu_ewma[0];
+		std::fill(status.cpu_combined.begin() + 1, status.cpu_combined.end(), UINT8_MAX);
+		for (size_t i = 0; i < MAX_CPUS; i++)
+			status.cpu_cores[i] = cpu_ewma[i + 1] < 0.0f ? UINT8_MAX : cpu_ewma[i + 1];
+
+		status.gpu_cores.fill(UINT8_MAX);
+		status.gpu_combined.fill(UINT8_MAX);
+
+		status.temperature_board = zone_count > 0 && temp_ewma[0] >= 0.0f ? temp_ewma[0] : 0;
+		for (size_t i = 0; i < MAX_ZONES; i++)
+			status.temperature_core[i] = temp_ewma[i] < 0.0f ? INT8_MAX : temp_ewma[i];
+
+		status.fan_speed.fill(INT16_MAX);
+		status.storage_type.fill(UINT32_MAX);
+		status.storage_usage.fill(UINT32_MAX);
+		status.storage_total.fill(UINT32_MAX);
+		status.link_type.fill(UINT32_MAX);
+		status.link_tx_rate.fill(UINT32_MAX);
+		status.link_rx_rate.fill(UINT32_MAX);
+		status.link_tx_max.fill(UINT32_MAX);
+		status.link_rx_max.fill(UINT32_MAX);
+
+		// periodic telemetry: never ahead of commands or streams
+		UAS_FCU(m_uas)->send_message_ignore_drop(status, mavconn::TxPrio::BULK);
+	}
 
 	/**
 	 * @brief Send onboard computer status to FCU and groundstation
@@ -103,8 +395,6 @@ private:
 		std::copy(req->link_rx_max.cbegin(), req->link_rx_max.cend(), status.link_rx_max.begin());
 		// [[[end]]] (checksum: 98538293a5932dfb5952d4badd311b39)
 
-		std::cout << "timestamp: " << status.time_usec << "\n";
-
 		UAS_FCU(m_uas)->send_message_ignore_drop(status, req->component);
 	}
 };
@@ -16,11 +16,15 @@
  * https://github.com/mavlink/mavros/tree/master/LICENSE.md
  */
 
+#include <mutex>
+
 #include <mavros/mavros_plugin.h>
+#include <mavros/msg_pool.h>
 
 #include <mavros_msgs/OpticalFlowRad.h>
 #include <sensor_msgs/Temperature.h>
 #include <sensor_msgs/Range.h>
+#include <std_msgs/Empty.h>
 
 namespace mavros {
 namespace extra_plugins{
@@ -28,14 +32,22 @@ namespace extra_plugins{
  * @brief PX4 Optical Flow plugin
  *
  * This plugin can publish data from PX4Flow camera to ROS
+ *
+ * It also keeps a quality-gated running integral of the flow: each
+ * OPTICAL_FLOW_RAD sample with quality >= ~px4flow/integrator/min_quality
+ * is folded into an accumulator (O(1), using the sensor's own
+ * integration_time_us), published on ~px4flow/integrated and zeroed via
+ * ~px4flow/integrated/reset. A VIO consumer takes the preintegrated
+ * flow once per keyframe instead of re-accumulating at message rate.
  */
 class PX4FlowPlugin : public plugin::PluginBase {
 public:
 	PX4FlowPlugin() : PluginBase(),
-		flow_nh("~px4flow"),
+		flow_nh(plugin_ns("px4flow")),
 		ranger_fov(0.0),
 		ranger_min_range(0.3),
-		ranger_max_range(5.0)
+		ranger_max_range(5.0),
+		integ_min_quality(0)
 	{ }
 
 	void initialize(UAS &uas_)
@@ -55,11 +67,16 @@ public:
 		flow_nh.param("ranger_min_range", ranger_min_range, 0.3);
 		flow_nh.param("ranger_max_range", ranger_max_range, 5.0);
 
+		// flow samples below this quality are excluded from the integral
+		flow_nh.param("integrator/min_quality", integ_min_quality, 0);
+
 		flow_rad_pub = flow_nh.advertise<mavros_msgs::OpticalFlowRad>("raw/optical_flow_rad", 10);
 		range_pub = flow_nh.advertise<sensor_msgs::Range>("ground_distance", 10);
 		temp_pub = flow_nh.advertise<sensor_msgs::Temperature>("temperature", 10);
+		integrated_pub = flow_nh.advertise<mavros_msgs::OpticalFlowRad>("integrated", 10);
 
 		flow_rad_sub = flow_nh.subscribe("raw/send", 1, &PX4FlowPlugin::send_cb, this);
+		integ_reset_sub = flow_nh.subscribe("integrated/reset", 1, &PX4FlowPlugin::integ_reset_cb, this);
 	}
 
 	Subscriptions get_subscriptions()
@@ -81,7 +98,26 @@ private:
 	ros::Publisher flow_rad_pub;
 	ros::Publisher range_pub;
 	ros::Publisher temp_pub;
+	ros::Publisher integrated_pub;
 	ros::Subscriber flow_rad_sub;
+	ros::Subscriber integ_reset_sub;
+
+	MessagePool<mavros_msgs::OpticalFlowRad> flow_pool;
+	MessagePool<sensor_msgs::Temperature> temp_pool;
+	MessagePool<sensor_msgs::Range> range_pool;
+	MessagePool<mavros_msgs::OpticalFlowRad> integ_pool;
+
+	int integ_min_quality;		//!< quality gate for the integral
+
+	/**
+	 * Keyframe flow integral: sums of the baselink-frame integrated
+	 * samples since the last reset (guarded by integ_mutex).
+	 */
+	std::mutex integ_mutex;
+	Eigen::Vector2d integ_xy {0.0, 0.0};
+	Eigen::Vector3d integ_gyro {0.0, 0.0, 0.0};
+	uint32_t integ_time_us = 0;
+	uint8_t integ_min_q = UINT8_MAX;	//!< worst accepted sample quality
 
 	void handle_optical_flow_rad(const mavlink::mavlink_message_t *msg, mavlink::common::msg::OPTICAL_FLOW_RAD &flow_rad)
 	{
@@ -104,32 +140,37 @@ private:
 					flow_rad.integrated_ygyro,
 					flow_rad.integrated_zgyro));
 
-		auto flow_rad_msg = boost::make_shared<mavros_msgs::OpticalFlowRad>();
+		if (flow_rad_pub.getNumSubscribers() > 0) {
+			auto flow_rad_msg = flow_pool.acquire();
 
-		flow_rad_msg->header = header;
-		flow_rad_msg->integration_time_us = flow_rad.integration_time_us;
+			flow_rad_msg->header = header;
+			flow_rad_msg->integration_time_us = flow_rad.integration_time_us;
 
-		flow_rad_msg->integrated_x = int_xy.x();
-		flow_rad_msg->integrated_y = int_xy.y();
+			flow_rad_msg->integrated_x = int_xy.x();
+			flow_rad_msg->integrated_y = int_xy.y();
 
-		flow_rad_msg->integrated_xgyro = int_gyro.x();
-		flow_rad_msg->integrated_ygyro = int_gyro.y();
-		flow_rad_msg->integrated_zgyro = int_gyro.z();
+			flow_rad_msg->integrated_xgyro = int_gyro.x();
+			flow_rad_msg->integrated_ygyro = int_gyro.y();
+			flow_rad_msg->integrated_zgyro = int_gyro.z();
 
-		flow_rad_msg->temperature = flow_rad.temperature / 100.0f;	// in degrees celsius
-		flow_rad_msg->time_delta_distance_us = flow_rad.time_delta_distance_us;
-		flow_rad_msg->distance = flow_rad.distance;
-		flow_rad_msg->quality = flow_rad.quality;
+			flow_rad_msg->temperature = flow_rad.temperature / 100.0f;	// in degrees celsius
+			flow_rad_msg->time_delta_distance_us = flow_rad.time_delta_distance_us;
+			flow_rad_msg->distance = flow_rad.distance;
+			flow_rad_msg->quality = flow_rad.quality;
 
-		flow_rad_pub.publish(flow_rad_msg);
+			flow_rad_pub.publish(flow_rad_msg);
+		}
 
 		// Temperature
-		auto temp_msg = boost::make_shared<sensor_msgs::Temperature>();
+		if (temp_pub.getNumSubscribers() > 0) {
+			auto temp_msg = temp_pool.acquire();
 
-		temp_msg->header = header;
-		temp_msg->temperature = flow_rad_msg->temperature;
+			temp_msg->header = header;
+			temp_msg->temperature = flow_rad.temperature / 100.0f;
+			temp_msg->variance = 0.0;
 
-		temp_pub.publish(temp_msg);
+			temp_pub.publish(temp_msg);
+		}
 
 		// Rangefinder
 		/**
@@ -140,17 +181,59 @@ private:
 		 * @todo: suggest modification on MAVLink OPTICAL_FLOW_RAD msg
 		 * which removes sonar data fields from it
 		 */
-		auto range_msg = boost::make_shared<sensor_msgs::Range>();
-
-		range_msg->header = header;
+		if (range_pub.getNumSubscribers() > 0) {
+			auto range_msg = range_pool.acquire();
+
+			range_msg->header = header;
+
+			range_msg->radiation_type = sensor_msgs::Range::ULTRASOUND;
+			range_msg->field_of_view = ranger_fov;
+			range_msg->min_range = ranger_min_range;
+			range_msg->max_range = ranger_max_range;
+			range_msg->range = flow_rad.distance;
+
+			range_pub.publish(range_msg);
+		}
+
+		// Keyframe integral: fold this sample in and publish the
+		// running totals; the rest of the fields carry latest values
+		if (flow_rad.quality >= integ_min_quality) {
+			std::lock_guard<std::mutex> lock(integ_mutex);
+
+			integ_xy += Eigen::Vector2d(int_xy.x(), int_xy.y());
+			integ_gyro += int_gyro;
+			integ_time_us += flow_rad.integration_time_us;
+			integ_min_q = std::min<uint8_t>(integ_min_q, flow_rad.quality);
+
+			if (integrated_pub.getNumSubscribers() > 0) {
+				auto integ_msg = integ_pool.acquire();
+
+				integ_msg->header = header;
+				integ_msg->integration_time_us = integ_time_us;
+				integ_msg->integrated_x = integ_xy.x();
+				integ_msg->integrated_y = integ_xy.y();
+				integ_msg->integrated_xgyro = integ_gyro.x();
+				integ_msg->integrated_ygyro = integ_gyro.y();
+				integ_msg->integrated_zgyro = integ_gyro.z();
+				integ_msg->temperature = flow_rad.temperature / 100.0f;
+				integ_msg->time_delta_distance_us = flow_rad.time_delta_distance_us;
+				integ_msg->distance = flow_rad.distance;
+				integ_msg->quality = integ_min_q;
+
+				integrated_pub.publish(integ_msg);
+			}
+		}
+	}
 
-		range_msg->radiation_type = sensor_msgs::Range::ULTRASOUND;
-		range_msg->field_of_view = ranger_fov;
-		range_msg->min_range = ranger_min_range;
-		range_msg->max_range = ranger_max_range;
-		range_msg->range = flow_rad.distance;
+	//! Keyframe boundary: zero the flow integral
+	void integ_reset_cb(const std_msgs::Empty::ConstPtr &msg)
+	{
+		std::lock_guard<std::mutex> lock(integ_mutex);
 
-		range_pub.publish(range_msg);
+		integ_xy.setZero();
+		integ_gyro.setZero();
+		integ_time_us = 0;
+		integ_min_q = UINT8_MAX;
 	}
 
 	void send_cb(const mavros_msgs::OpticalFlowRad::ConstPtr msg)
@@ -28,7 +28,7 @@ namespace extra_plugins {
 class RangefinderPlugin : public plugin::PluginBase {
 public:
 	RangefinderPlugin() : PluginBase(),
-		rangefinder_nh("~rangefinder")
+		rangefinder_nh(plugin_ns("rangefinder"))
 	{ }
 
 	void initialize(UAS &uas_)
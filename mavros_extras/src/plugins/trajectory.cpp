@@ -14,6 +14,7 @@
  * https://github.com/mavlink/mavros/tree/master/LICENSE.mdA
  */
 
+#include <array>
 #include <mavros/mavros_plugin.h>
 #include <mavros_msgs/Trajectory.h>
 #include <mavros_msgs/PositionTarget.h>
@@ -35,12 +36,16 @@ using RosPoints = mavros_msgs::PositionTarget;
  * @brief Trajectory plugin to receive planned path from the FCU and
  * send back to the FCU a corrected path (collision free, smoothed)
  *
+ * The wire message stores each component as a contiguous per-point
+ * array, so the ENU/NED conversion runs as one batched axis
+ * permutation per component instead of a transform per point.
+ *
  * @see trajectory_cb()
  */
 class TrajectoryPlugin : public plugin::PluginBase {
 public:
 	TrajectoryPlugin() : PluginBase(),
-		trajectory_nh("~trajectory")
+		trajectory_nh(plugin_ns("trajectory"))
 	{ }
 
 	void initialize(UAS &uas_)
@@ -67,141 +72,31 @@ private:
 
 	ros::Publisher trajectory_desired_pub;
 
-	// [[[cog:
-	// def outl_fill_points_ned_vector(x, y, z, vec_name, vec_type, point_xyz):
-	//     cog.outl(
-	//         """void fill_points_{vec_name}(MavPoints &{x}, MavPoints &{y}, MavPoints &{z}, const geometry_msgs::{vec_type} &{vec_name}, const size_t i)\n"""
-	//         """{{\n"""
-	//         """\tauto {vec_name}_ned = ftf::transform_frame_enu_ned(ftf::to_eigen({vec_name}));\n"""
-	//         .format(**locals())
-	//     )
-	//
-	//     for axis in "xyz":
-	//         cog.outl("\t{axis}[i] = {vec_name}_ned.{axis}();".format(**locals()))
-	//
-	//     cog.outl("}\n")
-	//
-	//
-	// outl_fill_points_ned_vector('x', 'y', 'z', 'position', 'Point', range(0, 3))
-	// outl_fill_points_ned_vector('x', 'y', 'z', 'velocity', 'Vector3', range(3, 6))
-	// outl_fill_points_ned_vector('x', 'y', 'z', 'acceleration', 'Vector3', range(6, 9))
-	// ]]]
-	void fill_points_position(MavPoints &x, MavPoints &y, MavPoints &z, const geometry_msgs::Point &position, const size_t i)
-	{
-		auto position_ned = ftf::transform_frame_enu_ned(ftf::to_eigen(position));
-
-		x[i] = position_ned.x();
-		y[i] = position_ned.y();
-		z[i] = position_ned.z();
-	}
+	//! contiguous per-point component row, gathered before the batch transform
+	using PointRow = Eigen::Array<float, NUM_POINTS, 1>;
+	//! Eigen view over one wire component array
+	using MavRow = Eigen::Map<Eigen::Array<float, NUM_POINTS, 1>>;
 
-	void fill_points_velocity(MavPoints &x, MavPoints &y, MavPoints &z, const geometry_msgs::Vector3 &velocity, const size_t i)
+	//! Trajectory keeps its points as five named fields; this view makes them iterable
+	static std::array<const RosPoints *, NUM_POINTS> point_view(const mavros_msgs::Trajectory &t)
 	{
-		auto velocity_ned = ftf::transform_frame_enu_ned(ftf::to_eigen(velocity));
-
-		x[i] = velocity_ned.x();
-		y[i] = velocity_ned.y();
-		z[i] = velocity_ned.z();
+		return {{ &t.point_1, &t.point_2, &t.point_3, &t.point_4, &t.point_5 }};
 	}
 
-	void fill_points_acceleration(MavPoints &x, MavPoints &y, MavPoints &z, const geometry_msgs::Vector3 &acceleration, const size_t i)
+	static std::array<RosPoints *, NUM_POINTS> point_view(mavros_msgs::Trajectory &t)
 	{
-		auto acceleration_ned = ftf::transform_frame_enu_ned(ftf::to_eigen(acceleration));
-
-		x[i] = acceleration_ned.x();
-		y[i] = acceleration_ned.y();
-		z[i] = acceleration_ned.z();
-	}
-
-	// [[[end]]] (checksum: 92ea0f7f329c90c486fdb8b738c0e7c3)
-
-
-	void fill_points_yaw_wp(MavPoints &y, const double yaw, const size_t i) {
-		y[i] = wrap_pi(-yaw + (M_PI / 2.0f));
+		return {{ &t.point_1, &t.point_2, &t.point_3, &t.point_4, &t.point_5 }};
 	}
 
-	void fill_points_yaw_speed(MavPoints &yv, const double yaw_speed, const size_t i) {
-		yv[i] = yaw_speed;
-	}
-
-	void fill_points_yaw_q(MavPoints &y, const geometry_msgs::Quaternion &orientation, const size_t i) {
+	double yaw_from_quaternion(const geometry_msgs::Quaternion &orientation)
+	{
 		auto q_wp = ftf::transform_orientation_enu_ned(
 					ftf::transform_orientation_baselink_aircraft(
 						ftf::to_eigen(orientation)));
-		auto yaw_wp = ftf::quaternion_get_yaw(q_wp);
-
-		y[i] = wrap_pi(-yaw_wp + (M_PI / 2.0f));
-	}
-
-	void fill_points_delta(MavPoints &y, const double time_horizon, const size_t i) {
-		y[i] = time_horizon;
-	}
-
-	auto fill_points_unused_path(mavlink::common::msg::TRAJECTORY_REPRESENTATION_WAYPOINTS & t, const size_t i) {
-		t.vel_x[i] = NAN;
-		t.vel_y[i] = NAN;
-		t.vel_z[i] = NAN;
-		t.acc_x[i] = NAN;
-		t.acc_y[i] = NAN;
-		t.acc_z[i] = NAN;
-		t.vel_yaw[i] = NAN;
-	}
-
-	void fill_points_all_unused(mavlink::common::msg::TRAJECTORY_REPRESENTATION_WAYPOINTS &t, const size_t i) {
-		t.pos_x[i] = NAN;
-		t.pos_y[i] = NAN;
-		t.pos_z[i] = NAN;
-
-		t.vel_x[i] = NAN;
-		t.vel_y[i] = NAN;
-		t.vel_z[i] = NAN;
-
-		t.acc_x[i] = NAN;
-		t.acc_y[i] = NAN;
-		t.acc_z[i] = NAN;
-
-		t.pos_yaw[i] = NAN;
-		t.vel_yaw[i] = NAN;
-	}
-
-	void fill_points_all_unused_bezier(mavlink::common::msg::TRAJECTORY_REPRESENTATION_BEZIER &t, const size_t i) {
-		t.pos_x[i] = NAN;
-		t.pos_y[i] = NAN;
-		t.pos_z[i] = NAN;
-
-		t.pos_yaw[i] = NAN;
-
-		t.delta[i] = NAN;
-	}
 
-	void fill_msg_position(geometry_msgs::Point &position, const mavlink::common::msg::TRAJECTORY_REPRESENTATION_WAYPOINTS &t, const size_t i)
-	{
-		auto position_enu = ftf::transform_frame_ned_enu(Eigen::Vector3d(t.pos_x[i], t.pos_y[i], t.pos_z[i]));
-
-		position.x = position_enu.x();
-		position.y = position_enu.y();
-		position.z = position_enu.z();
-	}
-
-	void fill_msg_velocity(geometry_msgs::Vector3 &velocity, const mavlink::common::msg::TRAJECTORY_REPRESENTATION_WAYPOINTS &t, const size_t i)
-	{
-		auto velocity_enu = ftf::transform_frame_ned_enu(Eigen::Vector3d(t.vel_x[i], t.vel_y[i], t.vel_z[i]));
-
-		velocity.x = velocity_enu.x();
-		velocity.y = velocity_enu.y();
-		velocity.z = velocity_enu.z();
-	}
-
-	void fill_msg_acceleration(geometry_msgs::Vector3 &acceleration, const mavlink::common::msg::TRAJECTORY_REPRESENTATION_WAYPOINTS &t, const size_t i)
-	{
-		auto acceleration_enu = ftf::transform_frame_ned_enu(Eigen::Vector3d(t.acc_x[i], t.acc_y[i], t.acc_z[i]));
-
-		acceleration.x = acceleration_enu.x();
-		acceleration.y = acceleration_enu.y();
-		acceleration.z = acceleration_enu.z();
+		return wrap_pi(-ftf::quaternion_get_yaw(q_wp) + (M_PI / 2.0f));
 	}
 
-
 	// -*- callbacks -*-
 
 	/**
@@ -214,78 +109,75 @@ private:
 	{
 		ROS_ASSERT(NUM_POINTS == req->point_valid.size());
 
+		// gather the ENU components into contiguous rows; invalid
+		// points stay NaN, so the batch transform below writes
+		// "unused" for them without a separate path
+		PointRow px, py, pz, vx, vy, vz, ax, ay, az, yaw, yaw_v, delta;
+		px.setConstant(NAN); py.setConstant(NAN); pz.setConstant(NAN);
+		vx.setConstant(NAN); vy.setConstant(NAN); vz.setConstant(NAN);
+		ax.setConstant(NAN); ay.setConstant(NAN); az.setConstant(NAN);
+		yaw.setConstant(NAN); yaw_v.setConstant(NAN); delta.setConstant(NAN);
+
+		uint8_t valid_points = 0;
+		const auto points = point_view(*req);
+
+		for (size_t i = 0; i < NUM_POINTS; i++) {
+			if (!req->point_valid[i])
+				continue;
+
+			valid_points++;
+			const auto &rp = *points[i];
+
+			px[i] = rp.position.x;
+			py[i] = rp.position.y;
+			pz[i] = rp.position.z;
+			vx[i] = rp.velocity.x;
+			vy[i] = rp.velocity.y;
+			vz[i] = rp.velocity.z;
+			ax[i] = rp.acceleration_or_force.x;
+			ay[i] = rp.acceleration_or_force.y;
+			az[i] = rp.acceleration_or_force.z;
+			yaw[i] = wrap_pi(-rp.yaw + (M_PI / 2.0f));
+			yaw_v[i] = rp.yaw_rate;
+			delta[i] = req->time_horizon[i];
+		}
+
 		if (req->type == mavros_msgs::Trajectory::MAV_TRAJECTORY_REPRESENTATION_WAYPOINTS) {
 			mavlink::common::msg::TRAJECTORY_REPRESENTATION_WAYPOINTS trajectory {};
 
-			auto fill_point_rep_waypoints = [&](mavlink::common::msg::TRAJECTORY_REPRESENTATION_WAYPOINTS & t, const RosPoints &rp, const size_t i) {
-				const auto valid = req->point_valid[i];
-
-				auto valid_so_far = trajectory.valid_points;
-				if (!valid) {
-					fill_points_all_unused(t, i);
-					return;
-				}
-
-				trajectory.valid_points = valid_so_far + 1;
-				fill_points_position(t.pos_x, t.pos_y, t.pos_z, rp.position, i);
-				fill_points_velocity(t.vel_x, t.vel_y, t.vel_z, rp.velocity, i);
-				fill_points_acceleration(t.acc_x, t.acc_y, t.acc_z, rp.acceleration_or_force, i);
-				fill_points_yaw_wp(t.pos_yaw, rp.yaw, i);
-				fill_points_yaw_speed(t.vel_yaw, rp.yaw_rate, i);
-				t.command[i] = UINT16_MAX;
-			};
-
-			// [[[cog:
-			// for i in range(5):
-			//      cog.outl(
-			//          'fill_point_rep_waypoints(trajectory, req->point_{i1}, {i0});'
-			//          .format(i0=i, i1=i+1)
-			//      )
-			// ]]]
-			fill_point_rep_waypoints(trajectory, req->point_1, 0);
-			fill_point_rep_waypoints(trajectory, req->point_2, 1);
-			fill_point_rep_waypoints(trajectory, req->point_3, 2);
-			fill_point_rep_waypoints(trajectory, req->point_4, 3);
-			fill_point_rep_waypoints(trajectory, req->point_5, 4);
-			// [[[end]]] (checksum: e993aeb535c2df6f07bf7b4f1fcf3d2e)
-
+			// ENU -> NED is an axis permutation: swap x/y, negate z,
+			// one vector operation per component array
+			MavRow(trajectory.pos_x.data()) = py;
+			MavRow(trajectory.pos_y.data()) = px;
+			MavRow(trajectory.pos_z.data()) = -pz;
+			MavRow(trajectory.vel_x.data()) = vy;
+			MavRow(trajectory.vel_y.data()) = vx;
+			MavRow(trajectory.vel_z.data()) = -vz;
+			MavRow(trajectory.acc_x.data()) = ay;
+			MavRow(trajectory.acc_y.data()) = ax;
+			MavRow(trajectory.acc_z.data()) = -az;
+			MavRow(trajectory.pos_yaw.data()) = yaw;
+			MavRow(trajectory.vel_yaw.data()) = yaw_v;
+
+			for (size_t i = 0; i < NUM_POINTS; i++)
+				trajectory.command[i] = req->point_valid[i] ? UINT16_MAX : 0;
+
+			trajectory.valid_points = valid_points;
 			trajectory.time_usec = req->header.stamp.toNSec() / 1000;	//!< [milisecs]
 			UAS_FCU(m_uas)->send_message_ignore_drop(trajectory);
 		} else {
 			mavlink::common::msg::TRAJECTORY_REPRESENTATION_BEZIER trajectory {};
-			auto fill_point_rep_bezier = [&](mavlink::common::msg::TRAJECTORY_REPRESENTATION_BEZIER & t, const RosPoints &rp, const size_t i) {
-				const auto valid = req->point_valid[i];
-
-				auto valid_so_far = trajectory.valid_points;
-				if (!valid) {
-					fill_points_all_unused_bezier(t, i);
-					return;
-				}
-
-				trajectory.valid_points = valid_so_far + 1;
-				fill_points_position(t.pos_x, t.pos_y, t.pos_z, rp.position, i);
-				fill_points_yaw_wp(t.pos_yaw, rp.yaw, i);
-				fill_points_delta(t.delta, req->time_horizon[i], i);
-			};
-			// [[[cog:
-			// for i in range(5):
-			//      cog.outl(
-			//          'fill_point_rep_bezier(trajectory, req->point_{i1}, {i0});'
-			//          .format(i0=i, i1=i+1)
-			//      )
-			// ]]]
-			fill_point_rep_bezier(trajectory, req->point_1, 0);
-			fill_point_rep_bezier(trajectory, req->point_2, 1);
-			fill_point_rep_bezier(trajectory, req->point_3, 2);
-			fill_point_rep_bezier(trajectory, req->point_4, 3);
-			fill_point_rep_bezier(trajectory, req->point_5, 4);
-			// [[[end]]] (checksum: 3e6da5f06e0b33682c6122c40f05c1f6)
 
+			MavRow(trajectory.pos_x.data()) = py;
+			MavRow(trajectory.pos_y.data()) = px;
+			MavRow(trajectory.pos_z.data()) = -pz;
+			MavRow(trajectory.pos_yaw.data()) = yaw;
+			MavRow(trajectory.delta.data()) = delta;
+
+			trajectory.valid_points = valid_points;
 			trajectory.time_usec = req->header.stamp.toNSec() / 1000;	//!< [milisecs]
 			UAS_FCU(m_uas)->send_message_ignore_drop(trajectory);
 		}
-
-
 	}
 
 
@@ -302,31 +194,35 @@ private:
 		trajectory.time_usec = req->header.stamp.toNSec() / 1000;	//!< [milisecs]
 		trajectory.valid_points = std::min(NUM_POINTS, req->poses.size());
 
-		auto fill_point = [&](mavlink::common::msg::TRAJECTORY_REPRESENTATION_WAYPOINTS & t, const size_t i) {
-			t.command[i] = UINT16_MAX;
-			if (req->poses.size() < i + 1) {
-				fill_points_all_unused(t, i);
-			}
-			else {
-				auto &pose = req->poses[i].pose;
-
-				fill_points_position(t.pos_x, t.pos_y, t.pos_z, pose.position, i);
-				fill_points_yaw_q(t.pos_yaw, pose.orientation, i);
-				fill_points_unused_path(t, i);
-			}
-		};
+		PointRow px, py, pz, yaw;
+		px.setConstant(NAN); py.setConstant(NAN); pz.setConstant(NAN);
+		yaw.setConstant(NAN);
+
+		for (size_t i = 0; i < std::min(NUM_POINTS, req->poses.size()); i++) {
+			auto &pose = req->poses[i].pose;
+
+			px[i] = pose.position.x;
+			py[i] = pose.position.y;
+			pz[i] = pose.position.z;
+			yaw[i] = yaw_from_quaternion(pose.orientation);
+		}
 
-		// [[[cog:
-		// for i in range(5):
-		//      cog.outl(
-		//          'fill_point(trajectory, {i0});'.format(i0=i, i1=i+1))
-		// ]]]
-		fill_point(trajectory, 0);
-		fill_point(trajectory, 1);
-		fill_point(trajectory, 2);
-		fill_point(trajectory, 3);
-		fill_point(trajectory, 4);
-		// [[[end]]] (checksum: 267a911c65a3768f04a8230fcb235bca)
+		MavRow(trajectory.pos_x.data()) = py;
+		MavRow(trajectory.pos_y.data()) = px;
+		MavRow(trajectory.pos_z.data()) = -pz;
+		MavRow(trajectory.pos_yaw.data()) = yaw;
+
+		// velocity, acceleration and yaw speed are not derivable from a Path
+		MavRow(trajectory.vel_x.data()).setConstant(NAN);
+		MavRow(trajectory.vel_y.data()).setConstant(NAN);
+		MavRow(trajectory.vel_z.data()).setConstant(NAN);
+		MavRow(trajectory.acc_x.data()).setConstant(NAN);
+		MavRow(trajectory.acc_y.data()).setConstant(NAN);
+		MavRow(trajectory.acc_z.data()).setConstant(NAN);
+		MavRow(trajectory.vel_yaw.data()).setConstant(NAN);
+
+		for (size_t i = 0; i < NUM_POINTS; i++)
+			trajectory.command[i] = UINT16_MAX;
 
 		UAS_FCU(m_uas)->send_message_ignore_drop(trajectory);
 	}
@@ -335,41 +231,32 @@ private:
 	{
 		auto tr_desired = boost::make_shared<mavros_msgs::Trajectory>();
 
-		auto fill_msg_point = [&](RosPoints & p, const mavlink::common::msg::TRAJECTORY_REPRESENTATION_WAYPOINTS & t, const size_t i) {
-			fill_msg_position(p.position, t, i);
-			fill_msg_velocity(p.velocity, t, i);
-			fill_msg_acceleration(p.acceleration_or_force, t, i);
-			p.yaw = wrap_pi((M_PI / 2.0f) - t.pos_yaw[i]);
-			p.yaw_rate = t.vel_yaw[i];
-			tr_desired->command[i] = t.command[i];
-		};
-
 		tr_desired->header = m_uas->synchronized_header("local_origin", trajectory.time_usec);
 
-		for (int i = 0; i < trajectory.valid_points; ++i)
-		{
-			tr_desired->point_valid[i] = true;
+		for (size_t i = 0; i < NUM_POINTS; ++i)
+			tr_desired->point_valid[i] = i < trajectory.valid_points;
+
+		// NED -> ENU is the same permutation: read the swapped wire
+		// rows directly while scattering into the named point fields
+		auto points = point_view(*tr_desired);
+
+		for (size_t i = 0; i < NUM_POINTS; i++) {
+			auto &p = *points[i];
+
+			p.position.x = trajectory.pos_y[i];
+			p.position.y = trajectory.pos_x[i];
+			p.position.z = -trajectory.pos_z[i];
+			p.velocity.x = trajectory.vel_y[i];
+			p.velocity.y = trajectory.vel_x[i];
+			p.velocity.z = -trajectory.vel_z[i];
+			p.acceleration_or_force.x = trajectory.acc_y[i];
+			p.acceleration_or_force.y = trajectory.acc_x[i];
+			p.acceleration_or_force.z = -trajectory.acc_z[i];
+			p.yaw = wrap_pi((M_PI / 2.0f) - trajectory.pos_yaw[i]);
+			p.yaw_rate = trajectory.vel_yaw[i];
+			tr_desired->command[i] = trajectory.command[i];
 		}
 
-		for (int i = trajectory.valid_points; i < NUM_POINTS; ++i)
-		{
-			tr_desired->point_valid[i] = false;
-		}
-
-		// [[[cog:
-		// for i in range(5):
-		//     cog.outl(
-		//         "fill_msg_point(tr_desired->point_{i1}, trajectory, {i0});"
-		//         .format(i0=i, i1=i + 1, )
-		//     )
-		// ]]]
-		fill_msg_point(tr_desired->point_1, trajectory, 0);
-		fill_msg_point(tr_desired->point_2, trajectory, 1);
-		fill_msg_point(tr_desired->point_3, trajectory, 2);
-		fill_msg_point(tr_desired->point_4, trajectory, 3);
-		fill_msg_point(tr_desired->point_5, trajectory, 4);
-		// [[[end]]] (checksum: b6aa0c7395a7a426c25d726b75b6efea)
-
 		trajectory_desired_pub.publish(tr_desired);
 	}
 
@@ -14,10 +14,17 @@
  * https://github.com/mavlink/mavros/tree/master/LICENSE.md
  */
 
+#include <complex>
+#include <mutex>
+#include <vector>
+
 #include <mavros/mavros_plugin.h>
+#include <mavros/msg_pool.h>
 #include <eigen_conversions/eigen_msg.h>
 
 #include <mavros_msgs/Vibration.h>
+#include <mavros_msgs/VibrationSpectrum.h>
+#include <sensor_msgs/Imu.h>
 
 namespace mavros {
 namespace extra_plugins {
@@ -25,11 +32,23 @@ namespace extra_plugins {
  * @brief Vibration plugin
  *
  * This plugin is intended to publish MAV vibration levels and accelerometer clipping from FCU.
+ *
+ * With ~vibration/spectrum/rate set, it also runs a streaming spectral
+ * analyzer: high-rate IMU samples (subscribe ~vibration/imu_in to the
+ * imu plugin's raw output) land in a fixed ring, and a periodic pass
+ * computes a windowed radix-2 FFT per axis into preallocated buffers,
+ * publishing band energies and a prop-imbalance indicator - spectra on
+ * the vehicle instead of gigabytes of bagged raw IMU.
  */
 class VibrationPlugin : public plugin::PluginBase {
 public:
 	VibrationPlugin() : PluginBase(),
-		vibe_nh("~vibration")
+		vibe_nh(plugin_ns("vibration")),
+		spectrum_rate(0.0),
+		window(256),
+		ring_head(0),
+		ring_count(0),
+		dt_ema(0.0)
 	{ }
 
 	void initialize(UAS &uas_)
@@ -38,7 +57,31 @@ public:
 
 		vibe_nh.param<std::string>("frame_id", frame_id, "base_link");
 
+		// spectrum publish rate [Hz]; 0 disables the analyzer
+		vibe_nh.param("spectrum/rate", spectrum_rate, 0.0);
+		// FFT window length, rounded down to a power of two
+		vibe_nh.param("spectrum/window", window, 256);
+
 		vibration_pub = vibe_nh.advertise<mavros_msgs::Vibration>("raw/vibration", 10);
+
+		if (spectrum_rate > 0.0) {
+			while (window & (window - 1))
+				window &= window - 1;
+			window = std::max(window, 32);
+
+			ring_x.resize(window);
+			ring_y.resize(window);
+			ring_z.resize(window);
+			fft_buf.resize(window);
+			hann.resize(window);
+			for (int i = 0; i < window; i++)
+				hann[i] = 0.5f * (1.0f - std::cos(2.0f * M_PI * i / (window - 1)));
+
+			spectrum_pub = vibe_nh.advertise<mavros_msgs::VibrationSpectrum>("spectrum", 10);
+			imu_sub = vibe_nh.subscribe("imu_in", 10, &VibrationPlugin::imu_cb, this);
+			spectrum_timer = vibe_nh.createTimer(ros::Duration(1.0 / spectrum_rate),
+						&VibrationPlugin::spectrum_cb, this);
+		}
 	}
 
 	Subscriptions get_subscriptions()
@@ -54,6 +97,26 @@ private:
 	std::string frame_id;
 
 	ros::Publisher vibration_pub;
+	ros::Publisher spectrum_pub;
+	ros::Subscriber imu_sub;
+	ros::Timer spectrum_timer;
+
+	double spectrum_rate;		//!< spectrum publish rate [Hz]; 0: off
+	int window;			//!< FFT length, power of two
+
+	//! sample ring, newest overwrites oldest (guarded by ring_mutex)
+	std::mutex ring_mutex;
+	std::vector<float> ring_x, ring_y, ring_z;
+	size_t ring_head;
+	size_t ring_count;
+	ros::Time last_sample_time;
+	double dt_ema;			//!< smoothed sample interval [s]
+
+	// preallocated analysis scratch, analyzer timer thread only
+	std::vector<std::complex<float>> fft_buf;
+	std::vector<float> hann;
+
+	MessagePool<mavros_msgs::VibrationSpectrum, 2> spectrum_pool;
 
 	void handle_vibration(const mavlink::mavlink_message_t *msg, mavlink::common::msg::VIBRATION &vibration)
 	{
@@ -70,6 +133,138 @@ private:
 
 		vibration_pub.publish(vibe_msg);
 	}
+
+	void imu_cb(const sensor_msgs::Imu::ConstPtr &imu)
+	{
+		std::lock_guard<std::mutex> lock(ring_mutex);
+
+		ring_x[ring_head] = imu->linear_acceleration.x;
+		ring_y[ring_head] = imu->linear_acceleration.y;
+		ring_z[ring_head] = imu->linear_acceleration.z;
+		ring_head = (ring_head + 1) % window;
+		if (ring_count < size_t(window))
+			ring_count++;
+
+		if (!last_sample_time.isZero()) {
+			double dt = (imu->header.stamp - last_sample_time).toSec();
+			if (dt > 0.0) {
+				if (dt_ema <= 0.0)
+					dt_ema = dt;
+				else
+					dt_ema += 0.05 * (dt - dt_ema);
+			}
+		}
+		last_sample_time = imu->header.stamp;
+	}
+
+	/**
+	 * @brief In-place iterative radix-2 FFT of fft_buf.
+	 * Textbook Cooley-Tukey; window lengths are small enough (<= 1024)
+	 * that twiddle recomputation is cheaper than caching tables.
+	 */
+	void fft()
+	{
+		const size_t n = fft_buf.size();
+
+		// bit-reversal permutation
+		for (size_t i = 1, j = 0; i < n; i++) {
+			size_t bit = n >> 1;
+			for (; j & bit; bit >>= 1)
+				j ^= bit;
+			j ^= bit;
+			if (i < j)
+				std::swap(fft_buf[i], fft_buf[j]);
+		}
+
+		for (size_t len = 2; len <= n; len <<= 1) {
+			float ang = -2.0f * M_PI / len;
+			std::complex<float> wlen(std::cos(ang), std::sin(ang));
+
+			for (size_t i = 0; i < n; i += len) {
+				std::complex<float> w(1.0f);
+				for (size_t k = 0; k < len / 2; k++) {
+					auto u = fft_buf[i + k];
+					auto v = fft_buf[i + k + len / 2] * w;
+					fft_buf[i + k] = u + v;
+					fft_buf[i + k + len / 2] = u - v;
+					w *= wlen;
+				}
+			}
+		}
+	}
+
+	//! Window one ring axis into fft_buf (oldest first) and transform
+	void analyze_axis(const std::vector<float> &ring, std::vector<float> &energy)
+	{
+		const size_t n = window;
+
+		float mean = 0.0f;
+		for (auto v : ring)
+			mean += v;
+		mean /= n;
+
+		for (size_t i = 0; i < n; i++) {
+			// ring_head points at the oldest sample (next overwrite)
+			float v = ring[(ring_head + i) % n] - mean;
+			fft_buf[i] = std::complex<float>(v * hann[i], 0.0f);
+		}
+
+		fft();
+
+		energy.resize(n / 2 + 1);	// reuses pooled capacity
+		for (size_t k = 0; k <= n / 2; k++)
+			energy[k] = std::norm(fft_buf[k]) / n;
+	}
+
+	void spectrum_cb(const ros::TimerEvent &event)
+	{
+		{
+			std::lock_guard<std::mutex> lock(ring_mutex);
+			if (ring_count < size_t(window) || dt_ema <= 0.0)
+				return;	// window not yet filled
+		}
+
+		if (spectrum_pub.getNumSubscribers() == 0)
+			return;
+
+		auto msg = spectrum_pool.acquire();
+
+		double sample_rate;
+		{
+			// ring updates at IMU rate; hold the lock for the copies
+			// only, the transforms run on our own scratch
+			std::lock_guard<std::mutex> lock(ring_mutex);
+			sample_rate = 1.0 / dt_ema;
+			analyze_axis(ring_x, msg->energy_x);
+			analyze_axis(ring_y, msg->energy_y);
+			analyze_axis(ring_z, msg->energy_z);
+		}
+
+		msg->header.stamp = event.current_real;
+		msg->header.frame_id = frame_id;
+		msg->sample_rate = sample_rate;
+		msg->resolution = sample_rate / window;
+
+		// prop imbalance shows as one dominant lateral peak; skip the
+		// near-DC bins that hold maneuvering accelerations
+		size_t first_bin = std::max<size_t>(1, std::ceil(2.0 / msg->resolution));
+		size_t peak = 0;
+		float peak_e = 0.0f, total = 0.0f;
+
+		for (size_t k = first_bin; k < msg->energy_x.size(); k++) {
+			float e = msg->energy_x[k] + msg->energy_y[k];
+			total += e;
+			if (e > peak_e) {
+				peak_e = e;
+				peak = k;
+			}
+		}
+
+		msg->peak_freq = peak * msg->resolution;
+		msg->imbalance = total > 0.0f ? peak_e / total : 0.0f;
+
+		spectrum_pub.publish(msg);
+	}
 };
 }	// namespace extra_plugins
 }	// namespace mavros
@@ -15,6 +15,7 @@
  * https://github.com/mavlink/mavros/tree/master/LICENSE.md
  */
 
+#include <mavros/external_pose.h>
 #include <mavros/mavros_plugin.h>
 #include <mavros/setpoint_mixin.h>
 #include <eigen_conversions/eigen_msg.h>
@@ -30,13 +31,29 @@ namespace extra_plugins{
  * Send pose estimation from various vision estimators
  * to FCU position and attitude estimators.
  *
+ * With ~vision_pose/coalesce_rate set, incoming samples are coalesced:
+ * only the newest sample per send slot goes to the FCU. When a VIO
+ * pipeline bursts (frame queue flush), forwarding every sample queues
+ * them on the link and the EKF fuses stale poses; dropping the
+ * overwritten ones keeps the fused pose fresh.
  */
 class VisionPoseEstimatePlugin : public plugin::PluginBase,
 	private plugin::TF2ListenerMixin<VisionPoseEstimatePlugin> {
 public:
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
 	VisionPoseEstimatePlugin() : PluginBase(),
-		sp_nh("~vision_pose"),
-		tf_rate(10.0)
+		sp_nh(plugin_ns("vision_pose")),
+		tf_rate(10.0),
+		source_id(0),
+		coalesce_rate(0.0),
+		sample_pending(false),
+		rx_count(0),
+		tx_count(0),
+		coalesced_count(0),
+		interval_ema(0.0),
+		jitter_ema(0.0),
+		latency_ema(0.0)
 	{ }
 
 	void initialize(UAS &uas_)
@@ -51,6 +68,20 @@ public:
 		sp_nh.param<std::string>("tf/child_frame_id", tf_child_frame_id, "vision_estimate");
 		sp_nh.param("tf/rate_limit", tf_rate, 10.0);
 
+		// arbitration between external localization sources
+		int source_priority;
+		sp_nh.param("source_priority", source_priority, 20);
+		source_id = m_uas->ep_arbiter.add_source("vision_pose", source_priority);
+
+		// coalescing: send at most coalesce_rate samples/s, always the
+		// newest one; 0 keeps the forward-every-sample behavior
+		sp_nh.param("coalesce_rate", coalesce_rate, 0.0);
+		if (coalesce_rate > 0.0) {
+			coalesce_timer = sp_nh.createTimer(ros::Duration(1.0 / coalesce_rate),
+						&VisionPoseEstimatePlugin::coalesce_cb, this);
+			UAS_DIAG(m_uas).add("vision_pose", this, &VisionPoseEstimatePlugin::diag_run);
+		}
+
 		if (tf_listen) {
 			ROS_INFO_STREAM_NAMED("vision_pose", "Listen to vision transform " << tf_frame_id
 						<< " -> " << tf_child_frame_id);
@@ -79,6 +110,28 @@ private:
 	double tf_rate;
 	ros::Time last_transform_stamp;
 
+	external_pose::Arbiter::SourceId source_id;
+
+	double coalesce_rate;		//!< send slot rate [Hz]; 0: immediate forwarding
+	ros::Timer coalesce_timer;
+
+	//! latest pending sample; overwritten by newer arrivals until sent
+	std::mutex sample_mutex;
+	bool sample_pending;
+	ros::Time sample_stamp;
+	ros::Time sample_rx_time;
+	Eigen::Affine3d sample_tr;
+	ftf::Covariance6d sample_cov;
+
+	// link quality counters (guarded by sample_mutex)
+	uint64_t rx_count;		//!< samples received
+	uint64_t tx_count;		//!< samples sent to FCU
+	uint64_t coalesced_count;	//!< samples overwritten before their slot
+	ros::Time last_rx_time;
+	double interval_ema;		//!< smoothed inter-arrival time [s]
+	double jitter_ema;		//!< smoothed |deviation| from interval_ema [s]
+	double latency_ema;		//!< smoothed queue-to-send delay [s]
+
 	/* -*- low-level send -*- */
 	/**
 	 * @brief Send vision estimate transform to FCU position controller
@@ -95,10 +148,13 @@ private:
 		}
 		last_transform_stamp = stamp;
 
-		auto position = ftf::transform_frame_enu_ned(Eigen::Vector3d(tr.translation()));
-		auto rpy = ftf::quaternion_to_rpy(
-				ftf::transform_orientation_enu_ned(
-				ftf::transform_orientation_baselink_aircraft(Eigen::Quaterniond(tr.rotation()))));
+		if (!m_uas->ep_arbiter.should_send(source_id))
+			return;
+
+		// shared external-pose transform stage
+		auto sample = external_pose::sample_from_enu(stamp,
+				Eigen::Vector3d(tr.translation()), Eigen::Quaterniond(tr.rotation()));
+		auto rpy = ftf::quaternion_to_rpy(sample.orientation);
 
 		auto cov_ned = ftf::transform_frame_enu_ned(cov);
 		ftf::EigenMapConstCovariance6d cov_map(cov_ned.data());
@@ -111,13 +167,13 @@ private:
 		vp.usec = stamp.toNSec() / 1000;
 		// [[[cog:
 		// for f in "xyz":
-		//     cog.outl("vp.%s = position.%s();" % (f, f))
+		//     cog.outl("vp.%s = sample.position.%s();" % (f, f))
 		// for a, b in zip("xyz", ('roll', 'pitch', 'yaw')):
 		//     cog.outl("vp.%s = rpy.%s();" % (b, a))
 		// ]]]
-		vp.x = position.x();
-		vp.y = position.y();
-		vp.z = position.z();
+		vp.x = sample.position.x();
+		vp.y = sample.position.y();
+		vp.z = sample.position.z();
 		vp.roll = rpy.x();
 		vp.pitch = rpy.y();
 		vp.yaw = rpy.z();
@@ -130,8 +186,82 @@ private:
 		UAS_FCU(m_uas)->send_message_ignore_drop(vp);
 	}
 
+	/**
+	 * @brief Route one sample: forward immediately, or park it as the
+	 * pending sample for the next send slot.
+	 */
+	void submit_sample(const ros::Time &stamp, const Eigen::Affine3d &tr, const geometry_msgs::PoseWithCovariance::_covariance_type &cov)
+	{
+		if (coalesce_rate <= 0.0) {
+			send_vision_estimate(stamp, tr, cov);
+			return;
+		}
+
+		auto now = ros::Time::now();
+
+		std::lock_guard<std::mutex> lock(sample_mutex);
+		rx_count++;
+
+		if (!last_rx_time.isZero()) {
+			double dt = (now - last_rx_time).toSec();
+			if (interval_ema <= 0.0)
+				interval_ema = dt;
+			jitter_ema += 0.1 * (std::abs(dt - interval_ema) - jitter_ema);
+			interval_ema += 0.1 * (dt - interval_ema);
+		}
+		last_rx_time = now;
+
+		if (sample_pending)
+			coalesced_count++;	// overwritten, never sent
+
+		sample_pending = true;
+		sample_stamp = stamp;
+		sample_rx_time = now;
+		sample_tr = tr;
+		sample_cov = cov;
+	}
+
 	/* -*- callbacks -*- */
 
+	void coalesce_cb(const ros::TimerEvent &event)
+	{
+		ros::Time stamp;
+		Eigen::Affine3d tr;
+		ftf::Covariance6d cov;
+
+		{
+			std::lock_guard<std::mutex> lock(sample_mutex);
+			if (!sample_pending)
+				return;
+
+			sample_pending = false;
+			stamp = sample_stamp;
+			tr = sample_tr;
+			cov = sample_cov;
+			tx_count++;
+			latency_ema += 0.1 * ((event.current_real - sample_rx_time).toSec() - latency_ema);
+		}
+
+		send_vision_estimate(stamp, tr, cov);
+	}
+
+	void diag_run(diagnostic_updater::DiagnosticStatusWrapper &stat)
+	{
+		std::lock_guard<std::mutex> lock(sample_mutex);
+
+		if (rx_count == 0)
+			stat.summary(1, "No data");
+		else
+			stat.summary(0, "Normal");
+
+		stat.addf("Received", "%llu", (long long unsigned)rx_count);
+		stat.addf("Sent", "%llu", (long long unsigned)tx_count);
+		stat.addf("Coalesced", "%llu", (long long unsigned)coalesced_count);
+		stat.addf("Sample interval (ms)", "%.1f", interval_ema * 1e3);
+		stat.addf("Sample jitter (ms)", "%.1f", jitter_ema * 1e3);
+		stat.addf("Send latency (ms)", "%.1f", latency_ema * 1e3);
+	}
+
 	/* common TF listener moved to mixin */
 
 	void transform_cb(const geometry_msgs::TransformStamped &transform)
@@ -140,7 +270,7 @@ private:
 		tf::transformMsgToEigen(transform.transform, tr);
 		ftf::Covariance6d cov {};	// zero initialized
 
-		send_vision_estimate(transform.header.stamp, tr, cov);
+		submit_sample(transform.header.stamp, tr, cov);
 	}
 
 	void vision_cb(const geometry_msgs::PoseStamped::ConstPtr &req)
@@ -149,7 +279,7 @@ private:
 		tf::poseMsgToEigen(req->pose, tr);
 		ftf::Covariance6d cov {};	// zero initialized
 
-		send_vision_estimate(req->header.stamp, tr, cov);
+		submit_sample(req->header.stamp, tr, cov);
 	}
 
 	void vision_cov_cb(const geometry_msgs::PoseWithCovarianceStamped::ConstPtr &req)
@@ -157,7 +287,7 @@ private:
 		Eigen::Affine3d tr;
 		tf::poseMsgToEigen(req->pose.pose, tr);
 
-		send_vision_estimate(req->header.stamp, tr, req->pose.covariance);
+		submit_sample(req->header.stamp, tr, req->pose.covariance);
 	}
 };
 }	// namespace extra_plugins
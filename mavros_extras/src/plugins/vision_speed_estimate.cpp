@@ -33,7 +33,7 @@ namespace extra_plugins {
 class VisionSpeedEstimatePlugin : public plugin::PluginBase {
 public:
 	VisionSpeedEstimatePlugin() : PluginBase(),
-		sp_nh("~vision_speed"),
+		sp_nh(plugin_ns("vision_speed")),
 		listen_twist(true),
 		twist_cov(true)
 	{ }
@@ -14,7 +14,9 @@
  * https://github.com/mavlink/mavros/tree/master/LICENSE.md
  */
 
+#include <array>
 #include <mavros/mavros_plugin.h>
+#include <mavros/msg_pool.h>
 #include <mavros_msgs/WheelOdomStamped.h>
 
 #include <geometry_msgs/TwistWithCovarianceStamped.h>
@@ -37,7 +39,7 @@ public:
 	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
 	WheelOdometryPlugin() : PluginBase(),
-		wo_nh("~wheel_odometry"),
+		wo_nh(plugin_ns("wheel_odometry")),
 		count(0),
 		odom_mode(OM::NONE),
 		raw_send(false),
@@ -128,6 +130,11 @@ public:
 						ROS_WARN_NAMED("wo", "WO: Wheel #%i has incorrect radius (%f).", i, wheel_radius[i]);
 					}
 				}
+
+				// Precompute the RPM -> speed factors: constant per wheel
+				rpm_2_speed.resize(wheel_radius.size());
+				for (size_t i = 0; i < wheel_radius.size(); i++)
+					rpm_2_speed[i] = wheel_radius[i] * 2.0 * M_PI / 60.0;
 			}
 			else {
 				odom_mode = OM::NONE;
@@ -191,9 +198,18 @@ private:
 	std::string tf_child_frame_id;	//!< frame for TF and Pose
 	double vel_cov;			//!< wheel velocity measurement error 1-var (m/s)
 
+	//! WHEEL_DISTANCE wire capacity: bounds all per-sample buffers at compile time
+	static constexpr size_t MAX_WHEELS = 16;
+
+	std::vector<double> rpm_2_speed;	//!< precomputed per-wheel RPM -> speed factor (m/s)
+
 	int count_meas;				//!< number of wheels in measurements
 	ros::Time time_prev;			//!< timestamp of previous measurement
-	std::vector<double> measurement_prev;	//!< previous measurement
+	std::array<double, MAX_WHEELS> measurement_prev;	//!< previous measurement
+
+	MessagePool<mavros_msgs::WheelOdomStamped> raw_pool;
+	MessagePool<nav_msgs::Odometry> odom_pool;
+	MessagePool<geometry_msgs::TwistWithCovarianceStamped> twist_pool;
 
 	bool yaw_initialized;			//!< initial yaw initialized (from IMU)
 
@@ -249,7 +265,7 @@ private:
 
 		// Publish twist
 		if (twist_send) {
-			auto twist_cov_t = boost::make_shared<geometry_msgs::TwistWithCovarianceStamped>();
+			auto twist_cov_t = twist_pool.acquire();
 			// header
 			twist_cov_t->header.stamp = time;
 			twist_cov_t->header.frame_id = frame_id;
@@ -260,7 +276,7 @@ private:
 		}
 		// Publish odometry (only if we have initial yaw)
 		else if (yaw_initialized) {
-			auto odom = boost::make_shared<nav_msgs::Odometry>();
+			auto odom = odom_pool.acquire();
 			// header
 			odom->header.stamp = time;
 			odom->header.frame_id = frame_id;
@@ -271,6 +287,7 @@ private:
 			odom->pose.pose.position.z = 0.0;
 			odom->pose.pose.orientation = quat;
 			ftf::EigenMapCovariance6d pose_cov_map(odom->pose.covariance.data());
+			pose_cov_map.setZero();	// pooled message: clear unused entries
 			pose_cov_map.block<2, 2>(0, 0) << rpose_cov.block<2, 2>(0, 0);
 			pose_cov_map.block<2, 1>(0, 5) << rpose_cov.block<2, 1>(0, 2);
 			pose_cov_map.block<1, 2>(5, 0) << rpose_cov.block<1, 2>(2, 0);
@@ -314,7 +331,7 @@ private:
 	 * @param distance	distance traveled by each wheel since last odometry update
 	 * @param dt		time elapse since last odometry update (s)
 	 */
-	void update_odometry_diffdrive(std::vector<double> distance, double dt)
+	void update_odometry_diffdrive(const Eigen::Vector2d &distance, double dt)
 	{
 		double y0 = wheel_offset[0](1);
 		double y1 = wheel_offset[1](1);
@@ -437,38 +454,24 @@ private:
 		rpose_cov = J_pose * rpose_cov * J_pose.transpose() + J_meas * meas_cov * J_meas.transpose();
 	}
 
-	/**
-	 * @brief Update odometry (currently, only 2-wheels differential configuration implemented).
-	 * Odometry is computed for robot's origin (IMU).
-	 * @param distance	distance traveled by each wheel since last odometry update
-	 * @param dt		time elapse since last odometry update (s)
-	 */
-	void update_odometry(std::vector<double> distance, double dt)
-	{
-		// Currently, only 2-wheels configuration implemented
-		int nwheels = std::min(2, (int)distance.size());
-		switch (nwheels)
-		{
-		// Differential drive robot.
-		case 2:
-			update_odometry_diffdrive(distance, dt);
-			break;
-		}
-	}
-
 	/**
 	 * @brief Process wheel measurement.
-	 * @param measurement	measurement
+	 *
+	 * Fixed-capacity buffers only: at 100 Hz this path must not touch
+	 * the heap. Only the first two wheels feed the (differential drive)
+	 * estimator, which updates pose and covariance recursively.
+	 *
+	 * @param measurement	measurement values (first n valid)
+	 * @param n		number of wheels in measurement
 	 * @param rpm		whether measurement contains RPM-s or cumulative wheel distances
 	 * @param time		measurement's internal time stamp (for accurate dt computations)
 	 * @param time_pub	measurement's time stamp for publish
 	 */
-	void process_measurement(std::vector<double> measurement, bool rpm, ros::Time time, ros::Time time_pub)
+	void process_measurement(const std::array<double, MAX_WHEELS> &measurement, size_t n, bool rpm, ros::Time time, ros::Time time_pub)
 	{
 		// Initial measurement
 		if (time_prev == ros::Time(0)) {
-			count_meas = measurement.size();
-			measurement_prev.resize(count_meas);
+			count_meas = n;
 			count = std::min(count, count_meas); // don't try to use more wheels than we have
 		}
 		// Same time stamp (messages are generated by FCU more often than the wheel state updated)
@@ -476,38 +479,38 @@ private:
 			return;
 		}
 		// # of wheels differs from the initial value
-		else if (measurement.size() != count_meas) {
-			ROS_WARN_THROTTLE_NAMED(10, "wo", "WO: Number of wheels in measurement (%lu) differs from the initial value (%i).", measurement.size(), count_meas);
+		else if ((int)n != count_meas) {
+			ROS_WARN_THROTTLE_NAMED(10, "wo", "WO: Number of wheels in measurement (%lu) differs from the initial value (%i).", n, count_meas);
 			return;
 		}
 		// Compute odometry
 		else {
 			double dt = (time - time_prev).toSec(); // Time since previous measurement (s)
 
-			// Distance traveled by each wheel since last measurement.
-			// Reserve for at least 2 wheels.
-			std::vector<double> distance(std::max(2, count));
+			// Distance traveled by the first two wheels since last measurement
+			// (currently, only the 2-wheels differential configuration is implemented).
+			Eigen::Vector2d distance;
+			int nused = std::min(count, 2);
 			// Compute using RPM-s
 			if (rpm) {
-				for (int i = 0; i < count; i++) {
-					double RPM_2_SPEED = wheel_radius[i] * 2.0 * M_PI / 60.0; // RPM -> speed (m/s)
-					double rpm = 0.5 * (measurement[i] + measurement_prev[i]); // Mean RPM during last dt seconds
-					distance[i] = rpm * RPM_2_SPEED * dt;
+				for (int i = 0; i < nused; i++) {
+					double mean_rpm = 0.5 * (measurement[i] + measurement_prev[i]); // Mean RPM during last dt seconds
+					distance[i] = mean_rpm * rpm_2_speed[i] * dt;
 				}
 			}
 			// Compute using cumulative distances
 			else {
-				for (int i = 0; i < count; i++)
+				for (int i = 0; i < nused; i++)
 					distance[i] = measurement[i] - measurement_prev[i];
 			}
 
-			// Make distance of the 2nd wheel equal to that of the 1st one if requested or only one is available.
+			// Make distance of the 2nd wheel equal to that of the 1st one if only one is available.
 			// This generalizes odometry computations for 1- and 2-wheels configurations.
 			if (count == 1)
 				distance[1] = distance[0];
 
 			// Update odometry
-			update_odometry(distance, dt);
+			update_odometry_diffdrive(distance, dt);
 
 			// Publish odometry
 			publish_odometry(time_pub);
@@ -515,7 +518,7 @@ private:
 
 		// Time step
 		time_prev = time;
-		std::copy_n(measurement.begin(), measurement.size(), measurement_prev.begin());
+		std::copy_n(measurement.begin(), n, measurement_prev.begin());
 	}
 
 	/* -*- message handlers -*- */
@@ -533,10 +536,10 @@ private:
 
 		// Publish RPM-s
 		if (raw_send) {
-			auto rpm_msg = boost::make_shared<mavros_msgs::WheelOdomStamped>();
+			auto rpm_msg = raw_pool.acquire();
 
 			rpm_msg->header.stamp = timestamp;
-			rpm_msg->data.resize(2);
+			rpm_msg->data.resize(2);	// reuses pooled capacity
 			rpm_msg->data[0] = rpm.rpm1;
 			rpm_msg->data[1] = rpm.rpm2;
 
@@ -545,8 +548,10 @@ private:
 
 		// Process measurement
 		if (odom_mode == OM::RPM) {
-			std::vector<double> measurement{rpm.rpm1, rpm.rpm2};
-			process_measurement(measurement, true, timestamp, timestamp);
+			std::array<double, MAX_WHEELS> measurement;
+			measurement[0] = rpm.rpm1;
+			measurement[1] = rpm.rpm2;
+			process_measurement(measurement, 2, true, timestamp, timestamp);
 		}
 	}
 
@@ -569,10 +574,10 @@ private:
 
 		// Publish distances
 		if (raw_send) {
-			auto wheel_dist_msg = boost::make_shared<mavros_msgs::WheelOdomStamped>();
+			auto wheel_dist_msg = raw_pool.acquire();
 
 			wheel_dist_msg->header.stamp = timestamp;
-			wheel_dist_msg->data.resize(wheel_dist.count);
+			wheel_dist_msg->data.resize(wheel_dist.count);	// reuses pooled capacity
 			std::copy_n(wheel_dist.distance.begin(), wheel_dist.count, wheel_dist_msg->data.begin());
 
 			dist_pub.publish(wheel_dist_msg);
@@ -580,9 +585,10 @@ private:
 
 		// Process measurement
 		if (odom_mode == OM::DIST) {
-			std::vector<double> measurement(wheel_dist.count);
-			std::copy_n(wheel_dist.distance.begin(), wheel_dist.count, measurement.begin());
-			process_measurement(measurement, false, timestamp_int, timestamp);
+			std::array<double, MAX_WHEELS> measurement;
+			size_t n = std::min<size_t>(wheel_dist.count, MAX_WHEELS);
+			std::copy_n(wheel_dist.distance.begin(), n, measurement.begin());
+			process_measurement(measurement, n, false, timestamp_int, timestamp);
 		}
 	}
 };
@@ -15,6 +15,7 @@
 #include <ros/console.h>
 
 #include <urdf/model.h>
+#include <mavros/msg_pool.h>
 #include <mavros_msgs/RCOut.h>
 #include <sensor_msgs/JointState.h>
 
@@ -158,6 +159,16 @@ public:
 			ROS_INFO("SSP: joint '%s' (RC%d) loaded", pair.first.c_str(), rc_channel);
 		}
 
+		// persistent state: names never change after this point, and
+		// positions are updated in place per message (unset channels
+		// hold their last value, starting at the trim point)
+		joint_names.reserve(servos.size());
+		joint_positions.reserve(servos.size());
+		for (auto &desc : servos) {
+			joint_names.emplace_back(desc.joint_name);
+			joint_positions.emplace_back(desc.calculate_position(desc.rc_trim));
+		}
+
 		rc_out_sub = nh.subscribe("rc_out", 10, &ServoStatePublisher::rc_out_cb, this);
 		joint_states_pub = nh.advertise<sensor_msgs::JointState>("joint_states", 10);
 	}
@@ -177,27 +188,41 @@ private:
 	ros::Subscriber rc_out_sub;
 	ros::Publisher joint_states_pub;
 
-	std::list<ServoDescription> servos;
+	std::vector<ServoDescription> servos;
+
+	std::vector<std::string> joint_names;	//!< filled once at startup
+	std::vector<double> joint_positions;	//!< updated in place per RC_OUT
+
+	mavros::MessagePool<sensor_msgs::JointState> js_pool;
 
 	void rc_out_cb(const mavros_msgs::RCOut::ConstPtr &msg) {
 		if (msg->channels.empty())
 			return;		// nothing to do
 
-		auto states = boost::make_shared<sensor_msgs::JointState>();
-		states->header.stamp = msg->header.stamp;
+		for (size_t i = 0; i < servos.size(); i++) {
+			auto &desc = servos[i];
 
-		for (auto &desc : servos) {
 			if (!(desc.rc_channel != 0 && desc.rc_channel <= msg->channels.size()))
 				continue;	// prevent crash on servos not in that message
 
 			uint16_t pwm = msg->channels[desc.rc_channel - 1];
 			if (pwm == 0 || pwm == UINT16_MAX)
-				continue;	// exclude unset channels
+				continue;	// unset channel: joint holds last position
 
-			states->name.emplace_back(desc.joint_name);
-			states->position.emplace_back(desc.calculate_position(pwm));
+			joint_positions[i] = desc.calculate_position(pwm);
 		}
 
+		auto states = js_pool.acquire();
+		states->header.stamp = msg->header.stamp;
+
+		// a reused pool message already carries the names
+		if (states->name.size() != joint_names.size())
+			states->name = joint_names;
+
+		states->position = joint_positions;	// reuses pooled capacity
+		states->velocity.clear();
+		states->effort.clear();
+
 		joint_states_pub.publish(states);
 	}
 };
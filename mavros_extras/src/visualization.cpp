@@ -11,6 +11,8 @@
  * https://github.com/mavlink/mavros/tree/master/LICENSE.md
  */
 
+#include <algorithm>
+#include <cmath>
 #include <vector>
 
 #include <tf/tf.h>
@@ -18,6 +20,8 @@
 #include <ros/ros.h>
 #include <ros/console.h>
 
+#include <mavros/msg_pool.h>
+
 #include <geometry_msgs/PoseStamped.h>
 #include <geometry_msgs/Vector3Stamped.h>
 #include <visualization_msgs/Marker.h>
@@ -28,6 +32,47 @@ static std::string fixed_frame_id;
 static std::string child_frame_id;
 static double marker_scale;
 static int max_track_size = 100;
+static double pos_threshold;		// [m] republish when moved this far
+static double ori_threshold;		// [rad] republish when rotated this far
+static double track_epsilon;		// [m] track decimation tolerance
+
+// landing target markers come three at a time; pool them
+static mavros::MessagePool<visualization_msgs::Marker> marker_pool;
+
+/* -*- change detection helpers -*- */
+
+static inline double point_dist(const geometry_msgs::Point &a, const geometry_msgs::Point &b)
+{
+	double dx = a.x - b.x, dy = a.y - b.y, dz = a.z - b.z;
+	return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+static inline double quat_angle(const geometry_msgs::Quaternion &a, const geometry_msgs::Quaternion &b)
+{
+	double dot = a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z;
+	return 2.0 * std::acos(std::min(1.0, std::fabs(dot)));
+}
+
+static inline bool pose_changed(const geometry_msgs::Pose &a, const geometry_msgs::Pose &b)
+{
+	return point_dist(a.position, b.position) >= pos_threshold ||
+	       quat_angle(a.orientation, b.orientation) >= ori_threshold;
+}
+
+//! distance from @a p to the segment @a a - @a b
+static double point_segment_dist(const geometry_msgs::Point &p,
+		const geometry_msgs::Point &a, const geometry_msgs::Point &b)
+{
+	double abx = b.x - a.x, aby = b.y - a.y, abz = b.z - a.z;
+	double apx = p.x - a.x, apy = p.y - a.y, apz = p.z - a.z;
+
+	double ab2 = abx * abx + aby * aby + abz * abz;
+	double t = ab2 > 0.0 ? (apx * abx + apy * aby + apz * abz) / ab2 : 0.0;
+	t = std::max(0.0, std::min(1.0, t));
+
+	double dx = apx - t * abx, dy = apy - t * aby, dz = apz - t * abz;
+	return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
 
 // source subscribers
 ros::Subscriber local_position_sub;
@@ -68,13 +113,25 @@ static void publish_track_marker(const geometry_msgs::PoseStamped::ConstPtr &pos
 		track_marker->points.reserve(max_track_size);
 	}
 
-	static int marker_idx = 0;
+	auto &points = track_marker->points;
+	const auto &p = pose->pose.position;
 
-	if ( track_marker->points.size() < max_track_size )
-		track_marker->points.push_back(pose->pose.position);
-	else track_marker->points[marker_idx] = pose->pose.position;
+	// no motion: nothing to republish
+	if ( !points.empty() && point_dist(points.back(), p) < pos_threshold )
+		return;
 
-	marker_idx = ++marker_idx % max_track_size;
+	/** on-the-fly Ramer-Douglas-Peucker: if the last stored vertex stays
+	 *  within track_epsilon of the chord to the new point, it carries no
+	 *  shape information - slide it forward instead of appending.
+	 */
+	if ( points.size() >= 2 &&
+			point_segment_dist(points.back(), points[points.size() - 2], p) < track_epsilon )
+		points.back() = p;
+	else {
+		points.push_back(p);
+		if ( points.size() > static_cast<size_t>(max_track_size) )
+			points.erase(points.begin());
+	}
 
 	track_marker->header = pose->header;
 	track_marker_pub.publish(track_marker);
@@ -84,6 +141,10 @@ static void publish_wp_marker(const geometry_msgs::PoseStamped::ConstPtr &wp)
 {
 	static boost::shared_ptr<visualization_msgs::Marker> marker;
 
+	// setpoint arrow barely moved: keep the one rviz already has
+	if ( marker && !pose_changed(marker->pose, wp->pose) )
+		return;
+
 	if ( !marker )	// only instantiate marker once
 	{
 		marker = boost::make_shared<visualization_msgs::Marker>();
@@ -114,46 +175,62 @@ static void publish_wp_marker(const geometry_msgs::PoseStamped::ConstPtr &wp)
 static void publish_lt_marker(const geometry_msgs::PoseStamped::ConstPtr &target)
 {
 	static int marker_id = 2;	// TODO: generate new marker for each target
+	static bool have_last = false;
+	static geometry_msgs::Pose last_pose;
 
-	auto marker = boost::make_shared<visualization_msgs::Marker>();
+	// target barely moved: rviz keeps the previous markers
+	if ( have_last && !pose_changed(last_pose, target->pose) )
+		return;
 
-	marker->header = target->header;
-	marker->ns = "landing_target";
-	marker->id = marker_id;
-	marker->type = visualization_msgs::Marker::CUBE;
-	marker->action = visualization_msgs::Marker::ADD;
+	have_last = true;
+	last_pose = target->pose;
 
-	marker->color.a = 1.0;
-	marker->color.r = 1.0;
-	marker->color.g = 0.0;
-	marker->color.b = 0.0;
+	//! @note pooled messages keep their last contents: assign every field
+	auto fill_lt_marker = [&target](visualization_msgs::Marker &m, int id) {
+		m.header = target->header;
+		m.ns = "landing_target";
+		m.id = id;
+		m.type = visualization_msgs::Marker::CUBE;
+		m.action = visualization_msgs::Marker::ADD;
 
-	marker->scale.x = 1.0;
-	marker->scale.y = 1.0;
-	marker->scale.z = 1.0;
+		m.color.a = 1.0;
+		m.color.r = 1.0;
+		m.color.g = 0.0;
+		m.color.b = 0.0;
+
+		m.scale.x = 1.0;
+		m.scale.y = 1.0;
+		m.scale.z = 1.0;
+
+		m.pose = target->pose;
+	};
 
 	// origin
-	marker->pose = target->pose;
+	auto marker = marker_pool.acquire();
+	fill_lt_marker(*marker, marker_id);
 	lt_marker_pub.publish(marker);
 
 	// cross arms
+	marker = marker_pool.acquire();
+	fill_lt_marker(*marker, ++marker_id);
 	marker->pose.position.x = lt_size.x;
 	marker->pose.position.y = lt_size.y;
 	marker->pose.position.z = lt_size.z;
-
-	marker->id = ++marker_id;
 	marker->pose.orientation.w = 0;
 	marker->pose.orientation.x = 0;
 	marker->pose.orientation.y = 0;
-	marker->pose.orientation.w = 0;
 	lt_marker_pub.publish(marker);
 
-	marker->id = ++marker_id;
+	marker = marker_pool.acquire();
+	fill_lt_marker(*marker, ++marker_id);
+	marker->pose.position.x = lt_size.x;
+	marker->pose.position.y = lt_size.y;
+	marker->pose.position.z = lt_size.z;
 	// 90 degrees rotation
 	marker->pose.orientation.w = 0.70711;
 	marker->pose.orientation.x = 0;
 	marker->pose.orientation.y = 0;
-	marker->pose.orientation.w = 0.70711;
+	marker->pose.orientation.z = 0.70711;
 	lt_marker_pub.publish(marker);
 }
 
@@ -264,7 +341,6 @@ static void create_vehicle_markers( int num_rotors, float arm_len, float body_wi
 static void local_position_sub_cb(const geometry_msgs::PoseStamped::ConstPtr &pose)
 {
 	publish_track_marker(pose);
-	if (vehicle_marker) vehicle_marker_pub.publish(vehicle_marker);
 }
 
 void setpoint_local_pos_sub_cb(const geometry_msgs::PoseStamped::ConstPtr &wp)
@@ -302,13 +378,22 @@ int main(int argc, char *argv[])
 	priv_nh.param("max_track_size", max_track_size, 1000 );
 	priv_nh.param("prop_direction", prop_direction, 0);
 
+	// delta publishing: markers go out only when they moved this much
+	priv_nh.param("pos_threshold", pos_threshold, 0.05 );
+	priv_nh.param("ori_threshold", ori_threshold, 0.05 );
+	priv_nh.param("track_epsilon", track_epsilon, pos_threshold );
+
 	create_vehicle_markers( num_rotors, arm_len, body_width, body_height, prop_direction );
 
 	track_marker_pub = nh.advertise<visualization_msgs::Marker>("track_markers", 10);
-	vehicle_marker_pub = nh.advertise<visualization_msgs::MarkerArray>("vehicle_marker", 10);
+	// the vehicle model is static in the body frame (rviz moves it via
+	// TF): latch it once instead of resending it at telemetry rate
+	vehicle_marker_pub = nh.advertise<visualization_msgs::MarkerArray>("vehicle_marker", 10, true);
 	wp_marker_pub = nh.advertise<visualization_msgs::Marker>("wp_markers", 10);
 	lt_marker_pub = nh.advertise<visualization_msgs::Marker>("landing_target", 10);
 
+	if (vehicle_marker) vehicle_marker_pub.publish(vehicle_marker);
+
 	auto pos_sub = nh.subscribe("local_position", 10, local_position_sub_cb);
 	auto wp_sub = nh.subscribe("local_setpoint", 10, setpoint_local_pos_sub_cb);
 	lt_marker_sub = nh.subscribe("lt_marker", 10, lt_marker_sub_cb);
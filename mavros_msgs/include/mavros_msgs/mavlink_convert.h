@@ -14,6 +14,7 @@
 #pragma once
 
 #include <algorithm>
+#include <cstring>
 #include <mavros_msgs/Mavlink.h>
 #include <mavconn/mavlink_dialect.h>
 
@@ -105,16 +106,81 @@ inline bool convert(const mavlink_message_t &mmsg, mavros_msgs::Mavlink &rmsg, u
 	rmsg.msgid = mmsg.msgid;
 	rmsg.checksum = mmsg.checksum;
 	// [[[end]]] (checksum: 4f0a50d2fcd7eb8823aea3e0806cd698)
-	rmsg.payload64 = std::move(mavros_msgs::Mavlink::_payload64_type(mmsg.payload64, mmsg.payload64 + payload64_len));
+	// assign() reuses the capacity of recycled messages instead of
+	// reallocating a fresh vector per conversion
+	rmsg.payload64.assign(mmsg.payload64, mmsg.payload64 + payload64_len);
 
 	// copy signature block only if message is signed
 	if (mmsg.incompat_flags & MAVLINK_IFLAG_SIGNED)
-		rmsg.signature = std::move(mavros_msgs::Mavlink::_signature_type(mmsg.signature, mmsg.signature + sizeof(mmsg.signature)));
+		rmsg.signature.assign(mmsg.signature, mmsg.signature + sizeof(mmsg.signature));
 	else
 		rmsg.signature.clear();
 
 	return true;
 }
 
+/**
+ * @brief Serialize mavros_msgs/Mavlink straight to wire format
+ *
+ * The message already carries a complete frame (header fields,
+ * checksum, optional signature), so router paths that only bounce it
+ * towards a link can skip the intermediate mavlink_message_t and its
+ * payload staging copy.
+ *
+ * @param[in]  rmsg     mavros_msgs/Mavlink message
+ * @param[out] buf      output buffer, MAVLINK_MAX_PACKET_LEN bytes is always enough
+ * @param[in]  bufsize  size of @a buf
+ * @return frame length, or -1 if the message is not convertible
+ */
+inline ssize_t convert_to_frame(const mavros_msgs::Mavlink &rmsg, uint8_t *buf, size_t bufsize)
+{
+	const size_t payload_len = rmsg.len;
+	const bool mavlink1 = rmsg.magic == MAVLINK_STX_MAVLINK1;
+
+	if (payload_len > rmsg.payload64.size() * sizeof(uint64_t))
+		return -1;
+
+	const bool is_signed = !mavlink1 && (rmsg.incompat_flags & MAVLINK_IFLAG_SIGNED);
+	if (is_signed && rmsg.signature.size() != MAVLINK_SIGNATURE_BLOCK_LEN)
+		return -1;
+
+	const size_t header_len = (mavlink1) ? MAVLINK_CORE_HEADER_MAVLINK1_LEN + 1 : MAVLINK_NUM_HEADER_BYTES;
+	size_t frame_len = header_len + payload_len + MAVLINK_NUM_CHECKSUM_BYTES;
+	if (is_signed)
+		frame_len += MAVLINK_SIGNATURE_BLOCK_LEN;
+
+	if (bufsize < frame_len)
+		return -1;
+
+	uint8_t *p = buf;
+	*p++ = rmsg.magic;
+	*p++ = rmsg.len;
+	if (!mavlink1) {
+		*p++ = rmsg.incompat_flags;
+		*p++ = rmsg.compat_flags;
+	}
+	*p++ = rmsg.seq;
+	*p++ = rmsg.sysid;
+	*p++ = rmsg.compid;
+	*p++ = rmsg.msgid & 0xff;
+	if (!mavlink1) {
+		*p++ = (rmsg.msgid >> 8) & 0xff;
+		*p++ = (rmsg.msgid >> 16) & 0xff;
+	}
+
+	memcpy(p, rmsg.payload64.data(), payload_len);
+	p += payload_len;
+
+	*p++ = rmsg.checksum & 0xff;
+	*p++ = rmsg.checksum >> 8;
+
+	if (is_signed) {
+		memcpy(p, rmsg.signature.data(), MAVLINK_SIGNATURE_BLOCK_LEN);
+		p += MAVLINK_SIGNATURE_BLOCK_LEN;
+	}
+
+	return p - buf;
+}
+
 }	// namespace mavlink
 }	// namespace mavros_msgs
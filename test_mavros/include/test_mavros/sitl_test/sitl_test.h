@@ -20,6 +20,8 @@
 #include <ros/ros.h>
 #include <test_mavros/sitl_test/test_setup.h>
 #include <test_mavros/tests/offboard_control.h>
+#include <test_mavros/tests/latency_bench.h>
+#include <test_mavros/tests/traffic_gen.h>
 
 namespace sitltest {
 /**
@@ -0,0 +1,269 @@
+/**
+ * @brief End-to-end latency benchmark
+ * @file latency_bench.h
+ *
+ * @addtogroup sitl_test
+ * @{
+ */
+/*
+ * This file is part of the mavros package and subject to the license terms
+ * in the top-level LICENSE file of the mavros repository.
+ * https://github.com/mavlink/mavros/tree/master/LICENSE.md
+ */
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <mavconn/interface.h>
+#include <mavconn/thread_utils.h>
+#include <mavros/utils.h>
+#include <test_mavros/sitl_test/sitl_test.h>
+
+#include <mavros_msgs/StatusText.h>
+#include <geometry_msgs/PoseStamped.h>
+
+namespace testsetup {
+/**
+ * @brief End-to-end latency benchmark
+ *
+ * The bench node opens its own mavconn link and plays the FCU side of a
+ * loopback connection, while a regular mavros node connects to the other
+ * end. Two paths are measured with the host wall clock (both processes
+ * run on the same machine, so clock deltas are valid):
+ *
+ * - uplink: bench sends STATUSTEXT with an encoded sequence number,
+ *   mavros publishes it on /mavros/statustext/recv; latency covers
+ *   wire + transport ingress + router + plugin publication.
+ * - downlink: bench publishes a position setpoint with the sequence
+ *   number encoded in x, and stamps the SET_POSITION_TARGET_LOCAL_NED
+ *   arriving back at its transport ingress (message_received_cb).
+ *
+ * Results are printed as CSV (optionally to ~out_file) so regressions
+ * can be tracked per release:
+ *
+ *     direction,samples,sent,throughput_hz,p50_ms,p90_ms,p99_ms,max_ms
+ *
+ * Example wiring:
+ *
+ *     rosrun mavros mavros_node _fcu_url:=udp://:45000@127.0.0.1:45001
+ *     rosrun test_mavros sitl_test_node latency_bench \
+ *             _bench_url:=udp://:45001@127.0.0.1:45000
+ */
+class LatencyBench {
+public:
+	LatencyBench() :
+		nh_lb(test.nh),
+		local_pos_sp_pub(nh_lb.advertise<geometry_msgs::PoseStamped>("/mavros/setpoint_position/local", 10)),
+		statustext_sub(nh_lb.subscribe("/mavros/statustext/recv", 100, &LatencyBench::statustext_cb, this)),
+		rx_total(0)
+	{ };
+
+	void init() {
+		nh_lb.param<std::string>("bench_url", bench_url, "udp://:45001@127.0.0.1:45000");
+		nh_lb.param("rate", rate, 100.0);
+		nh_lb.param("duration", duration, 10.0);
+		nh_lb.param<std::string>("out_file", out_file, "");
+
+		const size_t probes = size_t(rate * duration) + 1;
+		uplink_sent.resize(probes);
+		downlink_sent.resize(probes);
+		uplink_lat_ms.reserve(probes);
+		downlink_lat_ms.reserve(probes);
+	}
+
+	/* -*- main routine -*- */
+
+	void spin(int argc, char *argv[]) {
+		init();
+
+		try {
+			// sysid/compid 1:1, so mavros accepts us as its target FCU
+			link = mavconn::MAVConnInterface::open_url(bench_url, 1, 1);
+		}
+		catch (mavconn::DeviceError &ex) {
+			ROS_FATAL_NAMED("sitl_test", "Latency bench: %s", ex.what());
+			return;
+		}
+
+		link->message_received_cb = std::bind(&LatencyBench::link_rx_cb, this,
+				std::placeholders::_1, std::placeholders::_2);
+
+		ROS_INFO("SITL Test: latency bench running on %s for %.1f s at %.1f Hz",
+				bench_url.c_str(), duration, rate);
+
+		ros::Rate loop_rate(rate);
+		const ros::WallTime t_end = ros::WallTime::now() + ros::WallDuration(duration);
+		size_t seq = 0;
+		int hb_div = std::max(1, int(rate));
+
+		while (ros::ok() && ros::WallTime::now() < t_end && seq < uplink_sent.size()) {
+			if (seq % hb_div == 0)
+				send_heartbeat();
+
+			send_uplink_probe(seq);
+			send_downlink_probe(seq);
+			seq++;
+
+			loop_rate.sleep();
+			ros::spinOnce();
+		}
+
+		// grace period for in-flight probes
+		ros::WallTime t_grace = ros::WallTime::now() + ros::WallDuration(1.0);
+		while (ros::ok() && ros::WallTime::now() < t_grace) {
+			loop_rate.sleep();
+			ros::spinOnce();
+		}
+
+		report(seq);
+		link->close();
+		ros::shutdown();
+	}
+
+private:
+	TestSetup test;
+
+	ros::NodeHandle nh_lb;
+	ros::Publisher local_pos_sp_pub;
+	ros::Subscriber statustext_sub;
+
+	mavconn::MAVConnInterface::Ptr link;
+
+	std::string bench_url;
+	std::string out_file;
+	double rate;
+	double duration;
+
+	//! guards latency sample vectors: link_rx_cb() runs on the mavconn IO thread
+	std::mutex mutex;
+	std::vector<ros::WallTime> uplink_sent;
+	std::vector<ros::WallTime> downlink_sent;
+	std::vector<double> uplink_lat_ms;
+	std::vector<double> downlink_lat_ms;
+	size_t rx_total;
+
+	/* -*- probe senders -*- */
+
+	void send_heartbeat() {
+		using mavlink::common::MAV_AUTOPILOT;
+		using mavlink::common::MAV_MODE;
+		using mavlink::common::MAV_STATE;
+		using mavlink::common::MAV_TYPE;
+
+		mavlink::common::msg::HEARTBEAT hb {};
+
+		hb.type = mavros::utils::enum_value(MAV_TYPE::QUADROTOR);
+		hb.autopilot = mavros::utils::enum_value(MAV_AUTOPILOT::PX4);
+		hb.base_mode = mavros::utils::enum_value(MAV_MODE::MANUAL_ARMED);
+		hb.custom_mode = 0;
+		hb.system_status = mavros::utils::enum_value(MAV_STATE::ACTIVE);
+
+		link->send_message_ignore_drop(hb);
+	}
+
+	void send_uplink_probe(size_t seq) {
+		mavlink::common::msg::STATUSTEXT st {};
+
+		st.severity = mavros::utils::enum_value(mavlink::common::MAV_SEVERITY::NOTICE);
+		mavlink::set_string_z(st.text, mavconn::utils::format("latbench %zu", seq));
+
+		uplink_sent[seq] = ros::WallTime::now();
+		link->send_message_ignore_drop(st);
+	}
+
+	void send_downlink_probe(size_t seq) {
+		geometry_msgs::PoseStamped sp {};
+
+		sp.header.stamp = ros::Time::now();
+		// sequence number travels in x, read back in link_rx_cb()
+		sp.pose.position.x = seq;
+		sp.pose.orientation.w = 1.0;
+
+		downlink_sent[seq] = ros::WallTime::now();
+		local_pos_sp_pub.publish(sp);
+	}
+
+	/* -*- callbacks -*- */
+
+	void statustext_cb(const mavros_msgs::StatusText::ConstPtr &req) {
+		size_t seq;
+		if (std::sscanf(req->text.c_str(), "latbench %zu", &seq) != 1)
+			return;
+
+		auto now = ros::WallTime::now();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if (seq < uplink_sent.size() && !uplink_sent[seq].isZero())
+			uplink_lat_ms.push_back((now - uplink_sent[seq]).toSec() * 1e3);
+	}
+
+	void link_rx_cb(const mavlink::mavlink_message_t *msg, const mavconn::Framing framing) {
+		if (framing != mavconn::Framing::ok)
+			return;
+
+		auto now = ros::WallTime::now();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		rx_total++;
+
+		if (msg->msgid != mavlink::common::msg::SET_POSITION_TARGET_LOCAL_NED::MSG_ID)
+			return;
+
+		mavlink::MsgMap map(msg);
+		mavlink::common::msg::SET_POSITION_TARGET_LOCAL_NED sp;
+		sp.deserialize(map);
+
+		// NED <-> ENU conversion moves the encoded x to y
+		size_t seq = size_t(sp.y + 0.5f);
+		if (seq < downlink_sent.size() && !downlink_sent[seq].isZero())
+			downlink_lat_ms.push_back((now - downlink_sent[seq]).toSec() * 1e3);
+	}
+
+	/* -*- reporting -*- */
+
+	static double percentile(const std::vector<double> &sorted, double p) {
+		if (sorted.empty())
+			return -1.0;
+
+		size_t idx = size_t(p / 100.0 * sorted.size());
+		return sorted[std::min(idx, sorted.size() - 1)];
+	}
+
+	void report_direction(std::ostream &os, const char *direction,
+			std::vector<double> &lat_ms, size_t sent) {
+		std::sort(lat_ms.begin(), lat_ms.end());
+
+		os << direction << ','
+			<< lat_ms.size() << ','
+			<< sent << ','
+			<< (lat_ms.size() / duration) << ','
+			<< percentile(lat_ms, 50.0) << ','
+			<< percentile(lat_ms, 90.0) << ','
+			<< percentile(lat_ms, 99.0) << ','
+			<< (lat_ms.empty() ? -1.0 : lat_ms.back()) << '\n';
+	}
+
+	void report(size_t sent) {
+		std::lock_guard<std::mutex> lock(mutex);
+
+		std::ofstream file;
+		if (!out_file.empty())
+			file.open(out_file);
+
+		std::ostream &os = file.is_open() ? file : std::cout;
+
+		os << "direction,samples,sent,throughput_hz,p50_ms,p90_ms,p99_ms,max_ms\n";
+		report_direction(os, "uplink", uplink_lat_ms, sent);
+		report_direction(os, "downlink", downlink_lat_ms, sent);
+
+		ROS_INFO("Latency bench done: %zu probes sent, %zu uplink / %zu downlink samples, "
+				"%zu messages at transport ingress",
+				sent, uplink_lat_ms.size(), downlink_lat_ms.size(), rx_total);
+	}
+};
+};	// namespace testsetup
@@ -0,0 +1,252 @@
+/**
+ * @brief Synthetic MAVLink traffic generator
+ * @file traffic_gen.h
+ *
+ * @addtogroup sitl_test
+ * @{
+ */
+/*
+ * This file is part of the mavros package and subject to the license terms
+ * in the top-level LICENSE file of the mavros repository.
+ * https://github.com/mavlink/mavros/tree/master/LICENSE.md
+ */
+
+#pragma once
+
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <utility>
+#include <iostream>
+#include <algorithm>
+#include <mavconn/interface.h>
+#include <mavconn/thread_utils.h>
+#include <mavros/utils.h>
+#include <test_mavros/sitl_test/sitl_test.h>
+
+#include <diagnostic_msgs/DiagnosticArray.h>
+
+namespace testsetup {
+/**
+ * @brief Synthetic MAVLink load generator
+ *
+ * Plays the FCU side of a loopback link and synthesizes a configurable
+ * message mix against a mavros instance: a steady HIGHRES_IMU stream,
+ * a steady ATTITUDE stream and periodic STATUSTEXT bursts. Each stream
+ * is driven by its own absolute steady-clock deadline, so the mix keeps
+ * its shape even when one stream runs at line rate.
+ *
+ * While generating, the node scrapes the "mavros dispatch" per-handler
+ * profiler from /diagnostics (run mavros with ~plugin_profiling:=true)
+ * and dumps the last sample next to the achieved generator rates, to
+ * locate the node's saturation point before flying a new companion
+ * board.
+ *
+ * Example:
+ *
+ *     rosrun mavros mavros_node _fcu_url:=udp://:45000@127.0.0.1:45001 \
+ *             _plugin_profiling:=true
+ *     rosrun test_mavros sitl_test_node traffic_gen \
+ *             _bench_url:=udp://:45001@127.0.0.1:45000 _imu_rate:=1000
+ */
+class TrafficGen {
+public:
+	TrafficGen() :
+		nh_tg(test.nh),
+		diag_sub(nh_tg.subscribe("/diagnostics", 10, &TrafficGen::diag_cb, this)),
+		imu_sent(0),
+		att_sent(0),
+		st_sent(0)
+	{ };
+
+	void init() {
+		nh_tg.param<std::string>("bench_url", bench_url, "udp://:45001@127.0.0.1:45000");
+		nh_tg.param("duration", duration, 30.0);
+		nh_tg.param("imu_rate", imu_rate, 1000.0);
+		nh_tg.param("attitude_rate", attitude_rate, 100.0);
+		nh_tg.param("statustext_burst", statustext_burst, 10);
+		nh_tg.param("statustext_burst_period", statustext_burst_period, 1.0);
+	}
+
+	/* -*- main routine -*- */
+
+	void spin(int argc, char *argv[]) {
+		using namespace std::chrono;
+
+		init();
+
+		try {
+			// sysid/compid 1:1, so mavros accepts us as its target FCU
+			link = mavconn::MAVConnInterface::open_url(bench_url, 1, 1);
+		}
+		catch (mavconn::DeviceError &ex) {
+			ROS_FATAL_NAMED("sitl_test", "Traffic gen: %s", ex.what());
+			return;
+		}
+
+		ROS_INFO("SITL Test: traffic gen on %s: %.0f Hz HIGHRES_IMU + %.0f Hz ATTITUDE "
+				"+ %d STATUSTEXT burst every %.1f s, %.1f s run",
+				bench_url.c_str(), imu_rate, attitude_rate,
+				statustext_burst, statustext_burst_period, duration);
+
+		const auto t_start = steady_clock::now();
+		const auto t_end = t_start + nanoseconds(int64_t(duration * 1e9));
+
+		auto period_of = [](double rate) {
+			return nanoseconds((rate > 0.0) ? int64_t(1e9 / rate) : int64_t(1e18));
+		};
+
+		const auto imu_period = period_of(imu_rate);
+		const auto att_period = period_of(attitude_rate);
+		const auto burst_period = period_of(1.0 / statustext_burst_period);
+		const auto hb_period = seconds(1);
+
+		auto next_imu = t_start;
+		auto next_att = t_start;
+		auto next_burst = t_start;
+		auto next_hb = t_start;
+
+		while (ros::ok() && steady_clock::now() < t_end) {
+			auto now = steady_clock::now();
+
+			if (now >= next_hb) {
+				send_heartbeat();
+				next_hb += hb_period;
+			}
+			if (imu_rate > 0.0 && now >= next_imu) {
+				send_highres_imu(now - t_start);
+				next_imu += imu_period;
+			}
+			if (attitude_rate > 0.0 && now >= next_att) {
+				send_attitude(now - t_start);
+				next_att += att_period;
+			}
+			if (statustext_burst > 0 && now >= next_burst) {
+				send_statustext_burst();
+				next_burst += burst_period;
+			}
+
+			ros::spinOnce();
+
+			auto next = std::min({next_imu, next_att, next_burst, next_hb});
+			if (next > steady_clock::now())
+				std::this_thread::sleep_until(next);
+		}
+
+		report(duration_cast<std::chrono::duration<double>>(steady_clock::now() - t_start).count());
+		link->close();
+		ros::shutdown();
+	}
+
+private:
+	TestSetup test;
+
+	ros::NodeHandle nh_tg;
+	ros::Subscriber diag_sub;
+
+	mavconn::MAVConnInterface::Ptr link;
+
+	std::string bench_url;
+	double duration;
+	double imu_rate;
+	double attitude_rate;
+	int statustext_burst;
+	double statustext_burst_period;
+
+	size_t imu_sent;
+	size_t att_sent;
+	size_t st_sent;
+
+	//! last scraped "mavros dispatch" profiler sample
+	std::vector<std::pair<std::string, std::string>> dispatch_profile;
+
+	/* -*- generators -*- */
+
+	void send_heartbeat() {
+		using mavlink::common::MAV_AUTOPILOT;
+		using mavlink::common::MAV_MODE;
+		using mavlink::common::MAV_STATE;
+		using mavlink::common::MAV_TYPE;
+
+		mavlink::common::msg::HEARTBEAT hb {};
+
+		hb.type = mavros::utils::enum_value(MAV_TYPE::QUADROTOR);
+		hb.autopilot = mavros::utils::enum_value(MAV_AUTOPILOT::PX4);
+		hb.base_mode = mavros::utils::enum_value(MAV_MODE::MANUAL_ARMED);
+		hb.custom_mode = 0;
+		hb.system_status = mavros::utils::enum_value(MAV_STATE::ACTIVE);
+
+		link->send_message_ignore_drop(hb);
+	}
+
+	void send_highres_imu(std::chrono::steady_clock::duration since_start) {
+		mavlink::common::msg::HIGHRES_IMU imu {};
+
+		imu.time_usec = std::chrono::duration_cast<std::chrono::microseconds>(since_start).count();
+		imu.zacc = -9.81f;
+		imu.abs_pressure = 1013.25f;
+		imu.temperature = 25.0f;
+		imu.fields_updated = 0x1fff;
+
+		link->send_message_ignore_drop(imu);
+		imu_sent++;
+	}
+
+	void send_attitude(std::chrono::steady_clock::duration since_start) {
+		mavlink::common::msg::ATTITUDE att {};
+
+		att.time_boot_ms = std::chrono::duration_cast<std::chrono::milliseconds>(since_start).count();
+		att.roll = 0.1f;
+		att.pitch = -0.1f;
+		att.yaw = 1.0f;
+
+		link->send_message_ignore_drop(att);
+		att_sent++;
+	}
+
+	void send_statustext_burst() {
+		mavlink::common::msg::STATUSTEXT st {};
+
+		st.severity = mavros::utils::enum_value(mavlink::common::MAV_SEVERITY::NOTICE);
+
+		for (int i = 0; i < statustext_burst; i++) {
+			// distinct texts so the sys_status dedup filter passes them
+			mavlink::set_string_z(st.text, mavconn::utils::format("load burst %zu", st_sent));
+			link->send_message_ignore_drop(st);
+			st_sent++;
+		}
+	}
+
+	/* -*- callbacks -*- */
+
+	void diag_cb(const diagnostic_msgs::DiagnosticArray::ConstPtr &da) {
+		for (const auto &status : da->status) {
+			if (status.name.find("mavros dispatch") == std::string::npos)
+				continue;
+
+			dispatch_profile.clear();
+			for (const auto &kv : status.values)
+				dispatch_profile.emplace_back(kv.key, kv.value);
+		}
+	}
+
+	/* -*- reporting -*- */
+
+	void report(double elapsed) {
+		std::cout << "stream,sent,rate_hz\n";
+		std::cout << "HIGHRES_IMU," << imu_sent << ',' << imu_sent / elapsed << '\n';
+		std::cout << "ATTITUDE," << att_sent << ',' << att_sent / elapsed << '\n';
+		std::cout << "STATUSTEXT," << st_sent << ',' << st_sent / elapsed << '\n';
+
+		if (dispatch_profile.empty()) {
+			ROS_WARN("Traffic gen: no \"mavros dispatch\" diagnostics seen; "
+					"run mavros with ~plugin_profiling:=true");
+			return;
+		}
+
+		std::cout << "handler,profile\n";
+		for (const auto &kv : dispatch_profile)
+			std::cout << kv.first << ',' << kv.second << '\n';
+	}
+};
+};	// namespace testsetup
@@ -28,6 +28,18 @@ void SitlTest::spin(int argc, char *argv[])
 		testsetup::OffboardControl offboard_control;
 		offboard_control.spin(argc, argv);
 	}
+	else if (strcmp(argv[1],"latency_bench") == 0)
+	{
+		ros::init(argc, argv, "latency_bench");
+		testsetup::LatencyBench latency_bench;
+		latency_bench.spin(argc, argv);
+	}
+	else if (strcmp(argv[1],"traffic_gen") == 0)
+	{
+		ros::init(argc, argv, "traffic_gen");
+		testsetup::TrafficGen traffic_gen;
+		traffic_gen.spin(argc, argv);
+	}
 
 	/** @todo add more testing structures */
 }